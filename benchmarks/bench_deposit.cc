@@ -0,0 +1,129 @@
+#include "benchmark.h"
+
+#include "synergia/collective/deposit.h"
+#include "synergia/collective/domain_tracker.h"
+#include "synergia/utils/distributed_fft3d.h"
+
+namespace {
+    // nominal cloud-in-cell costs per particle: read x, y, z and the mask,
+    // then a read-modify-write of 8 (3d) or 4 (2d) grid cells
+    const double bytes_3d = 3 * sizeof(double) + sizeof(int) + 16 * 8;
+    const double bytes_2d = 3 * sizeof(double) + sizeof(int) + 16 * 4;
+
+    const double flops_3d = 40.0;
+    const double flops_2d = 20.0;
+
+    void
+    bench_deposit_3d(Bench_runner& runner, Bunch const& bunch)
+    {
+        const int g = runner.get_options().grid;
+
+        // domain of the 3d open hockney solver, about 10 sigma wide
+        std::array<int, 3> shape{g, g, g};
+        Rectangular_grid_domain domain(
+            shape, {1e-2, 1e-2, 1e-1}, {0.0, 0.0, 0.0}, false);
+
+        std::array<int, 3> dims{
+            Distributed_fft3d::get_padded_shape_real(2 * g), 2 * g, 2 * g};
+
+        karray1d_dev rho("rho", dims[0] * dims[1] * dims[2]);
+        karray1d moments("moments", Domain_tracker::num_moments);
+
+        syn::json params{{"particles", bunch.size()}, {"grid", shape}};
+
+        Bench_work work{"particles",
+                        double(bunch.size()),
+                        bunch.size() * bytes_3d,
+                        bunch.size() * flops_3d};
+
+        runner.run("deposit/3d_kokkos_scatter_view", params, work, [&]() {
+            deposit_charge_rectangular_3d_kokkos_scatter_view(
+                rho, domain, dims, bunch);
+        });
+
+        runner.run(
+            "deposit/3d_kokkos_scatter_view_moments", params, work, [&]() {
+                deposit_charge_rectangular_3d_kokkos_scatter_view(
+                    rho, domain, dims, bunch, &moments);
+            });
+
+#ifdef SYNERGIA_ENABLE_OPENMP
+        runner.run("deposit/3d_omp_reduce", params, work, [&]() {
+            deposit_charge_rectangular_3d_omp_reduce(rho, domain, dims, bunch);
+        });
+
+        runner.run("deposit/3d_omp_reduce_moments", params, work, [&]() {
+            deposit_charge_rectangular_3d_omp_reduce(
+                rho, domain, dims, bunch, &moments);
+        });
+#endif
+
+        // grid of the rectangular solver
+        karray1d_dev rho_xyz("rho_xyz", g * g * g);
+
+        runner.run("deposit/3d_kokkos_scatter_view_xyz", params, work, [&]() {
+            deposit_charge_rectangular_3d_kokkos_scatter_view_xyz(
+                rho_xyz, domain, shape, bunch);
+        });
+
+#ifdef SYNERGIA_ENABLE_OPENMP
+        runner.run("deposit/3d_omp_reduce_xyz", params, work, [&]() {
+            deposit_charge_rectangular_3d_omp_reduce_xyz(
+                rho_xyz, domain, shape, bunch);
+        });
+#endif
+    }
+
+    void
+    bench_deposit_2d(Bench_runner& runner, Bunch const& bunch)
+    {
+        const int g = runner.get_options().grid;
+
+        // doubled domain of the 2d open hockney solver
+        std::array<int, 3> shape{2 * g, 2 * g, g};
+        Rectangular_grid_domain domain(
+            shape, {2e-2, 2e-2, 1e-1}, {0.0, 0.0, 0.0}, false);
+
+        karray1d_dev rho("rho", shape[0] * shape[1] * 2 + shape[2]);
+        karray2d_dev bin("particle_bin", bunch.size(), 6);
+
+        // returned by the non-scatter-view variants
+        karray1d_dev rho_ret;
+
+        syn::json params{{"particles", bunch.size()}, {"grid", shape}};
+
+        Bench_work work{"particles",
+                        double(bunch.size()),
+                        bunch.size() * bytes_2d,
+                        bunch.size() * flops_2d};
+
+        runner.run("deposit/2d_kokkos", params, work, [&]() {
+            rho_ret = deposit_charge_rectangular_2d_kokkos(domain, bin, bunch);
+        });
+
+        runner.run("deposit/2d_kokkos_atomic", params, work, [&]() {
+            rho_ret = deposit_charge_rectangular_2d_kokkos_atomic(
+                domain, bin, bunch);
+        });
+
+        runner.run("deposit/2d_kokkos_scatter_view", params, work, [&]() {
+            deposit_charge_rectangular_2d_kokkos_scatter_view(
+                rho, domain, bin, bunch);
+        });
+
+#ifdef SYNERGIA_ENABLE_OPENMP
+        runner.run("deposit/2d_omp_reduce", params, work, [&]() {
+            deposit_charge_rectangular_2d_omp_reduce(rho, domain, bin, bunch);
+        });
+#endif
+    }
+}
+
+void
+bench_deposit(Bench_runner& runner)
+{
+    auto bunch = make_bench_bunch(runner.get_options().particles);
+
+    bench_deposit_3d(runner, bunch);
+    bench_deposit_2d(runner, bunch);
+}
@@ -0,0 +1,60 @@
+#include "benchmark.h"
+
+#include "synergia/bunch/core_diagnostics.h"
+
+namespace {
+    // the 6 coordinates and the mask are read once per reduction
+    const double bytes_per_particle = 6 * sizeof(double) + sizeof(int);
+
+    void
+    bench_moments(Bench_runner& runner, Bunch const& bunch, bool half_lost)
+    {
+        syn::json params{{"particles", bunch.size()},
+                         {"masked", half_lost ? "half" : "none"}};
+
+        auto work = [&](double flops) {
+            return Bench_work{"particles",
+                              double(bunch.size()),
+                              bunch.size() * bytes_per_particle,
+                              bunch.size() * flops};
+        };
+
+        auto mean = Core_diagnostics::calculate_mean(bunch);
+
+        runner.run("diagnostics/mean", params, work(6.0), [&]() {
+            Core_diagnostics::calculate_mean(bunch);
+        });
+
+        runner.run("diagnostics/std", params, work(18.0), [&]() {
+            Core_diagnostics::calculate_std(bunch, mean);
+        });
+
+        // 21 independent second moments, each a subtract, multiply and add
+        runner.run("diagnostics/mom2", params, work(12.0 + 42.0), [&]() {
+            Core_diagnostics::calculate_mom2(bunch, mean);
+        });
+
+        runner.run("diagnostics/min", params, work(6.0), [&]() {
+            Core_diagnostics::calculate_min(bunch);
+        });
+
+        runner.run("diagnostics/max", params, work(6.0), [&]() {
+            Core_diagnostics::calculate_max(bunch);
+        });
+
+        runner.run("diagnostics/spatial_mean_stddev", params, work(9.0), [&]() {
+            Core_diagnostics::calculate_spatial_mean_stddev(bunch);
+        });
+    }
+}
+
+void
+bench_diagnostics(Bench_runner& runner)
+{
+    for (bool half_lost : {false, true}) {
+        auto bunch =
+            make_bench_bunch(runner.get_options().particles, half_lost);
+
+        bench_moments(runner, bunch, half_lost);
+    }
+}
@@ -0,0 +1,82 @@
+#include <cmath>
+
+#include "benchmark.h"
+
+#include "synergia/utils/distributed_fft2d.h"
+#include "synergia/utils/distributed_fft3d.h"
+
+namespace {
+    // nominal 5 N log2(N) flops of a complex transform of size N, halved
+    // for the real-to-complex ones
+    double
+    fft_flops(double n)
+    {
+        return 2.5 * n * std::log2(n);
+    }
+
+    void
+    bench_fft3d(Bench_runner& runner)
+    {
+        // doubled grid of the 3d open hockney solver
+        const int g = 2 * runner.get_options().grid;
+        std::array<int, 3> shape{g, g, g};
+
+        Distributed_fft3d fft;
+        fft.construct(shape, runner.get_comm());
+
+        const int nx_real = Distributed_fft3d::get_padded_shape_real(g);
+        karray1d_dev buf("buf", nx_real * g * g);
+
+        const double n = double(g) * g * g;
+
+        syn::json params{{"shape", shape},
+                         {"ranks", runner.get_comm().size()}};
+
+        Bench_work work{"points", n, 2 * n * sizeof(double), fft_flops(n)};
+
+        // the transforms are in place, as in the solver
+        runner.run("fft/3d_r2c", params, work, [&]() {
+            fft.transform(buf, buf);
+        });
+
+        runner.run("fft/3d_c2r", params, work, [&]() {
+            fft.inv_transform(buf, buf);
+        });
+    }
+
+    void
+    bench_fft2d(Bench_runner& runner)
+    {
+        // doubled grid of the 2d open hockney solver
+        const int g = 2 * runner.get_options().grid;
+        std::array<int, 2> shape{g, g};
+
+        Distributed_fft2d fft;
+        fft.construct(shape, runner.get_comm());
+
+        karray1d_dev buf("buf", g * g * 2);
+
+        const double n = double(g) * g;
+
+        syn::json params{{"shape", shape},
+                         {"ranks", runner.get_comm().size()}};
+
+        Bench_work work{
+            "points", n, 4 * n * sizeof(double), 2.0 * fft_flops(n)};
+
+        runner.run("fft/2d_c2c_forward", params, work, [&]() {
+            fft.transform(buf, buf);
+        });
+
+        runner.run("fft/2d_c2c_backward", params, work, [&]() {
+            fft.inv_transform(buf, buf);
+        });
+    }
+}
+
+void
+bench_fft(Bench_runner& runner)
+{
+    bench_fft3d(runner);
+    bench_fft2d(runner);
+}
@@ -0,0 +1,290 @@
+#include "benchmark.h"
+
+#include "synergia/bunch/particle_tiles.h"
+#include "synergia/lattice/lattice.h"
+#include "synergia/libFF/ff_element.h"
+
+namespace {
+    // nominal read and write of the 6 coordinates plus the mask
+    const double bytes_per_particle = 2 * 6 * sizeof(double) + sizeof(int);
+
+    // nominal flops per particle, counted from FF_algorithm::drift_unit
+    // and FF_algorithm::thin_quadrupole_unit
+    const double drift_flops = 30.0;
+    const double thin_quad_flops = 8.0;
+
+    Lattice_element
+    make_element(std::string const& type,
+                 std::vector<std::pair<std::string, double>> const& attrs)
+    {
+        Lattice_element e(type, "bench_" + type);
+        for (auto const& a : attrs)
+            e.set_double_attribute(a.first, a.second);
+        return e;
+    }
+
+    // benchmark lattice, one element of each type handled by libFF
+    Lattice
+    make_lattice(Reference_particle const& ref)
+    {
+        Lattice lattice("bench", ref);
+
+        lattice.append(make_element("drift", {{"l", 1.0}}));
+        lattice.append(make_element("quadrupole", {{"l", 1.0}, {"k1", 0.5}}));
+        lattice.append(make_element("quadrupole", {{"l", 0.0}, {"k1", 0.5}}));
+        lattice.append(make_element("sbend", {{"l", 1.0}, {"angle", 0.01}}));
+        lattice.append(make_element("sextupole", {{"l", 0.2}, {"k2", 1.0}}));
+        lattice.append(make_element("octupole", {{"l", 0.2}, {"k3", 1.0}}));
+        lattice.append(make_element("hkicker", {{"l", 0.0}, {"kick", 1e-4}}));
+        lattice.append(make_element("solenoid", {{"l", 1.0}, {"ks", 0.1}}));
+        lattice.append(make_element(
+            "rfcavity", {{"l", 0.0}, {"volt", 0.1}, {"freq", 50.0}}));
+        lattice.append(make_element("dipedge", {{"h", 0.01}, {"e1", 0.005}}));
+        lattice.append(make_element(
+            "nllens", {{"l", 0.0}, {"knll", 1e-6}, {"cnll", 0.01}}));
+        lattice.append(make_element("elens",
+                                    {{"l", 1.0},
+                                     {"current", 1.0},
+                                     {"eenergy", 10.0},
+                                     {"radius", 1e-3},
+                                     {"gaussian", 1.0}}));
+
+        auto mp = make_element("multipole", {});
+        mp.set_vector_attribute("knl", {0.0, 0.1, 0.2, 0.3});
+        lattice.append(mp);
+
+        return lattice;
+    }
+
+    std::string
+    element_label(Lattice_element const& e)
+    {
+        auto label = e.get_type_name();
+        if (e.get_double_attribute("l", 0.0) == 0.0) label += "_thin";
+        return label;
+    }
+
+    // whole element apply, as in the propagation (GSVector kernels where
+    // available)
+    void
+    bench_elements(Bench_runner& runner, Bunch& bunch, bool half_lost)
+    {
+        auto lattice = make_lattice(bunch.get_reference_particle());
+
+        syn::json params{{"particles", bunch.size()},
+                         {"masked", half_lost ? "half" : "none"}};
+
+        Bench_work work{"particles",
+                        double(bunch.size()),
+                        bunch.size() * bytes_per_particle,
+                        0.0};
+
+        for (auto const& e : lattice.get_elements()) {
+            Lattice_element_slice slice(e);
+
+            runner.run("libff/element/" + element_label(e),
+                       params,
+                       work,
+                       [&]() { FF_element::apply(slice, bunch); });
+        }
+    }
+
+    // a run of the elements FF_element::supports_tiles(), propagated on
+    // the column layout and on the tiles. The tiled run includes the
+    // pack and unpack of the bunch, as in a tiled LibFF_operation
+    void
+    bench_tiled_run(Bench_runner& runner, Bunch& bunch, bool half_lost)
+    {
+        auto lattice = make_lattice(bunch.get_reference_particle());
+
+        std::vector<Lattice_element_slice> slices;
+        for (auto const& e : lattice.get_elements()) {
+            Lattice_element_slice slice(e);
+            if (FF_element::supports_tiles(slice)) slices.push_back(slice);
+        }
+
+        syn::json params{{"particles", bunch.size()},
+                         {"masked", half_lost ? "half" : "none"},
+                         {"elements", slices.size()}};
+
+        Bench_work work{"particles",
+                        double(bunch.size()),
+                        slices.size() * bunch.size() * bytes_per_particle,
+                        0.0};
+
+        runner.run("libff/run/columns", params, work, [&]() {
+            for (auto const& slice : slices)
+                FF_element::apply(slice, bunch);
+        });
+
+        tiled_bunch_t<> tiles;
+
+        runner.run("libff/run/tiled", params, work, [&]() {
+            tiles.pack(bunch);
+            for (auto const& slice : slices)
+                FF_element::apply_tiled(slice, tiles);
+            tiles.unpack();
+        });
+    }
+
+    // scalar and GSVector kernels of the same element
+    template <class Scalar, class Simd>
+    void
+    bench_pair(Bench_runner& runner,
+               std::string const& name,
+               Bunch& bunch,
+               bool half_lost,
+               double flops,
+               Scalar const& scalar,
+               Simd const& simd)
+    {
+        using exec = Bunch::exec_space;
+
+        Bench_work work{"particles",
+                        double(bunch.size()),
+                        bunch.size() * bytes_per_particle,
+                        bunch.size() * flops};
+
+        std::string masked = half_lost ? "half" : "none";
+
+        runner.run(name + "/scalar",
+                   {{"particles", bunch.size()}, {"masked", masked}},
+                   work,
+                   [&]() {
+                       Kokkos::parallel_for(
+                           Kokkos::RangePolicy<exec>(0, bunch.size()),
+                           scalar);
+                   });
+
+        runner.run(name + "/gsvector",
+                   {{"particles", bunch.size()},
+                    {"masked", masked},
+                    {"width", Bunch::gsv_t::size()}},
+                   work,
+                   [&]() {
+                       Kokkos::parallel_for(
+                           Kokkos::RangePolicy<exec>(0, bunch.size_in_gsv()),
+                           simd);
+                   });
+    }
+
+    void
+    bench_kernels(Bench_runner& runner, Bunch& bunch, bool half_lost)
+    {
+        using bp_t = Bunch::bp_t;
+
+        auto& bp = bunch.get_bunch_particles();
+
+        double ref_p = bunch.get_reference_particle().get_momentum();
+        double mass = bunch.get_mass();
+
+        {
+            using namespace drift_impl;
+
+            PropDrift<bp_t> scalar{bp.parts, bp.masks, 1.0, ref_p, mass, 0.0};
+            PropDriftSimd<bp_t> simd{
+                bp.parts, bp.masks, 1.0, ref_p, mass, 0.0};
+
+            bench_pair(runner,
+                       "libff/kernel/drift",
+                       bunch,
+                       half_lost,
+                       drift_flops,
+                       scalar,
+                       simd);
+
+            // the same GSVector kernel on the tiled (AoSoA) layout
+            using tiles_t = particle_tiles_t<>;
+
+            tiles_t tiles(bunch.size());
+            tiles.pack(bp);
+
+            PropDriftSimd<tiles_t> tiled{
+                tiles.parts, tiles.masks, 1.0, ref_p, mass, 0.0};
+
+            Bench_work work{"particles",
+                            double(bunch.size()),
+                            bunch.size() * bytes_per_particle,
+                            bunch.size() * drift_flops};
+
+            runner.run("libff/kernel/drift/gsvector_tiled",
+                       {{"particles", bunch.size()},
+                        {"masked", half_lost ? "half" : "none"},
+                        {"width", tiles_t::tile_width}},
+                       work,
+                       [&]() {
+                           Kokkos::parallel_for(
+                               Kokkos::RangePolicy<Bunch::exec_space>(
+                                   0, tiles.size_in_gsv()),
+                               tiled);
+                       });
+        }
+
+        {
+            using namespace quad_impl;
+
+            PropQuadThin<bp_t> scalar{bp.parts, bp.masks, {0.5, 0.0}, 0.0, 0.0};
+            PropQuadThinSimd<bp_t> simd{
+                bp.parts, bp.masks, {0.5, 0.0}, 0.0, 0.0};
+
+            bench_pair(runner,
+                       "libff/kernel/quadrupole_thin",
+                       bunch,
+                       half_lost,
+                       thin_quad_flops,
+                       scalar,
+                       simd);
+        }
+
+        {
+            using namespace quad_impl;
+
+            // 4 yoshida steps over 1 m
+            const int steps = 4;
+            const double step_l = 1.0 / steps;
+
+            PropQuad<bp_t> scalar{bp.parts,
+                                  bp.masks,
+                                  steps,
+                                  0.0,
+                                  0.0,
+                                  ref_p,
+                                  mass,
+                                  0.0,
+                                  step_l,
+                                  {0.5 * step_l, 0.0}};
+
+            PropQuadSimd<bp_t> simd{bp.parts,
+                                    bp.masks,
+                                    steps,
+                                    0.0,
+                                    0.0,
+                                    ref_p,
+                                    mass,
+                                    0.0,
+                                    step_l,
+                                    {0.5 * step_l, 0.0}};
+
+            bench_pair(runner,
+                       "libff/kernel/quadrupole",
+                       bunch,
+                       half_lost,
+                       0.0,
+                       scalar,
+                       simd);
+        }
+    }
+}
+
+void
+bench_libff(Bench_runner& runner)
+{
+    for (bool half_lost : {false, true}) {
+        auto bunch =
+            make_bench_bunch(runner.get_options().particles, half_lost);
+
+        bench_elements(runner, bunch, half_lost);
+        bench_tiled_run(runner, bunch, half_lost);
+        bench_kernels(runner, bunch, half_lost);
+    }
+}
@@ -0,0 +1,58 @@
+#include <stdexcept>
+
+#include "benchmark.h"
+
+#include "synergia/lattice/madx.h"
+#include "synergia/lattice/mx_expr.h"
+#include "synergia/lattice/mx_parse.h"
+
+using namespace synergia;
+
+namespace {
+    // evaluations per timed call
+    const int num = 10000;
+
+    mx_expr
+    parse(std::string const& s)
+    {
+        mx_expr expr;
+        if (!parse_expression(s, expr))
+            throw std::runtime_error("bench_mx_eval: cannot parse " + s);
+        return expr;
+    }
+
+    void
+    bench_expression(Bench_runner& runner,
+                     std::string const& name,
+                     std::string const& str,
+                     MadX const* mx)
+    {
+        auto expr = parse(str);
+
+        Bench_work work{"evaluations", double(num), 0.0, 0.0};
+
+        volatile double sink = 0.0;
+
+        runner.run("mx_eval/" + name, {{"expression", str}}, work, [&]() {
+            double sum = 0.0;
+            for (int i = 0; i < num; ++i)
+                sum += mx ? mx_eval(expr, *mx) : mx_eval(expr);
+            sink = sink + sum;
+        });
+    }
+}
+
+void
+bench_mx_eval(Bench_runner& runner)
+{
+    // variables of the expressions, as they would come from a lattice file
+    MadX mx;
+    if (!parse_madx("kf = 0.0123; lq = 0.5; brho = 29.65; ang = 0.01;", mx))
+        throw std::runtime_error("bench_mx_eval: cannot parse variables");
+
+    bench_expression(runner, "constant", "3.0 * (1.0 + 2.0) / 7.0", nullptr);
+    bench_expression(runner, "functions", "sin(0.1) + sqrt(2.0)", nullptr);
+    bench_expression(runner, "variables", "kf * lq / brho", &mx);
+    bench_expression(
+        runner, "nested", "2.0 * sin(ang / 2.0) * kf / (lq + 1.0)", &mx);
+}
@@ -0,0 +1,69 @@
+#include "benchmark.h"
+
+#include "synergia/foundation/trigon.h"
+
+namespace {
+    // monomials of exactly power p in 6 variables, C(p + 5, 5)
+    double
+    monomials(unsigned int p)
+    {
+        double c = 1.0;
+        for (unsigned int i = 1; i <= 5; ++i)
+            c = c * (p + i) / i;
+        return c;
+    }
+
+    // nominal flops of a truncated product, one multiply-add for every
+    // pair of terms with p1 + p2 <= P
+    double
+    product_flops(unsigned int power)
+    {
+        double f = 0.0;
+        for (unsigned int p1 = 0; p1 <= power; ++p1)
+            for (unsigned int p2 = 0; p1 + p2 <= power; ++p2)
+                f += 2.0 * monomials(p1) * monomials(p2);
+        return f;
+    }
+
+    template <unsigned int P>
+    void
+    bench_product(Bench_runner& runner)
+    {
+        using trigon_t = Trigon<double, P, 6>;
+
+        // products per timed call
+        const int num = 1000;
+
+        trigon_t x(0.1, 0), px(0.01, 1), y(0.2, 2);
+        trigon_t t = x * px + y;
+
+        Bench_work work{"products",
+                        double(num),
+                        2.0 * num * sizeof(trigon_t),
+                        num * product_flops(P)};
+
+        // keeps the products from being optimized away
+        volatile double sink = 0.0;
+
+        runner.run("trigon/product/" + std::to_string(P),
+                   {{"power", P}, {"dim", 6}},
+                   work,
+                   [&]() {
+                       trigon_t r = t;
+                       for (int i = 0; i < num; ++i) {
+                           r = r * t;
+                           r *= 0.5;
+                       }
+                       sink = sink + r.value();
+                   });
+    }
+}
+
+void
+bench_trigon(Bench_runner& runner)
+{
+    bench_product<1>(runner);
+    bench_product<2>(runner);
+    bench_product<3>(runner);
+    bench_product<4>(runner);
+}
@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+#include <Kokkos_Core.hpp>
+
+#include "benchmark.h"
+
+#include "synergia/foundation/physical_constants.h"
+#include "synergia/utils/command_line_arg.h"
+#include "synergia/utils/gsvector.h"
+
+Bench_options::Bench_options(int argc, char** argv)
+    : particles(1048576)
+    , grid(64)
+    , reps(10)
+    , warmup(2)
+    , filter()
+    , json("synergia_benchmarks.json")
+{
+    for (int i = 1; i < argc; ++i) {
+        Command_line_arg arg(argv[i]);
+
+        if (!arg.is_equal_pair()) {
+            throw std::runtime_error("Bad argument " + std::string(argv[i]));
+        }
+
+        if (arg.get_lhs() == "particles") {
+            particles = arg.extract_value<int>();
+        } else if (arg.get_lhs() == "grid") {
+            grid = arg.extract_value<int>();
+        } else if (arg.get_lhs() == "reps") {
+            reps = arg.extract_value<int>();
+        } else if (arg.get_lhs() == "warmup") {
+            warmup = arg.extract_value<int>();
+        } else if (arg.get_lhs() == "filter") {
+            filter = arg.get_rhs();
+        } else if (arg.get_lhs() == "json") {
+            json = arg.get_rhs();
+        } else {
+            throw std::runtime_error("Unknown argument " + arg.get_lhs());
+        }
+    }
+
+    if (reps < 1) throw std::runtime_error("reps must be at least 1");
+}
+
+Bench_runner::Bench_runner(Bench_options const& opts, Commxx const& comm)
+    : opts(opts), comm(comm), results(syn::json::array())
+{}
+
+bool
+Bench_runner::selected(std::string const& name) const
+{
+    return opts.filter.empty() || name.find(opts.filter) != std::string::npos;
+}
+
+void
+Bench_runner::run(std::string const& name,
+                  syn::json const& params,
+                  Bench_work const& work,
+                  std::function<void()> const& fn,
+                  std::function<void()> const& reset)
+{
+    if (!selected(name)) return;
+
+    std::vector<double> times;
+
+    for (int r = 0; r < opts.warmup + opts.reps; ++r) {
+        if (reset) reset();
+
+        Kokkos::fence();
+        MPI_Barrier(comm);
+
+        double t0 = MPI_Wtime();
+        fn();
+        Kokkos::fence();
+        double t = MPI_Wtime() - t0;
+
+        // slowest rank
+        MPI_Allreduce(MPI_IN_PLACE, &t, 1, MPI_DOUBLE, MPI_MAX, comm);
+
+        if (r >= opts.warmup) times.push_back(t);
+    }
+
+    std::sort(times.begin(), times.end());
+
+    double t_min = times.front();
+    double t_median = times[times.size() / 2];
+
+    syn::json res;
+
+    res["name"] = name;
+    res["params"] = params;
+    res["reps"] = opts.reps;
+    res["time_min"] = t_min;
+    res["time_median"] = t_median;
+    res["time_max"] = times.back();
+    res["item"] = work.item;
+    res["items"] = work.items;
+    res["items_per_second"] = work.items / t_min;
+    res["bytes_per_second"] = work.bytes / t_min;
+
+    if (work.flops > 0.0) {
+        res["gflops"] = work.flops / t_min * 1e-9;
+    } else {
+        res["gflops"] = nullptr;
+    }
+
+    results.push_back(res);
+
+    if (comm.rank() == 0) {
+        std::cout << std::left << std::setw(40) << name << " "
+                  << std::setw(32) << params.dump() << std::right
+                  << std::scientific << std::setprecision(3)
+                  << " t = " << t_min << " s, " << work.items / t_min << " "
+                  << work.item << "/s, " << work.bytes / t_min * 1e-9
+                  << " GB/s";
+
+        if (work.flops > 0.0)
+            std::cout << ", " << work.flops / t_min * 1e-9 << " GFLOP/s";
+
+        std::cout << "\n";
+    }
+}
+
+void
+Bench_runner::write() const
+{
+    if (comm.rank() != 0 || opts.json.empty()) return;
+
+    syn::json ctx;
+
+#if defined(GSV_AVX512)
+    ctx["gsvector"] = "AVX512";
+#elif defined(GSV_AVX2)
+    ctx["gsvector"] = "AVX2";
+#elif defined(GSV_AVX)
+    ctx["gsvector"] = "AVX";
+#elif defined(GSV_SSE)
+    ctx["gsvector"] = "SSE";
+#else
+    ctx["gsvector"] = "DOUBLE";
+#endif
+
+    ctx["gsvector_size"] = GSVector::size();
+    ctx["execution_space"] = Kokkos::DefaultExecutionSpace::name();
+    ctx["concurrency"] = Kokkos::DefaultExecutionSpace().concurrency();
+    ctx["mpi_ranks"] = comm.size();
+    ctx["particles"] = opts.particles;
+    ctx["grid"] = opts.grid;
+    ctx["warmup"] = opts.warmup;
+
+    syn::json out;
+    out["context"] = ctx;
+    out["benchmarks"] = results;
+
+    std::ofstream f(opts.json);
+    f << out.dump(2) << "\n";
+}
+
+Bunch
+make_bench_bunch(int num, bool half_lost)
+{
+    Four_momentum fm(pconstants::mp);
+    fm.set_kinetic_energy(8.0);
+
+    Reference_particle ref(pconstants::proton_charge, fm);
+    Bunch bunch(ref, num, 1.0e11, Commxx());
+
+    // the same particles in every run
+    std::mt19937 gen(12345);
+    std::normal_distribution<double> dist(0.0, 1.0);
+
+    const double sigma[6] = {1e-3, 1e-3, 1e-3, 1e-3, 1e-2, 1e-4};
+
+    bunch.checkout_particles();
+
+    auto parts = bunch.get_host_particles();
+    auto masks = bunch.get_host_particle_masks();
+
+    for (int i = 0; i < bunch.size(); ++i) {
+        for (int j = 0; j < 6; ++j)
+            parts(i, j) = sigma[j] * dist(gen);
+
+        if (half_lost && (i % 2)) masks(i) = 0;
+    }
+
+    bunch.checkin_particles();
+
+    if (half_lost) {
+        bunch.get_bunch_particles().update_valid_num();
+        bunch.update_total_num();
+    }
+
+    return bunch;
+}
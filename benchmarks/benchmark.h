@@ -0,0 +1,98 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "synergia/bunch/bunch.h"
+#include "synergia/utils/commxx.h"
+#include "synergia/utils/json.h"
+
+/// Options of the benchmark driver, given as key=value pairs on the
+/// command line, e.g.,
+///
+///   synergia_benchmarks particles=4194304 reps=20 filter=libff
+///
+struct Bench_options {
+    Bench_options(int argc, char** argv);
+
+    // macroparticles per bunch
+    int particles;
+
+    // grid size of the space charge solvers in each direction
+    int grid;
+
+    // timed repetitions, and untimed ones before them
+    int reps;
+    int warmup;
+
+    // only run the benchmarks whose name contains the filter
+    std::string filter;
+
+    // output file of the results
+    std::string json;
+};
+
+/// Work done by a single call of a benchmarked function. The rates are
+/// derived from the fastest call. The flop counts are nominal (see the
+/// individual benchmarks), and 0 when not meaningful.
+struct Bench_work {
+    std::string item; // what is counted, e.g., "particles"
+    double items = 0.0;
+    double bytes = 0.0;
+    double flops = 0.0;
+};
+
+/// Times the benchmarked functions and collects the results. Every call
+/// is fenced, and its time is the slowest over all ranks.
+class Bench_runner {
+  private:
+    Bench_options opts;
+    Commxx comm;
+
+    syn::json results;
+
+  public:
+    Bench_runner(Bench_options const& opts, Commxx const& comm);
+
+    Bench_options const&
+    get_options() const
+    {
+        return opts;
+    }
+
+    Commxx const&
+    get_comm() const
+    {
+        return comm;
+    }
+
+    bool selected(std::string const& name) const;
+
+    /// Run fn for warmup + reps times. reset (if any) is called before
+    /// every call outside of the timed region.
+    void run(std::string const& name,
+             syn::json const& params,
+             Bench_work const& work,
+             std::function<void()> const& fn,
+             std::function<void()> const& reset = {});
+
+    /// Write the results with the description of the build and the run
+    /// to the json file (on rank 0)
+    void write() const;
+};
+
+/// Bunch of 8 GeV protons with a gaussian distribution of about 1 mm and
+/// 1 mrad. With half_lost, every other particle is masked out.
+Bunch make_bench_bunch(int num, bool half_lost = false);
+
+// benchmark groups
+void bench_libff(Bench_runner& runner);
+void bench_deposit(Bench_runner& runner);
+void bench_fft(Bench_runner& runner);
+void bench_diagnostics(Bench_runner& runner);
+void bench_trigon(Bench_runner& runner);
+void bench_mx_eval(Bench_runner& runner);
+
+#endif /* BENCHMARK_H_ */
@@ -0,0 +1,281 @@
+#!/usr/bin/env python
+
+"""Strong and weak scaling driver for the synergia examples.
+
+Runs a workload at a series of MPI rank and thread counts on one node,
+collects the propagation time and the per-operator timings printed by
+the simple timer (configure with -DSIMPLE_TIMER=ON to get them), and
+writes strong or weak scaling tables with the parallel efficiency.
+
+Examples:
+
+    # strong scaling of fodo_cxx, 1M particles, 1 to 8 ranks
+    scaling.py fodo_cxx --build-dir build --mode strong \\
+        --ranks 1 2 4 8 --particles 1048576
+
+    # weak scaling, 262144 particles per core, 2 threads per rank
+    scaling.py fodo_cxx --build-dir build --mode weak \\
+        --ranks 1 2 4 --threads 2 --particles 262144 --grid 32 32 64
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+from dataclasses import dataclass, field
+from typing import Dict, List, Optional
+
+
+@dataclass
+class Workload:
+    # executable, relative to the examples/ directory of the build tree
+    executable: str
+    # option names of the particle count and the grid
+    particles: str
+    grid: List[str]
+    # fixed options of the workload
+    options: Dict[str, str] = field(default_factory=dict)
+
+
+# examples taking their parameters as key=value options. New workloads
+# need at least a particle count and a grid size option.
+workloads = {
+    "fodo_cxx": Workload(
+        executable="fodo_cxx/fodo_cxx",
+        particles="macroparticles",
+        grid=["gridx", "gridy", "gridz"],
+        options={"turns": "1"},
+    ),
+}
+
+
+@dataclass
+class Run:
+    ranks: int
+    threads: int
+    particles: int
+    grid: List[int]
+    total: Optional[float] = None
+    timers: Dict[str, float] = field(default_factory=dict)
+
+    @property
+    def cores(self):
+        return self.ranks * self.threads
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawTextHelpFormatter
+    )
+    parser.add_argument("workload", choices=sorted(workloads.keys()))
+    parser.add_argument(
+        "--build-dir", default="build", help="synergia build directory"
+    )
+    parser.add_argument("--run-dir", default="scaling_runs")
+    parser.add_argument("--mode", choices=["strong", "weak"], default="strong")
+    parser.add_argument("--ranks", type=int, nargs="+", default=[1, 2, 4])
+    parser.add_argument("--threads", type=int, nargs="+", default=[1])
+    parser.add_argument(
+        "--particles",
+        type=int,
+        default=1048576,
+        help="particles of the run (strong), or per core (weak)",
+    )
+    parser.add_argument("--grid", type=int, nargs=3, default=[32, 32, 64])
+    parser.add_argument(
+        "--launcher",
+        default="mpirun -np {ranks}",
+        help="MPI launcher, {ranks} is replaced by the number of ranks",
+    )
+    parser.add_argument("--json", default="scaling.json", help="output file")
+    parser.add_argument(
+        "--timers",
+        type=int,
+        default=6,
+        help="number of the most expensive timers shown in the tables",
+    )
+    parser.add_argument(
+        "--dry-run", action="store_true", help="print the commands only"
+    )
+    return parser.parse_args()
+
+
+def command_line(args, wl: Workload, run: Run):
+    cmd = args.launcher.format(ranks=run.ranks).split()
+    exe = os.path.join(args.build_dir, "examples", wl.executable)
+
+    cmd += [os.path.abspath(exe)]
+
+    opts = dict(wl.options)
+    opts[wl.particles] = str(run.particles)
+    for name, g in zip(wl.grid, run.grid):
+        opts[name] = str(g)
+
+    return cmd + ["{}={}".format(k, v) for k, v in opts.items()]
+
+
+total_re = re.compile(r"Propagator: total time = ([0-9.eE+-]+)s")
+timer_re = re.compile(r"^(\S+)\s+([0-9.eE+-]+)\s+([0-9]+)\s*$")
+
+
+def parse_output(output: str, run: Run):
+    in_timers = False
+
+    for line in output.splitlines():
+        m = total_re.search(line)
+        if m:
+            run.total = float(m.group(1))
+            continue
+
+        # table printed by simple_timer_print()
+        if line.startswith("timer label"):
+            in_timers = True
+            continue
+
+        if in_timers:
+            m = timer_re.match(line)
+            if m:
+                run.timers[m.group(1)] = float(m.group(2))
+            elif line.strip() and not line.startswith("---"):
+                in_timers = False
+
+
+def execute(args, wl: Workload, run: Run):
+    cmd = command_line(args, wl, run)
+    print(" ".join(cmd), flush=True)
+
+    if args.dry_run:
+        return
+
+    # every run in its own directory, the examples write their output
+    # files to the working directory
+    rundir = os.path.join(
+        args.run_dir,
+        "{}_r{}_t{}_p{}".format(
+            args.workload, run.ranks, run.threads, run.particles
+        ),
+    )
+    os.makedirs(rundir, exist_ok=True)
+
+    env = dict(os.environ)
+    env["OMP_NUM_THREADS"] = str(run.threads)
+
+    res = subprocess.run(
+        cmd,
+        cwd=rundir,
+        env=env,
+        stdout=subprocess.PIPE,
+        stderr=subprocess.STDOUT,
+        universal_newlines=True,
+    )
+
+    with open(os.path.join(rundir, "output.txt"), "w") as f:
+        f.write(res.stdout)
+
+    if res.returncode != 0:
+        print("  failed with code {}, see {}".format(res.returncode, rundir))
+        return
+
+    parse_output(res.stdout, run)
+
+    if run.total is None:
+        print("  no propagation time found in the output")
+    else:
+        print("  total time = {:.3f}s".format(run.total))
+
+
+def efficiency(mode, base: Run, run: Run):
+    if base.total is None or run.total is None:
+        return None, None
+
+    speedup = base.total / run.total
+
+    if mode == "strong":
+        return speedup, speedup * base.cores / run.cores
+    else:
+        # same work per core, the time should stay constant
+        return speedup * run.cores / base.cores, speedup
+
+
+def fmt(v):
+    return "-" if v is None else "{:.3f}".format(v)
+
+
+def print_table(args, runs: List[Run]):
+    base = runs[0]
+
+    # the most expensive timers of the base run
+    labels = sorted(base.timers, key=base.timers.get, reverse=True)
+    labels = labels[: args.timers]
+
+    header = ["ranks", "threads", "cores", "particles", "time(s)"]
+    header += ["speedup" if args.mode == "strong" else "scaled_speedup"]
+    header += ["efficiency"] + labels
+
+    rows = []
+    for run in runs:
+        speedup, eff = efficiency(args.mode, base, run)
+        row = [str(run.ranks), str(run.threads), str(run.cores)]
+        row += [str(run.particles), fmt(run.total), fmt(speedup), fmt(eff)]
+        row += [fmt(run.timers.get(label)) for label in labels]
+        rows.append(row)
+
+    widths = [
+        max(len(r[i]) for r in [header] + rows) for i in range(len(header))
+    ]
+
+    print("\n{} scaling of {}\n".format(args.mode, args.workload))
+    for r in [header] + rows:
+        print("  ".join(c.rjust(w) for c, w in zip(r, widths)))
+    print()
+
+
+def main():
+    args = parse_args()
+    wl = workloads[args.workload]
+
+    runs = []
+    for threads in args.threads:
+        for ranks in args.ranks:
+            particles = args.particles
+            if args.mode == "weak":
+                particles *= ranks * threads
+
+            run = Run(ranks, threads, particles, list(args.grid))
+            execute(args, wl, run)
+            runs.append(run)
+
+    if args.dry_run or not runs:
+        return
+
+    print_table(args, runs)
+
+    base = runs[0]
+    results = []
+    for run in runs:
+        speedup, eff = efficiency(args.mode, base, run)
+        results.append(
+            {
+                "ranks": run.ranks,
+                "threads": run.threads,
+                "cores": run.cores,
+                "particles": run.particles,
+                "grid": run.grid,
+                "time": run.total,
+                "speedup": speedup,
+                "efficiency": eff,
+                "timers": run.timers,
+            }
+        )
+
+    with open(args.json, "w") as f:
+        json.dump(
+            {"workload": args.workload, "mode": args.mode, "runs": results},
+            f,
+            indent=2,
+        )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,29 @@
+#include "benchmark.h"
+
+#include "synergia/utils/utils.h"
+
+// Micro-benchmarks of the hot kernels. Each benchmark is timed over a
+// number of repetitions, and the results are written to a json file
+// for tracking across builds and machines.
+int
+main(int argc, char** argv)
+{
+    synergia::initialize(argc, argv);
+
+    {
+        Bench_options opts(argc, argv);
+        Bench_runner runner(opts, Commxx());
+
+        bench_libff(runner);
+        bench_deposit(runner);
+        bench_fft(runner);
+        bench_diagnostics(runner);
+        bench_trigon(runner);
+        bench_mx_eval(runner);
+
+        runner.write();
+    }
+
+    synergia::finalize();
+    return 0;
+}
@@ -8,31 +8,93 @@
 #include <cmath>
 #include <stdexcept>
 
-template <>
-Bunch::bunch_t(Reference_particle const& reference_particle,
-               int total_num,
-               double real_num,
-               Commxx bunch_comm,
-               int total_spectator_num,
-               int bunch_index,
-               int bucket_index,
-               int array_index,
-               int train_index)
-    : comm(std::make_shared<Commxx>(bunch_comm))
+template <class PART>
+bunch_t<PART>::bunch_t(Reference_particle const& reference_particle,
+                       int total_num,
+                       double real_num,
+                       std::shared_ptr<Commxx> const& bunch_comm,
+                       int total_spectator_num,
+                       int bunch_index,
+                       int bucket_index,
+                       int array_index,
+                       int train_index)
+    : comm(bunch_comm)
     , boundary(LB::open)
     , boundary_param(0.0)
     , ref_part(reference_particle)
     , design_ref_part(reference_particle)
     , particle_charge(reference_particle.get_charge())
     , real_num(real_num)
-    , parts{BunchParticles(PG::regular, total_num, -1, *comm),
-            BunchParticles(PG::spectator, total_spectator_num, -1, *comm)}
+    , parts{bp_t(PG::regular, total_num, -1, *comm),
+            bp_t(PG::spectator, total_spectator_num, -1, *comm)}
     , bunch_index(bunch_index)
     , bucket_index(bucket_index)
     , array_index(array_index)
     , train_index(train_index)
 {}
 
+template <class PART>
+bunch_t<PART>::bunch_t(Reference_particle const& reference_particle,
+                       int total_num,
+                       double real_num,
+                       Commxx bunch_comm,
+                       int total_spectator_num,
+                       int bunch_index,
+                       int bucket_index,
+                       int array_index,
+                       int train_index)
+    : bunch_t(reference_particle,
+              total_num,
+              real_num,
+              std::make_shared<Commxx>(bunch_comm),
+              total_spectator_num,
+              bunch_index,
+              bucket_index,
+              array_index,
+              train_index)
+{}
+
+// double and single precision (reduced storage) bunches
+template bunch_t<double>::bunch_t(Reference_particle const&,
+                                  int,
+                                  double,
+                                  std::shared_ptr<Commxx> const&,
+                                  int,
+                                  int,
+                                  int,
+                                  int,
+                                  int);
+
+template bunch_t<double>::bunch_t(Reference_particle const&,
+                                  int,
+                                  double,
+                                  Commxx,
+                                  int,
+                                  int,
+                                  int,
+                                  int,
+                                  int);
+
+template bunch_t<float>::bunch_t(Reference_particle const&,
+                                 int,
+                                 double,
+                                 std::shared_ptr<Commxx> const&,
+                                 int,
+                                 int,
+                                 int,
+                                 int,
+                                 int);
+
+template bunch_t<float>::bunch_t(Reference_particle const&,
+                                 int,
+                                 double,
+                                 Commxx,
+                                 int,
+                                 int,
+                                 int,
+                                 int,
+                                 int);
+
 template <>
 Bunch::bunch_t()
     : comm(new Commxx())
@@ -166,7 +228,7 @@ Bunch::print_statistics(Logger& logger) const
 #if defined SYNERGIA_HAVE_OPENPMD
 template <>
 void
-Bunch::read_openpmd_file(std::string const& filename)
+Bunch::read_openpmd_file_impl(std::string const& filename)
 {
     auto series = openPMD::Series(filename, openPMD::Access::READ_ONLY);
     // get the last iteration from the series
@@ -275,11 +337,11 @@ Bunch::read_openpmd_file(std::string const& filename)
 // num_part = -1 means write all particles
 template <>
 void
-Bunch::write_openpmd_file(std::string const& filename,
-                          int num_part,
-                          int offset,
-                          int num_part_spec,
-                          int offset_spec) const
+Bunch::write_openpmd_file_impl(std::string const& filename,
+                               int num_part,
+                               int offset,
+                               int num_part_spec,
+                               int offset_spec) const
 {
     size_t local_num, local_offset, file_offset;
     size_t spec_local_num, spec_local_offset, spec_file_offset;
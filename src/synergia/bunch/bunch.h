@@ -13,6 +13,7 @@
 #include "synergia/foundation/reference_particle.h"
 #include "synergia/utils/commxx.h"
 #include "synergia/utils/hdf5_file.h"
+#include "synergia/utils/io_thread.h"
 #include "synergia/utils/logger.h"
 #include "synergia/utils/restrict_extension.h"
 
@@ -100,12 +101,24 @@ class bunch_t {
     std::unique_ptr<Diagnostics_worker> diag_aperture;
     std::unique_ptr<Diagnostics_worker> diag_zcut;
 
+    // name of the location (element) of the most recent aperture apply
+    std::string last_discard_location;
+
     // bunch indicies
     int bunch_index;  // index in the train
     int bucket_index; // which bucket its occupying
     int array_index;  // array index in the train's bunch array
     int train_index;  // the index of the containing tain
 
+#if defined SYNERGIA_HAVE_OPENPMD
+    void read_openpmd_file_impl(std::string const& filename);
+    void write_openpmd_file_impl(std::string const& filename,
+                                 int num_part,
+                                 int offset,
+                                 int num_part_spec,
+                                 int offset_spec) const;
+#endif
+
   public:
     //!
     //! Constructor:
@@ -129,6 +142,18 @@ class bunch_t {
             int array_index = 0,
             int train_index = 0);
 
+    // same as above, but the bunch shares the communicator object with
+    // other bunches (e.g., bunches of a train on the same ranks)
+    bunch_t(Reference_particle const& reference_particle,
+            int total_num,
+            double real_num,
+            std::shared_ptr<Commxx> const& comm,
+            int total_spectator_num = 0,
+            int bunch_index = 0,
+            int bucket_index = 0,
+            int array_index = 0,
+            int train_index = 0);
+
     // to construct a bunch with trigon particles.
     // Will fail to compile if PART is not a trigon.
     bunch_t(Reference_particle const& reference_particle,
@@ -164,6 +189,13 @@ class bunch_t {
         return bucket_index;
     }
 
+    // the array index changes when the bunches of a train are remapped
+    void
+    set_array_index(int index)
+    {
+        array_index = index;
+    }
+
     ///
     /// Set the particle charge
     /// @param particle_charge in units of e.
@@ -226,6 +258,21 @@ class bunch_t {
         return parts[(int)pg];
     }
 
+    // copy the particles, the reference particles and the real number
+    // from a bunch of another precision, e.g. to track a bunch populated
+    // in double with the reduced precision storage of bunch_t<float>
+    template <class P2>
+    void
+    assign(bunch_t<P2> const& o)
+    {
+        for (auto pg : {PG::regular, PG::spectator})
+            get_bunch_particles(pg).assign(o.get_bunch_particles(pg));
+
+        ref_part = o.get_reference_particle();
+        design_ref_part = o.get_design_reference_particle();
+        real_num = o.get_real_num();
+    }
+
     std::pair<size_t, size_t>
     get_local_particle_count_in_range(ParticleGroup pg,
                                       int num_part,
@@ -377,13 +424,23 @@ class bunch_t {
 
     // aperture operation
     // discard the particles (by moving them to the tail of the array) filtered
-    // out by the aperture, returns the number of particles discarded
+    // out by the aperture, returns the number of particles discarded.
+    // location is the name of the element the aperture belongs to, and is
+    // recorded in the loss diagnostics
     template <typename AP>
-    int apply_aperture(AP const& ap, ParticleGroup pg = PG::regular);
+    int apply_aperture(AP const& ap,
+                       ParticleGroup pg = PG::regular,
+                       std::string const& location = "");
 
     template <typename AP>
     int apply_zcut(AP const& ap, ParticleGroup pg = PG::regular);
 
+    std::string const&
+    get_last_discard_location() const
+    {
+        return last_discard_location;
+    }
+
     // retrieve the array holding lost particles from last aperture operation
     karray2d_row
     get_particles_last_discarded(ParticleGroup pg = PG::regular) const
@@ -406,6 +463,20 @@ class bunch_t {
         get_bunch_particles(pg).checkin_particles();
     }
 
+    // non-blocking checkout. the host arrays are valid only after
+    // a call to wait_checkout_particles()
+    void
+    checkout_particles_async(ParticleGroup pg = PG::regular)
+    {
+        get_bunch_particles(pg).checkout_particles_async();
+    }
+
+    void
+    wait_checkout_particles(ParticleGroup pg = PG::regular)
+    {
+        get_bunch_particles(pg).fence();
+    }
+
     // checkout (deep_copy) num particles starting from idx, and
     // store them in a host array
     // TODO: when compiled for host, it returns a subview to the original
@@ -503,6 +574,20 @@ class bunch_t {
         return *comm;
     }
 
+    // replace the communicator with one over the same ranks, e.g., shared
+    // with the other bunches on these ranks. The diagnostics keep the
+    // communicator they were created with
+    void
+    set_comm(std::shared_ptr<Commxx> const& new_comm)
+    {
+        if (new_comm->size() != comm->size()) {
+            throw std::runtime_error(
+                "Bunch::set_comm(): communicator of a different size");
+        }
+
+        comm = new_comm;
+    }
+
     // Diagnostics
     template <class Diag>
     std::pair<Diagnostics_handler, int>
@@ -537,18 +622,53 @@ class bunch_t {
         get_diag(id).update_and_write();
     }
 
+    // whether any diagnostics (including the loss diagnostics) has been
+    // attached to the bunch
+    bool
+    has_diagnostics() const
+    {
+        return !diags.empty() || diag_aperture || diag_zcut;
+    }
+
+    // flush_turns and flush_size turn on the buffered mode of the
+    // loss diagnostics. see Diagnostics_loss for details
+    void
+    set_diag_loss_aperture(std::string const& filename,
+                           int flush_turns = 0,
+                           int flush_size = 0)
+    {
+        diag_aperture.reset(new Diagnostics_worker(
+            Diagnostics_loss(filename, flush_turns, flush_size), comm));
+    }
+
     void
-    set_diag_loss_aperture(std::string const& filename)
+    set_diag_loss_zcut(std::string const& filename,
+                       int flush_turns = 0,
+                       int flush_size = 0)
     {
-        diag_aperture.reset(
-            new Diagnostics_worker(Diagnostics_loss(filename), comm));
+        diag_zcut.reset(new Diagnostics_worker(
+            Diagnostics_loss(filename, flush_turns, flush_size), comm));
     }
 
+    // write out the buffered loss diagnostics when their flush criteria
+    // are met, or unconditionally if force is true. must be called
+    // collectively by all ranks of the bunch
     void
-    set_diag_loss_zcut(std::string const& filename)
+    flush_diag_loss(bool force = false)
     {
-        diag_zcut.reset(
-            new Diagnostics_worker(Diagnostics_loss(filename), comm));
+        if (diag_aperture) diag_aperture->flush(*this, force);
+        if (diag_zcut) diag_zcut->flush(*this, force);
+    }
+
+    // same as flush_diag_loss(), for all the buffered diagnostics of
+    // the bunch including the loss diagnostics
+    void
+    flush_diags(bool force = false)
+    {
+        for (auto& diag : diags)
+            diag.flush(*this, force);
+
+        flush_diag_loss(force);
     }
 
     /// Add a copy of the particles in bunch to the current bunch. The
@@ -582,30 +702,47 @@ class bunch_t {
         get_bunch_particles(PG::spectator).check_pz2_positive();
     }
 
-    // read/write particles
+    // read/write particles. The files named by the caller are read and
+    // written through Io_thread::run(), after the pending diagnostics
+    // writes
     void
     read_file_legacy(std::string const& filename)
     {
-        Hdf5_file file(filename, Hdf5_file::Flag::read_only, comm);
-        get_bunch_particles(PG::regular).read_file_legacy(file, *comm);
+        Io_thread::get().run([&]() {
+            Hdf5_file file(filename, Hdf5_file::Flag::read_only, comm);
+            get_bunch_particles(PG::regular).read_file_legacy(file, *comm);
+        });
     }
 
     void
     read_file(std::string const& filename)
     {
-        Hdf5_file file(filename, Hdf5_file::Flag::read_only, comm);
-        get_bunch_particles(PG::regular).read_file(file, *comm);
+        Io_thread::get().run([&]() {
+            Hdf5_file file(filename, Hdf5_file::Flag::read_only, comm);
+            get_bunch_particles(PG::regular).read_file(file, *comm);
+        });
     }
 
 #if defined SYNERGIA_HAVE_OPENPMD
-    void read_openpmd_file(std::string const& filename);
+    void
+    read_openpmd_file(std::string const& filename)
+    {
+        Io_thread::get().run([&]() { read_openpmd_file_impl(filename); });
+    }
 
     // num_part = -1 means write all particles
-    void write_openpmd_file(std::string const& filename,
-                            int num_part = -1,
-                            int offset = 0,
-                            int num_part_spec = 0,
-                            int offset_spec = 0) const;
+    void
+    write_openpmd_file(std::string const& filename,
+                       int num_part = -1,
+                       int offset = 0,
+                       int num_part_spec = 0,
+                       int offset_spec = 0) const
+    {
+        Io_thread::get().run([&]() {
+            write_openpmd_file_impl(
+                filename, num_part, offset, num_part_spec, offset_spec);
+        });
+    }
 #endif
 
     // num_part = -1 means write all particles
@@ -616,10 +753,14 @@ class bunch_t {
                int num_part_spec = 0,
                int offset_spec = 0) const
     {
-        Hdf5_file file(filename, Hdf5_file::Flag::truncate, comm);
-        write_file(file, num_part, offset, num_part_spec, offset_spec);
+        Io_thread::get().run([&]() {
+            Hdf5_file file(filename, Hdf5_file::Flag::truncate, comm);
+            write_file(file, num_part, offset, num_part_spec, offset_spec);
+        });
     }
 
+    // the file is opened by the caller, who has to keep the HDF5 calls
+    // off the I/O thread (see Io_thread)
     void
     write_file(Hdf5_file const& file,
                int num_part,
@@ -704,10 +845,15 @@ class bunch_t {
 
 using Bunch = bunch_t<double>;
 
-template <>
+// single precision particle storage, see bunch_particles_t
+using BunchF = bunch_t<float>;
+
+template <typename PART>
 template <typename AP>
 inline int
-bunch_t<double>::apply_aperture(AP const& ap, ParticleGroup pg)
+bunch_t<PART>::apply_aperture(AP const& ap,
+                              ParticleGroup pg,
+                              std::string const& location)
 {
     // Particles might get lost here. The update of total particle number is
     // performed at the end of each independent operator on a per-bunch basis.
@@ -716,21 +862,31 @@ bunch_t<double>::apply_aperture(AP const& ap, ParticleGroup pg)
     // only important to the space charge solvers
     int ndiscarded = get_bunch_particles(pg).apply_aperture(ap);
 
-    // diagnostics
-    if (ndiscarded && diag_aperture) diag_aperture->update_and_write(*this);
+    // diagnostics, which only take double precision bunches
+    if constexpr (std::is_same<PART, double>::value) {
+        if (ndiscarded && diag_aperture) {
+            last_discard_location = location;
+            diag_aperture->update_and_write(*this);
+        }
+    }
 
     return ndiscarded;
 }
 
-template <>
+template <typename PART>
 template <typename AP>
 inline int
-bunch_t<double>::apply_zcut(AP const& ap, ParticleGroup pg)
+bunch_t<PART>::apply_zcut(AP const& ap, ParticleGroup pg)
 {
     int ndiscarded = get_bunch_particles(pg).apply_aperture(ap);
 
     // diagnostics
-    if (ndiscarded && diag_zcut) diag_zcut->update_and_write(*this);
+    if constexpr (std::is_same<PART, double>::value) {
+        if (ndiscarded && diag_zcut) {
+            last_discard_location = "zcut";
+            diag_zcut->update_and_write(*this);
+        }
+    }
 
     return ndiscarded;
 }
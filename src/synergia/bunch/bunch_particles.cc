@@ -210,20 +210,50 @@ namespace {
         }
     };
 
+    // functors of the reduced precision storage
+    struct id_finder {
+        BunchParticlesF::ids_t ids;
+        int pid;
+
+        KOKKOS_INLINE_FUNCTION
+        void
+        operator()(const int i, int& idx) const
+        {
+            if (ids(i) == pid) idx = i;
+        }
+    };
+
+    struct particle_zeroer_f {
+        BunchParticlesF::parts_t parts;
+        BunchParticlesF::ids_t ids;
+
+        KOKKOS_INLINE_FUNCTION
+        void
+        operator()(const int i) const
+        {
+            for (int j = 0; j < 6; ++j)
+                parts(i, j) = 0.0f;
+            ids(i) = 0;
+        }
+    };
+
     struct discarded_particle_mover {
         Kokkos::View<int*> counter;
 
         ConstParticles parts;
         ParticleMasks discards;
         karray2d_row_dev discarded_parts;
+        int offset;
 
         discarded_particle_mover(ConstParticles const& parts,
                                  ParticleMasks const& discards,
-                                 karray2d_row_dev const& discarded_parts)
+                                 karray2d_row_dev const& discarded_parts,
+                                 int offset = 0)
             : counter("counter", 1)
             , parts(parts)
             , discards(discards)
             , discarded_parts(discarded_parts)
+            , offset(offset)
         {}
 
         KOKKOS_INLINE_FUNCTION
@@ -231,7 +261,8 @@ namespace {
         operator()(const int i) const
         {
             if (discards(i)) {
-                int pos = Kokkos::atomic_fetch_add(counter.data(), 1);
+                int pos =
+                    offset + Kokkos::atomic_fetch_add(counter.data(), 1);
 
                 discarded_parts(pos, 0) = parts(i, 0);
                 discarded_parts(pos, 1) = parts(i, 1);
@@ -542,6 +573,20 @@ bunch_particles_t<double>::get_particles_last_discarded() const
     return hdiscarded;
 }
 
+template <>
+void
+bunch_particles_t<double>::append_particles_last_discarded(
+    karray2d_row_dev const& buf,
+    int offset) const
+{
+    if (offset + n_last_discarded > buf.extent(0))
+        throw std::runtime_error(
+            "append_particles_last_discarded: buffer too small");
+
+    discarded_particle_mover dpm(parts, discards, buf, offset);
+    Kokkos::parallel_for(n_active, dpm);
+}
+
 template <>
 void
 bunch_particles_t<double>::check_pz2_positive()
@@ -736,3 +781,104 @@ bunch_particles_t<double>::load_checkpoint_particles(Hdf5_file& file, int idx)
 
     checkin_particles();
 }
+
+// reduced precision storage
+
+template <>
+void
+bunch_particles_t<float>::reserve_local(int r)
+{
+    if (r <= n_reserved) return;
+
+#ifdef NO_PADDING
+    Kokkos::resize(parts, r);
+#else
+    Kokkos::resize(Kokkos::AllowPadding, parts, r);
+#endif
+    n_reserved = parts.stride(1);
+
+    Kokkos::resize(masks, n_reserved);
+    Kokkos::resize(discards, n_reserved);
+    Kokkos::resize(ids, n_reserved);
+
+    hparts = Kokkos::create_mirror_view(parts);
+    hmasks = Kokkos::create_mirror_view(masks);
+    hdiscards = Kokkos::create_mirror_view(discards);
+    hids = Kokkos::create_mirror_view(ids);
+
+    n_reserved = r;
+}
+
+template <>
+void
+bunch_particles_t<float>::reserve(int n, Commxx const& comm)
+{
+    int r = decompose_1d_local(comm, n);
+    reserve_local(r);
+}
+
+template <>
+void
+bunch_particles_t<float>::assign_ids(int train_idx, int bunch_idx)
+{
+    // same id space as the double storage
+    int64_t base = 0;
+    base |= (int64_t)train_idx << 50;
+    base |= (int64_t)bunch_idx << 34;
+    base |= (int64_t)group << 32;
+
+    using namespace bunch_particles_impl;
+
+    pid_assigner_ids<ids_t> pia{ids, base + poffset};
+    Kokkos::parallel_for(n_active, pia);
+}
+
+template <>
+void
+bunch_particles_t<float>::drain()
+{
+    particle_zeroer_f pz{parts, ids};
+    masks_zeroer mz{masks, 0};
+
+    Kokkos::parallel_for(n_reserved, pz);
+    Kokkos::parallel_for(n_reserved, mz);
+
+    n_valid = 0;
+    n_total = 0;
+}
+
+template <>
+int
+bunch_particles_t<float>::update_valid_num()
+{
+    int old_valid_num = n_valid;
+    mask_reducer mr{masks};
+    Kokkos::parallel_reduce(n_active, mr, n_valid);
+    return old_valid_num;
+}
+
+template <>
+int
+bunch_particles_t<float>::update_total_num(Commxx const& comm)
+{
+    int old_total_num = n_total;
+    MPI_Allreduce(&n_valid, &n_total, 1, MPI_INT, MPI_SUM, comm);
+    return old_total_num;
+}
+
+template <>
+int
+bunch_particles_t<float>::search_particle(int pid, int last_idx) const
+{
+    if (last_idx != particle_index_null && last_idx < n_active) {
+        int64_t id = 0;
+        Kokkos::deep_copy(id, Kokkos::subview(ids, last_idx));
+        if (id == pid) return last_idx;
+    }
+
+    int idx = particle_index_null;
+    id_finder f{ids, pid};
+    Kokkos::parallel_reduce(n_active, f, idx);
+
+    return idx;
+}
@@ -10,6 +10,7 @@
 
 #include <cereal/cereal.hpp>
 #include <string>
+#include <type_traits>
 #include <utility>
 
 #if defined SYNERGIA_HAVE_OPENPMD
@@ -115,6 +116,16 @@ class bunch_particles_t {
 
     using part_t = PART;
 
+    // reduced precision storage: the coordinates are kept in float and
+    // widened to double in the kernels (see gsv_t). The particle ids are
+    // kept in a separate integer array, since a float holds integers
+    // exactly only up to 2^24
+    constexpr static const bool reduced_precision =
+        std::is_same<PART, float>::value;
+
+    // number of columns of the particle array
+    constexpr static const int num_columns = reduced_precision ? 6 : 7;
+
     using default_memspace =
         typename Kokkos::DefaultExecutionSpace::memory_space;
 
@@ -122,8 +133,8 @@ class bunch_particles_t {
                                                Kokkos::HostSpace,
                                                default_memspace>::type;
 
-    using parts_t =
-        typename Kokkos::View<PART* [7], Kokkos::LayoutLeft, memspace>;
+    using parts_t = typename Kokkos::
+        View<PART* [num_columns], Kokkos::LayoutLeft, memspace>;
 
     using masks_t = typename Kokkos::View<uint8_t*, memspace>;
 
@@ -131,8 +142,8 @@ class bunch_particles_t {
 
     using host_masks_t = typename masks_t::HostMirror;
 
-    using const_parts_t =
-        typename Kokkos::View<const PART* [7], Kokkos::LayoutLeft, memspace>;
+    using const_parts_t = typename Kokkos::
+        View<const PART* [num_columns], Kokkos::LayoutLeft, memspace>;
 
     using const_masks_t = typename Kokkos::View<const uint8_t*, memspace>;
 
@@ -140,8 +151,17 @@ class bunch_particles_t {
 
     using const_host_masks_t = typename const_masks_t::HostMirror;
 
-    using gsv_t = typename std::
-        conditional<is_trigon<PART>::value, GSVec<PART>, GSVector>::type;
+    // trigons and floats are processed one particle at a time, floats
+    // are computed in double
+    using gsv_t = typename std::conditional<
+        is_trigon<PART>::value,
+        GSVec<PART>,
+        typename std::conditional<reduced_precision, GSVec<double>, GSVector>::
+            type>::type;
+
+    // separate particle ids of the reduced precision storage
+    using ids_t = typename Kokkos::View<int64_t*, memspace>;
+    using host_ids_t = typename ids_t::HostMirror;
 
     using exec_space = typename parts_t::execution_space;
 
@@ -225,6 +245,10 @@ class bunch_particles_t {
     host_masks_t hmasks;
     host_masks_t hdiscards;
 
+    // only allocated with reduced precision
+    ids_t ids;
+    host_ids_t hids;
+
   public:
     // particles array will be allocated to the size of reserved_num
     // if reserved is less than total, it will be set to the total_num
@@ -307,6 +331,7 @@ class bunch_particles_t {
     {
         Kokkos::deep_copy(parts, hparts);
         Kokkos::deep_copy(masks, hmasks);
+        if constexpr (reduced_precision) Kokkos::deep_copy(ids, hids);
     }
 
     void
@@ -314,6 +339,26 @@ class bunch_particles_t {
     {
         Kokkos::deep_copy(hparts, parts);
         Kokkos::deep_copy(hmasks, masks);
+        if constexpr (reduced_precision) Kokkos::deep_copy(hids, ids);
+    }
+
+    // same as checkout_particles() but returns without waiting for the
+    // copy to complete. The copy is enqueued on the default execution
+    // space instance so it is ordered before any kernels launched
+    // afterwards. Call fence() before reading the host arrays
+    void
+    checkout_particles_async() const
+    {
+        Kokkos::deep_copy(exec_space(), hparts, parts);
+        Kokkos::deep_copy(exec_space(), hmasks, masks);
+        if constexpr (reduced_precision)
+            Kokkos::deep_copy(exec_space(), hids, ids);
+    }
+
+    void
+    fence() const
+    {
+        exec_space().fence();
     }
 
     // change capacity (can only increase)
@@ -335,6 +380,12 @@ class bunch_particles_t {
                 karray1d_dev const& inj_st,
                 double pdiff);
 
+    // copy the coordinates, masks and ids from the particles of another
+    // precision, e.g. a bunch populated in double and tracked in float.
+    // The local capacity is increased when needed
+    template <class P2>
+    void assign(bunch_particles_t<P2> const& o);
+
     // convert between fixed z lab and fixed t lab
     void convert_to_fixed_t_lab(double p_ref, double beta);
     void convert_to_fixed_z_lab(double p_ref, double beta);
@@ -375,6 +426,12 @@ class bunch_particles_t {
 
     karray2d_row get_particles_last_discarded() const;
 
+    // copy the particles discarded from the most recent aperture apply
+    // into the device array buf starting at row offset. buf must have at
+    // least offset + num_last_discarded() rows. no host copy is involved
+    void append_particles_last_discarded(karray2d_row_dev const& buf,
+                                         int offset) const;
+
     void check_pz2_positive();
     void print_particle(size_t idx, Logger& logger) const;
 
@@ -461,14 +518,17 @@ class bunch_particles_t {
 // instantiated with a double is still the default BunchParticles
 typedef bunch_particles_t<double> BunchParticles;
 
+// reduced precision particle storage
+typedef bunch_particles_t<float> BunchParticlesF;
+
 // implementations
 namespace bunch_particles_impl {
-    template <class AP>
+    template <class AP, class CP = ConstParticles>
     struct discard_applier {
         typedef int value_type;
 
         AP ap;
-        ConstParticles parts;
+        CP parts;
         ParticleMasks masks;
         ParticleMasks discards;
 
@@ -487,17 +547,20 @@ namespace bunch_particles_impl {
     };
 }
 
-template <>
+template <typename PART>
 template <typename AP>
 inline int
-bunch_particles_t<double>::apply_aperture(AP const& ap)
+bunch_particles_t<PART>::apply_aperture(AP const& ap)
 {
     using namespace bunch_particles_impl;
 
+    static_assert(!is_trigon<PART>::value,
+                  "bunch_particles_t::apply_aperture() not for trigons");
+
     int ndiscarded = 0;
 
     // go through each particle to see which one is been filtered out
-    discard_applier<AP> da{ap, parts, masks, discards};
+    discard_applier<AP, const_parts_t> da{ap, parts, masks, discards};
     Kokkos::parallel_reduce(n_active, da, ndiscarded);
 
     // std::cout << "      discarded = " << ndiscarded << "\n";
@@ -544,6 +607,55 @@ namespace bunch_particles_impl {
         }
     };
 
+    // ids in a separate array
+    template <typename ids_t>
+    struct pid_assigner_ids {
+        ids_t ids;
+        int64_t offset;
+
+        KOKKOS_INLINE_FUNCTION
+        void
+        operator()(const int i) const
+        {
+            ids(i) = i + offset;
+        }
+    };
+
+    // copy between particle arrays of different precisions. The id
+    // column is read from, or written to, the separate id array of the
+    // reduced precision side
+    template <typename BP1, typename BP2>
+    struct particle_assigner {
+        typename BP1::parts_t dst;
+        typename BP1::masks_t d_masks;
+        typename BP1::ids_t d_ids;
+
+        typename BP2::const_parts_t src;
+        typename BP2::const_masks_t s_masks;
+        typename BP2::ids_t s_ids;
+
+        KOKKOS_INLINE_FUNCTION
+        void
+        operator()(const int i) const
+        {
+            for (int j = 0; j < 6; ++j)
+                dst(i, j) = src(i, j);
+
+            int64_t id;
+            if constexpr (BP2::reduced_precision)
+                id = s_ids(i);
+            else
+                id = src(i, 6);
+
+            if constexpr (BP1::reduced_precision)
+                d_ids(i) = id;
+            else
+                dst(i, 6) = id;
+
+            d_masks(i) = s_masks(i);
+        }
+    };
+
     template <typename masks_t>
     struct particle_masks_initializer {
         masks_t masks;
@@ -569,8 +681,37 @@ bunch_particles_t<PART>::default_ids(int local_offset, Commxx const& comm)
     int global_offset = pid_offset::get(request_num, comm);
 
     auto range = Kokkos::RangePolicy<exec_space>(0, n_active);
-    pid_assigner<parts_t> pia{parts, local_offset + global_offset};
-    Kokkos::parallel_for(range, pia);
+
+    if constexpr (reduced_precision) {
+        pid_assigner_ids<ids_t> pia{ids, local_offset + global_offset};
+        Kokkos::parallel_for(range, pia);
+    } else {
+        pid_assigner<parts_t> pia{parts, local_offset + global_offset};
+        Kokkos::parallel_for(range, pia);
+    }
+}
+
+template <typename PART>
+template <typename P2>
+inline void
+bunch_particles_t<PART>::assign(bunch_particles_t<P2> const& o)
+{
+    using namespace bunch_particles_impl;
+
+    static_assert(!is_trigon<PART>::value && !is_trigon<P2>::value,
+                  "bunch_particles_t::assign() not available for trigons");
+
+    reserve_local(o.size());
+
+    particle_assigner<bunch_particles_t<PART>, bunch_particles_t<P2>> pa{
+        parts, masks, ids, o.parts, o.masks, o.ids};
+
+    auto range = Kokkos::RangePolicy<exec_space>(0, o.size());
+    Kokkos::parallel_for(range, pa);
+
+    n_valid = o.num_valid();
+    n_active = o.size();
+    n_total = o.num_total();
 }
 
 template <typename PART>
@@ -592,6 +733,8 @@ inline bunch_particles_t<PART>::bunch_particles_t(ParticleGroup pg,
     , hparts(Kokkos::create_mirror_view(parts))
     , hmasks(Kokkos::create_mirror_view(masks))
     , hdiscards(Kokkos::create_mirror_view(discards))
+    , ids()
+    , hids(Kokkos::create_mirror_view(ids))
 {
     using namespace bunch_particles_impl;
 
@@ -642,6 +785,11 @@ inline bunch_particles_t<PART>::bunch_particles_t(ParticleGroup pg,
         hmasks = Kokkos::create_mirror_view(masks);
         hdiscards = Kokkos::create_mirror_view(discards);
 
+        if constexpr (reduced_precision) {
+            ids = ids_t(label + "_ids", n_reserved);
+            hids = Kokkos::create_mirror_view(ids);
+        }
+
         // set default ids
         default_ids(offsets_t[mpi_rank], comm);
 
@@ -10,15 +10,112 @@
 
 #include "synergia/bunch/diagnostics_bulk_track.h"
 #include "synergia/bunch/diagnostics_full2.h"
+#include "synergia/bunch/diagnostics_histograms.h"
 #include "synergia/bunch/diagnostics_loss.h"
 #include "synergia/bunch/diagnostics_particles.h"
+#include "synergia/bunch/diagnostics_tunes.h"
 #include "synergia/bunch/diagnostics_worker.h"
 
 #include "synergia/bunch/diagnostics_py.h"
 
+#include "synergia/utils/array_export.h"
+
 namespace py = pybind11;
 using namespace py::literals;
 
+namespace {
+    // PyCapsule destructor for the DLPack protocol. A consumer renames the
+    // capsule to "used_dltensor" once it took over the ownership
+    void
+    dlpack_capsule_deleter(PyObject* capsule)
+    {
+        if (PyCapsule_IsValid(capsule, "used_dltensor")) return;
+
+        auto t = (DLManagedTensor*)PyCapsule_GetPointer(capsule, "dltensor");
+
+        if (t && t->deleter)
+            t->deleter(t);
+        else
+            PyErr_Clear();
+    }
+
+    // the stream argument of __dlpack__. All the device work is fenced
+    // before the export, after which the data is ready on any stream of
+    // the consumer. -1 asks for no synchronization
+    void
+    dlpack_sync(Array_export const& ae, py::object const& stream)
+    {
+        if (!stream.is_none()) {
+            if (ae.on_host())
+                throw py::buffer_error(
+                    "__dlpack__: stream must be None for host arrays");
+
+            if (!py::isinstance<py::int_>(stream))
+                throw py::type_error(
+                    "__dlpack__: stream must be an integer or None");
+
+            if (stream.cast<int64_t>() == -1) return;
+        }
+
+        // the data may still be in flight on the device
+        Kokkos::fence();
+    }
+
+    py::capsule
+    to_dlpack_capsule(Array_export const& ae, py::object const& stream)
+    {
+        dlpack_sync(ae, stream);
+
+        auto capsule =
+            PyCapsule_New(ae.to_dlpack(), "dltensor", dlpack_capsule_deleter);
+        return py::reinterpret_steal<py::capsule>(capsule);
+    }
+
+    // dict for the __array_interface__ and __cuda_array_interface__
+    py::dict
+    array_interface(Array_export const& ae)
+    {
+        std::string type = std::string(ae.dtype.code == kDLFloat ? "f"
+                                       : ae.dtype.code == kDLInt ? "i"
+                                                                 : "u") +
+                           std::to_string(ae.dtype.bits / 8);
+
+        py::list shape, strides;
+        for (size_t i = 0; i < ae.shape.size(); ++i) {
+            shape.append(ae.shape[i]);
+            strides.append(ae.strides[i] * ae.dtype.bits / 8);
+        }
+
+        py::dict d;
+        d["shape"] = py::tuple(shape);
+        d["strides"] = py::tuple(strides);
+        d["typestr"] = "<" + type;
+        d["data"] = py::make_tuple((uintptr_t)ae.data, false);
+        d["version"] = 3;
+
+        return d;
+    }
+
+    // adds the DLPack protocol to a python class of a Kokkos view
+    template <class View, class... Extra>
+    void
+    def_dlpack(py::class_<View, Extra...>& cls)
+    {
+        cls.def(
+               "__dlpack__",
+               [](View const& v, py::object stream) {
+                   return to_dlpack_capsule(Array_export::from_view(v),
+                                            stream);
+               },
+               "stream"_a = py::none())
+
+            .def("__dlpack_device__", [](View const& v) {
+                auto dev = Array_export::from_view(v).device;
+                return py::make_tuple((int)dev.device_type, dev.device_id);
+            });
+    }
+}
+
 PYBIND11_MODULE(bunch, m)
 {
     py::enum_<ParticleGroup>(m, "ParticleGroup")
@@ -31,8 +128,11 @@ PYBIND11_MODULE(bunch, m)
         .value("aperture", LongitudinalBoundary::aperture)
         .value("bucket_barrier", LongitudinalBoundary::bucket_barrier);
 
-    py::class_<HostParticles>(m, "Particles", py::buffer_protocol())
-        .def_buffer([](HostParticles const& p) -> py::buffer_info {
+    py::class_<HostParticles> py_host_particles(
+        m, "Particles", py::buffer_protocol());
+
+    py_host_particles.def_buffer(
+        [](HostParticles const& p) -> py::buffer_info {
             return py::buffer_info(
                 p.data(),                   // pointer to buffer
                 sizeof(double),             // size of one scalar
@@ -44,26 +144,76 @@ PYBIND11_MODULE(bunch, m)
             );
         });
 
-    py::class_<karray1d>(m, "karray1d", py::buffer_protocol())
-        .def_buffer([](karray1d const& p) -> py::buffer_info {
-            return py::buffer_info(p.data(),
-                                   sizeof(double),
-                                   py::format_descriptor<double>::format(),
-                                   1,
-                                   {p.extent(0)},
-                                   {p.stride(0) * sizeof(double)});
-        });
+    def_dlpack(py_host_particles);
+
+    py::class_<karray1d> py_karray1d(m, "karray1d", py::buffer_protocol());
+
+    py_karray1d.def_buffer([](karray1d const& p) -> py::buffer_info {
+        return py::buffer_info(p.data(),
+                               sizeof(double),
+                               py::format_descriptor<double>::format(),
+                               1,
+                               {p.extent(0)},
+                               {p.stride(0) * sizeof(double)});
+    });
+
+    def_dlpack(py_karray1d);
+
+    py::class_<karray2d_row> py_karray2d_row(
+        m, "karray2d_row", py::buffer_protocol());
+
+    py_karray2d_row.def_buffer([](karray2d_row const& p) -> py::buffer_info {
+        return py::buffer_info(
+            p.data(),
+            sizeof(double),
+            py::format_descriptor<double>::format(),
+            2,
+            {p.extent(0), p.extent(1)},
+            {p.stride(0) * sizeof(double), p.stride(1) * sizeof(double)});
+    });
+
+    def_dlpack(py_karray2d_row);
+
+    // zero-copy export of the particle arrays in the device (or host)
+    // memory. The exported arrays alias the bunch data, so they are
+    // only valid until the next change in the bunch capacity
+    py::class_<Array_export>(m, "ArrayExport")
+        .def_property_readonly("shape",
+                               [](Array_export const& ae) {
+                                   return py::tuple(py::cast(ae.shape));
+                               })
 
-    py::class_<karray2d_row>(m, "karray2d_row", py::buffer_protocol())
-        .def_buffer([](karray2d_row const& p) -> py::buffer_info {
-            return py::buffer_info(
-                p.data(),
-                sizeof(double),
-                py::format_descriptor<double>::format(),
-                2,
-                {p.extent(0), p.extent(1)},
-                {p.stride(0) * sizeof(double), p.stride(1) * sizeof(double)});
-        });
+        .def(
+            "__dlpack__",
+            [](Array_export const& ae, py::object stream) {
+                return to_dlpack_capsule(ae, stream);
+            },
+            "stream"_a = py::none())
+
+        .def("__dlpack_device__",
+             [](Array_export const& ae) {
+                 return py::make_tuple((int)ae.device.device_type,
+                                       ae.device.device_id);
+             })
+
+        .def_property_readonly("__array_interface__",
+                               [](Array_export const& ae) {
+                                   if (!ae.on_host())
+                                       throw py::attribute_error(
+                                           "array is not in host memory");
+                                   return array_interface(ae);
+                               })
+
+        .def_property_readonly("__cuda_array_interface__",
+                               [](Array_export const& ae) {
+                                   if (ae.on_host())
+                                       throw py::attribute_error(
+                                           "array is not in device memory");
+                                   Kokkos::fence();
+                                   auto d = array_interface(ae);
+                                   d["stream"] = py::none();
+                                   return d;
+                               });
 
     // Bunch
     py::class_<Bunch>(m, "Bunch")
@@ -148,6 +298,41 @@ PYBIND11_MODULE(bunch, m)
              "Copy the particle array from device memory to host memory.",
              "particle_group"_a = ParticleGroup::regular)
 
+        .def("checkout_particles_async",
+             &Bunch::checkout_particles_async,
+             "Start copying the particle array from device memory to host "
+             "memory without waiting for the copy to complete.",
+             "particle_group"_a = ParticleGroup::regular)
+
+        .def("wait_checkout_particles",
+             &Bunch::wait_checkout_particles,
+             "Wait for the pending checkout_particles_async() to complete.",
+             "particle_group"_a = ParticleGroup::regular)
+
+        .def(
+            "export_particles",
+            [](Bunch& self, ParticleGroup pg, int first, int last) {
+                auto ae = Array_export::from_view(self.get_local_particles(pg));
+                return ae.subset(self.size(pg), first, last);
+            },
+            "Zero-copy export of the columns [first, last) of the particle "
+            "array in device memory. Supports DLPack and the (cuda) array "
+            "interface.",
+            "particle_group"_a = ParticleGroup::regular,
+            "first"_a = 0,
+            "last"_a = 7)
+
+        .def(
+            "export_particle_masks",
+            [](Bunch& self, ParticleGroup pg) {
+                auto masks = self.get_local_particle_masks(pg);
+                auto ae = Array_export::from_view(masks);
+                ae.shape[0] = self.size(pg);
+                return ae;
+            },
+            "Zero-copy export of the particle masks array in device memory.",
+            "particle_group"_a = ParticleGroup::regular)
+
         .def("get_host_particles",
              (HostParticles(Bunch::*)(ParticleGroup)) &
                  Bunch::get_host_particles,
@@ -213,12 +398,26 @@ PYBIND11_MODULE(bunch, m)
         .def("set_diag_loss_aperture",
              &Bunch::set_diag_loss_aperture,
              "Set the loss diagnostics for apertures.",
-             "filename"_a)
+             "filename"_a,
+             "flush_turns"_a = 0,
+             "flush_size"_a = 0)
 
         .def("set_diag_loss_zcut",
              &Bunch::set_diag_loss_zcut,
              "Set the loss diagnostics for z-cut.",
-             "filename"_a)
+             "filename"_a,
+             "flush_turns"_a = 0,
+             "flush_size"_a = 0)
+
+        .def("flush_diag_loss",
+             &Bunch::flush_diag_loss,
+             "Write out the buffered loss diagnostics.",
+             "force"_a = false)
+
+        .def("flush_diags",
+             &Bunch::flush_diags,
+             "Write out all the buffered diagnostics.",
+             "force"_a = false)
 
         .def("diag_type",
              &Bunch::diag_type,
@@ -256,12 +455,14 @@ PYBIND11_MODULE(bunch, m)
     // Core_diagnostics
     py::class_<Core_diagnostics>(m, "Core_diagnostics")
         .def_static("calculate_mean_ka",
-                    &Core_diagnostics::calculate_mean,
+                    py::overload_cast<Bunch const&>(
+                        &Core_diagnostics::calculate_mean),
                     "Calculate the mean for the bunch.",
                     "bunch"_a)
 
         .def_static("calculate_abs_mean_ka",
-                    &Core_diagnostics::calculate_abs_mean,
+                    py::overload_cast<Bunch const&>(
+                        &Core_diagnostics::calculate_abs_mean),
                     "Calculate the mean of absolute values for the bunch.",
                     "bunch"_a)
 
@@ -347,12 +548,83 @@ PYBIND11_MODULE(bunch, m)
                Diagnostics,
                std::shared_ptr<Diagnostics_bulk_track>>(
         m, "Diagnostics_bulk_track")
-        .def(py::init<std::string const&, int, int, ParticleGroup>(),
+        .def(py::init<std::string const&, int, int, ParticleGroup, int, int>(),
              "Construct a Diagnostics_bulk_track object.",
              "filename"_a = "diag_bulk_track.h5",
              "num_tracks"_a = 0,
              "offset"_a = 0,
-             "particlegroup"_a = ParticleGroup::regular);
+             "particlegroup"_a = ParticleGroup::regular,
+             "flush_turns"_a = 0,
+             "deflate"_a = 0)
+
+        .def("get_num_buffered",
+             &Diagnostics_bulk_track::get_num_buffered,
+             "Number of updates in the buffer.");
+
+    py::class_<Diagnostics_tunes,
+               Diagnostics,
+               std::shared_ptr<Diagnostics_tunes>>(m, "Diagnostics_tunes")
+        .def(py::init<std::string const&, int, int, int, ParticleGroup>(),
+             "Construct a Diagnostics_tunes object.",
+             "filename"_a = "diag_tunes.h5",
+             "num_tracks"_a = 0,
+             "offset"_a = 0,
+             "window_turns"_a = 1024,
+             "particlegroup"_a = ParticleGroup::regular)
+
+        .def("get_num_turns",
+             &Diagnostics_tunes::get_num_turns,
+             "Number of turns in the current window.");
+
+    py::class_<Diagnostics_histograms,
+               Diagnostics,
+               std::shared_ptr<Diagnostics_histograms>>(
+        m, "Diagnostics_histograms")
+        .def(py::init<std::string const&, int, double>(),
+             "Construct a Diagnostics_histograms object.",
+             "filename"_a = "diag_histograms.h5",
+             "num_bins"_a = 64,
+             "num_sigmas"_a = 6.0)
+
+        .def("clear_histograms",
+             &Diagnostics_histograms::clear_histograms,
+             "Remove all the histograms.")
+
+        .def("add_histogram_1d",
+             &Diagnostics_histograms::add_histogram_1d,
+             "Add a 1d histogram of a coordinate.",
+             "name"_a,
+             "coord"_a,
+             "bins"_a,
+             "lo"_a = 0.0,
+             "hi"_a = 0.0)
+
+        .def("add_histogram_2d",
+             &Diagnostics_histograms::add_histogram_2d,
+             "Add a 2d histogram of two coordinates.",
+             "name"_a,
+             "coord0"_a,
+             "bins0"_a,
+             "coord1"_a,
+             "bins1"_a,
+             "lo0"_a = 0.0,
+             "hi0"_a = 0.0,
+             "lo1"_a = 0.0,
+             "hi1"_a = 0.0)
+
+        .def(
+            "get_histogram",
+            [](Diagnostics_histograms const& diag, std::string const& name) {
+                auto h = diag.get_histogram(name);
+                return std::vector<double>(h.data(), h.data() + h.extent(0));
+            },
+            "Counts of the named histogram from the last update.",
+            "name"_a)
+
+        .def("get_outside",
+             &Diagnostics_histograms::get_outside,
+             "Number of particles outside of the named histogram.",
+             "name"_a);
 
     py::class_<Diagnostics_particles,
                Diagnostics,
@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include "bunch_rank_map.h"
+
+namespace {
+    // number of contiguous groups needed to hold the weights with no
+    // group exceeding the capacity
+    int
+    num_groups(std::vector<double> const& weights, double capacity)
+    {
+        int groups = 1;
+        double sum = 0.0;
+
+        for (auto w : weights) {
+            if (sum > 0.0 && sum + w > capacity) {
+                ++groups;
+                sum = 0.0;
+            }
+
+            sum += w;
+        }
+
+        return groups;
+    }
+}
+
+Bunch_rank_map::Bunch_rank_map(int num_ranks, int num_bunches)
+    : Bunch_rank_map(num_ranks, std::vector<double>(num_bunches, 1.0))
+{}
+
+Bunch_rank_map::Bunch_rank_map(int num_ranks,
+                               std::vector<double> const& weights)
+    : num_ranks(num_ranks), first(weights.size()), count(weights.size())
+{
+    const int nb = weights.size();
+
+    if (num_ranks <= 0) {
+        throw std::runtime_error(
+            "Bunch_rank_map: number of ranks must be positive");
+    }
+
+    for (auto w : weights) {
+        if (!(w > 0.0)) {
+            throw std::runtime_error(
+                "Bunch_rank_map: bunch weights must be positive");
+        }
+    }
+
+    if (nb == 0) return;
+
+    if (num_ranks >= nb) {
+        // one rank each, then the rest goes to the bunch with the
+        // highest weight per rank
+        std::fill(count.begin(), count.end(), 1);
+
+        for (int r = nb; r < num_ranks; ++r) {
+            int b_max = 0;
+            for (int b = 1; b < nb; ++b) {
+                if (weights[b] / count[b] > weights[b_max] / count[b_max])
+                    b_max = b;
+            }
+
+            ++count[b_max];
+        }
+
+        first[0] = 0;
+        for (int b = 1; b < nb; ++b)
+            first[b] = first[b - 1] + count[b - 1];
+
+        return;
+    }
+
+    // bisect the smallest capacity that fits the bunches in num_ranks
+    // contiguous groups
+    double lo = *std::max_element(weights.begin(), weights.end());
+    double hi = std::accumulate(weights.begin(), weights.end(), 0.0);
+
+    if (num_groups(weights, lo) > num_ranks) {
+        for (int i = 0; i < 100 && hi - lo > 1e-12 * hi; ++i) {
+            double mid = 0.5 * (lo + hi);
+            if (num_groups(weights, mid) <= num_ranks)
+                hi = mid;
+            else
+                lo = mid;
+        }
+    } else {
+        hi = lo;
+    }
+
+    // greedy fill, recording the first bunch of each group
+    std::vector<int> starts{0};
+    double sum = 0.0;
+
+    for (int b = 0; b < nb; ++b) {
+        if (sum > 0.0 && sum + weights[b] > hi) {
+            starts.push_back(b);
+            sum = 0.0;
+        }
+
+        sum += weights[b];
+    }
+
+    // there might be fewer groups than ranks. split the last bunch off
+    // the heaviest group with more than one bunch until every rank has
+    // a bunch
+    while ((int)starts.size() < num_ranks) {
+        int g_max = -1;
+        double w_max = 0.0;
+
+        const int ng = starts.size();
+
+        for (int g = 0; g < ng; ++g) {
+            int end = (g == ng - 1) ? nb : starts[g + 1];
+            if (end - starts[g] < 2) continue;
+
+            double w = std::accumulate(
+                weights.begin() + starts[g], weights.begin() + end, 0.0);
+
+            if (g_max == -1 || w > w_max) {
+                g_max = g;
+                w_max = w;
+            }
+        }
+
+        int end = (g_max == ng - 1) ? nb : starts[g_max + 1];
+        starts.insert(starts.begin() + g_max + 1, end - 1);
+    }
+
+    const int ng = starts.size();
+
+    for (int g = 0; g < ng; ++g) {
+        int end = (g == ng - 1) ? nb : starts[g + 1];
+        for (int b = starts[g]; b < end; ++b) {
+            first[b] = g;
+            count[b] = 1;
+        }
+    }
+}
+
+Bunch_rank_map
+Bunch_rank_map::shared(int num_ranks, int num_bunches)
+{
+    if (num_ranks <= 0) {
+        throw std::runtime_error(
+            "Bunch_rank_map: number of ranks must be positive");
+    }
+
+    Bunch_rank_map map;
+
+    map.num_ranks = num_ranks;
+    map.first.assign(num_bunches, 0);
+    map.count.assign(num_bunches, num_ranks);
+
+    return map;
+}
+
+bool
+Bunch_rank_map::is_shared() const
+{
+    if (num_ranks == 1) return false;
+
+    for (size_t b = 0; b < first.size(); ++b) {
+        if (first[b] != 0 || count[b] != num_ranks) return false;
+    }
+
+    return !first.empty();
+}
+
+std::vector<int>
+Bunch_rank_map::get_bunches_of_rank(int rank) const
+{
+    std::vector<int> bunches;
+
+    for (size_t b = 0; b < first.size(); ++b) {
+        if (rank >= first[b] && rank < first[b] + count[b])
+            bunches.push_back(b);
+    }
+
+    return bunches;
+}
+
+int
+Bunch_rank_map::get_color(int rank) const
+{
+    for (size_t b = 0; b < first.size(); ++b) {
+        if (rank >= first[b] && rank < first[b] + count[b]) return b;
+    }
+
+    throw std::runtime_error("Bunch_rank_map::get_color(): rank out of range");
+}
+
+void
+Bunch_rank_map::get_counts_and_offsets(std::vector<int>& counts,
+                                       std::vector<int>& offsets) const
+{
+    counts.assign(num_ranks, 0);
+    offsets.assign(num_ranks, 0);
+
+    if (first.empty()) return;
+
+    for (int r = 0; r < num_ranks; ++r)
+        offsets[r] = get_color(r);
+
+    for (size_t b = 0; b < first.size(); ++b)
+        ++counts[first[b]];
+}
+
+double
+Bunch_rank_map::get_imbalance(std::vector<double> const& weights) const
+{
+    if (weights.size() != first.size()) {
+        throw std::runtime_error("Bunch_rank_map::get_imbalance(): "
+                                 "inconsistent number of weights");
+    }
+
+    if (first.empty()) return 1.0;
+
+    std::vector<double> loads(num_ranks, 0.0);
+
+    for (size_t b = 0; b < first.size(); ++b) {
+        for (int r = first[b]; r < first[b] + count[b]; ++r)
+            loads[r] += weights[b] / count[b];
+    }
+
+    double total = std::accumulate(loads.begin(), loads.end(), 0.0);
+    double max = *std::max_element(loads.begin(), loads.end());
+
+    return max * num_ranks / total;
+}
@@ -0,0 +1,125 @@
+#ifndef BUNCH_RANK_MAP_H_
+#define BUNCH_RANK_MAP_H_
+
+#include <vector>
+
+#include "synergia/utils/cereal.h"
+
+#include <cereal/types/vector.hpp>
+
+/// Bunch_rank_map assigns the bunches of a train to the ranks of the
+/// train communicator. Every bunch occupies a contiguous range of ranks,
+/// and the bunches are laid out in increasing order of ranks.
+///
+/// The assignment is weighted, e.g., by the number of macroparticles of
+/// each bunch times the cost of the collective operators applied to it:
+///
+///   num_ranks >= num_bunches: each bunch gets at least one rank, and the
+///     remaining ranks go one at a time to the bunch with the highest
+///     weight per rank (the ranks are shared among bunches in proportion
+///     to their weights).
+///
+///   num_ranks < num_bunches: each rank gets a contiguous set of whole
+///     bunches (at least one), chosen to minimize the largest sum of
+///     weights on a rank.
+///
+/// A shared map (see shared()) places every bunch on all the ranks of the
+/// train instead, so that the bunches share a single communicator and the
+/// communications of one bunch can overlap with the computations of the
+/// others (see Step::apply()).
+///
+/// The map is a pure function of its inputs, so all ranks construct the
+/// same map from the same weights.
+class Bunch_rank_map {
+  private:
+    int num_ranks;
+
+    // first rank and number of ranks of each bunch
+    std::vector<int> first;
+    std::vector<int> count;
+
+  public:
+    Bunch_rank_map() : num_ranks(0), first(), count() {}
+
+    // uniform weights
+    Bunch_rank_map(int num_ranks, int num_bunches);
+
+    // weights must be positive, one for each bunch
+    Bunch_rank_map(int num_ranks, std::vector<double> const& weights);
+
+    // all bunches on all ranks
+    static Bunch_rank_map shared(int num_ranks, int num_bunches);
+
+    int
+    get_num_ranks() const
+    {
+        return num_ranks;
+    }
+
+    int
+    get_num_bunches() const
+    {
+        return first.size();
+    }
+
+    // first rank of the bunch
+    int
+    get_first_rank(int bunch) const
+    {
+        return first[bunch];
+    }
+
+    // number of ranks the bunch spans across
+    int
+    get_rank_count(int bunch) const
+    {
+        return count[bunch];
+    }
+
+    // whether all bunches are on all ranks
+    bool is_shared() const;
+
+    // indices of the bunches on the rank, in increasing order
+    std::vector<int> get_bunches_of_rank(int rank) const;
+
+    // color to split the train communicator into bunch communicators.
+    // ranks holding the same bunches have the same color
+    int get_color(int rank) const;
+
+    // counts[r] is the number of bunches whose first rank is r, and
+    // offsets[r] the index of the first bunch on r. see
+    // Bunch_train::get_proc_counts_for_impedance()
+    void get_counts_and_offsets(std::vector<int>& counts,
+                                std::vector<int>& offsets) const;
+
+    // ratio of the largest weight per rank to the average weight per
+    // rank (1 is a perfect balance)
+    double get_imbalance(std::vector<double> const& weights) const;
+
+    bool
+    operator==(Bunch_rank_map const& o) const
+    {
+        return num_ranks == o.num_ranks && first == o.first &&
+               count == o.count;
+    }
+
+    bool
+    operator!=(Bunch_rank_map const& o) const
+    {
+        return !(*this == o);
+    }
+
+  private:
+    friend class cereal::access;
+
+    template <class Archive>
+    void
+    serialize(Archive& ar)
+    {
+        ar(CEREAL_NVP(num_ranks));
+        ar(CEREAL_NVP(first));
+        ar(CEREAL_NVP(count));
+    }
+};
+
+#endif /* BUNCH_RANK_MAP_H_ */
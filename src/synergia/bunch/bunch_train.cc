@@ -1,64 +1,16 @@
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+
 #include "bunch_train.h"
 #include "synergia/utils/parallel_utils.h"
 
-#if 0
-void 
-Bunch_train::find_parent_comm()
-{
-  try{
-    if (bunches.size()>0) {
-        // check if all bunches has the same parent communicator
-        MPI_Comm comm_test=bunches[0]->get_comm().get_parent_sptr()->get();
-	for (size_t i = 1; i < bunches.size(); ++i) {
- 	      int result;
- 	      MPI_Comm_compare( comm_test, bunches[i]->get_comm().get_parent_sptr()->get(), &result);
- 	      if (result != MPI_IDENT) {
-             	throw std::runtime_error("Bunch_train, find_parent_comm_sptr: bunches have different parrent comunicator");
- 	      } 
- 	} 
- 	parent_comm_sptr=bunches[0]->get_comm().get_parent_sptr();
-    }
-    else{
-	 throw std::runtime_error(
-	    "Bunch_train, find_parent_comm_sptr: number of bunches is zero, there is no commuicator");
-    }   
-    has_parent_comm=true;
-  }
-  catch (std::exception const& e) {
-         std::cout<<e.what()<<std::endl;
-         MPI_Abort(MPI_COMM_WORLD, 333);
-  }  
-}
-#endif
-
 void
 Bunch_train::calculates_counts_and_offsets_for_impedance()
 {
-#if 0
-   
-  try{
-     if (!has_parent_comm) find_parent_comm_sptr(); 
-     int size_parent=parent_comm_sptr->get_size();
-     proc_counts_imped.resize(size_parent);
-     proc_offsets_imped.resize(size_parent); 
- 	  counts_and_offsets_for_impedance(*parent_comm_sptr, bunches.size(), proc_offsets_imped, proc_counts_imped);
-  }
-  catch (std::exception const& e) {
-        std::cout<<e.what()<<std::endl;
-        MPI_Abort(MPI_COMM_WORLD, 333);
-  }
-#endif
+    rank_map.get_counts_and_offsets(proc_counts_imped, proc_offsets_imped);
 }
 
-#if 0
-Commxx
-Bunch_train::get_parent_comm()
-{
-  if (!has_parent_comm) find_parent_comm(); 
-  return parent_comm;
-}
-#endif
-
 void
 Bunch_train::set_bucket_indices()
 {
@@ -113,14 +65,46 @@ Bunch_train::Bunch_train(Reference_particle const& ref,
                          Commxx const& bt_comm,
                          size_t num_spectator_per_bunch,
                          int index)
+    : Bunch_train(ref,
+                  std::vector<size_t>(num_bunches, num_particles_per_bunch),
+                  std::vector<double>(num_bunches,
+                                      num_real_particles_per_bunch),
+                  spacing,
+                  bt_comm,
+                  num_spectator_per_bunch,
+                  index)
+{}
+
+Bunch_train::Bunch_train(Reference_particle const& ref,
+                         std::vector<size_t> const& num_particles,
+                         std::vector<double> const& num_real_particles,
+                         double spacing,
+                         Commxx const& bt_comm,
+                         size_t num_spectator_per_bunch,
+                         int index,
+                         Bunch_rank_map const& map,
+                         int first_rank)
     : comm(std::make_shared<Commxx>(bt_comm))
     , bunches()
     , spacings()
     , index(index)
-    , num_bunches(num_bunches)
-    , num_buckets(num_bunches)
-    , bunch_idx_map(num_bunches, -1)
+    , num_bunches(num_particles.size())
+    , num_buckets(num_particles.size())
+    , bunch_idx_map(num_particles.size(), -1)
+    , rank_map(map)
+    , first_rank(first_rank)
 {
+    if ((int)num_real_particles.size() != num_bunches) {
+        throw std::runtime_error("Bunch_train::Bunch_train() inconsistent "
+                                 "sizes of the particle numbers");
+    }
+
+    if (rank_map.get_num_bunches() != 0 &&
+        rank_map.get_num_bunches() != num_bunches) {
+        throw std::runtime_error("Bunch_train::Bunch_train() the rank map "
+                                 "has a different number of bunches");
+    }
+
     for (auto i = 0; i < num_bunches; ++i)
         spacings.emplace_back(spacing);
 
@@ -128,36 +112,29 @@ Bunch_train::Bunch_train(Reference_particle const& ref,
     if (comm->is_null()) return;
     if (num_bunches == 0) return;
 
-    // construct bunches
-    int rank = comm->rank();
-    int size = comm->size();
-
-    int bunches_per_rank = 0;
-    int color = 0;
+    // weighted by the number of macroparticles. empty bunches still
+    // need a rank
+    if (rank_map.get_num_bunches() == 0) {
+        std::vector<double> weights;
+        for (auto n : num_particles)
+            weights.push_back(std::max(1.0, double(n)));
 
-    if (size < num_bunches) {
-        if (num_bunches % size != 0) {
-            throw std::runtime_error("Bunch_train::Bunch_train() number of "
-                                     "bunches must be divisible "
-                                     "by the number of ranks.");
-        }
-
-        bunches_per_rank = num_bunches / size;
-        color = rank;
-    } else {
-        if (size % num_bunches != 0) {
-            throw std::runtime_error(
-                "Bunch_train::Bunch_train() number of ranks must be divisible "
-                "by the number of bunches.");
-        }
+        rank_map = Bunch_rank_map(comm->size(), weights);
+    }
 
-        bunches_per_rank = 1;
-        color = rank / (size / num_bunches); // rank / ranks_per_bunch
+    if (rank_map.get_num_ranks() != comm->size()) {
+        throw std::runtime_error("Bunch_train::Bunch_train() the rank map "
+                                 "has a different number of ranks");
     }
 
-    for (int b = 0; b < bunches_per_rank; ++b) {
-        // bunch_index and array_index
-        int b_idx = b + color * bunches_per_rank;
+    // construct bunches. all the local bunches share the same bunch
+    // communicator, so there is a single split on every rank
+    int rank = comm->rank();
+    auto bunch_comm =
+        std::make_shared<Commxx>(comm->split(rank_map.get_color(rank)));
+
+    for (int b_idx : rank_map.get_bunches_of_rank(rank)) {
+        // array index
         int a_idx = bunches.size();
 
         // construct the idx map
@@ -166,9 +143,9 @@ Bunch_train::Bunch_train(Reference_particle const& ref,
         // construct and push bunch object
         bunches.emplace_back(
             ref,
-            num_particles_per_bunch,
-            num_real_particles_per_bunch,
-            comm->split(color),
+            num_particles[b_idx],
+            num_real_particles[b_idx],
+            bunch_comm,
             num_spectator_per_bunch,
             b_idx, // bunch index in the train
             b_idx, // bucket index set to the same of bunch index
@@ -176,6 +153,8 @@ Bunch_train::Bunch_train(Reference_particle const& ref,
             index  // train index
         );
     }
+
+    calculates_counts_and_offsets_for_impedance();
 }
 
 std::vector<double>&
@@ -196,6 +175,345 @@ Bunch_train::get_proc_offsets_for_impedance()
     return proc_offsets_imped;
 }
 
+std::vector<int>
+Bunch_train::get_bunch_ranks(int bunch) const
+{
+    if (bunch < 0 || bunch >= rank_map.get_num_bunches()) {
+        throw std::runtime_error(
+            "Bunch_train::get_bunch_ranks() invalid bunch index");
+    }
+
+    std::vector<int> ranks(rank_map.get_rank_count(bunch));
+    std::iota(ranks.begin(),
+              ranks.end(),
+              first_rank + rank_map.get_first_rank(bunch));
+
+    return ranks;
+}
+
+std::vector<double>
+Bunch_train::get_bunch_total_nums(Commxx const& parent) const
+{
+    std::vector<double> nums(num_bunches, 0.0);
+    if (num_bunches == 0) return nums;
+
+    for (auto const& b : bunches)
+        nums[b.get_bunch_index()] += b.get_local_num();
+
+    MPI_Allreduce(
+        MPI_IN_PLACE, nums.data(), num_bunches, MPI_DOUBLE, MPI_SUM, parent);
+
+    return nums;
+}
+
+namespace {
+    bool
+    is_moved(Bunch_rank_map const& m1, Bunch_rank_map const& m2, int b)
+    {
+        return m1.get_first_rank(b) != m2.get_first_rank(b) ||
+               m1.get_rank_count(b) != m2.get_rank_count(b);
+    }
+
+    // state of a bunch other than its particles
+    struct bunch_state {
+        Reference_particle ref;
+        Reference_particle design_ref;
+        LongitudinalBoundary boundary;
+        double boundary_param;
+        int particle_charge;
+        double real_num;
+        int bucket_index;
+
+        template <class AR>
+        void
+        serialize(AR& ar)
+        {
+            ar(ref,
+               design_ref,
+               boundary,
+               boundary_param,
+               particle_charge,
+               real_num,
+               bucket_index);
+        }
+    };
+
+    // broadcast the state of the bunch from the root rank
+    bunch_state
+    bcast_state(Bunch const* bunch, int root, Commxx const& comm)
+    {
+        bunch_state st;
+        std::string str;
+
+        if (comm.rank() == root) {
+            st = bunch_state{bunch->get_reference_particle(),
+                             bunch->get_design_reference_particle(),
+                             bunch->get_longitudinal_boundary().first,
+                             bunch->get_longitudinal_boundary().second,
+                             bunch->get_particle_charge(),
+                             bunch->get_real_num(),
+                             bunch->get_bucket_index()};
+
+            std::stringstream ss;
+            {
+                cereal::BinaryOutputArchive ar(ss);
+                ar(st);
+            }
+
+            str = ss.str();
+        }
+
+        uint64_t len = str.size();
+        MPI_Bcast(&len, 1, MPI_UINT64_T, root, comm);
+
+        str.resize(len);
+        MPI_Bcast(&str[0], len, MPI_BYTE, root, comm);
+
+        if (comm.rank() != root) {
+            std::stringstream ss(str);
+            cereal::BinaryInputArchive ar(ss);
+            ar(st);
+        }
+
+        return st;
+    }
+
+    // move the valid particles of a group from the old ranks of a bunch
+    // to its new ranks [first, first + count) in comm. Returns the
+    // particles received by the rank (7 doubles per particle) and the
+    // total number of particles in the group
+    std::vector<double>
+    exchange_particles(Bunch* bunch,
+                       ParticleGroup pg,
+                       int first,
+                       int count,
+                       Commxx const& comm,
+                       int& total)
+    {
+        const int rank = comm.rank();
+        const int size = comm.size();
+
+        // pack the valid local particles
+        std::vector<double> sbuf;
+
+        if (bunch) {
+            bunch->checkout_particles(pg);
+
+            auto parts = bunch->get_host_particles(pg);
+            auto masks = bunch->get_host_particle_masks(pg);
+
+            sbuf.reserve(bunch->get_local_num(pg) * 7);
+
+            for (int i = 0; i < bunch->size(pg); ++i) {
+                if (!masks(i)) continue;
+                for (int j = 0; j < 7; ++j)
+                    sbuf.push_back(parts(i, j));
+            }
+        }
+
+        // ranges of the particles in the global order, before and after
+        int num = sbuf.size() / 7;
+        std::vector<int> nums(size);
+        MPI_Allgather(&num, 1, MPI_INT, nums.data(), 1, MPI_INT, comm);
+
+        std::vector<int> src(size + 1, 0);
+        for (int r = 0; r < size; ++r)
+            src[r + 1] = src[r] + nums[r];
+
+        total = src[size];
+
+        std::vector<int> offsets(count), counts(count);
+        decompose_1d_raw(count, total, offsets, counts);
+
+        std::vector<int> dst(size + 1, 0);
+        for (int r = 0; r < size; ++r) {
+            bool in = r >= first && r < first + count;
+            dst[r + 1] = dst[r] + (in ? counts[r - first] : 0);
+        }
+
+        // send and receive the overlaps of the ranges
+        std::vector<int> scounts(size, 0), sdispls(size, 0);
+        std::vector<int> rcounts(size, 0), rdispls(size, 0);
+
+        for (int r = 0; r < size; ++r) {
+            int lo = std::max(src[rank], dst[r]);
+            int hi = std::min(src[rank + 1], dst[r + 1]);
+
+            if (hi > lo) {
+                scounts[r] = (hi - lo) * 7;
+                sdispls[r] = (lo - src[rank]) * 7;
+            }
+
+            lo = std::max(src[r], dst[rank]);
+            hi = std::min(src[r + 1], dst[rank + 1]);
+
+            if (hi > lo) {
+                rcounts[r] = (hi - lo) * 7;
+                rdispls[r] = (lo - dst[rank]) * 7;
+            }
+        }
+
+        std::vector<double> rbuf((dst[rank + 1] - dst[rank]) * 7);
+
+        MPI_Alltoallv(sbuf.data(),
+                      scounts.data(),
+                      sdispls.data(),
+                      MPI_DOUBLE,
+                      rbuf.data(),
+                      rcounts.data(),
+                      rdispls.data(),
+                      MPI_DOUBLE,
+                      comm);
+
+        return rbuf;
+    }
+
+    // fill the local particles of a newly constructed bunch
+    void
+    fill_particles(Bunch& bunch,
+                   ParticleGroup pg,
+                   std::vector<double> const& buf)
+    {
+        int num = buf.size() / 7;
+
+        if (num != bunch.size(pg)) {
+            throw std::runtime_error(
+                "Bunch_train::remap() inconsistent number of particles");
+        }
+
+        bunch.checkout_particles(pg);
+
+        auto parts = bunch.get_host_particles(pg);
+        auto masks = bunch.get_host_particle_masks(pg);
+
+        for (int i = 0; i < num; ++i) {
+            for (int j = 0; j < 7; ++j)
+                parts(i, j) = buf[i * 7 + j];
+            masks(i) = 1;
+        }
+
+        bunch.checkin_particles(pg);
+    }
+}
+
+bool
+Bunch_train::can_remap(Bunch_rank_map const& map) const
+{
+    if (comm->is_null() || map == rank_map) return true;
+
+    int ok = 1;
+    for (auto const& b : bunches) {
+        if (is_moved(rank_map, map, b.get_bunch_index()) &&
+            b.has_diagnostics())
+            ok = 0;
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, &ok, 1, MPI_INT, MPI_MIN, *comm);
+    return ok;
+}
+
+void
+Bunch_train::move_bunch(int b,
+                        Bunch_rank_map const& map,
+                        std::shared_ptr<Commxx> const& new_comm,
+                        std::vector<Bunch>& new_bunches)
+{
+    const int rank = comm->rank();
+
+    const int first = map.get_first_rank(b);
+    const int count = map.get_rank_count(b);
+
+    int a_idx = bunch_idx_map[b];
+    Bunch* old_bunch = (a_idx == -1) ? nullptr : &bunches[a_idx];
+
+    auto st = bcast_state(old_bunch, rank_map.get_first_rank(b), *comm);
+
+    int total = 0;
+    int total_spec = 0;
+
+    auto parts =
+        exchange_particles(old_bunch, PG::regular, first, count, *comm, total);
+    auto specs = exchange_particles(
+        old_bunch, PG::spectator, first, count, *comm, total_spec);
+
+    // not one of the new ranks
+    if (rank < first || rank >= first + count) return;
+
+    new_bunches.emplace_back(st.ref,
+                             total,
+                             st.real_num,
+                             new_comm,
+                             total_spec,
+                             b,
+                             st.bucket_index,
+                             new_bunches.size(),
+                             index);
+
+    auto& bunch = new_bunches.back();
+
+    bunch.set_design_reference_particle(st.design_ref);
+    bunch.set_particle_charge(st.particle_charge);
+    bunch.set_longitudinal_boundary(st.boundary, st.boundary_param);
+
+    fill_particles(bunch, PG::regular, parts);
+    fill_particles(bunch, PG::spectator, specs);
+}
+
+void
+Bunch_train::remap(Bunch_rank_map const& map)
+{
+    if (map.get_num_bunches() != num_bunches) {
+        throw std::runtime_error(
+            "Bunch_train::remap() inconsistent number of bunches");
+    }
+
+    if (map == rank_map) return;
+
+    // not in the train, only keep the map
+    if (comm->is_null()) {
+        rank_map = map;
+        return;
+    }
+
+    if (map.get_num_ranks() != comm->size()) {
+        throw std::runtime_error(
+            "Bunch_train::remap() inconsistent number of ranks");
+    }
+
+    if (!can_remap(map)) {
+        throw std::runtime_error("Bunch_train::remap() bunches with "
+                                 "diagnostics cannot change ranks");
+    }
+
+    // all local bunches, moved or not, go to the new bunch communicator
+    // so every rank keeps a single bunch communicator
+    int rank = comm->rank();
+    auto new_comm =
+        std::make_shared<Commxx>(comm->split(map.get_color(rank)));
+
+    std::vector<Bunch> new_bunches;
+
+    for (int b = 0; b < num_bunches; ++b) {
+        if (is_moved(rank_map, map, b)) {
+            move_bunch(b, map, new_comm, new_bunches);
+        } else if (bunch_idx_map[b] != -1) {
+            auto& bunch = bunches[bunch_idx_map[b]];
+            bunch.set_comm(new_comm);
+            bunch.set_array_index(new_bunches.size());
+            new_bunches.push_back(std::move(bunch));
+        }
+    }
+
+    bunches = std::move(new_bunches);
+    rank_map = map;
+
+    std::fill(bunch_idx_map.begin(), bunch_idx_map.end(), -1);
+    for (size_t a = 0; a < bunches.size(); ++a)
+        bunch_idx_map[bunches[a].get_bunch_index()] = a;
+
+    calculates_counts_and_offsets_for_impedance();
+}
+
 void
 Bunch_train::update_bunch_total_num()
 {
@@ -2,6 +2,7 @@
 #define BUNCH_TRAIN_H_
 
 #include "synergia/bunch/bunch.h"
+#include "synergia/bunch/bunch_rank_map.h"
 
 #include <cereal/types/array.hpp>
 #include <cereal/types/vector.hpp>
@@ -24,6 +25,13 @@ class Bunch_train {
     // the current rank, the stored value is -1
     std::vector<int> bunch_idx_map;
 
+    // assignment of the bunches to the ranks of the train communicator,
+    // and the rank of the first train rank in the parent communicator
+    // (e.g., the Bunch_simulator). available on all ranks of the parent
+    // communicator, including the ones not in the train
+    Bunch_rank_map rank_map;
+    int first_rank;
+
     /// counts and offsets are needed for impedance,
     /// counts.size()=offsets.size()=num_procs they are meaningfull only on the
     /// local rank=0 of every bunch communicator for example:  3 bunches on 5
@@ -37,9 +45,18 @@ class Bunch_train {
     std::vector<int> proc_offsets_imped;
 
     void set_bucket_indices();
-    void find_parent_comm();
     void calculates_counts_and_offsets_for_impedance();
 
+    void construct_bunches(Reference_particle const& ref,
+                           std::vector<size_t> const& num_particles,
+                           std::vector<double> const& num_real_particles,
+                           size_t num_spectator_per_bunch);
+
+    void move_bunch(int bunch,
+                    Bunch_rank_map const& map,
+                    std::shared_ptr<Commxx> const& new_comm,
+                    std::vector<Bunch>& new_bunches);
+
   public:
     // Bunch_train(Bunches const& bunches, double spacing);
     // Bunch_train(Bunches const& bunches, std::vector<double > const&
@@ -54,6 +71,21 @@ class Bunch_train {
                 size_t num_spectator_per_bunch = 0,
                 int index = 0);
 
+    // bunches with individual numbers of macro and real particles. the
+    // bunches are assigned to the ranks with the map, or, if the map is
+    // empty, by their numbers of macroparticles (see Bunch_rank_map).
+    // first_rank is the rank of the first train rank in the parent
+    // communicator
+    Bunch_train(Reference_particle const& ref,
+                std::vector<size_t> const& num_particles,
+                std::vector<double> const& num_real_particles,
+                double spacing,
+                Commxx const& comm = Commxx(),
+                size_t num_spectator_per_bunch = 0,
+                int index = 0,
+                Bunch_rank_map const& map = Bunch_rank_map(),
+                int first_rank = 0);
+
     // Get the communicator
     Commxx const&
     get_comm() const
@@ -161,6 +193,30 @@ class Bunch_train {
     std::vector<int>& get_proc_counts_for_impedance();
     std::vector<int>& get_proc_offsets_for_impedance();
 
+    // bunch to rank assignment
+    Bunch_rank_map const&
+    get_rank_map() const
+    {
+        return rank_map;
+    }
+
+    // ranks of the bunch in the parent communicator
+    std::vector<int> get_bunch_ranks(int bunch) const;
+
+    // total number of valid macroparticles of every bunch in the train.
+    // collective over the parent communicator
+    std::vector<double> get_bunch_total_nums(Commxx const& parent) const;
+
+    // reassign the bunches to the ranks of the train. The particles and
+    // the states of the bunches that changed ranks are moved to their new
+    // ranks; bunches whose ranks are unchanged are kept as they are.
+    // Must be called by all ranks of the parent communicator with the
+    // same map. Bunches with diagnostics cannot be moved, since their
+    // output files are owned by the old ranks; can_remap() tells whether
+    // the map is possible (collective over the train communicator)
+    bool can_remap(Bunch_rank_map const& map) const;
+    void remap(Bunch_rank_map const& map);
+
   private:
     friend class cereal::access;
 
@@ -175,6 +231,8 @@ class Bunch_train {
         ar(CEREAL_NVP(num_bunches));
         ar(CEREAL_NVP(num_buckets));
         ar(CEREAL_NVP(bunch_idx_map));
+        ar(CEREAL_NVP(rank_map));
+        ar(CEREAL_NVP(first_rank));
         ar(CEREAL_NVP(proc_counts_imped));
         ar(CEREAL_NVP(proc_offsets_imped));
     }
@@ -3,26 +3,39 @@
 
 #include "synergia/bunch/bunch.h"
 
+// The moments are accumulated in double for the single precision
+// bunches (BunchF) as well
 struct Core_diagnostics {
     static karray1d calculate_mean(Bunch const& bunch);
+    static karray1d calculate_mean(BunchF const& bunch);
 
     static double calculate_z_mean(Bunch const& bunch);
+    static double calculate_z_mean(BunchF const& bunch);
 
     static karray1d calculate_abs_mean(Bunch const& bunch);
+    static karray1d calculate_abs_mean(BunchF const& bunch);
 
     static karray1d calculate_std(Bunch const& bunch, karray1d const& mean);
+    static karray1d calculate_std(BunchF const& bunch, karray1d const& mean);
 
     static karray2d_row calculate_sum2(Bunch const& bunch,
                                        karray1d const& mean);
+    static karray2d_row calculate_sum2(BunchF const& bunch,
+                                       karray1d const& mean);
 
     static karray2d_row calculate_mom2(Bunch const& bunch,
                                        karray1d const& mean);
+    static karray2d_row calculate_mom2(BunchF const& bunch,
+                                       karray1d const& mean);
 
     static karray1d calculate_min(Bunch const& bunch);
+    static karray1d calculate_min(BunchF const& bunch);
 
     static karray1d calculate_max(Bunch const& bunch);
+    static karray1d calculate_max(BunchF const& bunch);
 
     static karray1d calculate_spatial_mean_stddev(Bunch const& bunch);
+    static karray1d calculate_spatial_mean_stddev(BunchF const& bunch);
 
     static std::vector<double> kokkos_view_to_stl_vector(karray1d const& view);
     static std::vector<double> kokkos_view_to_stl_vector(
@@ -1,6 +1,7 @@
 #ifndef DIAGNOSTICS_H_
 #define DIAGNOSTICS_H_
 
+#include <memory>
 #include <string>
 
 #include <cereal/archives/json.hpp>
@@ -32,6 +33,30 @@ class Diagnostics {
     virtual void do_write(io_device&, const size_t) = 0;
     virtual void do_first_write(io_device&) = 0;
 
+    // buffered diagnostics accumulate the data over multiple updates and
+    // only write out when do_flush_due() says so
+    virtual bool
+    do_buffered() const
+    {
+        return false;
+    }
+
+    virtual bool
+    do_flush_due(Bunch const&, bool)
+    {
+        return true;
+    }
+
+    // a copy of the diagnostics holding the data of the last update,
+    // which can be written while the original is updated again. The
+    // default nullptr means the diagnostics can only be written in
+    // place
+    virtual std::shared_ptr<Diagnostics>
+    do_snapshot() const
+    {
+        return nullptr;
+    }
+
   public:
     Diagnostics(std::string const& type = "Diagnostics",
                 std::string const& filename = "diag.h5",
@@ -80,6 +105,32 @@ class Diagnostics {
         return single_file_;
     }
 
+    bool
+    buffered() const
+    {
+        return do_buffered();
+    }
+
+    // snapshot of the updated diagnostics for the background writes,
+    // nullptr if not supported. The header of the file is written by
+    // the snapshot, so the diagnostics itself is marked as written
+    std::shared_ptr<Diagnostics>
+    snapshot()
+    {
+        auto s = do_snapshot();
+        if (s) first_write = false;
+        return s;
+    }
+
+    // collective call over the bunch communicator. returns true when the
+    // buffered data should be written. force asks for a write whenever
+    // there is anything in the buffer
+    bool
+    flush_due(Bunch const& bunch, bool force = false)
+    {
+        return do_flush_due(bunch, force);
+    }
+
     template <class Archive>
     void
     serialize(Archive& ar)
@@ -2,23 +2,114 @@
 #include "synergia/bunch/bunch.h"
 #include "synergia/utils/parallel_utils.h"
 #include "synergia/utils/simple_timer.h"
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 
+namespace {
+    // copies the tracked particles into the slot of the buffer
+    struct alg_buffer_coords {
+        karray3d_row_dev buf;
+        ConstParticles parts;
+        int slot;
+        int offset;
+
+        KOKKOS_INLINE_FUNCTION
+        void
+        operator()(const int i) const
+        {
+            for (int j = 0; j < 7; ++j)
+                buf(slot, i, j) = parts(offset + i, j);
+        }
+    };
+
+    template <class V>
+    V
+    head(V const& v, int n, const char* label)
+    {
+        V h(label, n);
+        Kokkos::deep_copy(h, Kokkos::subview(v, std::make_pair(0, n)));
+        return h;
+    }
+}
+
 Diagnostics_bulk_track::Diagnostics_bulk_track(std::string const& filename,
                                                int num_tracks,
                                                int offset,
-                                               ParticleGroup pg)
+                                               ParticleGroup pg,
+                                               int flush_turns,
+                                               int deflate)
     : Diagnostics("diagnostis_bulk_track", filename, true)
     , total_num_tracks(num_tracks)
     , local_num_tracks(0)
     , offset(offset)
     , local_offset(0)
     , setup(false)
+    , layout(false)
     , track_coords("local_coords", 0, 0)
+    , flush_turns(flush_turns)
+    , deflate(deflate)
+    , turns_since_flush(0)
+    , num_buffered(0)
+    , buf_coords("bulk_track_buf_coords", 0, 0, 7)
+    , buf_pz("bulk_track_buf_pz", 0)
+    , buf_s("bulk_track_buf_s", 0)
+    , buf_s_n("bulk_track_buf_s_n", 0)
+    , buf_repetition("bulk_track_buf_repetition", 0)
+    , buf_abs_time("bulk_track_buf_abs_time", 0)
+    , flushed_coords("bulk_track_coords", 0, 0, 7)
+    , flushed_pz()
+    , flushed_s()
+    , flushed_s_n()
+    , flushed_repetition()
+    , flushed_abs_time()
     , pg(pg)
 {}
 
+void
+Diagnostics_bulk_track::setup_layout(Bunch const& bunch)
+{
+    // the tracks are a fixed range of the local particles, so the
+    // layout across the ranks never changes after the setup
+#ifdef SYNERGIA_HAVE_OPENPMD
+    auto const& comm = bunch.get_comm();
+    track_parts_local_num = local_num_tracks;
+
+    if (MPI_Allreduce(&track_parts_local_num,
+                      &track_parts_total_num,
+                      1,
+                      MPI_SIZE_T,
+                      MPI_SUM,
+                      comm) != MPI_SUCCESS) {
+        throw std::runtime_error(
+            "Error in MPI_Allreduce in diagnostics-bulk-track!");
+    }
+
+    if (MPI_Scan(&track_parts_local_num,
+                 &track_parts_offset_num,
+                 1,
+                 MPI_SIZE_T,
+                 MPI_SUM,
+                 comm) != MPI_SUCCESS) {
+        throw std::runtime_error("Error in MPI_Scan in diagnostics-bulk-track!");
+    }
+#endif
+
+    if (do_buffered()) {
+        // one slot per turn, grows if updated more than once per turn
+        int cap = flush_turns;
+        Kokkos::resize(buf_coords, cap, local_num_tracks, 7);
+        Kokkos::resize(buf_pz, cap);
+        Kokkos::resize(buf_s, cap);
+        Kokkos::resize(buf_s_n, cap);
+        Kokkos::resize(buf_repetition, cap);
+        Kokkos::resize(buf_abs_time, cap);
+    }
+
+    layout = true;
+}
+
 void
 Diagnostics_bulk_track::do_update(Bunch const& bunch)
 {
@@ -31,7 +122,6 @@ Diagnostics_bulk_track::do_update(Bunch const& bunch)
         ref_mass = ref.get_four_momentum().get_mass();
         ref_pz = ref.get_four_momentum().get_momentum();
 
-
         auto const& comm = bunch.get_comm();
 
         local_num_tracks = decompose_1d_local(comm, total_num_tracks);
@@ -43,6 +133,15 @@ Diagnostics_bulk_track::do_update(Bunch const& bunch)
         setup = true;
     }
 
+    // the track ranges are restored from a checkpoint, the layout
+    // across the ranks and the buffers are not
+    if (!layout) setup_layout(bunch);
+
+    if (do_buffered()) {
+        buffer_coords(bunch);
+        return;
+    }
+
     pz = ref.get_momentum();
     s = ref.get_s();
     s_n = ref.get_s_n();
@@ -50,32 +149,79 @@ Diagnostics_bulk_track::do_update(Bunch const& bunch)
     bunch_abs_offset = ref.get_bunch_abs_offset();
     bunch_abs_time = ref.get_bunch_abs_time();
 
-
     track_coords =
         bunch.get_particles_in_range_row(local_offset, local_num_tracks, pg);
+}
 
-#ifdef SYNERGIA_HAVE_OPENPMD
-    track_parts_local_num = track_coords.extent(0);
-
-    if (MPI_Allreduce(&track_parts_local_num,
-                      &track_parts_total_num,
-                      1,
-                      MPI_SIZE_T,
-                      MPI_SUM,
-                      bunch.get_comm()) != MPI_SUCCESS) {
-        std::runtime_error("Error in MPI_Allreduce in diagnostics-bulk-track!");
+void
+Diagnostics_bulk_track::buffer_coords(Bunch const& bunch)
+{
+    // local operation only, no communications and no host copies
+    int cap = buf_coords.extent(0);
+    if (num_buffered == cap) {
+        cap = std::max(2 * cap, 1);
+        Kokkos::resize(buf_coords, cap, local_num_tracks, 7);
+        Kokkos::resize(buf_pz, cap);
+        Kokkos::resize(buf_s, cap);
+        Kokkos::resize(buf_s_n, cap);
+        Kokkos::resize(buf_repetition, cap);
+        Kokkos::resize(buf_abs_time, cap);
     }
 
-    if (MPI_Scan(&track_parts_local_num,
-                 &track_parts_offset_num,
-                 1,
-                 MPI_SIZE_T,
-                 MPI_SUM,
-                 bunch.get_comm()) != MPI_SUCCESS) {
-        std::runtime_error("Error in MPI_Scan in diagnostics-bulk-track!");
-    }
+    alg_buffer_coords alg{buf_coords,
+                          bunch.get_local_particles(pg),
+                          num_buffered,
+                          local_offset};
 
-#endif
+    Kokkos::parallel_for("bulk_track_buffer", local_num_tracks, alg);
+
+    auto const& ref = bunch.get_reference_particle();
+
+    buf_pz(num_buffered) = ref.get_momentum();
+    buf_s(num_buffered) = ref.get_s();
+    buf_s_n(num_buffered) = ref.get_s_n();
+    buf_repetition(num_buffered) = ref.get_repetition();
+    buf_abs_time(num_buffered) = ref.get_bunch_abs_time();
+    bunch_abs_offset = ref.get_bunch_abs_offset();
+
+    ++num_buffered;
+}
+
+bool
+Diagnostics_bulk_track::do_flush_due(Bunch const& bunch, bool force)
+{
+    // called once at the end of every turn (force = false), or at the
+    // checkpoint and the end of propagation (force = true). Every rank
+    // has buffered the same number of updates, so the decision needs
+    // no communication
+    if (!force) ++turns_since_flush;
+
+    bool due = force || turns_since_flush >= flush_turns;
+    if (!due) return false;
+
+    turns_since_flush = 0;
+    if (num_buffered == 0) return false;
+
+    // the only device to host copy of the buffered mode. The flushed
+    // arrays are new for every flush so they can be shared with the
+    // snapshot written in the background
+    auto range = std::make_pair(0, num_buffered);
+
+    flushed_coords = karray3d_row(
+        "bulk_track_coords", num_buffered, local_num_tracks, 7);
+    Kokkos::deep_copy(
+        flushed_coords,
+        Kokkos::subview(buf_coords, range, Kokkos::ALL, Kokkos::ALL));
+
+    flushed_pz = head(buf_pz, num_buffered, "bulk_track_pz");
+    flushed_s = head(buf_s, num_buffered, "bulk_track_s");
+    flushed_s_n = head(buf_s_n, num_buffered, "bulk_track_s_n");
+    flushed_repetition =
+        head(buf_repetition, num_buffered, "bulk_track_repetition");
+    flushed_abs_time = head(buf_abs_time, num_buffered, "bulk_track_abs_time");
+
+    num_buffered = 0;
+    return true;
 }
 
 void
@@ -99,6 +245,11 @@ Diagnostics_bulk_track::do_write(io_device& file, const size_t iteration)
 {
     scoped_simple_timer("diag_bulk_track_write");
 
+    if (do_buffered()) {
+        write_buffer(file, iteration);
+        return;
+    }
+
 #ifdef SYNERGIA_HAVE_OPENPMD
     auto i = file.iterations[iteration];
     i.setAttribute("track_pz", pz);
@@ -163,3 +314,105 @@ Diagnostics_bulk_track::do_write(io_device& file, const size_t iteration)
     file.append_collective("track_coords", track_coords);
 #endif
 }
+
+void
+Diagnostics_bulk_track::write_buffer(io_device& file, size_t iteration)
+{
+    int n = flushed_coords.extent(0);
+
+#ifdef SYNERGIA_HAVE_OPENPMD
+    // one iteration per flush, with [n x total_tracks] records. The
+    // components are copied out so each of them is contiguous
+    karray3d_row comps("bulk_track_comps", 7, n, local_num_tracks);
+
+    for (int t = 0; t < n; ++t)
+        for (int p = 0; p < local_num_tracks; ++p)
+            for (int j = 0; j < 7; ++j)
+                comps(j, t, p) = flushed_coords(t, p, j);
+
+    std::vector<double> v_pz(n), v_s(n), v_s_n(n), v_abs_time(n);
+    std::vector<int> v_repetition(n);
+
+    for (int t = 0; t < n; ++t) {
+        v_pz[t] = flushed_pz(t);
+        v_s[t] = flushed_s(t);
+        v_s_n[t] = flushed_s_n(t);
+        v_repetition[t] = flushed_repetition(t);
+        v_abs_time[t] = flushed_abs_time(t);
+    }
+
+    auto i = file.iterations[iteration];
+    i.setAttribute("track_pz", v_pz);
+    i.setAttribute("track_s", v_s);
+    i.setAttribute("track_s_n", v_s_n);
+    i.setAttribute("track_repitition", v_repetition);
+    i.setAttribute("bunch_abs_time", v_abs_time);
+
+    openPMD::ParticleSpecies& protons =
+        file.iterations[iteration].particles["track_coords"];
+
+    openPMD::Datatype datatype = openPMD::determineDatatype<double>();
+    openPMD::Extent global_extent = {(size_t)n, track_parts_total_num};
+    openPMD::Dataset dataset = openPMD::Dataset(datatype, global_extent);
+
+    // whole flush in a chunk
+    dataset.options = "{\"hdf5\": {\"dataset\": {\"chunks\": [" +
+                      std::to_string(n) + ", " +
+                      std::to_string(track_parts_total_num) + "]}}}";
+
+    protons["position"]["x"].resetDataset(dataset);
+    protons["position"]["y"].resetDataset(dataset);
+    protons["position"]["z"].resetDataset(dataset);
+
+    protons["moments"]["x"].resetDataset(dataset);
+    protons["moments"]["y"].resetDataset(dataset);
+    protons["moments"]["z"].resetDataset(dataset);
+
+    file.flush();
+
+    openPMD::Offset chunk_offset = {
+        0, track_parts_offset_num - track_parts_local_num};
+    openPMD::Extent chunk_extent = {(size_t)n, track_parts_local_num};
+
+    auto comp = [&comps](int j) {
+        return Kokkos::subview(comps, j, Kokkos::ALL, Kokkos::ALL).data();
+    };
+
+    protons["position"]["x"].storeChunkRaw(
+        comp(Bunch::x), chunk_offset, chunk_extent);
+    protons["position"]["y"].storeChunkRaw(
+        comp(Bunch::y), chunk_offset, chunk_extent);
+    protons["position"]["z"].storeChunkRaw(
+        comp(Bunch::cdt), chunk_offset, chunk_extent);
+    protons["moments"]["x"].storeChunkRaw(
+        comp(Bunch::xp), chunk_offset, chunk_extent);
+    protons["moments"]["y"].storeChunkRaw(
+        comp(Bunch::yp), chunk_offset, chunk_extent);
+    protons["moments"]["z"].storeChunkRaw(
+        comp(Bunch::dpop), chunk_offset, chunk_extent);
+
+    file.flush();
+
+#else
+    // same datasets as the unbuffered mode, n slabs at a time
+    file.append_slabs("track_pz", flushed_pz, false, flush_turns, deflate);
+    file.append_slabs("track_s", flushed_s, false, flush_turns, deflate);
+    file.append_slabs("track_s_n", flushed_s_n, false, flush_turns, deflate);
+    file.append_slabs(
+        "track_repetition", flushed_repetition, false, flush_turns, deflate);
+    file.append_slabs(
+        "bunch_abs_time", flushed_abs_time, false, flush_turns, deflate);
+
+    file.append_slabs(
+        "track_coords", flushed_coords, true, flush_turns, deflate);
+#endif
+}
+
+std::shared_ptr<Diagnostics>
+Diagnostics_bulk_track::do_snapshot() const
+{
+    // track_coords is a new host array from every update, and so are the
+    // flushed arrays from every flush, so they can be shared with the
+    // snapshot. The device buffer is never read by the writes
+    return std::make_shared<Diagnostics_bulk_track>(*this);
+}
@@ -9,6 +9,14 @@
 /// Particles will only be tracked if they stay on the same processor.
 /// Lost particles that are somehow restored or particles not available when
 /// the first update is called will also not be tracked.
+///
+/// In the buffered mode (flush_turns > 0) the coordinates of every update
+/// are copied into a preallocated device buffer of
+/// [updates x local_tracks x 7], and the buffer is written out once every
+/// flush_turns turns as one multi-turn slab of the track_coords dataset.
+/// The file has the same layout as in the unbuffered mode. deflate > 0
+/// creates the HDF5 datasets chunked over flush_turns turns and compressed
+/// with the shuffle and deflate filters of the given level (1 to 9).
 class Diagnostics_bulk_track : public Diagnostics {
 
   private:
@@ -16,6 +24,9 @@ class Diagnostics_bulk_track : public Diagnostics {
     int offset, local_offset;
     bool setup;
 
+    // collectives and buffer allocation done once the tracks are set up
+    bool layout;
+
     // used between update and write
     double s_n;
     int repetition;
@@ -30,6 +41,28 @@ class Diagnostics_bulk_track : public Diagnostics {
 
     karray2d_row track_coords;
 
+    // buffered mode
+    int flush_turns;
+    int deflate;
+
+    int turns_since_flush;
+    int num_buffered;
+
+    karray3d_row_dev buf_coords;
+    karray1d_row buf_pz;
+    karray1d_row buf_s;
+    karray1d_row buf_s_n;
+    karray1i_row buf_repetition;
+    karray1d_row buf_abs_time;
+
+    // host copies of the flushed updates, [num_flushed x local_tracks x 7]
+    karray3d_row flushed_coords;
+    karray1d_row flushed_pz;
+    karray1d_row flushed_s;
+    karray1d_row flushed_s_n;
+    karray1i_row flushed_repetition;
+    karray1d_row flushed_abs_time;
+
 #ifdef SYNERGIA_HAVE_OPENPMD
     size_t track_parts_local_num;
     size_t track_parts_offset_num;
@@ -45,6 +78,20 @@ class Diagnostics_bulk_track : public Diagnostics {
     {}
     void do_first_write(io_device& file) override;
     void do_write(io_device& file, const size_t iteration) override;
+    std::shared_ptr<Diagnostics> do_snapshot() const override;
+
+    bool
+    do_buffered() const override
+    {
+        return flush_turns > 0;
+    }
+
+    bool do_flush_due(Bunch const& bunch, bool force) override;
+
+    // openPMD chunk layout and the buffers of the tracks
+    void setup_layout(Bunch const& bunch);
+    void buffer_coords(Bunch const& bunch);
+    void write_buffer(io_device& file, size_t iteration);
 
     friend class cereal::access;
 
@@ -58,6 +105,11 @@ class Diagnostics_bulk_track : public Diagnostics {
         ar(offset);
         ar(local_offset);
         ar(setup);
+
+        // buffer is always drained before the checkpoint
+        ar(flush_turns);
+        ar(deflate);
+        ar(turns_since_flush);
     }
 
   public:
@@ -66,10 +118,22 @@ class Diagnostics_bulk_track : public Diagnostics {
     ///        a numerical index inserted
     /// @param num_tracks the number of local particles to track
     /// @param offset id offset for first particle to track
+    /// @param flush_turns write out the buffered updates every flush_turns
+    ///        turns, 0 to write every update
+    /// @param deflate compression level of the buffered datasets, 0 for
+    ///        no compression
     Diagnostics_bulk_track(std::string const& filename = "diag_bulk_track.h5",
                            int num_tracks = 0,
                            int offset = 0,
-                           ParticleGroup pg = ParticleGroup::regular);
+                           ParticleGroup pg = ParticleGroup::regular,
+                           int flush_turns = 0,
+                           int deflate = 0);
+
+    int
+    get_num_buffered() const
+    {
+        return num_buffered;
+    }
 };
 
 CEREAL_REGISTER_TYPE(Diagnostics_bulk_track)
@@ -108,3 +108,27 @@ Diagnostics_full2::do_write(io_device& file, size_t iteration)
 #endif
     return;
 }
+
+std::shared_ptr<Diagnostics>
+Diagnostics_full2::do_snapshot() const
+{
+    auto s = std::make_shared<Diagnostics_full2>(*this);
+
+    // std and corr are filled in place by do_update(), all the moments
+    // are copied so the snapshot never shares data with the next update
+    s->mean = karray1d("mean", 6);
+    s->std = karray1d("std", 6);
+    s->min = karray1d("min", 3);
+    s->max = karray1d("max", 3);
+    s->mom2 = karray2d_row("mom2", 6, 6);
+    s->corr = karray2d_row("corr", 6, 6);
+
+    Kokkos::deep_copy(s->mean, mean);
+    Kokkos::deep_copy(s->std, std);
+    Kokkos::deep_copy(s->min, min);
+    Kokkos::deep_copy(s->max, max);
+    Kokkos::deep_copy(s->mom2, mom2);
+    Kokkos::deep_copy(s->corr, corr);
+
+    return s;
+}
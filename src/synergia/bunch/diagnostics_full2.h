@@ -44,6 +44,7 @@ class Diagnostics_full2 : public Diagnostics {
     {}
     void do_first_write(io_device& file) override;
     void do_write(io_device& file, size_t iteration) override;
+    std::shared_ptr<Diagnostics> do_snapshot() const override;
 
     friend class cereal::access;
 
@@ -0,0 +1,368 @@
+#include "diagnostics_histograms.h"
+#include "synergia/bunch/bunch.h"
+#include "synergia/bunch/core_diagnostics.h"
+#include "synergia/utils/simple_timer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    // all the histograms in a single pass over the particles
+    template <class HISTS, class SCATTER>
+    struct alg_histograms {
+        ConstParticles parts;
+        ConstParticleMasks masks;
+        HISTS hists;
+        int nhists;
+        SCATTER scatter;
+
+        KOKKOS_INLINE_FUNCTION
+        void
+        operator()(const int i) const
+        {
+            if (!masks(i)) return;
+
+            auto access = scatter.access();
+
+            for (int h = 0; h < nhists; ++h) {
+                auto const& d = hists(h);
+
+                double f0 = floor((parts(i, d.c0) - d.lo0) * d.ih0);
+                double f1 =
+                    d.c1 < 0 ? 0.0 : floor((parts(i, d.c1) - d.lo1) * d.ih1);
+
+                bool in = f0 >= 0 && f0 < d.n0 && f1 >= 0 && f1 < d.n1;
+
+                if (in) {
+                    access(d.off + (int)f0 * d.n1 + (int)f1) += 1.0;
+                } else {
+                    access(d.outside) += 1.0;
+                }
+            }
+        }
+    };
+
+    using hview1d_t = Kokkos::View<double*,
+                                   Kokkos::LayoutRight,
+                                   Kokkos::HostSpace,
+                                   Kokkos::MemoryUnmanaged>;
+
+    using hview2d_t = Kokkos::View<double**,
+                                   Kokkos::LayoutRight,
+                                   Kokkos::HostSpace,
+                                   Kokkos::MemoryUnmanaged>;
+}
+
+Diagnostics_histograms::Diagnostics_histograms(std::string const& filename,
+                                               int num_bins,
+                                               double num_sigmas)
+    : Diagnostics("diagnostics_histograms", filename, true)
+    , projections()
+    , num_bins(num_bins)
+    , num_sigmas(num_sigmas)
+    , ranges_set(false)
+    , repetition(0)
+    , s(0.0)
+    , s_n(0.0)
+    , num_particles(0)
+    , counts("histogram_counts", 0)
+    , hists()
+    , dcounts()
+    , scatter()
+{
+    add_histogram_2d("x_xp", Bunch::x, num_bins, Bunch::xp, num_bins);
+    add_histogram_2d("y_yp", Bunch::y, num_bins, Bunch::yp, num_bins);
+    add_histogram_2d("z_dpop", Bunch::cdt, num_bins, Bunch::dpop, num_bins);
+    add_histogram_2d("x_y", Bunch::x, num_bins, Bunch::y, num_bins);
+}
+
+void
+Diagnostics_histograms::clear_histograms()
+{
+    if (ranges_set) {
+        throw std::runtime_error(
+            "Diagnostics_histograms: histograms changed after the first "
+            "update");
+    }
+
+    projections.clear();
+}
+
+void
+Diagnostics_histograms::add_histogram_1d(std::string const& name,
+                                         int coord,
+                                         int bins,
+                                         double lo,
+                                         double hi)
+{
+    add_histogram_2d(name, coord, bins, -1, 1, lo, hi);
+}
+
+void
+Diagnostics_histograms::add_histogram_2d(std::string const& name,
+                                         int coord0,
+                                         int bins0,
+                                         int coord1,
+                                         int bins1,
+                                         double lo0,
+                                         double hi0,
+                                         double lo1,
+                                         double hi1)
+{
+    if (ranges_set) {
+        throw std::runtime_error(
+            "Diagnostics_histograms: histograms changed after the first "
+            "update");
+    }
+
+    if (coord0 < 0 || coord0 > 5 || coord1 > 5) {
+        throw std::runtime_error(
+            "Diagnostics_histograms: invalid coordinate in histogram " + name);
+    }
+
+    if (bins0 < 1 || bins1 < 1) {
+        throw std::runtime_error(
+            "Diagnostics_histograms: invalid number of bins in histogram " +
+            name);
+    }
+
+    for (auto const& p : projections) {
+        if (p.name == name) {
+            throw std::runtime_error(
+                "Diagnostics_histograms: duplicate histogram " + name);
+        }
+    }
+
+    projection_t p;
+    p.name = name;
+    p.coords = {coord0, coord1};
+    p.bins = {bins0, coord1 < 0 ? 1 : bins1};
+    p.lo = {lo0, lo1};
+    p.hi = {hi0, hi1};
+
+    projections.push_back(p);
+}
+
+int
+Diagnostics_histograms::offset_of(int p) const
+{
+    int off = 0;
+    for (int i = 0; i < p; ++i)
+        off += projections[i].size();
+    return off;
+}
+
+int
+Diagnostics_histograms::total_size() const
+{
+    return offset_of(projections.size()) + projections.size();
+}
+
+void
+Diagnostics_histograms::set_ranges(Bunch const& bunch)
+{
+    // collectives, only once
+    auto mean = Core_diagnostics::calculate_mean(bunch);
+    auto stddev = Core_diagnostics::calculate_std(bunch, mean);
+
+    for (auto& p : projections) {
+        for (int d = 0; d < 2; ++d) {
+            int c = p.coords[d];
+            if (c < 0 || p.hi[d] > p.lo[d]) continue;
+
+            // a unit range for the coordinates without spread
+            double w = num_sigmas * stddev(c);
+            if (!(w > 0)) w = 0.5;
+
+            p.lo[d] = mean(c) - w;
+            p.hi[d] = mean(c) + w;
+        }
+    }
+
+    ranges_set = true;
+}
+
+void
+Diagnostics_histograms::build_histograms()
+{
+    int nhists = projections.size();
+
+    hists = Kokkos::View<hist_t*>("hists", nhists);
+    auto hhists = Kokkos::create_mirror_view(hists);
+
+    int off = 0;
+    for (int h = 0; h < nhists; ++h) {
+        auto const& p = projections[h];
+
+        hhists(h).c0 = p.coords[0];
+        hhists(h).c1 = p.coords[1];
+        hhists(h).n0 = p.bins[0];
+        hhists(h).n1 = p.bins[1];
+        hhists(h).off = off;
+        hhists(h).outside = offset_of(nhists) + h;
+        hhists(h).lo0 = p.lo[0];
+        hhists(h).lo1 = p.lo[1];
+        hhists(h).ih0 = p.bins[0] / (p.hi[0] - p.lo[0]);
+        hhists(h).ih1 =
+            p.coords[1] < 0 ? 0.0 : p.bins[1] / (p.hi[1] - p.lo[1]);
+
+        off += p.size();
+    }
+
+    Kokkos::deep_copy(hists, hhists);
+
+    dcounts = karray1d_row_dev("histogram_counts", total_size());
+    scatter = scatter_t(dcounts);
+}
+
+void
+Diagnostics_histograms::do_update(Bunch const& bunch)
+{
+    scoped_simple_timer timer("diag_histograms_update");
+
+    if (!ranges_set) {
+        set_ranges(bunch);
+        build_histograms();
+    }
+
+    Kokkos::deep_copy(dcounts, 0.0);
+    scatter.reset_except(dcounts);
+
+    alg_histograms<Kokkos::View<hist_t*>, scatter_t> alg{
+        bunch.get_local_particles(),
+        bunch.get_local_particle_masks(),
+        hists,
+        (int)projections.size(),
+        scatter};
+
+    Kokkos::parallel_for("diag_histograms", bunch.size(), alg);
+    Kokkos::Experimental::contribute(dcounts, scatter);
+
+    // a new host array for every update, so it can be shared with
+    // the snapshot written in the background
+    counts = karray1d_row("histogram_counts", total_size());
+    Kokkos::deep_copy(counts, dcounts);
+
+    // the only communication of the update
+    int error = MPI_Allreduce(MPI_IN_PLACE,
+                              counts.data(),
+                              counts.extent(0),
+                              MPI_DOUBLE,
+                              MPI_SUM,
+                              bunch.get_comm());
+
+    if (error != MPI_SUCCESS) {
+        throw std::runtime_error(
+            "Error in MPI_Allreduce in diagnostics-histograms!");
+    }
+
+    auto const& ref = bunch.get_reference_particle();
+    repetition = ref.get_repetition();
+    s = ref.get_s();
+    s_n = ref.get_s_n();
+    num_particles = bunch.get_total_num();
+}
+
+karray1d_row
+Diagnostics_histograms::get_histogram(std::string const& name) const
+{
+    for (int p = 0; p < (int)projections.size(); ++p) {
+        if (projections[p].name != name) continue;
+
+        if (!counts.extent(0)) break;
+
+        int off = offset_of(p);
+        auto range = std::make_pair(off, off + projections[p].size());
+
+        karray1d_row h(name, projections[p].size());
+        Kokkos::deep_copy(h, Kokkos::subview(counts, range));
+        return h;
+    }
+
+    throw std::runtime_error(
+        "Diagnostics_histograms: no histogram " + name + " available");
+}
+
+double
+Diagnostics_histograms::get_outside(std::string const& name) const
+{
+    for (int p = 0; p < (int)projections.size(); ++p) {
+        if (projections[p].name != name) continue;
+        if (!counts.extent(0)) break;
+
+        return counts(offset_of(projections.size()) + p);
+    }
+
+    throw std::runtime_error(
+        "Diagnostics_histograms: no histogram " + name + " available");
+}
+
+void
+Diagnostics_histograms::do_first_write(io_device& file)
+{
+    // ranges of the histograms, as (lo0, hi0, lo1, hi1)
+    for (auto const& p : projections) {
+        std::vector<double> range = {p.lo[0], p.hi[0], p.lo[1], p.hi[1]};
+
+#ifdef SYNERGIA_HAVE_OPENPMD
+        file.setAttribute(p.name + "_range", range);
+#else
+        karray1d_row r("range", 4);
+        std::copy(range.begin(), range.end(), r.data());
+        file.write(p.name + "_range", r);
+#endif
+    }
+}
+
+void
+Diagnostics_histograms::do_write(io_device& file, size_t iteration)
+{
+    scoped_simple_timer timer("diag_histograms_write");
+
+    int nhists = projections.size();
+    int outside = offset_of(nhists);
+
+#ifdef SYNERGIA_HAVE_OPENPMD
+    auto i = file.iterations[iteration];
+    i.setAttribute("repetition", repetition);
+    i.setAttribute("s", s);
+    i.setAttribute("s_n", s_n);
+    i.setAttribute("num_particles", num_particles);
+
+    for (int h = 0; h < nhists; ++h) {
+        auto const& p = projections[h];
+        double const* begin = counts.data() + offset_of(h);
+
+        i.setAttribute(p.name, std::vector<double>(begin, begin + p.size()));
+        i.setAttribute(p.name + "_outside", counts(outside + h));
+    }
+#else
+    file.append("repetition", repetition);
+    file.append("s", s);
+    file.append("s_n", s_n);
+    file.append("num_particles", num_particles);
+
+    // [updates x bins0 (x bins1)]
+    for (int h = 0; h < nhists; ++h) {
+        auto const& p = projections[h];
+        double* begin = counts.data() + offset_of(h);
+
+        if (p.coords[1] < 0) {
+            file.append(p.name, hview1d_t(begin, p.bins[0]));
+        } else {
+            file.append(p.name, hview2d_t(begin, p.bins[0], p.bins[1]));
+        }
+
+        file.append(p.name + "_outside", counts(outside + h));
+    }
+#endif
+}
+
+std::shared_ptr<Diagnostics>
+Diagnostics_histograms::do_snapshot() const
+{
+    // counts is a new host array from every update
+    return std::make_shared<Diagnostics_histograms>(*this);
+}
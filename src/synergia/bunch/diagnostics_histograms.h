@@ -0,0 +1,171 @@
+#ifndef DIAGNOSTICS_HISTOGRAMS_H_
+#define DIAGNOSTICS_HISTOGRAMS_H_
+
+#include <array>
+
+#include <Kokkos_ScatterView.hpp>
+
+#include <cereal/types/array.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include "synergia/bunch/diagnostics.h"
+#include "synergia/utils/kokkos_views.h"
+
+/// Diagnostics_histograms bins 1d and 2d projections of the phase space
+/// of the bunch on a fixed grid, e.g., for the halo and tail monitoring
+/// of large bunches without dumping the particles.
+///
+/// The histograms are filled on the device with a scatter view, in a
+/// single pass over the particles for all the projections, and merged
+/// across the ranks with one reduction. The counts are the numbers of
+/// macroparticles in the bins, the particles outside of the range of a
+/// projection are counted separately.
+///
+/// The diagnostics is created with the (x, xp), (y, yp), (cdt, dpop) and
+/// (x, y) projections. A projection with an empty range (lo >= hi) has
+/// its range set at the first update to mean +/- num_sigmas std of the
+/// bunch. The ranges are then fixed, so the histograms of all updates
+/// can be compared.
+class Diagnostics_histograms : public Diagnostics {
+  public:
+    // a 1d (coords[1] < 0) or 2d projection
+    struct projection_t {
+        std::string name;
+        std::array<int, 2> coords;
+        std::array<int, 2> bins;
+        std::array<double, 2> lo;
+        std::array<double, 2> hi;
+
+        int
+        size() const
+        {
+            return bins[0] * (coords[1] < 0 ? 1 : bins[1]);
+        }
+
+        template <class AR>
+        void
+        serialize(AR& ar)
+        {
+            ar(CEREAL_NVP(name));
+            ar(CEREAL_NVP(coords));
+            ar(CEREAL_NVP(bins));
+            ar(CEREAL_NVP(lo));
+            ar(CEREAL_NVP(hi));
+        }
+    };
+
+  private:
+    // projection in the kernel, n1 = 1 for the 1d histograms
+    struct hist_t {
+        int c0, c1;
+        int n0, n1;
+        int off, outside;
+        double lo0, lo1;
+        double ih0, ih1;
+    };
+
+    using scatter_t =
+        Kokkos::Experimental::ScatterView<double*, Kokkos::LayoutRight>;
+
+  private:
+    std::vector<projection_t> projections;
+
+    int num_bins;
+    double num_sigmas;
+    bool ranges_set;
+
+    int repetition;
+    double s;
+    double s_n;
+    int num_particles;
+
+    // bins of all the projections followed by one outside count per
+    // projection. a new host array from every update
+    karray1d_row counts;
+
+    // projections and device counts of the kernel, built once the
+    // ranges are set and reused by all the updates
+    Kokkos::View<hist_t*> hists;
+    karray1d_row_dev dcounts;
+    scatter_t scatter;
+
+  private:
+    void do_update(Bunch const& bunch) override;
+    void
+    do_reduce(Commxx const& comm, int root) override
+    {}
+    void do_first_write(io_device& file) override;
+    void do_write(io_device& file, size_t iteration) override;
+    std::shared_ptr<Diagnostics> do_snapshot() const override;
+
+    void set_ranges(Bunch const& bunch);
+    void build_histograms();
+    int offset_of(int p) const;
+    int total_size() const;
+
+    friend class cereal::access;
+
+    template <class AR>
+    void
+    serialize(AR& ar)
+    {
+        ar(cereal::base_class<Diagnostics>(this));
+        ar(CEREAL_NVP(projections));
+        ar(CEREAL_NVP(num_bins));
+        ar(CEREAL_NVP(num_sigmas));
+        ar(CEREAL_NVP(ranges_set));
+
+        // the kernel views are not persistent
+        if (AR::is_loading::value && ranges_set) build_histograms();
+    }
+
+  public:
+    /// Create a Diagnostics_histograms object with the default projections
+    /// @param filename the file to write to
+    /// @param num_bins number of bins per dimension of the default
+    ///        projections
+    /// @param num_sigmas half width of the automatic ranges in units of
+    ///        the rms size of the bunch
+    Diagnostics_histograms(std::string const& filename = "diag_histograms.h5",
+                           int num_bins = 64,
+                           double num_sigmas = 6.0);
+
+    /// Remove all the projections
+    void clear_histograms();
+
+    /// Add a 1d histogram of the coordinate coord (Bunch::x, ...)
+    void add_histogram_1d(std::string const& name,
+                          int coord,
+                          int bins,
+                          double lo = 0.0,
+                          double hi = 0.0);
+
+    /// Add a 2d histogram of the coordinates coord0 and coord1
+    void add_histogram_2d(std::string const& name,
+                          int coord0,
+                          int bins0,
+                          int coord1,
+                          int bins1,
+                          double lo0 = 0.0,
+                          double hi0 = 0.0,
+                          double lo1 = 0.0,
+                          double hi1 = 0.0);
+
+    std::vector<projection_t> const&
+    get_projections() const
+    {
+        return projections;
+    }
+
+    /// Counts of the named histogram from the last update, of size
+    /// bins0 * bins1 with the coord1 index running fastest
+    karray1d_row get_histogram(std::string const& name) const;
+
+    /// Number of particles outside the range of the named histogram
+    double get_outside(std::string const& name) const;
+};
+
+CEREAL_REGISTER_TYPE(Diagnostics_histograms)
+
+#endif /* DIAGNOSTICS_HISTOGRAMS_H_ */
@@ -1,6 +1,8 @@
 #include "synergia/bunch/diagnostics_loss.h"
 #include "synergia/bunch/bunch.h"
 #include "synergia/utils/simple_timer.h"
+
+#include <algorithm>
 #include <stdexcept>
 
 void
@@ -8,6 +10,11 @@ Diagnostics_loss::do_update(Bunch const& bunch)
 {
     scoped_simple_timer timer("diag_loss_update");
 
+    if (do_buffered()) {
+        buffer_discards(bunch);
+        return;
+    }
+
     auto ref = bunch.get_reference_particle();
     repetition = ref.get_repetition();
     s_ref_particle = ref.get_s();
@@ -39,6 +46,159 @@ Diagnostics_loss::do_update(Bunch const& bunch)
 #endif
 }
 
+void
+Diagnostics_loss::buffer_discards(Bunch const& bunch)
+{
+    // local operation only, no communications
+    auto const& bp = bunch.get_bunch_particles();
+    int ndiscarded = bp.num_last_discarded();
+    if (ndiscarded == 0) return;
+
+    // grow the arena geometrically. Kokkos::resize preserves the contents
+    int cap = buf_parts.extent(0);
+    if (num_buffered + ndiscarded > cap) {
+        cap = std::max(2 * cap, num_buffered + ndiscarded);
+        Kokkos::resize(buf_parts, cap, 7);
+        Kokkos::resize(buf_info, cap, info_size);
+    }
+
+    bp.append_particles_last_discarded(buf_parts, num_buffered);
+
+    // local index of the element name
+    auto const& name = bunch.get_last_discard_location();
+    auto it = std::find(element_names.begin(), element_names.end(), name);
+    int ele = it - element_names.begin();
+    if (it == element_names.end()) element_names.push_back(name);
+
+    auto const& ref = bunch.get_reference_particle();
+    for (int i = num_buffered; i < num_buffered + ndiscarded; ++i) {
+        buf_info(i, info_s) = ref.get_s();
+        buf_info(i, info_repetition) = ref.get_repetition();
+        buf_info(i, info_bucket) = bunch.get_bucket_index();
+        buf_info(i, info_element) = ele;
+    }
+
+    num_buffered += ndiscarded;
+}
+
+bool
+Diagnostics_loss::do_flush_due(Bunch const& bunch, bool force)
+{
+    // called once at the end of every turn (force = false), or
+    // at the checkpoint and the end of propagation (force = true)
+    if (!force) ++turns_since_flush;
+
+    bool due = force || (flush_turns > 0 && turns_since_flush >= flush_turns);
+
+    // decision made without any communication
+    if (!due && flush_size <= 0) return false;
+
+    size_t local_num = num_buffered;
+
+    if (MPI_Allreduce(&local_num,
+                      &discards_total_num,
+                      1,
+                      MPI_SIZE_T,
+                      MPI_SUM,
+                      bunch.get_comm()) != MPI_SUCCESS) {
+        throw std::runtime_error("Error in MPI_Allreduce in diagnostics-loss!");
+    }
+
+    if (!due) due = discards_total_num >= size_t(flush_size);
+    if (!due) return false;
+
+    // nothing to write
+    if (discards_total_num == 0) {
+        clear_buffer();
+        return false;
+    }
+
+#ifdef SYNERGIA_HAVE_OPENPMD
+    discards_local_num = local_num;
+
+    if (MPI_Scan(&discards_local_num,
+                 &discards_offset_num,
+                 1,
+                 MPI_SIZE_T,
+                 MPI_SUM,
+                 bunch.get_comm()) != MPI_SUCCESS) {
+        throw std::runtime_error("Error in MPI_Scan in diagnostics-loss!");
+    }
+#endif
+
+    auto const& ref = bunch.get_reference_particle();
+    repetition = ref.get_repetition();
+    s_ref_particle = ref.get_s();
+    sn_ref_particle = ref.get_s_n();
+    bucket_index = bunch.get_bucket_index();
+
+    unify_element_names(bunch.get_comm());
+
+    return true;
+}
+
+void
+Diagnostics_loss::unify_element_names(Commxx const& comm)
+{
+    // the name tables are built locally on each rank. gather them into
+    // a sorted global table and remap the local indices accordingly
+    std::string local;
+    for (auto const& name : element_names)
+        local.append(name).push_back('\0');
+
+    int mpi_size = comm.size();
+    int local_len = local.size();
+
+    std::vector<int> lens(mpi_size);
+    std::vector<int> displs(mpi_size, 0);
+
+    MPI_Allgather(&local_len, 1, MPI_INT, lens.data(), 1, MPI_INT, comm);
+
+    for (int r = 1; r < mpi_size; ++r)
+        displs[r] = displs[r - 1] + lens[r - 1];
+
+    std::string all(displs[mpi_size - 1] + lens[mpi_size - 1], '\0');
+
+    MPI_Allgatherv(local.data(),
+                   local_len,
+                   MPI_CHAR,
+                   all.data(),
+                   lens.data(),
+                   displs.data(),
+                   MPI_CHAR,
+                   comm);
+
+    std::vector<std::string> global;
+    for (size_t pos = 0; pos < all.size();) {
+        auto end = all.find('\0', pos);
+        global.emplace_back(all.substr(pos, end - pos));
+        pos = end + 1;
+    }
+
+    std::sort(global.begin(), global.end());
+    global.erase(std::unique(global.begin(), global.end()), global.end());
+
+    std::vector<int> remap(element_names.size());
+    for (size_t i = 0; i < element_names.size(); ++i) {
+        auto it =
+            std::lower_bound(global.begin(), global.end(), element_names[i]);
+        remap[i] = it - global.begin();
+    }
+
+    for (int i = 0; i < num_buffered; ++i)
+        buf_info(i, info_element) = remap[(int)buf_info(i, info_element)];
+
+    element_names = std::move(global);
+}
+
+void
+Diagnostics_loss::clear_buffer()
+{
+    num_buffered = 0;
+    turns_since_flush = 0;
+    element_names.clear();
+}
+
 void
 Diagnostics_loss::do_first_write(io_device& file)
 {
@@ -54,6 +214,12 @@ void
 Diagnostics_loss::do_write(io_device& file, size_t iteration)
 {
     scoped_simple_timer timer("diag_loss_write");
+
+    if (do_buffered()) {
+        write_buffer(file, iteration);
+        return;
+    }
+
 #ifdef SYNERGIA_HAVE_OPENPMD
     auto i = file.iterations[iteration];
     i.setAttribute("repetition", repetition);
@@ -114,3 +280,109 @@ Diagnostics_loss::do_write(io_device& file, size_t iteration)
 
     return;
 }
+
+void
+Diagnostics_loss::write_buffer(io_device& file, size_t iteration)
+{
+    auto range = std::make_pair(0, num_buffered);
+
+    // the only device to host copy of the buffered mode
+    karray2d_row hparts("loss_parts", num_buffered, 7);
+    Kokkos::deep_copy(hparts, Kokkos::subview(buf_parts, range, Kokkos::ALL));
+
+#ifdef SYNERGIA_HAVE_OPENPMD
+    // column major copies so every column is contiguous for the chunk store
+    karray2d parts("loss_parts_col", num_buffered, 7);
+    karray2d info("loss_info_col", num_buffered, info_size);
+
+    Kokkos::deep_copy(parts, hparts);
+    Kokkos::deep_copy(info, Kokkos::subview(buf_info, range, Kokkos::ALL));
+
+    auto i = file.iterations[iteration];
+    i.setAttribute("repetition", repetition);
+    i.setAttribute("s", s_ref_particle);
+    i.setAttribute("s_n", sn_ref_particle);
+    i.setAttribute("element_names", element_names);
+
+    openPMD::ParticleSpecies& protons =
+        file.iterations[iteration].particles["bunch_discards"];
+
+    openPMD::Datatype datatype = openPMD::determineDatatype<double>();
+    openPMD::Extent global_extent = {discards_total_num};
+    openPMD::Dataset dataset = openPMD::Dataset(datatype, global_extent);
+
+    auto const scalar = openPMD::RecordComponent::SCALAR;
+
+    protons["position"]["x"].resetDataset(dataset);
+    protons["position"]["y"].resetDataset(dataset);
+    protons["position"]["z"].resetDataset(dataset);
+
+    protons["moments"]["x"].resetDataset(dataset);
+    protons["moments"]["y"].resetDataset(dataset);
+    protons["moments"]["z"].resetDataset(dataset);
+
+    protons["id"][scalar].resetDataset(dataset);
+    protons["s"][scalar].resetDataset(dataset);
+    protons["repetition"][scalar].resetDataset(dataset);
+    protons["bucket_index"][scalar].resetDataset(dataset);
+    protons["element_index"][scalar].resetDataset(dataset);
+
+    file.flush();
+
+    openPMD::Offset chunk_offset = {discards_offset_num - discards_local_num};
+    openPMD::Extent chunk_extent = {discards_local_num};
+
+    auto col = [](auto const& v, int c) {
+        return Kokkos::subview(v, Kokkos::ALL, c).data();
+    };
+
+    protons["position"]["x"].storeChunkRaw(
+        col(parts, Bunch::x), chunk_offset, chunk_extent);
+    protons["position"]["y"].storeChunkRaw(
+        col(parts, Bunch::y), chunk_offset, chunk_extent);
+    protons["position"]["z"].storeChunkRaw(
+        col(parts, Bunch::cdt), chunk_offset, chunk_extent);
+    protons["moments"]["x"].storeChunkRaw(
+        col(parts, Bunch::xp), chunk_offset, chunk_extent);
+    protons["moments"]["y"].storeChunkRaw(
+        col(parts, Bunch::yp), chunk_offset, chunk_extent);
+    protons["moments"]["z"].storeChunkRaw(
+        col(parts, Bunch::dpop), chunk_offset, chunk_extent);
+
+    protons["id"][scalar].storeChunkRaw(
+        col(parts, Bunch::id), chunk_offset, chunk_extent);
+    protons["s"][scalar].storeChunkRaw(
+        col(info, info_s), chunk_offset, chunk_extent);
+    protons["repetition"][scalar].storeChunkRaw(
+        col(info, info_repetition), chunk_offset, chunk_extent);
+    protons["bucket_index"][scalar].storeChunkRaw(
+        col(info, info_bucket), chunk_offset, chunk_extent);
+    protons["element_index"][scalar].storeChunkRaw(
+        col(info, info_element), chunk_offset, chunk_extent);
+
+    file.flush();
+
+#else
+    // names are stored as a '\0' separated list of chars
+    std::string names;
+    for (auto const& name : element_names)
+        names.append(name).push_back('\0');
+
+    Kokkos::View<uint8_t*, Kokkos::HostSpace> hnames("names", names.size());
+    std::copy(names.begin(), names.end(), hnames.data());
+
+    auto suffix = "_" + std::to_string(num_flushes);
+
+    file.append("repetition", repetition);
+    file.append("s", s_ref_particle);
+    file.append("s_n", sn_ref_particle);
+
+    file.write_collective("coordinates" + suffix, hparts);
+    file.write_collective("loss_info" + suffix,
+                          Kokkos::subview(buf_info, range, Kokkos::ALL));
+    file.write_single("element_names" + suffix, hnames);
+#endif
+
+    ++num_flushes;
+    clear_buffer();
+}
@@ -1,10 +1,34 @@
 #ifndef DIAGNOSTICS_LOSS_H_
 #define DIAGNOSTICS_LOSS_H_
 
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
 #include "synergia/bunch/diagnostics.h"
 #include "synergia/utils/kokkos_views.h"
 
+/// Diagnostics_loss records the coordinates of the particles discarded by
+/// the apertures (or z-cut).
+///
+/// In the default (unbuffered) mode every aperture operation that discards
+/// particles triggers an update and a collective write.
+///
+/// In the buffered mode (flush_turns > 0 or flush_size > 0) the discarded
+/// particles are appended to a growable device array together with the
+/// s, turn, bucket index and element name of the loss. The buffer is only
+/// written out, in a single collective write, at the end of every
+/// flush_turns turns, or at the end of a turn when the total number of
+/// buffered particles across the bunch has reached flush_size. The buffer
+/// is also drained before a checkpoint and at the end of the propagation.
 class Diagnostics_loss : public Diagnostics {
+  public:
+    // columns of the per-particle loss info array
+    constexpr static const int info_s = 0;
+    constexpr static const int info_repetition = 1;
+    constexpr static const int info_bucket = 2;
+    constexpr static const int info_element = 3;
+    constexpr static const int info_size = 4;
+
   private:
     int bucket_index;
     int repetition;
@@ -13,22 +37,55 @@ class Diagnostics_loss : public Diagnostics {
 
     karray2d_row coords;
 
+    // buffered mode
+    int flush_turns;
+    int flush_size;
+
+    int turns_since_flush;
+    int num_flushes;
+
+    int num_buffered;
+    karray2d_row_dev buf_parts;
+    karray2d_row buf_info;
+
+    // element names of the buffered losses, indexed by the
+    // info_element column of buf_info
+    std::vector<std::string> element_names;
+
+    size_t discards_total_num;
+
 #ifdef SYNERGIA_HAVE_OPENPMD
     size_t discards_local_num;
     size_t discards_offset_num;
-    size_t discards_total_num;
 #endif
 
   public:
-    Diagnostics_loss(std::string const& filename = "diag_loss.h5")
+    Diagnostics_loss(std::string const& filename = "diag_loss.h5",
+                     int flush_turns = 0,
+                     int flush_size = 0)
         : Diagnostics("diagnostics_loss", filename, true)
         , bucket_index(-1)
         , repetition(0)
         , s_ref_particle(0.0)
         , sn_ref_particle(0.0)
         , coords()
+        , flush_turns(flush_turns)
+        , flush_size(flush_size)
+        , turns_since_flush(0)
+        , num_flushes(0)
+        , num_buffered(0)
+        , buf_parts("loss_buf_parts", 0, 7)
+        , buf_info("loss_buf_info", 0, info_size)
+        , element_names()
+        , discards_total_num(0)
     {}
 
+    int
+    get_num_buffered() const
+    {
+        return num_buffered;
+    }
+
   private:
     void do_update(Bunch const& bunch) override;
     void
@@ -37,13 +94,31 @@ class Diagnostics_loss : public Diagnostics {
     void do_first_write(io_device& file) override;
     void do_write(io_device& file, size_t iteration) override;
 
+    bool
+    do_buffered() const override
+    {
+        return flush_turns > 0 || flush_size > 0;
+    }
+
+    bool do_flush_due(Bunch const& bunch, bool force) override;
+
+    void buffer_discards(Bunch const& bunch);
+    void unify_element_names(Commxx const& comm);
+    void write_buffer(io_device& file, size_t iteration);
+    void clear_buffer();
+
     friend class cereal::access;
 
     template <class Archive>
     void
     serialize(Archive& ar)
     {
+        // buffer is always drained before the checkpoint
         ar(cereal::base_class<Diagnostics>(this));
+        ar(CEREAL_NVP(flush_turns));
+        ar(CEREAL_NVP(flush_size));
+        ar(CEREAL_NVP(turns_since_flush));
+        ar(CEREAL_NVP(num_flushes));
     }
 };
 
@@ -0,0 +1,601 @@
+#include "diagnostics_tunes.h"
+#include "synergia/bunch/bunch.h"
+#include "synergia/utils/parallel_utils.h"
+#include "synergia/utils/simple_timer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+constexpr auto pi = Kokkos::numbers::pi_v<double>;
+
+namespace {
+    using cplx = Kokkos::complex<double>;
+
+    // number of tracks analyzed at a time, bounds the size of the
+    // FFT scratch array
+    constexpr const int analysis_batch = 16384;
+
+    // copies x, xp, y, yp of the tracks into the turn slot of the buffer
+    struct alg_record {
+        karray3d_row_dev buf;
+        karray1i_row_dev valid;
+        ConstParticles parts;
+        ConstParticleMasks masks;
+        int offset;
+        int turn;
+
+        KOKKOS_INLINE_FUNCTION
+        void
+        operator()(const int i) const
+        {
+            for (int j = 0; j < 4; ++j)
+                buf(i, j, turn) = parts(offset + i, j);
+
+            if (!masks(offset + i)) valid(i) = 0;
+        }
+    };
+
+    // in place radix-2 FFT, exp(-i) convention. n is a power of 2
+    KOKKOS_INLINE_FUNCTION
+    void
+    fft_radix2(cplx* a, int n)
+    {
+        for (int i = 1, j = 0; i < n; ++i) {
+            int bit = n >> 1;
+            for (; j & bit; bit >>= 1)
+                j ^= bit;
+            j ^= bit;
+
+            if (i < j) {
+                cplx t = a[i];
+                a[i] = a[j];
+                a[j] = t;
+            }
+        }
+
+        for (int len = 2; len <= n; len <<= 1) {
+            double ang = -2.0 * pi / len;
+            cplx wl(cos(ang), sin(ang));
+
+            for (int s = 0; s < n; s += len) {
+                cplx w(1.0, 0.0);
+
+                for (int k = 0; k < len / 2; ++k) {
+                    cplx u = a[s + k];
+                    cplx v = a[s + k + len / 2] * w;
+                    a[s + k] = u + v;
+                    a[s + k + len / 2] = u - v;
+                    w *= wl;
+                }
+            }
+        }
+    }
+
+    // Hann window
+    KOKKOS_INLINE_FUNCTION
+    double
+    hann(int n, int len)
+    {
+        return 1.0 - cos(2.0 * pi * n / len);
+    }
+
+    // turn by turn signal of a plane, normalized with the Courant-Snyder
+    // parameters estimated from the signal itself. The moments are Hann
+    // weighted, which suppresses the bias from the incomplete periods
+    struct normalized_signal_t {
+        const double* x;
+        const double* p;
+        int len;
+
+        double mx, mp;
+        double alpha, beta;
+        bool ok;
+
+        KOKKOS_INLINE_FUNCTION
+        normalized_signal_t(const double* x, const double* p, int len)
+            : x(x), p(p), len(len), mx(0), mp(0), alpha(0), beta(1), ok(false)
+        {
+            double sw = 0;
+            for (int n = 0; n < len; ++n) {
+                double w = hann(n, len);
+                mx += w * x[n];
+                mp += w * p[n];
+                sw += w;
+            }
+
+            mx /= sw;
+            mp /= sw;
+
+            double sxx = 0, sxp = 0, spp = 0;
+            for (int n = 0; n < len; ++n) {
+                double w = hann(n, len);
+                double dx = x[n] - mx;
+                double dp = p[n] - mp;
+                sxx += w * dx * dx;
+                sxp += w * dx * dp;
+                spp += w * dp * dp;
+            }
+
+            // <xx> = J beta, <xp> = -J alpha, <pp> = J gamma
+            double det = sxx * spp - sxp * sxp;
+            if (!(det > 0)) return;
+
+            double J = sqrt(det);
+            beta = sxx / J;
+            alpha = -sxp / J;
+            ok = true;
+        }
+
+        // z = x_n - i p_n = sqrt(2J) exp(i phi)
+        KOKKOS_INLINE_FUNCTION
+        cplx
+        operator()(int n) const
+        {
+            double dx = x[n] - mx;
+            double dp = p[n] - mp;
+            double sb = sqrt(beta);
+            return cplx(dx / sb, -(alpha * dx + beta * dp) / sb);
+        }
+    };
+
+    // |sum_n w_n z_n exp(-2 pi i nu n)|^2
+    KOKKOS_INLINE_FUNCTION
+    double
+    naff_power(normalized_signal_t const& z, double nu)
+    {
+        cplx rot(cos(-2.0 * pi * nu), sin(-2.0 * pi * nu));
+        cplx ph(1.0, 0.0);
+        cplx sum(0.0, 0.0);
+
+        for (int n = 0; n < z.len; ++n) {
+            sum += hann(n, z.len) * z(n) * ph;
+            ph *= rot;
+        }
+
+        return sum.real() * sum.real() + sum.imag() * sum.imag();
+    }
+
+    // tune in [0, 1) of the signal, NaN if it does not oscillate
+    KOKKOS_INLINE_FUNCTION
+    double
+    naff_tune(normalized_signal_t const& z, cplx* scratch)
+    {
+        if (!z.ok) return NAN;
+
+        int m = 1;
+        while (2 * m <= z.len)
+            m *= 2;
+
+        for (int n = 0; n < m; ++n)
+            scratch[n] = hann(n, m) * z(n);
+
+        fft_radix2(scratch, m);
+
+        int peak = 0;
+        double pmax = -1.0;
+        for (int k = 0; k < m; ++k) {
+            double p = scratch[k].real() * scratch[k].real() +
+                       scratch[k].imag() * scratch[k].imag();
+            if (p > pmax) {
+                pmax = p;
+                peak = k;
+            }
+        }
+
+        // golden section search of the maximum around the peak
+        const double g = 0.5 * (sqrt(5.0) - 1.0);
+
+        double a = (peak - 1.0) / m;
+        double b = (peak + 1.0) / m;
+        double c = b - g * (b - a);
+        double d = a + g * (b - a);
+        double fc = naff_power(z, c);
+        double fd = naff_power(z, d);
+
+        while (b - a > 1e-12) {
+            if (fc > fd) {
+                b = d;
+                d = c;
+                fd = fc;
+                c = b - g * (b - a);
+                fc = naff_power(z, c);
+            } else {
+                a = c;
+                c = d;
+                fc = fd;
+                d = a + g * (b - a);
+                fd = naff_power(z, d);
+            }
+        }
+
+        double nu = 0.5 * (a + b);
+        return nu - floor(nu);
+    }
+
+    // tunes of both halves of the window, one track per thread
+    struct alg_analyze {
+        karray3d_row_dev buf;
+        karray1i_row_dev valid;
+        karray2dc_row_dev scratch;
+        karray2d_row_dev tunes;
+        karray1d_row_dev diffusion;
+        int turns;
+        int first;
+
+        KOKKOS_INLINE_FUNCTION
+        void
+        operator()(const int i) const
+        {
+            if (!valid(i)) {
+                tunes(i, 0) = NAN;
+                tunes(i, 1) = NAN;
+                diffusion(i) = NAN;
+                return;
+            }
+
+            cplx* s = &scratch(i - first, 0);
+            int half = turns / 2;
+            double nu[2][2];
+
+            for (int plane = 0; plane < 2; ++plane) {
+                const double* x = &buf(i, 2 * plane, 0);
+                const double* p = &buf(i, 2 * plane + 1, 0);
+
+                for (int h = 0; h < 2; ++h) {
+                    normalized_signal_t z(x + h * half, p + h * half, half);
+                    nu[plane][h] = naff_tune(z, s);
+                }
+            }
+
+            tunes(i, 0) = nu[0][0];
+            tunes(i, 1) = nu[1][0];
+
+            // the tune difference across the integer
+            double dx = nu[0][1] - nu[0][0];
+            double dy = nu[1][1] - nu[1][0];
+            dx -= round(dx);
+            dy -= round(dy);
+
+            double dnu = sqrt(dx * dx + dy * dy);
+            diffusion(i) = log10(dnu > 1e-16 ? dnu : 1e-16);
+        }
+    };
+}
+
+Diagnostics_tunes::Diagnostics_tunes(std::string const& filename,
+                                     int num_tracks,
+                                     int offset,
+                                     int window_turns,
+                                     ParticleGroup pg)
+    : Diagnostics("diagnostics_tunes", filename, true)
+    , total_num_tracks(num_tracks)
+    , local_num_tracks(0)
+    , offset(offset)
+    , local_offset(0)
+    , setup(false)
+    , layout(false)
+    , window_turns(window_turns)
+    , num_turns(0)
+    , ref_charge(0.0)
+    , ref_mass(0.0)
+    , ref_pz(0.0)
+    , buf_coords("tunes_buf_coords", 0, 4, 0)
+    , buf_valid("tunes_buf_valid", 0)
+    , tunes("tunes", 0, 2)
+    , diffusion("diffusion", 0)
+    , track_ids("track_ids", 0)
+    , repetition(0)
+    , s_n(0.0)
+    , window_length(0)
+    , tracks_local_num(0)
+    , tracks_offset_num(0)
+    , tracks_total_num(0)
+    , pg(pg)
+{
+    if (window_turns < min_window_turns) {
+        throw std::runtime_error(
+            "Diagnostics_tunes: window_turns must be at least " +
+            std::to_string(min_window_turns));
+    }
+}
+
+void
+Diagnostics_tunes::setup_layout(Bunch const& bunch)
+{
+    auto const& comm = bunch.get_comm();
+
+    tracks_local_num = local_num_tracks;
+
+    if (MPI_Allreduce(&tracks_local_num,
+                      &tracks_total_num,
+                      1,
+                      MPI_SIZE_T,
+                      MPI_SUM,
+                      comm) != MPI_SUCCESS) {
+        throw std::runtime_error(
+            "Error in MPI_Allreduce in diagnostics-tunes!");
+    }
+
+    if (MPI_Scan(&tracks_local_num,
+                 &tracks_offset_num,
+                 1,
+                 MPI_SIZE_T,
+                 MPI_SUM,
+                 comm) != MPI_SUCCESS) {
+        throw std::runtime_error("Error in MPI_Scan in diagnostics-tunes!");
+    }
+
+    buf_coords =
+        karray3d_row_dev("tunes_buf_coords", local_num_tracks, 4, window_turns);
+    buf_valid = karray1i_row_dev("tunes_buf_valid", local_num_tracks);
+    Kokkos::deep_copy(buf_valid, 1);
+
+    auto parts =
+        bunch.get_particles_in_range_row(local_offset, local_num_tracks, pg);
+
+    track_ids = karray1i_row("track_ids", local_num_tracks);
+    for (int i = 0; i < local_num_tracks; ++i)
+        track_ids(i) = parts(i, Bunch::id);
+
+    restore_window();
+
+    layout = true;
+}
+
+void
+Diagnostics_tunes::save_window()
+{
+    window_coords.clear();
+    window_valid.clear();
+
+    if (!layout || !num_turns) return;
+
+    auto coords = Kokkos::create_mirror_view(buf_coords);
+    auto valid = Kokkos::create_mirror_view(buf_valid);
+
+    Kokkos::deep_copy(coords, buf_coords);
+    Kokkos::deep_copy(valid, buf_valid);
+
+    window_coords.reserve(local_num_tracks * 4 * num_turns);
+    window_valid.reserve(local_num_tracks);
+
+    for (int i = 0; i < local_num_tracks; ++i) {
+        for (int j = 0; j < 4; ++j)
+            for (int t = 0; t < num_turns; ++t)
+                window_coords.push_back(coords(i, j, t));
+
+        window_valid.push_back(valid(i));
+    }
+}
+
+void
+Diagnostics_tunes::restore_window()
+{
+    if (window_valid.empty()) return;
+
+    int num_valid = window_valid.size();
+    int num_coords = window_coords.size();
+
+    if (num_valid != local_num_tracks ||
+        num_coords != local_num_tracks * 4 * num_turns) {
+        throw std::runtime_error(
+            "Diagnostics_tunes: the partial window of the checkpoint does "
+            "not match the tracks");
+    }
+
+    auto coords = Kokkos::create_mirror_view(buf_coords);
+    auto valid = Kokkos::create_mirror_view(buf_valid);
+
+    int k = 0;
+    for (int i = 0; i < local_num_tracks; ++i) {
+        for (int j = 0; j < 4; ++j)
+            for (int t = 0; t < num_turns; ++t)
+                coords(i, j, t) = window_coords[k++];
+
+        valid(i) = window_valid[i];
+    }
+
+    Kokkos::deep_copy(buf_coords, coords);
+    Kokkos::deep_copy(buf_valid, valid);
+
+    window_coords.clear();
+    window_valid.clear();
+}
+
+void
+Diagnostics_tunes::do_update(Bunch const& bunch)
+{
+    scoped_simple_timer timer("diag_tunes_update");
+
+    auto const& ref = bunch.get_reference_particle();
+
+    if (!setup) {
+        ref_charge = ref.get_charge();
+        ref_mass = ref.get_four_momentum().get_mass();
+        ref_pz = ref.get_four_momentum().get_momentum();
+
+        auto const& comm = bunch.get_comm();
+
+        local_num_tracks = decompose_1d_local(comm, total_num_tracks);
+        local_offset = decompose_1d_local(comm, offset);
+
+        if (local_num_tracks + local_offset > bunch.size(pg))
+            local_num_tracks = bunch.size(pg) - local_offset;
+
+        setup = true;
+    }
+
+    // the track ranges are restored from a checkpoint, the layout
+    // across the ranks and the buffers are not
+    if (!layout) setup_layout(bunch);
+
+    // more updates than the window holds, e.g., the diagnostics is
+    // updated more than once per turn
+    if (num_turns == window_turns) {
+        throw std::runtime_error(
+            "Diagnostics_tunes: more updates than window_turns in a window, "
+            "the diagnostics must be updated once per turn");
+    }
+
+    alg_record alg{buf_coords,
+                   buf_valid,
+                   bunch.get_local_particles(pg),
+                   bunch.get_local_particle_masks(pg),
+                   local_offset,
+                   num_turns};
+
+    Kokkos::parallel_for("diag_tunes_record", local_num_tracks, alg);
+
+    repetition = ref.get_repetition();
+    s_n = ref.get_s_n();
+
+    ++num_turns;
+}
+
+bool
+Diagnostics_tunes::do_flush_due(Bunch const& bunch, bool force)
+{
+    // called at the end of every turn, and with force before the
+    // checkpoint and at the end of propagation. Only a complete window
+    // is analyzed, force leaves a partial one to the checkpoint. Every
+    // rank has the same number of turns, so the decision needs no
+    // communication
+    bool due = (num_turns == window_turns);
+
+    if (due) {
+        analyze_window();
+
+        num_turns = 0;
+        if (layout) Kokkos::deep_copy(buf_valid, 1);
+    }
+
+    return due;
+}
+
+void
+Diagnostics_tunes::analyze_window()
+{
+    scoped_simple_timer timer("diag_tunes_analyze");
+
+    int m = 1;
+    while (2 * m <= num_turns / 2)
+        m *= 2;
+
+    karray2d_row_dev dtunes("tunes", local_num_tracks, 2);
+    karray1d_row_dev ddiffusion("diffusion", local_num_tracks);
+
+    int batch = std::min(local_num_tracks, analysis_batch);
+    karray2dc_row_dev scratch("tunes_scratch", batch, m);
+
+    for (int first = 0; first < local_num_tracks; first += batch) {
+        int last = std::min(first + batch, local_num_tracks);
+
+        alg_analyze alg{buf_coords,
+                        buf_valid,
+                        scratch,
+                        dtunes,
+                        ddiffusion,
+                        num_turns,
+                        first};
+
+        Kokkos::parallel_for(
+            "diag_tunes_analyze",
+            Kokkos::RangePolicy<Kokkos::DefaultExecutionSpace>(first, last),
+            alg);
+    }
+
+    // new host arrays for every window, so they can be shared with
+    // the snapshot written in the background
+    tunes = karray2d_row("tunes", local_num_tracks, 2);
+    diffusion = karray1d_row("diffusion", local_num_tracks);
+
+    Kokkos::deep_copy(tunes, dtunes);
+    Kokkos::deep_copy(diffusion, ddiffusion);
+
+    window_length = num_turns;
+}
+
+void
+Diagnostics_tunes::do_first_write(io_device& file)
+{
+#ifdef SYNERGIA_HAVE_OPENPMD
+    file.setAttribute("charge", ref_charge);
+    file.setAttribute("mass", ref_mass);
+    file.setAttribute("pz", ref_pz);
+#else
+    file.write("charge", ref_charge);
+    file.write("mass", ref_mass);
+    file.write("pz", ref_pz);
+    file.write_collective("track_ids", track_ids);
+#endif
+}
+
+void
+Diagnostics_tunes::do_write(io_device& file, const size_t iteration)
+{
+    scoped_simple_timer timer("diag_tunes_write");
+
+#ifdef SYNERGIA_HAVE_OPENPMD
+    // contiguous columns for the chunk store
+    std::vector<double> nux(local_num_tracks), nuy(local_num_tracks);
+    for (int i = 0; i < local_num_tracks; ++i) {
+        nux[i] = tunes(i, 0);
+        nuy[i] = tunes(i, 1);
+    }
+
+    auto i = file.iterations[iteration];
+    i.setAttribute("repetition", repetition);
+    i.setAttribute("s_n", s_n);
+    i.setAttribute("window_length", window_length);
+
+    openPMD::ParticleSpecies& tracks =
+        file.iterations[iteration].particles["tunes"];
+
+    openPMD::Extent global_extent = {tracks_total_num};
+    openPMD::Dataset dataset(openPMD::determineDatatype<double>(),
+                             global_extent);
+    openPMD::Dataset dataset_id(openPMD::determineDatatype<int>(),
+                                global_extent);
+
+    auto const scalar = openPMD::RecordComponent::SCALAR;
+
+    tracks["nu"]["x"].resetDataset(dataset);
+    tracks["nu"]["y"].resetDataset(dataset);
+    tracks["diffusion"][scalar].resetDataset(dataset);
+    tracks["id"][scalar].resetDataset(dataset_id);
+
+    file.flush();
+
+    openPMD::Offset chunk_offset = {tracks_offset_num - tracks_local_num};
+    openPMD::Extent chunk_extent = {tracks_local_num};
+
+    tracks["nu"]["x"].storeChunkRaw(nux.data(), chunk_offset, chunk_extent);
+    tracks["nu"]["y"].storeChunkRaw(nuy.data(), chunk_offset, chunk_extent);
+    tracks["diffusion"][scalar].storeChunkRaw(
+        diffusion.data(), chunk_offset, chunk_extent);
+    tracks["id"][scalar].storeChunkRaw(
+        track_ids.data(), chunk_offset, chunk_extent);
+
+    file.flush();
+
+#else
+    file.append_single("repetition", repetition);
+    file.append_single("s_n", s_n);
+    file.append_single("window_length", window_length);
+
+    // [windows x tracks x 2] and [windows x tracks]
+    file.append_collective("tunes", tunes);
+    file.append_collective("diffusion", diffusion);
+#endif
+}
+
+std::shared_ptr<Diagnostics>
+Diagnostics_tunes::do_snapshot() const
+{
+    // the results are new host arrays from every window, and the device
+    // buffer is never read by the writes
+    return std::make_shared<Diagnostics_tunes>(*this);
+}
@@ -0,0 +1,171 @@
+#ifndef DIAGNOSTICS_TUNES_H_
+#define DIAGNOSTICS_TUNES_H_
+
+#include "synergia/bunch/bunch.h"
+#include "synergia/bunch/diagnostics.h"
+
+#include <cereal/types/vector.hpp>
+
+/// Diagnostics_tunes computes the betatron tunes of a set of particles in
+/// situ, from their turn by turn coordinates, and writes only the tunes
+/// and the diffusion indices.
+///
+/// The tracked particles are a fixed range of the local particles, as in
+/// Diagnostics_bulk_track. The diagnostics is meant to be updated once
+/// per turn. The x, xp, y and yp of the tracks are accumulated in a device
+/// array over a window of window_turns turns. At the end of the window
+/// the tunes are computed, one particle per thread, in each half of the
+/// window:
+///  - the coordinates are normalized with the Courant-Snyder parameters
+///    estimated from the turn by turn data of the particle, so the complex
+///    signal z = x_n - i p_n rotates with the tune in [0, 1);
+///  - the peak of the FFT of the Hann windowed signal gives the tune to
+///    1/M, M being the largest power of 2 in the half window;
+///  - NAFF refinement: the amplitude of the windowed Fourier integral is
+///    maximized around the peak with a golden section search.
+/// The tunes of the first half and the diffusion index
+/// log10(|nu_2 - nu_1|) are written. Particles lost within the window
+/// have NaN tunes.
+///
+/// Only complete windows are analyzed. The forced flush at the checkpoint
+/// keeps the turns of a partial window, which are saved in the checkpoint
+/// and completed after the resume, so the windows do not depend on the
+/// checkpoint period. A partial window left at the end of propagation is
+/// not analyzed.
+class Diagnostics_tunes : public Diagnostics {
+  public:
+    constexpr static const int min_window_turns = 32;
+
+  private:
+    int total_num_tracks, local_num_tracks;
+    int offset, local_offset;
+    bool setup;
+
+    // collectives and buffer allocation done once the tracks are set up
+    bool layout;
+
+    int window_turns;
+    int num_turns;
+
+    double ref_charge;
+    double ref_mass;
+    double ref_pz;
+
+    // turn by turn x, xp, y, yp of the tracks, [tracks x 4 x window]
+    karray3d_row_dev buf_coords;
+
+    // whether the track has been valid for all turns of the window
+    karray1i_row_dev buf_valid;
+
+    // the partial window of a checkpoint, x, xp, y, yp of the turns of
+    // every track and their validity. Copied to the device buffers once
+    // the layout is restored
+    std::vector<double> window_coords;
+    std::vector<int> window_valid;
+
+    // results of the last window, [tracks x 2] and [tracks]
+    karray2d_row tunes;
+    karray1d_row diffusion;
+    karray1i_row track_ids;
+
+    int repetition;
+    double s_n;
+    int window_length;
+
+    size_t tracks_local_num;
+    size_t tracks_offset_num;
+    size_t tracks_total_num;
+
+    ParticleGroup pg;
+
+  private:
+    void do_update(Bunch const& bunch) override;
+    void
+    do_reduce(Commxx const& comm, int root) override
+    {}
+    void do_first_write(io_device& file) override;
+    void do_write(io_device& file, const size_t iteration) override;
+    std::shared_ptr<Diagnostics> do_snapshot() const override;
+
+    bool
+    do_buffered() const override
+    {
+        return true;
+    }
+
+    bool do_flush_due(Bunch const& bunch, bool force) override;
+
+    void setup_layout(Bunch const& bunch);
+    void analyze_window();
+
+    void save_window();
+    void restore_window();
+
+    friend class cereal::access;
+
+    template <class AR>
+    void
+    serialize(AR& ar)
+    {
+        ar(cereal::base_class<Diagnostics>(this));
+        ar(total_num_tracks);
+        ar(local_num_tracks);
+        ar(offset);
+        ar(local_offset);
+        ar(setup);
+        ar(window_turns);
+        ar(ref_charge);
+        ar(ref_mass);
+        ar(ref_pz);
+
+        // the partial window, completed after the resume
+        ar(num_turns);
+        ar(repetition);
+        ar(s_n);
+
+        if (AR::is_saving::value) save_window();
+
+        ar(window_coords);
+        ar(window_valid);
+
+        if (AR::is_saving::value) {
+            window_coords.clear();
+            window_valid.clear();
+        }
+    }
+
+  public:
+    /// Create an empty Diagnostics_tunes object
+    /// @param filename the base name for file to write to
+    /// @param num_tracks the number of particles to analyze
+    /// @param offset index offset for first particle to analyze
+    /// @param window_turns the number of turns in a window
+    Diagnostics_tunes(std::string const& filename = "diag_tunes.h5",
+                      int num_tracks = 0,
+                      int offset = 0,
+                      int window_turns = 1024,
+                      ParticleGroup pg = ParticleGroup::regular);
+
+    int
+    get_num_turns() const
+    {
+        return num_turns;
+    }
+
+    // tunes (nu_x, nu_y) of the local tracks from the last window
+    karray2d_row
+    get_tunes() const
+    {
+        return tunes;
+    }
+
+    karray1d_row
+    get_diffusion() const
+    {
+        return diffusion;
+    }
+};
+
+CEREAL_REGISTER_TYPE(Diagnostics_tunes)
+
+#endif /* DIAGNOSTICS_TUNES_H_ */
@@ -1,6 +1,48 @@
-
 #include "synergia/bunch/diagnostics_worker.h"
 #include "synergia/bunch/bunch.h"
+#include "synergia/utils/io_thread.h"
+
+namespace {
+    void
+    write_diag(Diagnostics& diag, Diagnostics_io& io)
+    {
+        io.open_file();
+        diag.write(io.get_io_device(), io.get_count());
+        io.finish_write();
+    }
+}
+
+void
+Diagnostics_worker::setup_io(std::shared_ptr<Commxx> const& comm)
+{
+    async = Io_thread::get().running();
+
+    if (!async) {
+        diag_io = std::make_shared<Diagnostics_io>(
+            diag->filename(), diag->single_file(), comm);
+        return;
+    }
+
+    // the I/O thread must not share a communicator with the main thread
+    auto io_comm = std::make_shared<Commxx>(comm->dup());
+
+    Io_thread::get().run([&]() {
+        diag_io = std::make_shared<Diagnostics_io>(
+            diag->filename(), diag->single_file(), io_comm);
+        root_rank = diag_io->get_root_rank();
+    });
+}
+
+Diagnostics_worker::~Diagnostics_worker()
+{
+    if (!diag_io) return;
+
+    // the last reference to diag_io is released by the I/O thread,
+    // after the writes still holding it
+    Io_thread::get().submit([io = std::move(diag_io)]() mutable {
+        io.reset();
+    });
+}
 
 std::string
 Diagnostics_worker::type() const
@@ -12,16 +54,38 @@ void
 Diagnostics_worker::update(Bunch const& bunch)
 {
     diag->update(bunch);
+
+    // the writer rank is fixed when the file is created, and the
+    // file is opened by the I/O thread before writing
+    if (async) {
+        diag->reduce(bunch.get_comm(), root_rank);
+        return;
+    }
+
     // need to open file for the HDF5 backend to have
     // a meaningful root rank, previously this was done
     // implicity via get_file
-    diag_io.open_file();
-    diag->reduce(bunch.get_comm(), diag_io.get_root_rank());
+    Io_thread::get().run([this]() { diag_io->open_file(); });
+    diag->reduce(bunch.get_comm(), diag_io->get_root_rank());
 }
 
 void
 Diagnostics_worker::write()
 {
-    diag->write(diag_io.get_io_device(), diag_io.get_count());
-    diag_io.finish_write();
+    auto& io = Io_thread::get();
+    auto snap = async ? diag->snapshot() : nullptr;
+
+    if (snap) {
+        // written in the background, blocks only when the queue is full
+        io.submit([snap, dio = diag_io]() { write_diag(*snap, *dio); });
+    } else {
+        io.run([this]() { write_diag(*diag, *diag_io); });
+    }
+}
+
+void
+Diagnostics_worker::flush(Bunch const& bunch, bool force)
+{
+    if (!diag->buffered()) return;
+    if (diag->flush_due(bunch, force)) write();
 }
@@ -13,11 +13,22 @@ class Diagnostics_worker {
 
   private:
     std::shared_ptr<Diagnostics> diag;
-    Diagnostics_io diag_io;
+
+    // writes of the snapshots of diag are queued to the background I/O
+    // thread, diag_io then has a private communicator
+    bool async;
+    int root_rank;
+
+    // shared with the queued writes
+    std::shared_ptr<Diagnostics_io> diag_io;
+
+    void setup_io(std::shared_ptr<Commxx> const& comm);
 
   public:
     // default constructor for serialization only
-    Diagnostics_worker() : diag(), diag_io() {}
+    Diagnostics_worker()
+        : diag(), async(false), root_rank(0), diag_io(new Diagnostics_io())
+    {}
 
     // construct a diag worker with given type of diag and filename
     // specialization is provided for s_p<Diagnostics> so the python
@@ -25,27 +36,45 @@ class Diagnostics_worker {
     template <class DiagCal>
     Diagnostics_worker(DiagCal const& diag, std::shared_ptr<Commxx> const& comm)
         : diag(std::make_shared<DiagCal>(diag))
-        , diag_io(diag.filename(), diag.single_file(), comm)
-    {}
+        , async(false)
+        , root_rank(0)
+        , diag_io()
+    {
+        setup_io(comm);
+    }
 
     // for registering from python only
     Diagnostics_worker(std::shared_ptr<Diagnostics> const& diag,
                        std::shared_ptr<Commxx> const& comm)
-        : diag(diag), diag_io(diag->filename(), diag->single_file(), comm)
-    {}
+        : diag(diag), async(false), root_rank(0), diag_io()
+    {
+        setup_io(comm);
+    }
+
+    Diagnostics_worker(Diagnostics_worker&&) noexcept = default;
+    Diagnostics_worker& operator=(Diagnostics_worker&&) noexcept = default;
+
+    // the file is closed after the pending writes
+    ~Diagnostics_worker();
 
     std::string type() const;
 
     void update(Bunch const& bunch);
     void write();
 
+    // buffered diagnostics only accumulate here, the write is
+    // deferred to flush()
     void
     update_and_write(Bunch const& bunch)
     {
         update(bunch);
-        write();
+        if (!diag->buffered()) write();
     }
 
+    // write out the buffered diagnostics if the flush criteria are met,
+    // or unconditionally when force is set. no-op for unbuffered ones
+    void flush(Bunch const& bunch, bool force = false);
+
   private:
     friend class cereal::access;
 
@@ -54,7 +83,7 @@ class Diagnostics_worker {
     serialize(AR& ar)
     {
         ar(CEREAL_NVP(diag));
-        ar(CEREAL_NVP(diag_io));
+        ar(cereal::make_nvp("diag_io", *diag_io));
     }
 };
 
@@ -1,7 +1,165 @@
 #ifndef FIXED_T_Z_CONVERTER_H_
+#define FIXED_T_Z_CONVERTER_H_
+
+#include <Kokkos_Core.hpp>
+
+#include "synergia/bunch/bunch.h"
+
+/// Per-particle fixed-t/fixed-z transformations of the zeroth order
+/// approximation. Each converts the longitudinal pair (columns 4 and 5)
+/// of one particle in place, given its transverse momenta xp and yp, and
+/// returns false when the particle has no real pz (pz^2 < 0).
+///
+/// They can be called from inside a kernel to work in the other frame
+/// on the fly, without a separate pass over the particle array.
+namespace fixed_t_z_impl {
+
+    struct frame_t {
+        double beta;
+        double gamma;
+        double m;
+        double p_ref;
+    };
+
+    inline frame_t
+    make_frame(Reference_particle const& ref)
+    {
+        return frame_t{ref.get_beta(),
+                       ref.get_gamma(),
+                       ref.get_mass(),
+                       ref.get_momentum()};
+    }
+
+    // pz of a particle with total momentum p
+    KOKKOS_INLINE_FUNCTION
+    bool
+    pz_of(frame_t const& f, double xp, double yp, double p, double& pz)
+    {
+        double px = xp * f.p_ref;
+        double py = yp * f.p_ref;
+        double pz2 = p * p - px * px - py * py;
+
+        pz = sqrt(pz2 > 0.0 ? pz2 : 0.0);
+        return pz2 >= 0.0;
+    }
+
+    // (cdt, dpop) in the fixed-z lab frame to (z, zp) in the fixed-t lab
+    KOKKOS_INLINE_FUNCTION
+    bool
+    z_lab_to_t_lab(frame_t const& f,
+                   double xp,
+                   double yp,
+                   double& l,
+                   double& lp)
+    {
+        double pz;
+        bool ok = pz_of(f, xp, yp, f.p_ref * (1.0 + lp), pz);
+
+        l = -f.beta * l;
+        lp = pz / f.p_ref;
+        return ok;
+    }
+
+    // (z, zp) in the fixed-t lab frame to (cdt, dpop) in the fixed-z lab
+    KOKKOS_INLINE_FUNCTION
+    bool
+    t_lab_to_z_lab(frame_t const& f,
+                   double xp,
+                   double yp,
+                   double& l,
+                   double& lp)
+    {
+        double p = f.p_ref * sqrt(xp * xp + yp * yp + lp * lp);
+
+        l = -l / f.beta;
+        lp = (p - f.p_ref) / f.p_ref;
+        return true;
+    }
 
-// #include "synergia/utils/cereal.h"
-class Bunch;
+    // (cdt, dpop) in the fixed-z lab frame to (z, zp) in the fixed-t bunch
+    // frame. In the zeroth approximation the transformation from
+    // t' = gamma cdt to t' = 0 is a no-op.
+    KOKKOS_INLINE_FUNCTION
+    bool
+    z_lab_to_t_bunch(frame_t const& f,
+                     double xp,
+                     double yp,
+                     double& l,
+                     double& lp)
+    {
+        double p = f.p_ref * (1.0 + lp);
+        double Eoc = sqrt(p * p + f.m * f.m);
+
+        double pz;
+        bool ok = pz_of(f, xp, yp, p, pz);
+
+        l = -f.gamma * f.beta * l;
+        lp = f.gamma * (pz - f.beta * Eoc) / f.p_ref;
+        return ok;
+    }
+
+    // (z, zp) in the fixed-t bunch frame to (cdt, dpop) in the fixed-z lab
+    KOKKOS_INLINE_FUNCTION
+    bool
+    t_bunch_to_z_lab(frame_t const& f,
+                     double xp,
+                     double yp,
+                     double& l,
+                     double& lp)
+    {
+        double px = xp * f.p_ref;
+        double py = yp * f.p_ref;
+        double pzp = lp * f.p_ref;
+        double pt2 = px * px + py * py;
+
+        double Epoc = sqrt(pt2 + pzp * pzp + f.m * f.m);
+        double pz = f.gamma * (pzp + f.beta * Epoc);
+        double p = sqrt(pt2 + pz * pz);
+
+        l = l / (-f.gamma * f.beta);
+        lp = (p - f.p_ref) / f.p_ref;
+        return true;
+    }
+
+    // (z, zp) in the fixed-t lab frame to (z, zp) in the fixed-t bunch
+    KOKKOS_INLINE_FUNCTION
+    bool
+    t_lab_to_t_bunch(frame_t const& f,
+                     double xp,
+                     double yp,
+                     double& l,
+                     double& lp)
+    {
+        double pz = lp * f.p_ref;
+        double p = f.p_ref * sqrt(xp * xp + yp * yp + lp * lp);
+        double Eoc = sqrt(p * p + f.m * f.m);
+
+        l = f.gamma * l;
+        lp = f.gamma * (pz - f.beta * Eoc) / f.p_ref;
+        return true;
+    }
+
+    // (z, zp) in the fixed-t bunch frame to (z, zp) in the fixed-t lab
+    KOKKOS_INLINE_FUNCTION
+    bool
+    t_bunch_to_t_lab(frame_t const& f,
+                     double xp,
+                     double yp,
+                     double& l,
+                     double& lp)
+    {
+        double px = xp * f.p_ref;
+        double py = yp * f.p_ref;
+        double pzp = lp * f.p_ref;
+
+        double Epoc = sqrt(px * px + py * py + pzp * pzp + f.m * f.m);
+        double pz = f.gamma * (pzp + f.beta * Epoc);
+
+        l = l / f.gamma;
+        lp = pz / f.p_ref;
+        return true;
+    }
+}
 
 /// Fixed_t_z_converter is a virtual base class for converters
 /// between the different system of coordinates
@@ -170,6 +328,4 @@ the accelerator frame. void from_t_bunch_to_z_lab(Bunch &bunch); void
 };
 BOOST_CLASS_EXPORT_KEY(Fixed_t_z_synergia20)*/
 
-#define FIXED_T_Z_CONVERTER_H_
-
 #endif /* FIXED_T_Z_CONVERTER_H_ */
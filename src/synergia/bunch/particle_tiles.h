@@ -0,0 +1,358 @@
+#ifndef PARTICLE_TILES_H_
+#define PARTICLE_TILES_H_
+
+#include <array>
+
+#include "synergia/bunch/bunch.h"
+
+/*
+ * Array-of-structures-of-arrays (AoSoA) particle storage.
+ *
+ * The particles are grouped in tiles of W particles, W being the width
+ * of the GSVector. Each tile holds the 7 columns of its particles as
+ * 7 x W contiguous values, and the tiles follow each other:
+ *
+ *    tile 0                       tile 1
+ *   +------+------+-----+------+ +------+-----
+ *   | x[W] | xp[W]| ... | id[W]| | x[W] | ...
+ *   +------+------+-----+------+ +------+-----
+ *
+ * So the GSVector loaded from &p(i, k), with i a multiple of W, is W
+ * contiguous and aligned values, and a tile of particles spans a few
+ * consecutive cache lines instead of 7 columns far apart in memory.
+ *
+ * The validity of the particles is kept as one mask word per tile,
+ * bit l for particle l of the tile.
+ *
+ * tiled_parts and tiled_masks have the same element access as the
+ * Particles and ParticleMasks views, and particle_tiles_t has the type
+ * members of bunch_particles_t. Kernels templated on the bunch particles
+ * type (e.g., the libFF Prop*Simd functors) can therefore be run on the
+ * tiles unchanged.
+ *
+ * The tiles are used by the libFF operations of the elements with the
+ * extractor_type attribute set to "libff_tiled".
+ */
+
+template <class T, int W>
+struct tiled_parts {
+    using memspace = typename Kokkos::DefaultExecutionSpace::memory_space;
+    using view_t = Kokkos::View<T* [7][W], Kokkos::LayoutRight, memspace>;
+
+    view_t tiles;
+
+    tiled_parts() = default;
+
+    tiled_parts(view_t const& tiles) : tiles(tiles) {}
+
+    // non-const to const
+    template <class U>
+    tiled_parts(tiled_parts<U, W> const& o) : tiles(o.tiles)
+    {}
+
+    KOKKOS_INLINE_FUNCTION
+    T&
+    operator()(const int i, const int j) const
+    {
+        return tiles(i / W, j, i % W);
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    size_t
+    extent(const int r) const
+    {
+        return r == 0 ? tiles.extent(0) * W : 7;
+    }
+};
+
+template <int W>
+struct tiled_masks {
+    static_assert(W <= 32, "a tile mask word holds up to 32 particles");
+
+    using memspace = typename Kokkos::DefaultExecutionSpace::memory_space;
+    using view_t = Kokkos::View<uint32_t*, memspace>;
+
+    view_t words;
+
+    KOKKOS_INLINE_FUNCTION
+    uint8_t
+    operator()(const int i) const
+    {
+        return (words(i / W) >> (i % W)) & 1u;
+    }
+
+    // mask word of the tile t, zero when no particle of the tile is valid
+    KOKKOS_INLINE_FUNCTION
+    uint32_t
+    word(const int t) const
+    {
+        return words(t);
+    }
+};
+
+namespace particle_tiles_impl {
+    template <int W>
+    struct tile_packer {
+        tiled_parts<double, W> tp;
+        tiled_masks<W> tm;
+
+        ConstParticles parts;
+        ConstParticleMasks masks;
+
+        int num;
+
+        KOKKOS_INLINE_FUNCTION
+        void
+        operator()(const int t) const
+        {
+            uint32_t word = 0;
+
+            for (int l = 0; l < W; ++l) {
+                int i = t * W + l;
+
+                if (i < num) {
+                    for (int j = 0; j < 7; ++j)
+                        tp.tiles(t, j, l) = parts(i, j);
+
+                    if (masks(i)) word |= (1u << l);
+                } else {
+                    for (int j = 0; j < 7; ++j)
+                        tp.tiles(t, j, l) = 0.0;
+                }
+            }
+
+            tm.words(t) = word;
+        }
+    };
+
+    template <class TP>
+    struct tile_unpacker {
+        TP tp;
+        Particles parts;
+
+        KOKKOS_INLINE_FUNCTION
+        void
+        operator()(const int i) const
+        {
+            for (int j = 0; j < 6; ++j)
+                parts(i, j) = tp(i, j);
+        }
+    };
+}
+
+template <int W = GSVector::size()>
+class particle_tiles_t {
+  public:
+    constexpr static const int tile_width = W;
+
+    using part_t = double;
+    using exec_space = Kokkos::DefaultExecutionSpace;
+
+    using parts_t = tiled_parts<double, W>;
+    using const_parts_t = tiled_parts<const double, W>;
+
+    // the masks are read only in the tiled layout
+    using masks_t = tiled_masks<W>;
+    using const_masks_t = tiled_masks<W>;
+
+    using gsv_t = GSVector;
+
+    static_assert(W == gsv_t::size(),
+                  "the tile width must be the width of the GSVector");
+
+  private:
+    int n_active;
+    int n_valid;
+
+  public:
+    parts_t parts;
+    masks_t masks;
+
+  public:
+    particle_tiles_t() : particle_tiles_t(0) {}
+
+    // tiles for up to n particles
+    explicit particle_tiles_t(int n)
+        : n_active(0)
+        , n_valid(0)
+        , parts(typename parts_t::view_t("particle_tiles", (n + W - 1) / W))
+        , masks{typename masks_t::view_t("particle_tiles_masks",
+                                         (n + W - 1) / W)}
+    {}
+
+    int
+    size() const
+    {
+        return n_active;
+    }
+
+    int
+    num_valid() const
+    {
+        return n_valid;
+    }
+
+    int
+    size_in_gsv() const
+    {
+        return (n_active + W - 1) / W;
+    }
+
+    int
+    num_tiles() const
+    {
+        return parts.tiles.extent(0);
+    }
+
+    // grow the tiles to hold at least n particles. The packed particles
+    // are discarded when the tiles are reallocated
+    void
+    reserve(int n)
+    {
+        int nt = (n + W - 1) / W;
+        if (nt <= num_tiles()) return;
+
+        n_active = 0;
+        n_valid = 0;
+
+        parts = parts_t(typename parts_t::view_t("particle_tiles", nt));
+        masks = masks_t{typename masks_t::view_t("particle_tiles_masks", nt)};
+    }
+
+    // copy the particles and the masks from the column layout
+    void
+    pack(BunchParticles const& bp)
+    {
+        using namespace particle_tiles_impl;
+
+        if (bp.size() > num_tiles() * W) {
+            throw std::runtime_error(
+                "particle_tiles_t::pack(): insufficient number of tiles");
+        }
+
+        n_active = bp.size();
+        n_valid = bp.num_valid();
+
+        tile_packer<W> tp{parts, masks, bp.parts, bp.masks, n_active};
+        Kokkos::parallel_for(size_in_gsv(), tp);
+    }
+
+    // copy the coordinates back to the column layout. The masks of bp
+    // are left unchanged, the tiled masks are read only
+    void
+    unpack(BunchParticles& bp) const
+    {
+        using namespace particle_tiles_impl;
+
+        if (bp.size() != n_active) {
+            throw std::runtime_error(
+                "particle_tiles_t::unpack(): inconsistent particle number");
+        }
+
+        tile_unpacker<const_parts_t> tu{parts, bp.parts};
+        Kokkos::parallel_for(n_active, tu);
+    }
+};
+
+/*
+ * A Bunch with the particles of both groups packed in tiles. It has the
+ * bunch type members and the particle and reference particle accessors
+ * the libFF elements listed in FF_element::supports_tiles() use, so
+ * those elements can propagate the tiles in place of the bunch. The
+ * reference particles are the ones of the packed bunch.
+ */
+template <int W = GSVector::size()>
+class tiled_bunch_t {
+  public:
+    using bp_t = particle_tiles_t<W>;
+
+    using part_t = typename bp_t::part_t;
+    using gsv_t = typename bp_t::gsv_t;
+
+    using parts_t = typename bp_t::parts_t;
+    using masks_t = typename bp_t::masks_t;
+
+    using const_parts_t = typename bp_t::const_parts_t;
+    using const_masks_t = typename bp_t::const_masks_t;
+
+    using exec_space = typename bp_t::exec_space;
+
+  private:
+    Bunch* bunch;
+    std::array<bp_t, 2> parts;
+
+  public:
+    tiled_bunch_t() : bunch(nullptr), parts() {}
+
+    // pack both particle groups of b, growing the tiles when needed
+    void
+    pack(Bunch& b)
+    {
+        for (auto pg : {ParticleGroup::regular, ParticleGroup::spectator}) {
+            auto const& bp = b.get_bunch_particles(pg);
+            parts[(int)pg].reserve(bp.size());
+            parts[(int)pg].pack(bp);
+        }
+
+        bunch = &b;
+    }
+
+    // copy the coordinates back to the packed bunch
+    void
+    unpack()
+    {
+        if (!bunch) {
+            throw std::runtime_error(
+                "tiled_bunch_t::unpack(): no bunch has been packed");
+        }
+
+        for (auto pg : {ParticleGroup::regular, ParticleGroup::spectator})
+            parts[(int)pg].unpack(bunch->get_bunch_particles(pg));
+
+        bunch = nullptr;
+    }
+
+    bp_t&
+    get_bunch_particles(ParticleGroup pg = ParticleGroup::regular)
+    {
+        return parts[(int)pg];
+    }
+
+    bp_t const&
+    get_bunch_particles(ParticleGroup pg = ParticleGroup::regular) const
+    {
+        return parts[(int)pg];
+    }
+
+    Reference_particle&
+    get_reference_particle()
+    {
+        return bunch->get_reference_particle();
+    }
+
+    Reference_particle const&
+    get_reference_particle() const
+    {
+        return bunch->get_reference_particle();
+    }
+
+    Reference_particle&
+    get_design_reference_particle()
+    {
+        return bunch->get_design_reference_particle();
+    }
+
+    Reference_particle const&
+    get_design_reference_particle() const
+    {
+        return bunch->get_design_reference_particle();
+    }
+
+    double
+    get_mass() const
+    {
+        return bunch->get_mass();
+    }
+};
+
+#endif
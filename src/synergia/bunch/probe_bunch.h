@@ -0,0 +1,210 @@
+#ifndef PROBE_BUNCH_H_
+#define PROBE_BUNCH_H_
+
+#include "synergia/bunch/bunch_particles.h"
+#include "synergia/foundation/reference_particle.h"
+
+/*
+ * A few probe particles (typically 1 to 64) in host memory, for the
+ * optics calculations of the Lattice_simulator (closed orbit, tunes,
+ * one turn maps, lattice functions).
+ *
+ * probe_bunch_t has the part of the bunch_t interface used by the libFF
+ * elements, so FF_element::apply() propagates it with the same
+ * FF_algorithm unit functions. Unlike bunch_t, it has no communicator,
+ * ids, diagnostics or device arrays: the particles are processed one
+ * at a time (gsv_t is the scalar GSVec<T>) on the host, in the serial
+ * execution space when available. No device kernel is launched and no
+ * host/device copy is needed to read the particles back.
+ *
+ * T is either double or a trigon.
+ */
+
+template <class T>
+struct probe_particles_t {
+    using part_t = T;
+    using memspace = Kokkos::HostSpace;
+
+#ifdef KOKKOS_ENABLE_SERIAL
+    using exec_space = Kokkos::Serial;
+#else
+    using exec_space = Kokkos::DefaultHostExecutionSpace;
+#endif
+
+    using parts_t = Kokkos::View<T* [7], Kokkos::LayoutLeft, memspace>;
+    using masks_t = Kokkos::View<uint8_t*, memspace>;
+
+    using const_parts_t =
+        Kokkos::View<const T* [7], Kokkos::LayoutLeft, memspace>;
+    using const_masks_t = Kokkos::View<const uint8_t*, memspace>;
+
+    // one particle at a time
+    using gsv_t = GSVec<T>;
+
+    parts_t parts;
+    masks_t masks;
+
+    int n;
+
+    probe_particles_t(int n)
+        : parts("probe_parts", n), masks("probe_masks", n), n(n)
+    {
+        for (int i = 0; i < n; ++i)
+            masks(i) = 1;
+    }
+
+    int
+    size() const
+    {
+        return n;
+    }
+
+    int
+    size_in_gsv() const
+    {
+        return n;
+    }
+
+    // the probes are never discarded
+    int
+    num_valid() const
+    {
+        return n;
+    }
+};
+
+template <class T>
+class probe_bunch_t {
+  public:
+    using part_t = T;
+    using bp_t = probe_particles_t<T>;
+    using gsv_t = typename bp_t::gsv_t;
+
+    using parts_t = typename bp_t::parts_t;
+    using masks_t = typename bp_t::masks_t;
+
+    using const_parts_t = typename bp_t::const_parts_t;
+    using const_masks_t = typename bp_t::const_masks_t;
+
+    using exec_space = typename bp_t::exec_space;
+
+  private:
+    Reference_particle ref_part;
+    Reference_particle design_ref_part;
+
+    // regular probes and an empty spectator group
+    bp_t parts[2];
+
+  public:
+    probe_bunch_t(Reference_particle const& ref, int num = 1)
+        : ref_part(ref), design_ref_part(ref), parts{bp_t(num), bp_t(0)}
+    {}
+
+    Reference_particle&
+    get_reference_particle()
+    {
+        return ref_part;
+    }
+
+    Reference_particle const&
+    get_reference_particle() const
+    {
+        return ref_part;
+    }
+
+    Reference_particle&
+    get_design_reference_particle()
+    {
+        return design_ref_part;
+    }
+
+    Reference_particle const&
+    get_design_reference_particle() const
+    {
+        return design_ref_part;
+    }
+
+    void
+    set_design_reference_particle(Reference_particle const& ref)
+    {
+        design_ref_part = ref;
+    }
+
+    double
+    get_mass() const
+    {
+        return ref_part.get_four_momentum().get_mass();
+    }
+
+    bp_t&
+    get_bunch_particles(ParticleGroup pg = ParticleGroup::regular)
+    {
+        return parts[(int)pg];
+    }
+
+    bp_t const&
+    get_bunch_particles(ParticleGroup pg = ParticleGroup::regular) const
+    {
+        return parts[(int)pg];
+    }
+
+    // the particles are in host memory, no checkin/checkout needed
+    parts_t
+    get_local_particles(ParticleGroup pg = ParticleGroup::regular) const
+    {
+        return parts[(int)pg].parts;
+    }
+
+    masks_t
+    get_local_particle_masks(ParticleGroup pg = ParticleGroup::regular) const
+    {
+        return parts[(int)pg].masks;
+    }
+
+    int
+    get_local_num(ParticleGroup pg = ParticleGroup::regular) const
+    {
+        return parts[(int)pg].num_valid();
+    }
+
+    int
+    get_total_num(ParticleGroup pg = ParticleGroup::regular) const
+    {
+        return parts[(int)pg].num_valid();
+    }
+
+    int
+    size(ParticleGroup pg = ParticleGroup::regular) const
+    {
+        return parts[(int)pg].size();
+    }
+
+    int
+    size_in_gsv(ParticleGroup pg = ParticleGroup::regular) const
+    {
+        return parts[(int)pg].size_in_gsv();
+    }
+
+    // only available for trigons
+    template <class U = T>
+    karray2d_row
+    get_jacobian(int idx) const
+    {
+        static_assert(is_trigon<U>::value);
+
+        karray2d_row res("jacobian", 6, 6);
+        for (int i = 0; i < 6; ++i)
+            for (int j = 0; j < 6; ++j)
+                res(i, j) =
+                    parts[0].parts(idx, i).template get_subpower<1>().terms[j];
+        return res;
+    }
+};
+
+template <class B>
+struct is_probe_bunch : std::false_type {};
+
+template <class T>
+struct is_probe_bunch<probe_bunch_t<T>> : std::true_type {};
+
+#endif
@@ -1,5 +1,6 @@
 #include "synergia/bunch/bunch.h"
 #include "synergia/bunch/bunch_particles.h"
+#include "synergia/bunch/core_diagnostics.h"
 #include "synergia/foundation/physical_constants.h"
 #include "synergia/utils/catch.hpp"
 
@@ -43,6 +44,66 @@ TEST_CASE("Bunch", "[Bunch]")
     CHECK(p2(4, 6) == 127);
 }
 
+TEST_CASE("Bunch single precision storage", "[Bunch]")
+{
+    Four_momentum fm(mass, total_energy);
+    Reference_particle ref(pconstants::proton_charge, fm);
+
+    Bunch bunch(ref, num_parts, 1e13, Commxx());
+    BunchF fbunch(ref, 1, 1e13, Commxx());
+
+    bunch.checkout_particles();
+    auto parts = bunch.get_host_particles();
+
+    for (int i = 0; i < num_parts; ++i) {
+        for (int j = 0; j < 6; ++j)
+            parts(i, j) = 1.0e-3 * (i % 17 - 8) * (j + 1);
+    }
+
+    // beyond the 2^24 integers exactly representable in a float
+    parts(5, id) = 16777217;
+
+    bunch.checkin_particles();
+
+    fbunch.assign(bunch);
+    fbunch.checkout_particles();
+
+    CHECK(fbunch.get_local_num() == num_parts);
+    CHECK(fbunch.get_total_num() == num_parts);
+    CHECK(fbunch.get_real_num() == Approx(1e13));
+
+    auto fparts = fbunch.get_host_particles();
+    auto& fbp = fbunch.get_bunch_particles();
+
+    for (int i = 0; i < num_parts; ++i) {
+        for (int j = 0; j < 6; ++j)
+            CHECK(fparts(i, j) == Approx(parts(i, j)).margin(1e-7));
+
+        CHECK(fbp.hids(i) == (int64_t)parts(i, id));
+    }
+
+    CHECK(fbunch.search_particle(307) == 307);
+
+    // moments accumulated in double
+    auto mean = Core_diagnostics::calculate_mean(bunch);
+    auto fmean = Core_diagnostics::calculate_mean(fbunch);
+
+    auto sd = Core_diagnostics::calculate_std(bunch, mean);
+    auto fsd = Core_diagnostics::calculate_std(fbunch, fmean);
+
+    for (int j = 0; j < 6; ++j) {
+        CHECK(fmean(j) == Approx(mean(j)).margin(1e-7));
+        CHECK(fsd(j) == Approx(sd(j)).epsilon(1e-6));
+    }
+
+    // and back to double
+    Bunch bunch2(ref, 1, 1e13, Commxx());
+    bunch2.assign(fbunch);
+    bunch2.checkout_particles();
+
+    CHECK(bunch2.get_host_particles()(5, id) == 16777217);
+}
+
 #if defined SYNERGIA_HAVE_OPENPMD
 
 void
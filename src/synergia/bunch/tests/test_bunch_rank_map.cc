@@ -0,0 +1,91 @@
+#include "synergia/bunch/bunch_rank_map.h"
+#include "synergia/utils/catch.hpp"
+
+TEST_CASE("Bunch_rank_map uniform", "[Bunch_rank_map]")
+{
+    // 2 ranks per bunch
+    Bunch_rank_map m1(6, 3);
+
+    CHECK(m1.get_first_rank(0) == 0);
+    CHECK(m1.get_first_rank(1) == 2);
+    CHECK(m1.get_first_rank(2) == 4);
+    CHECK(m1.get_rank_count(1) == 2);
+    CHECK(m1.get_color(3) == 1);
+    CHECK(m1.get_bunches_of_rank(5) == std::vector<int>{2});
+
+    // 2 bunches per rank
+    Bunch_rank_map m2(2, 4);
+
+    CHECK(m2.get_bunches_of_rank(0) == std::vector<int>{0, 1});
+    CHECK(m2.get_bunches_of_rank(1) == std::vector<int>{2, 3});
+    CHECK(m2.get_color(1) == 2);
+
+    // not divisible
+    Bunch_rank_map m3(3, 5);
+
+    CHECK(m3.get_bunches_of_rank(0) == std::vector<int>{0, 1});
+    CHECK(m3.get_bunches_of_rank(1) == std::vector<int>{2, 3});
+    CHECK(m3.get_bunches_of_rank(2) == std::vector<int>{4});
+
+    std::vector<int> counts, offsets;
+    m3.get_counts_and_offsets(counts, offsets);
+
+    CHECK(counts == std::vector<int>{2, 2, 1});
+    CHECK(offsets == std::vector<int>{0, 2, 4});
+
+    Bunch_rank_map m4(5, 3);
+
+    CHECK(m4.get_rank_count(0) == 2);
+    CHECK(m4.get_rank_count(1) == 2);
+    CHECK(m4.get_rank_count(2) == 1);
+
+    m4.get_counts_and_offsets(counts, offsets);
+
+    CHECK(counts == std::vector<int>{1, 0, 1, 0, 1});
+    CHECK(offsets == std::vector<int>{0, 0, 1, 1, 2});
+}
+
+TEST_CASE("Bunch_rank_map weighted", "[Bunch_rank_map]")
+{
+    // more ranks than bunches, shared by the weights
+    Bunch_rank_map m1(8, std::vector<double>{1.0, 3.0});
+
+    CHECK(m1.get_rank_count(0) == 2);
+    CHECK(m1.get_rank_count(1) == 6);
+    CHECK(m1.get_first_rank(1) == 2);
+    CHECK(m1.get_imbalance({1.0, 3.0}) == Approx(1.0));
+
+    // fewer ranks than bunches, every rank has at least one bunch
+    std::vector<double> w{4.0, 1.0, 1.0, 1.0, 1.0};
+    Bunch_rank_map m2(2, w);
+
+    CHECK(m2.get_bunches_of_rank(0) == std::vector<int>{0});
+    CHECK(m2.get_bunches_of_rank(1) == std::vector<int>{1, 2, 3, 4});
+    CHECK(m2.get_imbalance(w) == Approx(1.0));
+
+    Bunch_rank_map m3(4, std::vector<double>{5.0, 1.0, 1.0, 1.0, 1.0});
+
+    for (int r = 0; r < 4; ++r)
+        CHECK(!m3.get_bunches_of_rank(r).empty());
+
+    CHECK(m3.get_bunches_of_rank(0) == std::vector<int>{0});
+
+    CHECK_THROWS(Bunch_rank_map(2, std::vector<double>{1.0, 0.0}));
+    CHECK_THROWS(Bunch_rank_map(0, 2));
+}
+
+TEST_CASE("Bunch_rank_map shared", "[Bunch_rank_map]")
+{
+    auto m = Bunch_rank_map::shared(4, 3);
+
+    CHECK(m.is_shared());
+    CHECK(!Bunch_rank_map(4, 3).is_shared());
+
+    for (int r = 0; r < 4; ++r) {
+        CHECK(m.get_color(r) == 0);
+        CHECK(m.get_bunches_of_rank(r) == std::vector<int>{0, 1, 2});
+    }
+
+    CHECK(m.get_rank_count(2) == 4);
+    CHECK(m.get_imbalance({1.0, 2.0, 3.0}) == Approx(1.0));
+}
@@ -0,0 +1,161 @@
+#include "synergia/bunch/bunch.h"
+#include "synergia/bunch/diagnostics_bulk_track.h"
+#include "synergia/foundation/physical_constants.h"
+#include "synergia/utils/catch.hpp"
+#include "synergia/utils/hdf5_file.h"
+
+#include <string>
+
+constexpr double mass = 100.0;
+constexpr double total_energy = 125.0;
+constexpr int num_parts = 32;
+constexpr int num_tracks = 12;
+constexpr int track_offset = 4;
+
+// not a multiple of flush_turns, so the last flush is a partial one
+constexpr int num_turns = 5;
+constexpr int flush_turns = 2;
+
+// more updates per turn than the initial one slot per turn of the buffer
+constexpr int updates_per_turn = 3;
+
+namespace {
+    void
+    fill_particles(Bunch& bunch)
+    {
+        bunch.checkout_particles();
+        auto parts = bunch.get_host_particles();
+
+        for (int i = 0; i < num_parts; ++i) {
+            parts(i, 0) = 1.0e-3 * i;
+            parts(i, 1) = 1.0e-5 * i;
+            parts(i, 2) = -1.0e-3 * i;
+            parts(i, 3) = 2.0e-5 * i;
+            parts(i, 4) = 0.1 * i;
+            parts(i, 5) = 1.0e-4 * i;
+        }
+
+        bunch.checkin_particles();
+    }
+
+    // moves the particles between the updates so every update records
+    // different coordinates
+    void
+    kick(Bunch& bunch, int update)
+    {
+        bunch.checkout_particles();
+        auto parts = bunch.get_host_particles();
+
+        for (int i = 0; i < num_parts; ++i) {
+            parts(i, 0) += parts(i, 1) * (update + 1);
+            parts(i, 2) += parts(i, 3) * (update + 1);
+            parts(i, 4) -= 1.0e-3 * update;
+        }
+
+        bunch.checkin_particles();
+    }
+
+    void
+    propagate(Bunch& bunch, int diag)
+    {
+        auto& ref = bunch.get_reference_particle();
+
+        for (int turn = 0; turn < num_turns; ++turn) {
+            for (int u = 0; u < updates_per_turn; ++u) {
+                int update = turn * updates_per_turn + u;
+
+                kick(bunch, update);
+                ref.increment_trajectory(0.5 * (u + 1));
+                ref.set_bunch_abs_time(1.0e-6 * update);
+
+                bunch.diag_update_and_write(diag);
+            }
+
+            bunch.flush_diags();
+            ref.start_repetition();
+        }
+
+        bunch.flush_diags(true);
+    }
+}
+
+TEST_CASE("Diagnostics_bulk_track buffered", "[Diagnostics_bulk_track]")
+{
+    Four_momentum fm(mass, total_energy);
+    Reference_particle ref(pconstants::proton_charge, fm);
+
+    // the files are closed when the bunches go out of scope
+    {
+        Bunch unbuffered(ref, num_parts, 1e13, Commxx());
+        Bunch buffered(ref, num_parts, 1e13, Commxx());
+
+        fill_particles(unbuffered);
+        fill_particles(buffered);
+
+        auto du = unbuffered.add_diagnostics(Diagnostics_bulk_track(
+            "diag_bulk_track_unbuffered.h5", num_tracks, track_offset));
+
+        auto db = buffered.add_diagnostics(
+            Diagnostics_bulk_track("diag_bulk_track_buffered.h5",
+                                   num_tracks,
+                                   track_offset,
+                                   ParticleGroup::regular,
+                                   flush_turns));
+
+        propagate(unbuffered, du.second);
+        propagate(buffered, db.second);
+    }
+
+#ifndef SYNERGIA_HAVE_OPENPMD
+    Hdf5_file unbuffered("diag_bulk_track_unbuffered.h5",
+                         Hdf5_file::Flag::read_only,
+                         Commxx());
+
+    Hdf5_file buffered("diag_bulk_track_buffered.h5",
+                       Hdf5_file::Flag::read_only,
+                       Commxx());
+
+    const int num_updates = num_turns * updates_per_turn;
+
+    auto uc = unbuffered.read<karray3d_row>("track_coords");
+    auto bc = buffered.read<karray3d_row>("track_coords");
+
+    REQUIRE(uc.extent(0) == num_updates);
+    REQUIRE(uc.extent(1) == num_tracks);
+    REQUIRE(uc.extent(2) == 7);
+
+    REQUIRE(bc.extent(0) == uc.extent(0));
+    REQUIRE(bc.extent(1) == uc.extent(1));
+    REQUIRE(bc.extent(2) == uc.extent(2));
+
+    for (int u = 0; u < num_updates; ++u)
+        for (int p = 0; p < num_tracks; ++p)
+            for (int j = 0; j < 7; ++j)
+                CHECK(bc(u, p, j) == uc(u, p, j));
+
+    // the first track is the particle at the offset
+    CHECK(uc(0, 0, Bunch::id) == track_offset);
+
+    for (auto name : {"track_pz", "track_s", "track_s_n", "bunch_abs_time"}) {
+        auto uv = unbuffered.read<karray1d_row>(name);
+        auto bv = buffered.read<karray1d_row>(name);
+
+        REQUIRE(uv.extent(0) == num_updates);
+        REQUIRE(bv.extent(0) == uv.extent(0));
+
+        for (int u = 0; u < num_updates; ++u)
+            CHECK(bv(u) == uv(u));
+    }
+
+    auto ur = unbuffered.read<karray1i_row>("track_repetition");
+    auto br = buffered.read<karray1i_row>("track_repetition");
+
+    REQUIRE(ur.extent(0) == num_updates);
+    REQUIRE(br.extent(0) == ur.extent(0));
+
+    for (int u = 0; u < num_updates; ++u) {
+        CHECK(ur(u) == u / updates_per_turn);
+        CHECK(br(u) == ur(u));
+    }
+#endif
+}
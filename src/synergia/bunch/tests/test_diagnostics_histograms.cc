@@ -0,0 +1,66 @@
+#include "synergia/bunch/diagnostics_histograms.h"
+#include "synergia/bunch/bunch.h"
+#include "synergia/foundation/physical_constants.h"
+#include "synergia/utils/catch.hpp"
+
+constexpr double mass = 100.0;
+constexpr double total_energy = 125.0;
+constexpr int num_parts = 16;
+
+TEST_CASE("Diagnostics_histograms", "[Diagnostics_histograms]")
+{
+    Four_momentum fm(mass, total_energy);
+    Reference_particle ref(pconstants::proton_charge, fm);
+    Bunch bunch(ref, num_parts, 1e13, Commxx());
+
+    bunch.checkout_particles();
+    auto parts = bunch.get_host_particles();
+
+    // bin centers, away from the edges
+    for (int i = 0; i < num_parts; ++i) {
+        parts(i, 0) = 1.0e-3 * (i + 0.5);
+        parts(i, 1) = 0.0;
+        parts(i, 2) = -1.0e-3 * (i % 4 + 0.5);
+        parts(i, 3) = 0.0;
+        parts(i, 4) = 0.0;
+        parts(i, 5) = 0.0;
+    }
+
+    bunch.checkin_particles();
+
+    Diagnostics_histograms diag;
+    CHECK(diag.get_projections().size() == 4);
+
+    diag.clear_histograms();
+    diag.add_histogram_1d("x", Bunch::x, 4, 0.0, 8.0e-3);
+    diag.add_histogram_2d("x_y", Bunch::x, 2, Bunch::y, 2, 0, 4e-3, -4e-3, 0);
+    diag.add_histogram_1d("xp_auto", Bunch::xp, 3);
+
+    CHECK_THROWS(diag.add_histogram_1d("x", Bunch::x, 4));
+
+    diag.update(bunch);
+
+    CHECK_THROWS(diag.add_histogram_1d("y", Bunch::y, 4));
+
+    // 2 particles per bin, 8 above the range
+    auto hx = diag.get_histogram("x");
+    REQUIRE(hx.extent(0) == 4);
+    for (int i = 0; i < 4; ++i)
+        CHECK(hx(i) == 2.0);
+    CHECK(diag.get_outside("x") == 8.0);
+
+    // x in [0, 4e-3) are particles 0 to 3, with y = -0.5e-3 ... -3.5e-3
+    auto hxy = diag.get_histogram("x_y");
+    REQUIRE(hxy.extent(0) == 4);
+    CHECK(hxy(0 * 2 + 0) == 0.0);
+    CHECK(hxy(0 * 2 + 1) == 2.0);
+    CHECK(hxy(1 * 2 + 0) == 2.0);
+    CHECK(hxy(1 * 2 + 1) == 0.0);
+    CHECK(diag.get_outside("x_y") == 12.0);
+
+    // no spread in xp, all particles in the middle bin of a unit range
+    auto hxp = diag.get_histogram("xp_auto");
+    REQUIRE(hxp.extent(0) == 3);
+    CHECK(hxp(1) == num_parts);
+    CHECK(diag.get_outside("xp_auto") == 0.0);
+}
@@ -0,0 +1,186 @@
+#include "synergia/bunch/bunch.h"
+#include "synergia/foundation/physical_constants.h"
+#include "synergia/utils/catch.hpp"
+#include "synergia/utils/hdf5_file.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+constexpr double mass = 100.0;
+constexpr double total_energy = 125.0;
+constexpr int num_parts = 64;
+constexpr int num_turns = 3;
+constexpr int steps_per_turn = 2;
+constexpr int lost_per_step = 8;
+
+namespace {
+    // discards the particles beyond x = limit
+    struct X_aperture {
+        double limit;
+
+        template <class CP>
+        KOKKOS_INLINE_FUNCTION bool
+        discard(CP const& parts, ConstParticleMasks const&, int p) const
+        {
+            return parts(p, 0) > limit;
+        }
+    };
+
+    void
+    fill_particles(Bunch& bunch)
+    {
+        bunch.checkout_particles();
+        auto parts = bunch.get_host_particles();
+
+        for (int i = 0; i < num_parts; ++i) {
+            parts(i, 0) = 1.0e-3 * i;
+            parts(i, 1) = 1.0e-5 * i;
+            parts(i, 2) = -1.0e-3 * i;
+            parts(i, 3) = 2.0e-5 * i;
+            parts(i, 4) = 0.1 * i;
+            parts(i, 5) = 1.0e-4 * i;
+        }
+
+        bunch.checkin_particles();
+    }
+
+    double
+    aperture_limit(int step)
+    {
+        return 1.0e-3 * (num_parts - lost_per_step * (step + 1) - 0.5);
+    }
+
+    // loses lost_per_step particles at every step, with the turn end
+    // flushes of the bunch simulator
+    void
+    propagate(Bunch& bunch)
+    {
+        auto& ref = bunch.get_reference_particle();
+
+        for (int turn = 0; turn < num_turns; ++turn) {
+            for (int s = 0; s < steps_per_turn; ++s) {
+                int step = turn * steps_per_turn + s;
+                ref.increment_trajectory(1.0);
+
+                X_aperture ap{aperture_limit(step)};
+                bunch.apply_aperture(
+                    ap, ParticleGroup::regular, "ap" + std::to_string(s));
+            }
+
+            bunch.flush_diag_loss();
+            ref.start_repetition();
+        }
+
+        bunch.flush_diag_loss(true);
+    }
+
+    struct record_t {
+        std::vector<double> coords;
+        double s;
+        int repetition;
+        int element;
+    };
+}
+
+TEST_CASE("Diagnostics_loss buffered", "[Diagnostics_loss]")
+{
+    Four_momentum fm(mass, total_energy);
+    Reference_particle ref(pconstants::proton_charge, fm);
+
+    // the files are closed when the bunches go out of scope
+    {
+        Bunch unbuffered(ref, num_parts, 1e13, Commxx());
+        Bunch buffered(ref, num_parts, 1e13, Commxx());
+
+        fill_particles(unbuffered);
+        fill_particles(buffered);
+
+        unbuffered.set_diag_loss_aperture("diag_loss_unbuffered.h5");
+        buffered.set_diag_loss_aperture("diag_loss_buffered.h5", 2);
+
+        propagate(unbuffered);
+        propagate(buffered);
+
+        CHECK(unbuffered.get_local_num() ==
+              num_parts - num_turns * steps_per_turn * lost_per_step);
+        CHECK(buffered.get_local_num() == unbuffered.get_local_num());
+    }
+
+#ifndef SYNERGIA_HAVE_OPENPMD
+    // the unbuffered records, one dataset per step named after the s of
+    // the step
+    std::map<int, record_t> expected;
+
+    Hdf5_file unbuffered(
+        "diag_loss_unbuffered.h5", Hdf5_file::Flag::read_only, Commxx());
+
+    Reference_particle r(ref);
+
+    for (int turn = 0; turn < num_turns; ++turn) {
+        for (int s = 0; s < steps_per_turn; ++s) {
+            r.increment_trajectory(1.0);
+
+            auto coords = unbuffered.read<karray2d_row>(
+                "coordinates_" + std::to_string(r.get_s()));
+
+            int n = coords.extent(0);
+            REQUIRE(n == lost_per_step);
+
+            for (int i = 0; i < n; ++i) {
+                record_t rec;
+                for (int c = 0; c < 7; ++c)
+                    rec.coords.push_back(coords(i, c));
+
+                rec.s = r.get_s();
+                rec.repetition = r.get_repetition();
+                rec.element = s;
+
+                expected[(int)coords(i, Bunch::id)] = rec;
+            }
+        }
+
+        r.start_repetition();
+    }
+
+    int num_lost = num_turns * steps_per_turn * lost_per_step;
+    REQUIRE(expected.size() == size_t(num_lost));
+
+    // flush_turns = 2 over 3 turns: one flush after the second turn and
+    // one forced flush of the last turn
+    Hdf5_file buffered(
+        "diag_loss_buffered.h5", Hdf5_file::Flag::read_only, Commxx());
+
+    int found = 0;
+
+    for (int flush = 0; flush < 2; ++flush) {
+        auto suffix = "_" + std::to_string(flush);
+
+        auto coords = buffered.read<karray2d_row>("coordinates" + suffix);
+        auto info = buffered.read<karray2d_row>("loss_info" + suffix);
+
+        int n = coords.extent(0);
+        CHECK(n == (flush == 0 ? 4 : 2) * lost_per_step);
+        REQUIRE(info.extent(0) == coords.extent(0));
+
+        for (int i = 0; i < n; ++i) {
+            auto it = expected.find((int)coords(i, Bunch::id));
+            REQUIRE(it != expected.end());
+
+            auto const& rec = it->second;
+
+            for (int c = 0; c < 7; ++c)
+                CHECK(coords(i, c) == rec.coords[c]);
+
+            CHECK(info(i, Diagnostics_loss::info_s) == Approx(rec.s));
+            CHECK(info(i, Diagnostics_loss::info_repetition) ==
+                  rec.repetition);
+            CHECK(info(i, Diagnostics_loss::info_element) == rec.element);
+
+            ++found;
+        }
+    }
+
+    CHECK(found == num_lost);
+#endif
+}
@@ -0,0 +1,160 @@
+#include "synergia/bunch/diagnostics_tunes.h"
+#include "synergia/foundation/physical_constants.h"
+#include "synergia/utils/catch.hpp"
+
+#include <cmath>
+#include <sstream>
+
+constexpr double mass = 100.0;
+constexpr double total_energy = 125.0;
+constexpr int num_parts = 8;
+constexpr double tolerance = 1.0e-6;
+
+namespace {
+    constexpr auto pi = Kokkos::numbers::pi_v<double>;
+
+    // one turn of a linear lattice with the tune nu and the Courant-Snyder
+    // parameters alpha and beta
+    void
+    rotate(double& x, double& xp, double nu, double alpha, double beta)
+    {
+        double c = std::cos(2.0 * pi * nu);
+        double s = std::sin(2.0 * pi * nu);
+        double gamma = (1.0 + alpha * alpha) / beta;
+
+        double x1 = (c + alpha * s) * x + beta * s * xp;
+        double xp1 = -gamma * s * x + (c - alpha * s) * xp;
+
+        x = x1;
+        xp = xp1;
+    }
+
+    void
+    init_particles(Bunch& bunch)
+    {
+        bunch.checkout_particles();
+        auto parts = bunch.get_host_particles();
+
+        for (int i = 0; i < num_parts; ++i) {
+            parts(i, 0) = 1.0e-3 * (i + 1);
+            parts(i, 1) = 1.0e-4 * (i - 4);
+            parts(i, 2) = 2.0e-3 * (i + 1);
+            parts(i, 3) = 0.0;
+        }
+
+        bunch.checkin_particles();
+    }
+
+    void
+    one_turn(Bunch& bunch, double nux, double nuy)
+    {
+        bunch.checkout_particles();
+        auto parts = bunch.get_host_particles();
+
+        for (int i = 0; i < num_parts; ++i) {
+            rotate(parts(i, 0), parts(i, 1), nux, 0.5, 5.0);
+            rotate(parts(i, 2), parts(i, 3), nuy, -1.2, 12.0);
+        }
+
+        bunch.checkin_particles();
+    }
+}
+
+TEST_CASE("Diagnostics_tunes linear lattice", "[Diagnostics_tunes]")
+{
+    const double nux = 0.31;
+    const double nuy = 0.77;
+    const int window = 256;
+
+    Four_momentum fm(mass, total_energy);
+    Reference_particle ref(pconstants::proton_charge, fm);
+    Bunch bunch(ref, num_parts, 1e13, Commxx());
+
+    init_particles(bunch);
+
+    Diagnostics_tunes diag("diag_tunes.h5", num_parts, 0, window);
+
+    for (int turn = 0; turn < window; ++turn) {
+        diag.update(bunch);
+        CHECK(diag.flush_due(bunch) == (turn == window - 1));
+
+        one_turn(bunch, nux, nuy);
+    }
+
+    CHECK(diag.get_num_turns() == 0);
+
+    auto tunes = diag.get_tunes();
+    auto diffusion = diag.get_diffusion();
+
+    REQUIRE(tunes.extent(0) == num_parts);
+
+    for (int i = 0; i < num_parts; ++i) {
+        CHECK(tunes(i, 0) == Approx(nux).margin(tolerance));
+        CHECK(tunes(i, 1) == Approx(nuy).margin(tolerance));
+        CHECK(diffusion(i) < -5.0);
+    }
+}
+
+TEST_CASE("Diagnostics_tunes checkpoint", "[Diagnostics_tunes]")
+{
+    const double nux = 0.31;
+    const double nuy = 0.77;
+    const int window = 256;
+    const int checkpoint_turn = 100;
+
+    Four_momentum fm(mass, total_energy);
+    Reference_particle ref(pconstants::proton_charge, fm);
+    Bunch bunch(ref, num_parts, 1e13, Commxx());
+
+    init_particles(bunch);
+
+    Diagnostics_tunes uninterrupted("diag_tunes.h5", num_parts, 0, window);
+    Diagnostics_tunes saved("diag_tunes.h5", num_parts, 0, window);
+
+    for (int turn = 0; turn < checkpoint_turn; ++turn) {
+        uninterrupted.update(bunch);
+        saved.update(bunch);
+        one_turn(bunch, nux, nuy);
+    }
+
+    // the forced flush before the checkpoint keeps the partial window
+    CHECK(!saved.flush_due(bunch, true));
+    CHECK(saved.get_num_turns() == checkpoint_turn);
+
+    std::stringstream ss;
+    {
+        cereal::JSONOutputArchive ar(ss);
+        ar(saved);
+    }
+
+    Diagnostics_tunes resumed;
+    {
+        cereal::JSONInputArchive ar(ss);
+        ar(resumed);
+    }
+
+    CHECK(resumed.get_num_turns() == checkpoint_turn);
+
+    for (int turn = checkpoint_turn; turn < window; ++turn) {
+        uninterrupted.update(bunch);
+        resumed.update(bunch);
+
+        bool last = (turn == window - 1);
+        CHECK(uninterrupted.flush_due(bunch) == last);
+        CHECK(resumed.flush_due(bunch) == last);
+
+        one_turn(bunch, nux, nuy);
+    }
+
+    auto tu = uninterrupted.get_tunes();
+    auto tr = resumed.get_tunes();
+
+    REQUIRE(tr.extent(0) == num_parts);
+
+    for (int i = 0; i < num_parts; ++i) {
+        CHECK(tr(i, 0) == tu(i, 0));
+        CHECK(tr(i, 1) == tu(i, 1));
+        CHECK(tr(i, 0) == Approx(nux).margin(tolerance));
+        CHECK(tr(i, 1) == Approx(nuy).margin(tolerance));
+    }
+}
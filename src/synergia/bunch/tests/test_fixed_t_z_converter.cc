@@ -0,0 +1,93 @@
+#include "synergia/bunch/fixed_t_z_converter.h"
+#include "synergia/foundation/physical_constants.h"
+#include "synergia/utils/catch.hpp"
+
+constexpr double mass = 100.0;
+constexpr double total_energy = 125.0;
+constexpr int num_parts = 16;
+constexpr double tolerance = 1.0e-12;
+
+namespace {
+    Bunch
+    make_bunch()
+    {
+        Four_momentum fm(mass, total_energy);
+        Reference_particle ref(pconstants::proton_charge, fm);
+        Bunch bunch(ref, num_parts, 1e13, Commxx());
+
+        bunch.checkout_particles();
+        auto parts = bunch.get_host_particles();
+
+        for (int i = 0; i < num_parts; ++i) {
+            parts(i, 0) = 1.0e-3 * i;
+            parts(i, 1) = 1.0e-4 * (i - 8);
+            parts(i, 2) = -2.0e-3 * i;
+            parts(i, 3) = 2.0e-4 * (8 - i);
+            parts(i, 4) = 1.0e-2 * (i - 8);
+            parts(i, 5) = 1.0e-4 * (i - 4);
+        }
+
+        bunch.checkin_particles();
+        return bunch;
+    }
+
+    void
+    check_same(Bunch& b1, Bunch& b2)
+    {
+        b1.checkout_particles();
+        b2.checkout_particles();
+
+        auto p1 = b1.get_host_particles();
+        auto p2 = b2.get_host_particles();
+
+        for (int i = 0; i < num_parts; ++i) {
+            for (int j = 0; j < 6; ++j) {
+                CHECK(p1(i, j) == Approx(p2(i, j)).margin(tolerance));
+            }
+        }
+    }
+}
+
+TEST_CASE("Fixed_t_z_zeroth lab round trip", "[Fixed_t_z_converter]")
+{
+    auto bunch = make_bunch();
+    auto orig = make_bunch();
+
+    Fixed_t_z_zeroth converter;
+
+    converter.from_z_lab_to_t_lab(bunch);
+
+    bunch.checkout_particles();
+    auto parts = bunch.get_host_particles();
+    double beta = bunch.get_reference_particle().get_beta();
+
+    // z = -beta cdt
+    CHECK(parts(3, 4) == Approx(-beta * 1.0e-2 * (3 - 8)).margin(tolerance));
+
+    converter.from_t_lab_to_z_lab(bunch);
+    check_same(bunch, orig);
+}
+
+TEST_CASE("Fixed_t_z_zeroth bunch round trip", "[Fixed_t_z_converter]")
+{
+    auto bunch = make_bunch();
+    auto orig = make_bunch();
+
+    Fixed_t_z_zeroth converter;
+
+    converter.from_z_lab_to_t_bunch(bunch);
+    converter.from_t_bunch_to_z_lab(bunch);
+    check_same(bunch, orig);
+}
+
+TEST_CASE("Fixed_t_z_zeroth negative pz^2", "[Fixed_t_z_converter]")
+{
+    auto bunch = make_bunch();
+
+    bunch.checkout_particles();
+    bunch.get_host_particles()(5, 1) = 2.0;
+    bunch.checkin_particles();
+
+    Fixed_t_z_zeroth converter;
+    CHECK_THROWS_AS(converter.from_z_lab_to_t_lab(bunch), std::runtime_error);
+}
@@ -18,7 +18,32 @@ PYBIND11_MODULE(collective, m)
          "gridz"_a)
     .def_readwrite("comm_group_size",
                    &Space_charge_2d_open_hockney_options::comm_group_size,
-                   "Communication group size (must be 1 on GPUs).");
+                   "Communication group size (must be 1 on GPUs).")
+    .def_readwrite(
+      "domain_centroid_tolerance",
+      &Space_charge_2d_open_hockney_options::domain_centroid_tolerance,
+      "Rebuild the domain when the centroid has moved by more "
+      "than this fraction of the domain size (default 0).")
+    .def_readwrite("domain_size_tolerance",
+                   &Space_charge_2d_open_hockney_options::domain_size_tolerance,
+                   "Rebuild the domain when the beam size has changed by "
+                   "more than this relative amount (default 0).")
+    .def_readwrite("slice_parallel",
+                   &Space_charge_2d_open_hockney_options::slice_parallel,
+                   "Solve the transverse field of each z slice with its "
+                   "own charge, slices distributed over the ranks "
+                   "(default false).")
+    .def_readwrite("periodic_z",
+                   &Space_charge_2d_open_hockney_options::periodic_z,
+                   "Periodic longitudinal boundary (slice_parallel only).")
+    .def_readwrite("z_period",
+                   &Space_charge_2d_open_hockney_options::z_period,
+                   "Longitudinal period in c*dt (slice_parallel only).")
+    .def_readwrite(
+      "grid_entire_period",
+      &Space_charge_2d_open_hockney_options::grid_entire_period,
+      "Grid the whole z_period instead of the bunch "
+      "(slice_parallel only).");
 
   py::class_<Space_charge_3d_open_hockney_options>(
     m, "Space_charge_3d_open_hockney_options")
@@ -29,7 +54,16 @@ PYBIND11_MODULE(collective, m)
          "gridz"_a)
     .def_readwrite("comm_group_size",
                    &Space_charge_3d_open_hockney_options::comm_group_size,
-                   "Communication group size (must be 1 on GPUs).");
+                   "Communication group size (must be 1 on GPUs).")
+    .def_readwrite(
+      "domain_centroid_tolerance",
+      &Space_charge_3d_open_hockney_options::domain_centroid_tolerance,
+      "Rebuild the domain when the centroid has moved by more "
+      "than this fraction of the domain size (default 0).")
+    .def_readwrite("domain_size_tolerance",
+                   &Space_charge_3d_open_hockney_options::domain_size_tolerance,
+                   "Rebuild the domain when the beam size has changed by "
+                   "more than this relative amount (default 0).");
 
 #ifdef BUILD_FD_SPACE_CHARGE_SOLVER
   py::class_<Space_charge_3d_fd_options>(m, "Space_charge_3d_fd_options")
@@ -40,9 +74,52 @@ PYBIND11_MODULE(collective, m)
          "gridz"_a)
     .def_readwrite("comm_group_size",
                    &Space_charge_3d_fd_options::comm_group_size,
-                   "Communication group size (must be 1 on GPUs).");
+                   "Communication group size (must be 1 on GPUs).")
+    .def_readwrite("warm_start",
+                   &Space_charge_3d_fd_options::warm_start,
+                   "Start each solve from the previous potential "
+                   "interpolated onto the new domain (default false).")
+    .def_readwrite("matrix_free",
+                   &Space_charge_3d_fd_options::matrix_free,
+                   "Use a matrix-free stencil operator with geometric "
+                   "multigrid (default false). Grid sizes must be of the "
+                   "form k*2^n+1.")
+    .def_readwrite("mg_levels",
+                   &Space_charge_3d_fd_options::mg_levels,
+                   "Maximum number of multigrid levels (default 3).");
 #endif
 
+  py::enum_<LongitudinalDistribution>(m, "LongitudinalDistribution")
+    .value("gaussian", LongitudinalDistribution::gaussian)
+    .value("uniform", LongitudinalDistribution::uniform);
+
+  py::class_<Space_charge_2d_bassetti_erskine_options>(
+    m, "Space_charge_2d_bassetti_erskine_options")
+    .def(py::init<>(),
+         "Construct the space charge 2d Bassetti-Erskine (transverse "
+         "gaussian) operator.")
+    .def_readwrite(
+      "longitudinal_distribution",
+      &Space_charge_2d_bassetti_erskine_options::longitudinal_distribution,
+      "Longitudinal line charge density (uniform or gaussian).")
+    .def_readwrite("strictly_centered",
+                   &Space_charge_2d_bassetti_erskine_options::strictly_centered,
+                   "Center the field on the reference orbit instead of the "
+                   "bunch centroid.")
+    .def_readwrite("frozen_sigma",
+                   &Space_charge_2d_bassetti_erskine_options::frozen_sigma,
+                   "Use fixed rms sizes instead of the bunch moments.")
+    .def_readwrite("sigma_x",
+                   &Space_charge_2d_bassetti_erskine_options::sigma_x,
+                   "Frozen rms x size [m], 0 to take it from the first kick.")
+    .def_readwrite("sigma_y",
+                   &Space_charge_2d_bassetti_erskine_options::sigma_y,
+                   "Frozen rms y size [m], 0 to take it from the first kick.")
+    .def_readwrite(
+      "sigma_cdt",
+      &Space_charge_2d_bassetti_erskine_options::sigma_cdt,
+      "Frozen rms cdt size [m], 0 to take it from the first kick.");
+
   py::class_<Space_charge_rectangular_options>(
     m, "Space_charge_rectangular_options")
     .def(py::init<std::array<int, 3> const&, std::array<double, 3> const&>(),
@@ -305,11 +305,79 @@ namespace deposit_impl {
         }
     };
 
-    // use scatter view
-    struct sv_zyx_rho_reducer_non_periodic {
+    // transverse charge of the z slices, real [z][x][y]. The particle is
+    // shared linearly between the two nearest slices (wrapped around
+    // with periodic_z), and the bins are kept for the kick
+    struct sv_slices_rho_reducer {
         ConstParticles p;
         ConstParticleMasks masks;
 
+        scatter_t scatter;
+        karray2d_dev bin;
+        int gx, gy, gz;
+        double ihx, ihy, ihz;
+        double lx, ly, lz;
+        double w0;
+        bool periodic_z;
+
+        KOKKOS_INLINE_FUNCTION
+        void
+        operator()(const int i) const
+        {
+            if (!masks(i)) return;
+
+            int ix, iy, iz;
+            double offx, offy, offz;
+
+            get_leftmost_indices_offset(p(i, 0), lx, ihx, ix, offx);
+            get_leftmost_indices_offset(p(i, 2), ly, ihy, iy, offy);
+            get_leftmost_indices_offset(p(i, 4), lz, ihz, iz, offz);
+
+            bin(i, 0) = ix;
+            bin(i, 1) = offx;
+            bin(i, 2) = iy;
+            bin(i, 3) = offy;
+            bin(i, 4) = iz;
+            bin(i, 5) = offz;
+
+            if (ix < 0 || ix >= gx - 1 || iy < 0 || iy >= gy - 1) return;
+
+            int iz1 = iz;
+            int iz2 = iz + 1;
+
+            if (periodic_z) {
+                iz1 = ((iz1 % gz) + gz) % gz;
+                iz2 = ((iz2 % gz) + gz) % gz;
+            }
+
+            auto access = scatter.access();
+
+            double aoffx = 1.0 - offx;
+            double aoffy = 1.0 - offy;
+
+            double wz[2] = {w0 * (1.0 - offz), w0 * offz};
+            int cz[2] = {iz1, iz2};
+
+            for (int k = 0; k < 2; ++k) {
+                if (cz[k] < 0 || cz[k] >= gz) continue;
+
+                int base = (cz[k] * gx + ix) * gy + iy;
+
+                access(base) += wz[k] * aoffx * aoffy;
+                access(base + 1) += wz[k] * aoffx * offy;
+                access(base + gy) += wz[k] * offx * aoffy;
+                access(base + gy + 1) += wz[k] * offx * offy;
+            }
+        }
+    };
+
+    // use scatter view. The particle array can be either of double or
+    // single precision, the charge is always accumulated in double
+    template <class CP = ConstParticles>
+    struct sv_zyx_rho_reducer_non_periodic {
+        CP p;
+        ConstParticleMasks masks;
+
         scatter_t scatter;
 
         int gx, gy, gz; // original grid size
@@ -318,7 +386,7 @@ namespace deposit_impl {
         double lx, ly, lz;
         double w0;
 
-        sv_zyx_rho_reducer_non_periodic(ConstParticles const& p,
+        sv_zyx_rho_reducer_non_periodic(CP const& p,
                                         ConstParticleMasks const& masks,
                                         scatter_t const& scatter,
                                         std::array<int, 3> const& g,
@@ -393,6 +461,55 @@ namespace deposit_impl {
         }
     };
 
+    // wraps a deposit functor to also accumulate the particle count, the
+    // sums and the sums of squares of x, y, z in the same pass
+    template <class F, class CP = ConstParticles>
+    struct with_moments {
+        typedef double value_type[];
+
+        const int value_count = 7;
+        F f;
+        CP p;
+        ConstParticleMasks masks;
+
+        KOKKOS_INLINE_FUNCTION
+        void
+        operator()(const int i, value_type sum) const
+        {
+            f(i);
+
+            if (masks(i)) {
+                double x = p(i, 0);
+                double y = p(i, 2);
+                double z = p(i, 4);
+
+                sum[0] += 1.0;
+                sum[1] += x;
+                sum[2] += y;
+                sum[3] += z;
+                sum[4] += x * x;
+                sum[5] += y * y;
+                sum[6] += z * z;
+            }
+        }
+    };
+
+    template <class F, class CP>
+    void
+    run_deposit(int nparts,
+                F const& f,
+                CP const& p,
+                ConstParticleMasks const& masks,
+                karray1d* moments)
+    {
+        if (moments) {
+            with_moments<F, CP> fm{7, f, p, masks};
+            Kokkos::parallel_reduce(nparts, fm, *moments);
+        } else {
+            Kokkos::parallel_for(nparts, f);
+        }
+    }
+
     // use scatter view
     struct sv_xyz_rho_reducer_non_periodic {
         ConstParticles p;
@@ -548,9 +665,11 @@ deposit_charge_rectangular_2d_kokkos_scatter_view(
     karray1d_dev& rho_dev,
     Rectangular_grid_domain& domain,
     karray2d_dev& particle_bin,
-    Bunch const& bunch)
+    Bunch const& bunch,
+    karray1d* moments)
 {
     using deposit_impl::rho_zeroer;
+    using deposit_impl::run_deposit;
     using deposit_impl::sv_rho_reducer;
 
     auto g = domain.get_grid_shape();
@@ -579,38 +698,41 @@ deposit_charge_rectangular_2d_kokkos_scatter_view(
         rho_dev);
 
     sv_rho_reducer rr(parts, masks, scatter, particle_bin, g, h, l, weight0);
-    Kokkos::parallel_for(nparts, rr);
+    run_deposit(nparts, rr, parts, masks, moments);
     Kokkos::Experimental::contribute(rho_dev, scatter);
 
     Kokkos::fence();
 }
 
 void
-deposit_charge_rectangular_3d_kokkos_scatter_view(
+deposit_charge_rectangular_2d_slices_kokkos_scatter_view(
     karray1d_dev& rho_dev,
     Rectangular_grid_domain& domain,
-    std::array<int, 3> const& dims,
-    Bunch const& bunch)
+    karray2d_dev& particle_bin,
+    bool periodic_z,
+    Bunch const& bunch,
+    karray1d* moments)
 {
-    using namespace deposit_impl;
+    using deposit_impl::rho_zeroer;
+    using deposit_impl::run_deposit;
+    using deposit_impl::scatter_t;
+    using deposit_impl::sv_slices_rho_reducer;
 
     auto g = domain.get_grid_shape();
     auto h = domain.get_cell_size();
     auto l = domain.get_left();
 
-    // g[0] (nx) needs to be padded to (2*(g[0]/2+1))
-    // int padded_gx = Distributed_fft3d::get_padded_shape_real(g[0]);
-
     auto parts = bunch.get_local_particles();
     auto masks = bunch.get_local_particle_masks();
     int nparts = bunch.size();
 
     double weight0 = (bunch.get_real_num() / bunch.get_total_num()) *
                      bunch.get_particle_charge() * pconstants::e /
-                     (h[0] * h[1] * h[2]);
+                     (h[0] * h[1]);
 
-    if (rho_dev.extent(0) < g[0] * g[1] * g[2])
-        throw std::runtime_error("insufficient size for rho in deposit charge");
+    // double[z][x][y]
+    if (rho_dev.extent(0) != g[0] * g[1] * g[2])
+        throw std::runtime_error("wrong size for rho in deposit charge");
 
     // zero first
     rho_zeroer rz{rho_dev};
@@ -619,15 +741,99 @@ deposit_charge_rectangular_3d_kokkos_scatter_view(
 
     // deposit
     scatter_t scatter(rho_dev);
-    sv_zyx_rho_reducer_non_periodic rr(
-        parts, masks, scatter, g, dims, h, l, weight0);
 
-    Kokkos::parallel_for(nparts, rr);
+    sv_slices_rho_reducer rr{parts,
+                             masks,
+                             scatter,
+                             particle_bin,
+                             g[0],
+                             g[1],
+                             g[2],
+                             1.0 / h[0],
+                             1.0 / h[1],
+                             1.0 / h[2],
+                             l[0],
+                             l[1],
+                             l[2],
+                             weight0,
+                             periodic_z};
+
+    run_deposit(nparts, rr, parts, masks, moments);
     Kokkos::Experimental::contribute(rho_dev, scatter);
 
     Kokkos::fence();
 }
 
+namespace {
+    // double and single precision bunches
+    template <class BUNCH>
+    void
+    deposit_3d_scatter_view(karray1d_dev& rho_dev,
+                            Rectangular_grid_domain& domain,
+                            std::array<int, 3> const& dims,
+                            BUNCH const& bunch,
+                            karray1d* moments)
+    {
+        using namespace deposit_impl;
+
+        auto g = domain.get_grid_shape();
+        auto h = domain.get_cell_size();
+        auto l = domain.get_left();
+
+        // g[0] (nx) needs to be padded to (2*(g[0]/2+1))
+        // int padded_gx = Distributed_fft3d::get_padded_shape_real(g[0]);
+
+        auto parts = bunch.get_local_particles();
+        auto masks = bunch.get_local_particle_masks();
+        int nparts = bunch.size();
+
+        double weight0 = (bunch.get_real_num() / bunch.get_total_num()) *
+                         bunch.get_particle_charge() * pconstants::e /
+                         (h[0] * h[1] * h[2]);
+
+        if (rho_dev.extent(0) < g[0] * g[1] * g[2])
+            throw std::runtime_error(
+                "insufficient size for rho in deposit charge");
+
+        // zero first
+        rho_zeroer rz{rho_dev};
+        Kokkos::parallel_for(rho_dev.extent(0), rz);
+        Kokkos::fence();
+
+        // deposit
+        scatter_t scatter(rho_dev);
+        sv_zyx_rho_reducer_non_periodic rr(
+            parts, masks, scatter, g, dims, h, l, weight0);
+
+        run_deposit(nparts, rr, parts, masks, moments);
+        Kokkos::Experimental::contribute(rho_dev, scatter);
+
+        Kokkos::fence();
+    }
+}
+
+void
+deposit_charge_rectangular_3d_kokkos_scatter_view(
+    karray1d_dev& rho_dev,
+    Rectangular_grid_domain& domain,
+    std::array<int, 3> const& dims,
+    Bunch const& bunch,
+    karray1d* moments)
+{
+    deposit_3d_scatter_view(rho_dev, domain, dims, bunch, moments);
+}
+
+void
+deposit_charge_rectangular_3d_kokkos_scatter_view(
+    karray1d_dev& rho_dev,
+    Rectangular_grid_domain& domain,
+    std::array<int, 3> const& dims,
+    BunchF const& bunch,
+    karray1d* moments)
+{
+    deposit_3d_scatter_view(rho_dev, domain, dims, bunch, moments);
+}
+
 void
 deposit_charge_rectangular_3d_kokkos_scatter_view_xyz(
     karray1d_dev& rho_dev,
@@ -676,7 +882,8 @@ void
 deposit_charge_rectangular_2d_omp_reduce(karray1d_dev& rho_dev,
                                          Rectangular_grid_domain& domain,
                                          karray2d_dev& bin,
-                                         Bunch const& bunch)
+                                         Bunch const& bunch,
+                                         karray1d* moments)
 {
     using namespace deposit_impl;
 
@@ -737,6 +944,9 @@ deposit_charge_rectangular_2d_omp_reduce(karray1d_dev& rho_dev,
     double ihy = 1.0 / h[1];
     double ihz = 1.0 / h[2];
 
+    // moments of the local particles, see deposit.h
+    double m0 = 0, mx = 0, my = 0, mz = 0, mxx = 0, myy = 0, mzz = 0;
+
 #pragma omp parallel shared(npart,                                             \
                             parts,                                             \
                             masks,                                             \
@@ -753,7 +963,8 @@ deposit_charge_rectangular_2d_omp_reduce(karray1d_dev& rho_dev,
                             gz,                                                \
                             rl,                                                \
                             nc,                                                \
-                            rho_dev)
+                            rho_dev)                                           \
+    reduction(+ : m0, mx, my, mz, mxx, myy, mzz)
     {
         int nt = omp_get_num_threads();
         int it = omp_get_thread_num();
@@ -772,6 +983,14 @@ deposit_charge_rectangular_2d_omp_reduce(karray1d_dev& rho_dev,
         for (int n = ps; n < pe; ++n) {
             if (!masks(n)) continue;
 
+            m0 += 1.0;
+            mx += parts(n, 0);
+            my += parts(n, 2);
+            mz += parts(n, 4);
+            mxx += parts(n, 0) * parts(n, 0);
+            myy += parts(n, 2) * parts(n, 2);
+            mzz += parts(n, 4) * parts(n, 4);
+
             get_leftmost_indices_offset(parts(n, 0), lx, ihx, ix, ox);
             get_leftmost_indices_offset(parts(n, 2), ly, ihy, iy, oy);
             get_leftmost_indices_offset(parts(n, 4), lz, ihz, iz, oz);
@@ -847,13 +1066,20 @@ deposit_charge_rectangular_2d_omp_reduce(karray1d_dev& rho_dev,
 #pragma omp barrier
 
     } //  end of #pragma parallel
+
+    if (moments) {
+        double m[7] = {m0, mx, my, mz, mxx, myy, mzz};
+        for (int j = 0; j < 7; ++j)
+            (*moments)(j) = m[j];
+    }
 }
 
 void
 deposit_charge_rectangular_3d_omp_reduce(karray1d_dev& rho_dev,
                                          Rectangular_grid_domain& domain,
                                          std::array<int, 3> const& dims,
-                                         Bunch const& bunch)
+                                         Bunch const& bunch,
+                                         karray1d* moments)
 {
     using namespace deposit_impl;
 
@@ -919,6 +1145,9 @@ deposit_charge_rectangular_3d_omp_reduce(karray1d_dev& rho_dev,
     double ihy = 1.0 / h[1];
     double ihz = 1.0 / h[2];
 
+    // moments of the local particles, see deposit.h
+    double m0 = 0, mx = 0, my = 0, mz = 0, mxx = 0, myy = 0, mzz = 0;
+
 #pragma omp parallel shared(npart,                                             \
                             parts,                                             \
                             masks,                                             \
@@ -937,7 +1166,8 @@ deposit_charge_rectangular_3d_omp_reduce(karray1d_dev& rho_dev,
                             dz,                                                \
                             rl,                                                \
                             nc,                                                \
-                            rho_dev)
+                            rho_dev)                                           \
+    reduction(+ : m0, mx, my, mz, mxx, myy, mzz)
     {
         int nt = omp_get_num_threads();
         int it = omp_get_thread_num();
@@ -956,6 +1186,14 @@ deposit_charge_rectangular_3d_omp_reduce(karray1d_dev& rho_dev,
         for (int n = ps; n < pe; ++n) {
             if (!masks(n)) continue;
 
+            m0 += 1.0;
+            mx += parts(n, 0);
+            my += parts(n, 2);
+            mz += parts(n, 4);
+            mxx += parts(n, 0) * parts(n, 0);
+            myy += parts(n, 2) * parts(n, 2);
+            mzz += parts(n, 4) * parts(n, 4);
+
             get_leftmost_indices_offset(parts(n, 0), lx, ihx, ix, ox);
             get_leftmost_indices_offset(parts(n, 2), ly, ihy, iy, oy);
             get_leftmost_indices_offset(parts(n, 4), lz, ihz, iz, oz);
@@ -1028,6 +1266,12 @@ deposit_charge_rectangular_3d_omp_reduce(karray1d_dev& rho_dev,
 #pragma omp barrier
 
     } //  end of #pragma parallel
+
+    if (moments) {
+        double m[7] = {m0, mx, my, mz, mxx, myy, mzz};
+        for (int j = 0; j < 7; ++j)
+            (*moments)(j) = m[j];
+    }
 }
 
 void
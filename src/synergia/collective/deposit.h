@@ -4,6 +4,11 @@
 #include "synergia/bunch/bunch.h"
 #include "synergia/collective/rectangular_grid_domain.h"
 
+// The deposit functions taking an optional moments array also accumulate
+// the particle count, the sums and the sums of squares of the local
+// x, y, z coordinates during the deposition pass (7 values, see
+// Domain_tracker), so no separate pass is needed for the statistics.
+
 karray1d_dev deposit_charge_rectangular_2d_kokkos(
     Rectangular_grid_domain& domain,
     karray2d_dev& particle_bin,
@@ -18,13 +23,33 @@ void deposit_charge_rectangular_2d_kokkos_scatter_view(
     karray1d_dev& rho_dev,
     Rectangular_grid_domain& domain,
     karray2d_dev& particle_bin,
-    Bunch const& bunch);
+    Bunch const& bunch,
+    karray1d* moments = nullptr);
+
+// real charge density of each z slice of the domain, in [z][x][y]
+// order, for the slice parallel 2.5d solver
+void deposit_charge_rectangular_2d_slices_kokkos_scatter_view(
+    karray1d_dev& rho_dev,
+    Rectangular_grid_domain& domain,
+    karray2d_dev& particle_bin,
+    bool periodic_z,
+    Bunch const& bunch,
+    karray1d* moments = nullptr);
 
 void deposit_charge_rectangular_3d_kokkos_scatter_view(
     karray1d_dev& rho_dev,
     Rectangular_grid_domain& domain,
     std::array<int, 3> const& dims,
-    Bunch const& bunch);
+    Bunch const& bunch,
+    karray1d* moments = nullptr);
+
+// single precision particles, deposited in double
+void deposit_charge_rectangular_3d_kokkos_scatter_view(
+    karray1d_dev& rho_dev,
+    Rectangular_grid_domain& domain,
+    std::array<int, 3> const& dims,
+    BunchF const& bunch,
+    karray1d* moments = nullptr);
 
 void deposit_charge_rectangular_3d_kokkos_scatter_view_xyz(
     karray1d_dev& rho_dev,
@@ -39,12 +64,14 @@ void deposit_charge_rectangular_3d_kokkos_scatter_view_xyz(
 void deposit_charge_rectangular_2d_omp_reduce(karray1d_dev& rho_dev,
                                               Rectangular_grid_domain& domain,
                                               karray2d_dev& bin,
-                                              Bunch const& bunch);
+                                              Bunch const& bunch,
+                                              karray1d* moments = nullptr);
 
 void deposit_charge_rectangular_3d_omp_reduce(karray1d_dev& rho_dev,
                                               Rectangular_grid_domain& domain,
                                               std::array<int, 3> const& dims,
-                                              Bunch const& bunch);
+                                              Bunch const& bunch,
+                                              karray1d* moments = nullptr);
 
 void deposit_charge_rectangular_3d_omp_reduce_xyz(
     karray1d_dev& rho_dev,
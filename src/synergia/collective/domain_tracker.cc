@@ -0,0 +1,123 @@
+#include <cmath>
+
+#include "domain_tracker.h"
+
+#include "synergia/bunch/core_diagnostics.h"
+
+Domain_tracker::Domain_tracker(double centroid_tolerance,
+                               double size_tolerance)
+    : centroid_tolerance(centroid_tolerance)
+    , size_tolerance(size_tolerance)
+    , moments("domain_moments", num_moments)
+    , request(MPI_REQUEST_NULL)
+    , pending(false)
+    , have_moments(false)
+    , valid(false)
+    , offset{0.0, 0.0, 0.0}
+    , size{0.0, 0.0, 0.0}
+    , changed(false)
+    , revision(0)
+{}
+
+Domain_tracker::Domain_tracker(Domain_tracker const& o)
+    : centroid_tolerance(o.centroid_tolerance)
+    , size_tolerance(o.size_tolerance)
+    , moments("domain_moments", num_moments)
+    , request(MPI_REQUEST_NULL)
+    , pending(false)
+    , have_moments(false)
+    , valid(o.valid)
+    , offset(o.offset)
+    , size(o.size)
+    , changed(o.changed)
+    , revision(o.revision)
+{
+    if (o.pending)
+        throw std::runtime_error(
+            "Domain_tracker: cannot copy with a pending reduction");
+}
+
+Domain_tracker::~Domain_tracker()
+{
+    if (pending) MPI_Wait(&request, MPI_STATUS_IGNORE);
+}
+
+void
+Domain_tracker::start_reduce(Bunch const& bunch)
+{
+    if (!hysteresis()) return;
+
+    if (pending) MPI_Wait(&request, MPI_STATUS_IGNORE);
+
+    int err = MPI_Iallreduce(MPI_IN_PLACE,
+                             moments.data(),
+                             num_moments,
+                             MPI_DOUBLE,
+                             MPI_SUM,
+                             bunch.get_comm(),
+                             &request);
+
+    if (err != MPI_SUCCESS) {
+        throw std::runtime_error(
+            "MPI error in Domain_tracker (MPI_Iallreduce in start_reduce)");
+    }
+
+    pending = true;
+}
+
+std::array<double, 6>
+Domain_tracker::get_mean_stddev(Bunch const& bunch)
+{
+    if (pending) {
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+        pending = false;
+        have_moments = true;
+    }
+
+    std::array<double, 6> ms;
+
+    if (have_moments && moments(0) > 0) {
+        double n = moments(0);
+
+        for (int j = 0; j < 3; ++j) {
+            double mean = moments(j + 1) / n;
+            double var = moments(j + 4) / n - mean * mean;
+
+            ms[j] = mean;
+            ms[j + 3] = std::sqrt(var > 0.0 ? var : 0.0);
+        }
+    } else {
+        auto mean_stddev =
+            Core_diagnostics::calculate_spatial_mean_stddev(bunch);
+
+        for (int j = 0; j < 6; ++j)
+            ms[j] = mean_stddev(j);
+    }
+
+    have_moments = false;
+    return ms;
+}
+
+bool
+Domain_tracker::update(std::array<double, 3> const& new_offset,
+                       std::array<double, 3> const& new_size)
+{
+    changed = !valid;
+
+    for (int i = 0; i < 3 && !changed; ++i) {
+        double drift = std::abs(new_offset[i] - offset[i]);
+        double scale = std::abs(new_size[i] / size[i] - 1.0);
+
+        if (drift > centroid_tolerance * size[i] || scale > size_tolerance)
+            changed = true;
+    }
+
+    if (changed) {
+        offset = new_offset;
+        size = new_size;
+        valid = true;
+        ++revision;
+    }
+
+    return changed;
+}
@@ -0,0 +1,107 @@
+#ifndef DOMAIN_TRACKER_H_
+#define DOMAIN_TRACKER_H_
+
+#include <array>
+
+#include "synergia/bunch/bunch.h"
+#include "synergia/utils/kokkos_views.h"
+
+/// Domain_tracker keeps the space charge grid domain of a bunch fixed
+/// until the beam centroid has moved by more than centroid_tolerance
+/// times the domain size, or the beam size has changed by more than the
+/// relative size_tolerance, in any of the three directions. With both
+/// tolerances at 0 (default) the domain follows the beam on every kick.
+///
+/// With hysteresis enabled the beam statistics are accumulated by the
+/// charge deposition (see deposit.h) and reduced with a non-blocking
+/// allreduce completed at the next kick, so the domain decision lags by
+/// one kick but costs no extra particle pass and no blocking collective.
+///
+/// The revision number is incremented every time the domain changes, so
+/// the solvers can keep data derived from the domain (e.g. the Green's
+/// function) while it stays unchanged.
+class Domain_tracker {
+  public:
+    // layout of the moments array
+    constexpr static const int num_moments = 7;
+
+  private:
+    double centroid_tolerance;
+    double size_tolerance;
+
+    // count, sums and sums of squares of x, y, z
+    karray1d moments;
+    MPI_Request request;
+    bool pending;
+    bool have_moments;
+
+    bool valid;
+    std::array<double, 3> offset;
+    std::array<double, 3> size;
+
+    bool changed;
+    int revision;
+
+  public:
+    Domain_tracker(double centroid_tolerance = 0.0,
+                   double size_tolerance = 0.0);
+
+    // only the trackers without a pending reduction can be copied
+    Domain_tracker(Domain_tracker const& o);
+
+    ~Domain_tracker();
+
+    bool
+    hysteresis() const
+    {
+        return centroid_tolerance > 0.0 || size_tolerance > 0.0;
+    }
+
+    /// buffer to be filled by the deposition, nullptr when the statistics
+    /// are not gathered during the deposition
+    karray1d*
+    deposit_moments()
+    {
+        return hysteresis() ? &moments : nullptr;
+    }
+
+    /// start the reduction of the deposited moments over the bunch comm
+    void start_reduce(Bunch const& bunch);
+
+    /// spatial mean (0-2) and standard deviation (3-5) of the bunch, from
+    /// the moments of the last deposition when available, otherwise from
+    /// a separate pass over the particles
+    std::array<double, 6> get_mean_stddev(Bunch const& bunch);
+
+    /// propose the domain for the current beam. Returns true if it has
+    /// been adopted, i.e. the domain has changed
+    bool update(std::array<double, 3> const& offset,
+                std::array<double, 3> const& size);
+
+    /// whether the last update has changed the domain
+    bool
+    domain_changed() const
+    {
+        return changed;
+    }
+
+    int
+    get_revision() const
+    {
+        return revision;
+    }
+
+    std::array<double, 3> const&
+    get_offset() const
+    {
+        return offset;
+    }
+
+    std::array<double, 3> const&
+    get_size() const
+    {
+        return size;
+    }
+};
+
+#endif /* DOMAIN_TRACKER_H_ */
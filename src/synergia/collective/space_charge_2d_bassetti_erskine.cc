@@ -0,0 +1,272 @@
+#include "space_charge_2d_bassetti_erskine.h"
+
+#include "synergia/bunch/core_diagnostics.h"
+#include "synergia/foundation/physical_constants.h"
+
+#include "synergia/utils/complex_error_function.h"
+#include "synergia/utils/simple_timer.h"
+
+namespace {
+    // relative difference of the rms sizes below which the beam is
+    // treated as round
+    const double round_tolerance = 1.0e-6;
+
+    // "normalized" electric field of a unit transverse gaussian charge
+    // distribution in the rest frame of the bunch, in inverse meters. To
+    // get the field [V/m], this must be multiplied by Q/(4 pi epsilon_o),
+    // where Q is the line density of charge [C/m]. This is the same
+    // normalization as the unit field in Space_charge_2d_kv, which goes
+    // to 2/r far from the beam.
+    //
+    // For sigma_a > sigma_b along the (u, v) axes, with v >= 0,
+    //
+    //   E_v + i E_u = 2 sqrt(pi)/S * [ w((u + iv)/S) - exp(-u^2/(2 sigma_a^2)
+    //                 - v^2/(2 sigma_b^2)) w((u r + iv/r)/S) ],
+    //
+    // where r = sigma_b/sigma_a, S = sqrt(2 (sigma_a^2 - sigma_b^2)) and
+    // w is the Faddeeva function. The field for v < 0 follows from the
+    // symmetry of the distribution.
+    struct gaussian_field {
+        bool round;
+        bool swap; // major axis is y
+        double r;
+        double is;
+        double coef;
+        double ia2;
+        double ib2;
+
+        gaussian_field(double sigma_x, double sigma_y)
+        {
+            swap = sigma_y > sigma_x;
+
+            double sa = swap ? sigma_y : sigma_x;
+            double sb = swap ? sigma_x : sigma_y;
+
+            round = (sa - sb) < round_tolerance * (sa + sb);
+
+            if (round) {
+                sa = 0.5 * (sa + sb);
+                sb = sa;
+            }
+
+            r = sb / sa;
+            is = round ? 0.0 : 1.0 / sqrt(2.0 * (sa * sa - sb * sb));
+            coef = 2.0 * sqrt(Kokkos::numbers::pi_v<double>) * is;
+            ia2 = 0.5 / (sa * sa);
+            ib2 = 0.5 / (sb * sb);
+        }
+
+        // T is double or GSVector
+        template <class T>
+        KOKKOS_INLINE_FUNCTION void
+        operator()(T const& x, T const& y, T& ex, T& ey) const
+        {
+            if (round) {
+                // 2 (1 - exp(-r^2/(2 sigma^2))) / r^2 * (x, y)
+                const double tiny = 1.0e-300;
+
+                T r2 = x * x + y * y;
+                T g = T(2.0) * (T(1.0) - exp(-r2 * T(ia2))) / (r2 + T(tiny));
+
+                ex = x * g;
+                ey = y * g;
+                return;
+            }
+
+            T u = swap ? y : x;
+            T v = swap ? x : y;
+            T av = gsv_abs(v);
+
+            T w1r(0.0), w1i(0.0), w2r(0.0), w2i(0.0);
+            wofz_upper(T(u * T(is)), T(av * T(is)), w1r, w1i);
+            wofz_upper(T(u * T(r * is)), T(av * T(is / r)), w2r, w2i);
+
+            T e = exp(-(u * u * T(ia2) + av * av * T(ib2)));
+
+            T eu = T(coef) * (w1i - e * w2i);
+            T ev = T(coef) * (w1r - e * w2r);
+            ev = gsv_flip_sign(ev, v);
+
+            ex = swap ? ev : eu;
+            ey = swap ? eu : ev;
+        }
+    };
+
+    struct sc_bassetti_erskine {
+        using gsv_t = Bunch::gsv_t;
+
+        Particles p;
+        ConstParticleMasks masks;
+
+        gaussian_field field;
+
+        double offx;
+        double offy;
+        double offz;
+
+        double factor;
+
+        // line charge density is lcd * exp(-z^2 * iz2)
+        double lcd;
+        double iz2;
+
+        KOKKOS_INLINE_FUNCTION
+        void
+        operator()(const int idx) const
+        {
+            int i = idx * gsv_t::size();
+
+            int m = 0;
+            for (int j = i; j < i + gsv_t::size(); ++j)
+                m |= masks(j);
+
+            if (m) {
+                gsv_t x(&p(i, 0));
+                gsv_t xp(&p(i, 1));
+                gsv_t y(&p(i, 2));
+                gsv_t yp(&p(i, 3));
+
+                x = x - gsv_t(offx);
+                y = y - gsv_t(offy);
+
+                gsv_t ex(0.0), ey(0.0);
+                field(x, y, ex, ey);
+
+                gsv_t k(factor * lcd);
+
+                if (iz2 > 0.0) {
+                    gsv_t z(&p(i, 4));
+                    z = z - gsv_t(offz);
+                    k = k * exp(-z * z * gsv_t(iz2));
+                }
+
+                xp = xp + ex * k;
+                yp = yp + ey * k;
+
+                xp.store(&p(i, 1));
+                yp.store(&p(i, 3));
+            }
+        }
+    };
+}
+
+Space_charge_2d_bassetti_erskine::Space_charge_2d_bassetti_erskine(
+    Space_charge_2d_bassetti_erskine_options const& opts)
+    : Collective_operator("sc_2d_bassetti_erskine", 1.0)
+    , opts(opts)
+    , bunch_sim_id()
+    , sigmas()
+{}
+
+void
+Space_charge_2d_bassetti_erskine::apply_impl(Bunch_simulator& sim,
+                                             double time_step,
+                                             Logger& logger)
+{
+    logger << "    Space charge 2d bassetti-erskine\n";
+
+    scoped_simple_timer timer("sc2d_be_total");
+
+    // reset the frozen sizes for a new bunch simulator
+    if (bunch_sim_id != sim.id()) {
+        std::array<double, 3> s{opts.sigma_x, opts.sigma_y, opts.sigma_cdt};
+
+        for (size_t t = 0; t < 2; ++t)
+            sigmas[t].assign(sim[t].get_bunch_array_size(), s);
+
+        bunch_sim_id = sim.id();
+    }
+
+    // apply to bunches
+    for (size_t t = 0; t < 2; ++t) {
+        for (size_t b = 0; b < sim[t].get_bunch_array_size(); ++b) {
+            apply_bunch(sim[t][b], sigmas[t][b], time_step, logger);
+        }
+    }
+}
+
+void
+Space_charge_2d_bassetti_erskine::apply_bunch(Bunch& bunch,
+                                              std::array<double, 3>& sigma,
+                                              double time_step,
+                                              Logger& logger)
+{
+    // frozen sizes are only computed (once) when not given
+    std::array<double, 3> s = sigma;
+    bool need_std = !opts.frozen_sigma || s[0] <= 0.0 || s[1] <= 0.0 ||
+                    s[2] <= 0.0;
+
+    double offx = 0;
+    double offy = 0;
+    double offz = 0;
+
+    if (need_std || !opts.strictly_centered) {
+        auto mean = Core_diagnostics::calculate_mean(bunch);
+
+        if (!opts.strictly_centered) {
+            offx = mean(0);
+            offy = mean(2);
+            offz = mean(4);
+        }
+
+        if (need_std) {
+            auto std = Core_diagnostics::calculate_std(bunch, mean);
+            std::array<double, 3> live{std(0), std(2), std(4)};
+
+            for (int j = 0; j < 3; ++j) {
+                if (!opts.frozen_sigma || s[j] <= 0.0) s[j] = live[j];
+            }
+
+            if (opts.frozen_sigma) sigma = s;
+        }
+    }
+
+    if (s[0] <= 0.0 || s[1] <= 0.0) {
+        throw std::runtime_error(
+            "Space_charge_2d_bassetti_erskine::apply_bunch: "
+            "transverse beam sizes must be positive");
+    }
+
+    // dp/p kick =
+    //
+    //   N r_p * (1/gamma**2) * delta-t * (1/(beta*gamma)) * unit_E_field
+    //
+    // (see Space_charge_2d_kv)
+
+    double beta = bunch.get_reference_particle().get_beta();
+    double gamma = bunch.get_reference_particle().get_gamma();
+
+    double factor = pconstants::rp * pconstants::c * time_step /
+                    (gamma * gamma * gamma * beta);
+
+    double total_q = bunch.get_real_num() * bunch.get_particle_charge();
+
+    double lcd = 0;
+    double iz2 = 0;
+
+    if (opts.longitudinal_distribution ==
+        Space_charge_2d_bassetti_erskine_options::LD::uniform) {
+        double bunch_length = std::sqrt(12) * s[2] * beta;
+        lcd = total_q / bunch_length;
+    } else {
+        lcd = total_q /
+              (sqrt(2.0 * Kokkos::numbers::pi_v<double>) * s[2] * beta);
+        iz2 = 0.5 / (s[2] * s[2]);
+    }
+
+    auto parts = bunch.get_local_particles();
+    auto masks = bunch.get_local_particle_masks();
+
+    sc_bassetti_erskine alg{parts,
+                            masks,
+                            gaussian_field(s[0], s[1]),
+                            offx,
+                            offy,
+                            offz,
+                            factor,
+                            lcd,
+                            iz2};
+
+    Kokkos::parallel_for(bunch.size_in_gsv(), alg);
+    Kokkos::fence();
+}
@@ -0,0 +1,35 @@
+#ifndef SPACE_CHARGE_2D_BASSETTI_ERSKINE_H_
+#define SPACE_CHARGE_2D_BASSETTI_ERSKINE_H_
+
+#include "synergia/simulation/collective_operator.h"
+#include "synergia/simulation/implemented_collective_options.h"
+
+/// Grid-free space charge kick from the field of a transverse Gaussian
+/// charge distribution (M. Bassetti and G.A. Erskine, CERN-ISR-TH/80-06).
+/// The rms sizes are either the moments of the bunch at every kick, or
+/// frozen (see Space_charge_2d_bassetti_erskine_options).
+class Space_charge_2d_bassetti_erskine : public Collective_operator {
+
+private:
+  const Space_charge_2d_bassetti_erskine_options opts;
+
+  // cached bunch simulator id, and the frozen {sigma_x, sigma_y,
+  // sigma_cdt} of every local bunch (negative when not set yet)
+  std::string bunch_sim_id;
+  std::array<std::vector<std::array<double, 3>>, 2> sigmas;
+
+  void apply_impl(Bunch_simulator& simulator,
+                  double time_step,
+                  Logger& logger) override;
+
+  void apply_bunch(Bunch& bunch,
+                   std::array<double, 3>& sigma,
+                   double time_step,
+                   Logger& logger);
+
+public:
+  Space_charge_2d_bassetti_erskine(
+    Space_charge_2d_bassetti_erskine_options const& opts);
+};
+
+#endif /* SPACE_CHARGE_2D_BASSETTI_ERSKINE_H_ */
@@ -5,6 +5,7 @@
 #include "synergia/bunch/core_diagnostics.h"
 #include "synergia/foundation/physical_constants.h"
 #include "synergia/utils/kokkos_utils.h"
+#include "synergia/utils/parallel_utils.h"
 #include "synergia/utils/simple_timer.h"
 
 constexpr auto pi = Kokkos::numbers::pi_v<double>;
@@ -278,6 +279,103 @@ namespace {
             }
         }
     };
+
+    // real charge of the local slices to the complex slab
+    struct alg_slab_expander {
+        karray1d_dev slab;
+        karray1d_dev rho;
+
+        KOKKOS_INLINE_FUNCTION
+        void
+        operator()(const int i) const
+        {
+            slab(i * 2) = rho(i);
+            slab(i * 2 + 1) = 0.0;
+        }
+    };
+
+    // every slice of the slab times the transformed green function
+    struct alg_slab_multiplier {
+        karray1d_dev slab;
+        karray1d_dev g2;
+        int n;
+
+        KOKKOS_INLINE_FUNCTION
+        void
+        operator()(const int i) const
+        {
+            const int j = i % n;
+
+            double re = slab(i * 2);
+            double im = slab(i * 2 + 1);
+
+            slab(i * 2) = re * g2(j * 2) - im * g2(j * 2 + 1);
+            slab(i * 2 + 1) = re * g2(j * 2 + 1) + im * g2(j * 2);
+        }
+    };
+
+    // fields of the slices [z][x][y][2], linear in z between the two
+    // nearest slices
+    struct alg_slice_kicker {
+        Particles p;
+        ConstParticleMasks masks;
+
+        karray1d_dev fn;
+        karray2d_dev bin;
+
+        int gx, gy, gz;
+        bool periodic_z;
+        double factor;
+
+        KOKKOS_INLINE_FUNCTION
+        void
+        operator()(const int i) const
+        {
+            if (!masks(i)) return;
+
+            int ix = fast_int_floor_kokkos(bin(i, 0));
+            int iy = fast_int_floor_kokkos(bin(i, 2));
+            int iz = fast_int_floor_kokkos(bin(i, 4));
+
+            if (ix < 0 || ix >= gx - 1 || iy < 0 || iy >= gy - 1) return;
+
+            double ox = bin(i, 1);
+            double oy = bin(i, 3);
+            double oz = bin(i, 5);
+
+            double wxy[4] = {(1.0 - ox) * (1.0 - oy),
+                             (1.0 - ox) * oy,
+                             ox * (1.0 - oy),
+                             ox * oy};
+
+            int cxy[4] = {ix * gy + iy,
+                          ix * gy + iy + 1,
+                          (ix + 1) * gy + iy,
+                          (ix + 1) * gy + iy + 1};
+
+            double wz[2] = {1.0 - oz, oz};
+            int cz[2] = {iz, iz + 1};
+
+            double vx = 0.0;
+            double vy = 0.0;
+
+            for (int k = 0; k < 2; ++k) {
+                int z = cz[k];
+
+                if (periodic_z) z = ((z % gz) + gz) % gz;
+                if (z < 0 || z >= gz) continue;
+
+                for (int c = 0; c < 4; ++c) {
+                    int idx = (z * gx * gy + cxy[c]) * 2;
+                    vx += wz[k] * wxy[c] * fn(idx);
+                    vy += wz[k] * wxy[c] * fn(idx + 1);
+                }
+            }
+
+            p(i, 1) += factor * vx;
+            p(i, 3) += factor * vy;
+        }
+    };
 }
 
 Space_charge_2d_open_hockney::Space_charge_2d_open_hockney(
@@ -289,7 +387,18 @@ Space_charge_2d_open_hockney::Space_charge_2d_open_hockney(
     , doubled_domain(ops.doubled_shape, {1.0, 1.0, 1.0})
     , particle_bin()
     , ffts()
-{}
+    , trackers()
+    , green_key{-1, -1, -1}
+    , slice_ffts()
+    , green_fft()
+{
+    if (options.slice_parallel && options.grid_entire_period &&
+        options.z_period <= 0.0) {
+        throw std::runtime_error(
+            "Space_charge_2d_open_hockney: grid_entire_period requires "
+            "a positive z_period");
+    }
+}
 
 void
 Space_charge_2d_open_hockney::apply_impl(Bunch_simulator& sim,
@@ -309,7 +418,24 @@ Space_charge_2d_open_hockney::apply_impl(Bunch_simulator& sim,
     // apply to bunches
     for (size_t t = 0; t < 2; ++t) {
         for (size_t b = 0; b < sim[t].get_bunch_array_size(); ++b) {
-            apply_bunch(sim[t][b], ffts[t][b], time_step, logger);
+            std::array<int, 3> key{int(t), int(b), 0};
+
+            if (options.slice_parallel) {
+                apply_bunch_slices(sim[t][b],
+                                   slice_ffts[t][b],
+                                   trackers[t][b],
+                                   key,
+                                   time_step,
+                                   logger);
+                continue;
+            }
+
+            apply_bunch(sim[t][b],
+                        ffts[t][b],
+                        trackers[t][b],
+                        key,
+                        time_step,
+                        logger);
         }
     }
 }
@@ -317,17 +443,27 @@ Space_charge_2d_open_hockney::apply_impl(Bunch_simulator& sim,
 void
 Space_charge_2d_open_hockney::apply_bunch(Bunch& bunch,
                                           Distributed_fft2d& fft,
+                                          Domain_tracker& tracker,
+                                          std::array<int, 3> const& key,
                                           double time_step,
                                           Logger& logger)
 {
-    update_domain(bunch);
+    update_domain(bunch, tracker);
 
-    get_local_charge_density(bunch); // [C/m^3]
+    get_local_charge_density(bunch, tracker); // [C/m^3]
     get_global_charge_density(bunch);
 
-    get_green_fn2_pointlike();
+    // green function, reused as long as the same bunch is being
+    // processed and its domain has not changed
+    std::array<int, 3> gkey{key[0], key[1], tracker.get_revision()};
+    bool new_green = (gkey != green_key);
+
+    if (new_green) {
+        get_green_fn2_pointlike();
+        green_key = gkey;
+    }
 
-    get_local_force2(fft);
+    get_local_force2(fft, new_green);
     get_global_force2(fft.get_comm());
 
     auto fn_norm = get_normalization_force(bunch, fft);
@@ -335,6 +471,33 @@ Space_charge_2d_open_hockney::apply_bunch(Bunch& bunch,
     apply_kick(bunch, fn_norm, time_step);
 }
 
+void
+Space_charge_2d_open_hockney::apply_bunch_slices(
+    Bunch& bunch,
+    Batched_fft2d& fft,
+    Domain_tracker& tracker,
+    std::array<int, 3> const& key,
+    double time_step,
+    Logger& logger)
+{
+    update_domain(bunch, tracker);
+
+    get_slice_charge_density(bunch, tracker); // [C/m^2] per slice
+
+    std::array<int, 3> gkey{key[0], key[1], tracker.get_revision()};
+    bool new_green = (gkey != green_key);
+
+    if (new_green) {
+        get_green_fn2_pointlike();
+        green_key = gkey;
+    }
+
+    auto fn = get_slice_fields(bunch.get_comm(), fft, new_green);
+    auto fn_norm = get_normalization_slices(bunch, fft);
+
+    apply_slice_kick(bunch, fn, fn_norm, time_step);
+}
+
 void
 Space_charge_2d_open_hockney::construct_workspaces(Bunch_simulator const& sim)
 {
@@ -342,51 +505,105 @@ Space_charge_2d_open_hockney::construct_workspaces(Bunch_simulator const& sim)
 
     auto const& s = options.doubled_shape;
 
-    rho2 = karray1d_dev("rho2", s[0] * s[1] * 2 + s[2]);
     g2 = karray1d_dev("g2", s[0] * s[1] * 2);
-    phi2 = karray1d_dev("phi2", s[0] * s[1] * 2);
 
-    h_rho2 = Kokkos::create_mirror_view(rho2);
-    h_phi2 = Kokkos::create_mirror_view(phi2);
+    if (options.slice_parallel) {
+        // largest block of slices of a rank over all the bunches
+        int max_local = 0;
+
+        for (size_t t = 0; t < 2; ++t) {
+            int num_local_bunches = sim[t].get_bunch_array_size();
+            slice_ffts[t] = std::vector<Batched_fft2d>(num_local_bunches);
+
+            for (size_t b = 0; b < num_local_bunches; ++b) {
+                int local = decompose_1d_local(sim[t][b].get_comm(), s[2]);
+
+                slice_ffts[t][b].construct({s[0], s[1]}, local);
+                max_local = std::max(max_local, local);
+            }
+        }
+
+        green_fft.construct({s[0], s[1]}, 1);
+
+        rho_slices = karray1d_dev("rho_slices", s[0] * s[1] * s[2]);
+        slab = karray1d_dev("slab", s[0] * s[1] * max_local * 2);
+        fields = karray1d_dev("fields", s[0] * s[1] * s[2] * 2);
+
+        h_rho_slices = Kokkos::create_mirror_view(rho_slices);
+        h_slab = Kokkos::create_mirror_view(slab);
+        h_fields = Kokkos::create_mirror_view(fields);
+    } else {
+        rho2 = karray1d_dev("rho2", s[0] * s[1] * 2 + s[2]);
+        phi2 = karray1d_dev("phi2", s[0] * s[1] * 2);
+
+        h_rho2 = Kokkos::create_mirror_view(rho2);
+        h_phi2 = Kokkos::create_mirror_view(phi2);
+
+        for (size_t t = 0; t < 2; ++t) {
+            int num_local_bunches = sim[t].get_bunch_array_size();
+            ffts[t] = std::vector<Distributed_fft2d>(num_local_bunches);
+
+            for (size_t b = 0; b < num_local_bunches; ++b) {
+                auto comm =
+                    sim[t][b].get_comm().divide(options.comm_group_size);
+
+                ffts[t][b].construct({s[0], s[1]}, comm);
+            }
+        }
+    }
 
     for (size_t t = 0; t < 2; ++t) {
         int num_local_bunches = sim[t].get_bunch_array_size();
-        ffts[t] = std::vector<Distributed_fft2d>(num_local_bunches);
 
-        for (size_t b = 0; b < num_local_bunches; ++b) {
-            auto comm = sim[t][b].get_comm().divide(options.comm_group_size);
+        trackers[t].clear();
+        trackers[t].reserve(num_local_bunches);
 
-            ffts[t][b].construct({s[0], s[1]}, comm);
+        for (size_t b = 0; b < num_local_bunches; ++b) {
+            trackers[t].emplace_back(options.domain_centroid_tolerance,
+                                     options.domain_size_tolerance);
         }
     }
+
+    green_key = {-1, -1, -1};
 }
 
 void
-Space_charge_2d_open_hockney::update_domain(Bunch const& bunch)
+Space_charge_2d_open_hockney::update_domain(Bunch const& bunch,
+                                            Domain_tracker& tracker)
 {
     scoped_simple_timer timer("sc2d_domain");
 
-    auto mean = Core_diagnostics::calculate_mean(bunch);
-    auto std = Core_diagnostics::calculate_std(bunch, mean);
+    // spatial mean (0-2) and std (3-5) of x, y, z
+    auto ms = tracker.get_mean_stddev(bunch);
 
     const double tiny = 1.0e-10;
 
-    const auto ix = Bunch::x;
-    const auto iy = Bunch::y;
-    const auto iz = Bunch::z;
-
-    if ((std[ix] < tiny) && (std[iy] < tiny) && (std[iz] < tiny)) {
+    if ((ms[3] < tiny) && (ms[4] < tiny) && (ms[5] < tiny)) {
         throw std::runtime_error(
             "Space_charge_3d_open_hockney_eigen::update_domain: "
             "all three spatial dimensions have neglible extent");
     }
 
-    std::array<double, 3> offset{mean[0], mean[2], mean[4]};
+    std::array<double, 3> offset{ms[0], ms[1], ms[2]};
 
     std::array<double, 3> size{
-        options.n_sigma * get_smallest_non_tiny(std[0], std[2], std[4], tiny),
-        options.n_sigma * get_smallest_non_tiny(std[2], std[0], std[4], tiny),
-        options.n_sigma * get_smallest_non_tiny(std[4], std[0], std[2], tiny)};
+        options.n_sigma * get_smallest_non_tiny(ms[3], ms[4], ms[5], tiny),
+        options.n_sigma * get_smallest_non_tiny(ms[4], ms[3], ms[5], tiny),
+        options.n_sigma * get_smallest_non_tiny(ms[5], ms[3], ms[4], tiny)};
+
+    // the whole period is gridded in z, centred on cdt = 0
+    if (options.slice_parallel && options.grid_entire_period) {
+        offset[2] = 0.0;
+        size[2] = options.z_period;
+    }
+
+    // keep the current domain of the bunch if the beam has not moved or
+    // changed size beyond the tolerances. The domains are shared by all
+    // the bunches, so they are always rebuilt from the tracker
+    tracker.update(offset, size);
+
+    offset = tracker.get_offset();
+    size = tracker.get_size();
 
     std::array<double, 3> doubled_size{size[0] * 2.0, size[1] * 2.0, size[2]};
 
@@ -397,20 +614,45 @@ Space_charge_2d_open_hockney::update_domain(Bunch const& bunch)
 }
 
 void
-Space_charge_2d_open_hockney::get_local_charge_density(Bunch const& bunch)
+Space_charge_2d_open_hockney::get_local_charge_density(
+    Bunch const& bunch,
+    Domain_tracker& tracker)
 {
     scoped_simple_timer timer("sc2d_local_rho");
 
     if (bunch.size() > particle_bin.extent(0))
         Kokkos::resize(particle_bin, bunch.size(), 6);
 
+    // beam moments for the domain of the next kick
+    auto moments = tracker.deposit_moments();
+
 #ifdef SYNERGIA_ENABLE_CUDA
     deposit_charge_rectangular_2d_kokkos_scatter_view(
-        rho2, doubled_domain, particle_bin, bunch);
+        rho2, doubled_domain, particle_bin, bunch, moments);
 #else
     deposit_charge_rectangular_2d_omp_reduce(
-        rho2, doubled_domain, particle_bin, bunch);
+        rho2, doubled_domain, particle_bin, bunch, moments);
 #endif
+
+    tracker.start_reduce(bunch);
+}
+
+void
+Space_charge_2d_open_hockney::get_slice_charge_density(Bunch const& bunch,
+                                                       Domain_tracker& tracker)
+{
+    scoped_simple_timer timer("sc2d_slice_rho");
+
+    if (bunch.size() > particle_bin.extent(0))
+        Kokkos::resize(particle_bin, bunch.size(), 6);
+
+    auto moments = tracker.deposit_moments();
+
+    deposit_charge_rectangular_2d_slices_kokkos_scatter_view(
+        rho_slices, doubled_domain, particle_bin, options.periodic_z, bunch,
+        moments);
+
+    tracker.start_reduce(bunch);
 }
 
 void
@@ -463,7 +705,8 @@ Space_charge_2d_open_hockney::get_green_fn2_pointlike()
 }
 
 void
-Space_charge_2d_open_hockney::get_local_force2(Distributed_fft2d& fft)
+Space_charge_2d_open_hockney::get_local_force2(Distributed_fft2d& fft,
+                                               bool transform_green)
 {
     scoped_simple_timer timer("sc2d_local_f");
 
@@ -473,8 +716,11 @@ Space_charge_2d_open_hockney::get_local_force2(Distributed_fft2d& fft)
     fft.transform(rho2, rho2);
     Kokkos::fence();
 
-    fft.transform(g2, g2);
-    Kokkos::fence();
+    // g2 is kept transformed while it is being reused
+    if (transform_green) {
+        fft.transform(g2, g2);
+        Kokkos::fence();
+    }
 
     // zero phi2 when using multiple ranks
     if (fft.get_comm().size() > 1) {
@@ -524,6 +770,99 @@ Space_charge_2d_open_hockney::get_global_force2(Commxx const& comm)
     Kokkos::deep_copy(phi2, h_phi2);
 }
 
+karray1d_dev
+Space_charge_2d_open_hockney::get_slice_fields(Commxx const& comm,
+                                               Batched_fft2d& fft,
+                                               bool transform_green)
+{
+    scoped_simple_timer timer("sc2d_slice_f");
+
+    auto dg = doubled_domain.get_grid_shape();
+
+    int nxy = dg[0] * dg[1];
+    int nranks = comm.size();
+
+    std::vector<int> offsets(nranks), counts(nranks);
+    decompose_1d_raw(nranks, dg[2], offsets, counts);
+
+    int local = counts[comm.rank()];
+
+    // the reduced charge of the local slices of this rank ends up at
+    // the beginning of rho_slices
+    if (nranks > 1) {
+        std::vector<int> rcounts(nranks);
+        for (int r = 0; r < nranks; ++r)
+            rcounts[r] = counts[r] * nxy;
+
+        Kokkos::deep_copy(h_rho_slices, rho_slices);
+
+        int err = MPI_Reduce_scatter(MPI_IN_PLACE,
+                                     (void*)h_rho_slices.data(),
+                                     rcounts.data(),
+                                     MPI_DOUBLE,
+                                     MPI_SUM,
+                                     comm);
+
+        if (err != MPI_SUCCESS) {
+            throw std::runtime_error(
+                "MPI error in Space_charge_2d_open_hockney"
+                "(MPI_Reduce_scatter in get_slice_fields)");
+        }
+
+        auto range = std::make_pair(0, local * nxy);
+        Kokkos::deep_copy(Kokkos::subview(rho_slices, range),
+                          Kokkos::subview(h_rho_slices, range));
+    }
+
+    if (transform_green) {
+        green_fft.transform(g2, g2);
+        Kokkos::fence();
+    }
+
+    // all the local slices in one batched transform each way
+    alg_slab_expander expander{slab, rho_slices};
+    Kokkos::parallel_for(local * nxy, expander);
+    Kokkos::fence();
+
+    fft.transform(slab, slab);
+    Kokkos::fence();
+
+    alg_slab_multiplier multiplier{slab, g2, nxy};
+    Kokkos::parallel_for(local * nxy, multiplier);
+    Kokkos::fence();
+
+    fft.inv_transform(slab, slab);
+    Kokkos::fence();
+
+    if (nranks == 1) return slab;
+
+    std::vector<int> fcounts(nranks), fdispls(nranks);
+    for (int r = 0; r < nranks; ++r) {
+        fcounts[r] = counts[r] * nxy * 2;
+        fdispls[r] = offsets[r] * nxy * 2;
+    }
+
+    Kokkos::deep_copy(h_slab, slab);
+
+    int err = MPI_Allgatherv((void*)h_slab.data(),
+                             local * nxy * 2,
+                             MPI_DOUBLE,
+                             (void*)h_fields.data(),
+                             fcounts.data(),
+                             fdispls.data(),
+                             MPI_DOUBLE,
+                             comm);
+
+    if (err != MPI_SUCCESS) {
+        throw std::runtime_error(
+            "MPI error in Space_charge_2d_open_hockney"
+            "(MPI_Allgatherv in get_slice_fields)");
+    }
+
+    Kokkos::deep_copy(fields, h_fields);
+    return fields;
+}
+
 double
 Space_charge_2d_open_hockney::get_normalization_force(
     Bunch const& bunch,
@@ -559,13 +898,29 @@ Space_charge_2d_open_hockney::get_normalization_force(
     return normalization;
 }
 
-void
-Space_charge_2d_open_hockney::apply_kick(Bunch& bunch,
-                                         double fn_norm,
-                                         double time_step)
+double
+Space_charge_2d_open_hockney::get_normalization_slices(
+    Bunch const& bunch,
+    Batched_fft2d const& fft) const
 {
-    scoped_simple_timer timer("sc2d_kick");
+    auto h = domain.get_cell_size();
+
+    // the charge of each slice is in [C/m^2] of the slice, the line
+    // density of the slice is h_z times smaller than in the 2d solve
+    double normalization = 2.0 * h[0] * h[1] / h[2];
+
+    normalization *= 1.0 / (4.0 * pi * pconstants::epsilon0);
+    normalization *= bunch.get_particle_charge() * pconstants::e;
+    normalization *= fft.get_roundtrip_normalization();
+
+    return normalization;
+}
 
+double
+Space_charge_2d_open_hockney::get_kick_factor(Bunch const& bunch,
+                                              double fn_norm,
+                                              double time_step) const
+{
     // EGS ported AM changes for kicks in lab frame from 3D solver
     // AM: kicks are done in the z_lab frame
     // $\delta \vec{p} = \vec{F} \delta t = q \vec{E} \delta t$
@@ -605,8 +960,18 @@ Space_charge_2d_open_hockney::apply_kick(Bunch& bunch,
     // the lorentz expansion longitudinally in the bunch frame and beta
     // comes because the stored coordinate is c*dt whereas the actual
     // domain is beta*c*dt.
-    double factor =
-        unit_conversion * delta_t_beam * fn_norm * p_scale / (gamma * beta);
+    return unit_conversion * delta_t_beam * fn_norm * p_scale /
+           (gamma * beta);
+}
+
+void
+Space_charge_2d_open_hockney::apply_kick(Bunch& bunch,
+                                         double fn_norm,
+                                         double time_step)
+{
+    scoped_simple_timer timer("sc2d_kick");
+
+    double factor = get_kick_factor(bunch, fn_norm, time_step);
 
     auto parts = bunch.get_local_particles();
     auto masks = bunch.get_local_particle_masks();
@@ -622,3 +987,28 @@ Space_charge_2d_open_hockney::apply_kick(Bunch& bunch,
     Kokkos::parallel_for(bunch.size(), kicker);
     Kokkos::fence();
 }
+
+void
+Space_charge_2d_open_hockney::apply_slice_kick(Bunch& bunch,
+                                               karray1d_dev const& fn,
+                                               double fn_norm,
+                                               double time_step)
+{
+    scoped_simple_timer timer("sc2d_slice_kick");
+
+    double factor = get_kick_factor(bunch, fn_norm, time_step);
+    auto dg = doubled_domain.get_grid_shape();
+
+    alg_slice_kicker kicker{bunch.get_local_particles(),
+                            bunch.get_local_particle_masks(),
+                            fn,
+                            particle_bin,
+                            dg[0],
+                            dg[1],
+                            dg[2],
+                            options.periodic_z,
+                            factor};
+
+    Kokkos::parallel_for(bunch.size(), kicker);
+    Kokkos::fence();
+}
@@ -4,8 +4,10 @@
 #include "synergia/simulation/collective_operator.h"
 #include "synergia/simulation/implemented_collective_options.h"
 
+#include "synergia/utils/batched_fft2d.h"
 #include "synergia/utils/distributed_fft2d.h"
 
+#include "synergia/collective/domain_tracker.h"
 #include "synergia/collective/rectangular_grid.h"
 #include "synergia/collective/rectangular_grid_domain.h"
 
@@ -24,6 +26,11 @@ private:
   karray2d_dev particle_bin;
 
   std::array<std::vector<Distributed_fft2d>, 2> ffts;
+  std::array<std::vector<Domain_tracker>, 2> trackers;
+
+  // (train, bunch, domain revision) of the transformed green function
+  // currently held in g2
+  std::array<int, 3> green_key;
 
   karray1d_dev rho2;
   karray1d_dev phi2;
@@ -32,6 +39,22 @@ private:
   karray1d_hst h_rho2;
   karray1d_hst h_phi2;
 
+  // slice parallel (2.5d) mode. Each rank of the bunch solves a
+  // contiguous block of the z slices with one batched transform
+  std::array<std::vector<Batched_fft2d>, 2> slice_ffts;
+  Batched_fft2d green_fft;
+
+  // real charge of all slices [z][x][y], the complex charge and then
+  // fields of the local slices [z][x][y][2], and the fields of all
+  // slices
+  karray1d_dev rho_slices;
+  karray1d_dev slab;
+  karray1d_dev fields;
+
+  karray1d_hst h_rho_slices;
+  karray1d_hst h_slab;
+  karray1d_hst h_fields;
+
 private:
   void apply_impl(Bunch_simulator& simulator,
                   double time_step,
@@ -39,28 +62,55 @@ private:
 
   void apply_bunch(Bunch& bunch,
                    Distributed_fft2d& fft,
+                   Domain_tracker& tracker,
+                   std::array<int, 3> const& key,
                    double time_step,
                    Logger& logger);
 
+  void apply_bunch_slices(Bunch& bunch,
+                          Batched_fft2d& fft,
+                          Domain_tracker& tracker,
+                          std::array<int, 3> const& key,
+                          double time_step,
+                          Logger& logger);
+
   void construct_workspaces(Bunch_simulator const& sim);
 
-  void update_domain(Bunch const& bunch);
+  void update_domain(Bunch const& bunch, Domain_tracker& tracker);
 
-  void get_local_charge_density(Bunch const& bunch);
+  void get_local_charge_density(Bunch const& bunch, Domain_tracker& tracker);
 
   void get_global_charge_density(Bunch const& bunch);
 
   void get_green_fn2_pointlike();
 
-  void get_local_force2(Distributed_fft2d& fft);
+  void get_local_force2(Distributed_fft2d& fft, bool transform_green);
 
   void get_global_force2(Commxx const& comm);
 
+  void get_slice_charge_density(Bunch const& bunch, Domain_tracker& tracker);
+
+  karray1d_dev get_slice_fields(Commxx const& comm,
+                                Batched_fft2d& fft,
+                                bool transform_green);
+
   void apply_kick(Bunch& bunch, double fn_norm, double time_step);
 
+  void apply_slice_kick(Bunch& bunch,
+                        karray1d_dev const& fn,
+                        double fn_norm,
+                        double time_step);
+
+  double get_kick_factor(Bunch const& bunch,
+                         double fn_norm,
+                         double time_step) const;
+
   double get_normalization_force(Bunch const& bunch,
                                  Distributed_fft2d const& fft);
 
+  double get_normalization_slices(Bunch const& bunch,
+                                  Batched_fft2d const& fft) const;
+
 public:
   Space_charge_2d_open_hockney(Space_charge_2d_open_hockney_options const& ops);
 };
@@ -196,6 +196,17 @@ Space_charge_3d_fd::apply_bunch(Bunch& bunch, double time_step, Logger& logger)
         {
             /* Only update the finite difference operator if required! */
             if (!use_fixed_domain) { PetscCall(compute_mat(lctx, sctx, gctx)); }
+
+            /* Initial guess from the previous potential */
+            if (gctx.warm_start && have_phi) {
+                PetscCall(warm_start(lctx,
+                                     sctx,
+                                     gctx,
+                                     phi_left,
+                                     phi_cell_size,
+                                     domain.get_left(),
+                                     domain.get_cell_size()));
+            }
         }
         /* End global (alias of local) to subcomm scatters! */
         for (PetscInt i = 0; i < gctx.nsubcomms; i++) {
@@ -301,6 +312,10 @@ Space_charge_3d_fd::apply_bunch(Bunch& bunch, double time_step, Logger& logger)
 
     get_force();
 
+    phi_left = domain.get_left();
+    phi_cell_size = domain.get_cell_size();
+    have_phi = true;
+
     // Note: enx/eny/enz vectors cannot be dumped to HDF5 files
     // because we cannot create a commxx of type MPI_COMM_SELF
     // as of now!
@@ -485,6 +500,10 @@ Space_charge_3d_fd::allocate_sc3d_fd(const Bunch& bunch)
 
     gctx.nsubcomms = gctx.global_size / options.comm_group_size;
 
+    gctx.warm_start = options.warm_start;
+    gctx.matrix_free = options.matrix_free;
+    gctx.mg_levels = options.mg_levels;
+
     /* Initialize task subcomms, display task-subcomm details */
     PetscCall(init_solver_subcomms(sctx, gctx));
 
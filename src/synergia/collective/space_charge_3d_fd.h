@@ -30,6 +30,12 @@ class Space_charge_3d_fd : public Collective_operator {
         2.5; /*! rebuild preconditioner if the size
               of the domain along z changes by this factor */
 
+    /* domain of the potential held in the local seqphi, used to
+       interpolate the warm start guess onto the next domain */
+    bool have_phi = false;
+    std::array<double, 3> phi_left;
+    std::array<double, 3> phi_cell_size;
+
     GlobalCtx gctx;
     SubcommCtx sctx;
     LocalCtx lctx;
@@ -29,6 +29,19 @@ struct LocalCtx {
     karray1d_dev coo_v; /*! kokkos view for matrix entries in coo format */
 };
 
+struct GlobalCtx;
+
+/*! Context of the matrix-free 7-point stencil operator on one level of
+    the DMDA hierarchy */
+struct StencilCtx {
+
+    DM da;    /*! DMDA of this level */
+    Vec xloc; /*! ghosted local vector used in MatMult */
+
+    const GlobalCtx* gctx; /*! domain lengths are read from here on every
+                             MatMult, so the operator follows the domain */
+};
+
 /*! Subcomm context */
 struct SubcommCtx {
 
@@ -45,6 +58,13 @@ struct SubcommCtx {
     PC pc;                         /* preconditioner */
     PetscBool reuse = PETSC_FALSE; /* state of ksp/pc re-use */
 
+    std::vector<DM> da_coarse; /*! coarsened DMDAs, coarsest first
+                                 (matrix-free mode) */
+    std::vector<Mat> A_coarse; /*! shell operators on the coarse levels,
+                                 coarsest first (matrix-free mode) */
+    std::vector<StencilCtx> stencils; /*! shell contexts for all levels,
+                                        finest last (matrix-free mode) */
+
     VecScatter scat_subcomm_to_local; /*! VecScatter from subcomm vector to
                                         constituent local vectors */
     IS ix_scat_subcomms_to_local; /*! IndexSet for scatter from subcomm vector
@@ -83,6 +103,10 @@ struct GlobalCtx {
     bool debug = false; /*! enable verbose outputs */
     bool dumps = false; /*! enable dumping states to HDF5 files */
 
+    bool warm_start = false;  /*! start from the interpolated previous phi */
+    bool matrix_free = false; /*! shell stencil operator with geometric MG */
+    PetscInt mg_levels = 3;   /*! max number of levels in matrix-free mode */
+
     PetscMPIInt global_rank = -1; /*! global MPI communicator rank */
     PetscMPIInt global_size = -1; /*! global MPI communicator size */
 
@@ -177,6 +177,13 @@ init_subcomm_mat(LocalCtx& lctx, SubcommCtx& sctx, GlobalCtx& gctx)
     PetscCall(DMSetFromOptions(sctx.da));
     PetscCall(DMSetUp(sctx.da));
 
+    /* shell operator and geometric multigrid instead of the matrix */
+    if (gctx.matrix_free) {
+        PetscCall(init_subcomm_mg(sctx, gctx));
+        PetscCall(init_ksp_logging(sctx, gctx));
+        PetscFunctionReturn(0);
+    }
+
     /* create discretization matrix */
     PetscCall(MatCreate(PetscObjectComm((PetscObject)sctx.da), &(sctx.A)));
     PetscCall(MatSetSizes(
@@ -290,7 +297,23 @@ init_subcomm_mat(LocalCtx& lctx, SubcommCtx& sctx, GlobalCtx& gctx)
         PCGAMGSetThreshold(sctx.pc, (std::array<double, 1>{-0.05}).data(), 1));
     PetscCall(PCGAMGSetThresholdScale(sctx.pc, 0.5));
 
-    /* Enable KSP logging if options are set */
+    PetscCall(init_ksp_logging(sctx, gctx));
+
+    PetscFunctionReturn(0);
+}
+
+/* --------------------------------------------------------------------- */
+/*!
+  Enable KSP logging if options are set
+  \param   sctx - subcomm context
+  \param   gctx - global context
+  \return  ierr - PetscErrorCode
+  */
+PetscErrorCode
+init_ksp_logging(SubcommCtx& sctx, GlobalCtx& gctx)
+{
+    PetscFunctionBeginUser;
+
     if (gctx.ksp_view) {
         PetscCall(KSPView(
             sctx.ksp,
@@ -310,6 +333,281 @@ init_subcomm_mat(LocalCtx& lctx, SubcommCtx& sctx, GlobalCtx& gctx)
     PetscFunctionReturn(0);
 }
 
+/* --------------------------------------------------------------------- */
+/*!
+  MatMult of the shell operator, the same (scaled) 7-point stencil with
+  trivial boundary rows as the assembled matrix
+  \param   A - shell matrix
+  \param   x - input vector
+  \param   y - output vector
+  \return  ierr - PetscErrorCode
+  */
+static PetscErrorCode
+stencil_mult(Mat A, Vec x, Vec y)
+{
+    StencilCtx* ctx;
+    DMDALocalInfo info;
+    const PetscScalar* xa;
+    PetscScalar* ya;
+    PetscMemType mtype_x, mtype_y;
+
+    PetscFunctionBeginUser;
+    PetscCall(MatShellGetContext(A, &ctx));
+    PetscCall(DMDAGetLocalInfo(ctx->da, &info));
+
+    PetscScalar hx = (ctx->gctx->Lx) / (PetscReal)(info.mx);
+    PetscScalar hy = (ctx->gctx->Ly) / (PetscReal)(info.my);
+    PetscScalar hz = (ctx->gctx->Lz) / (PetscReal)(info.mz);
+
+    PetscScalar hxhydhz = (hx * hy) / hz;
+    PetscScalar hxdhyhz = (hx * hz) / hy;
+    PetscScalar dhxhyhz = (hy * hz) / hx;
+    PetscScalar diag = 2 * (hxhydhz + hxdhyhz + dhxhyhz);
+
+    PetscCall(DMGlobalToLocalBegin(ctx->da, x, INSERT_VALUES, ctx->xloc));
+    PetscCall(DMGlobalToLocalEnd(ctx->da, x, INSERT_VALUES, ctx->xloc));
+
+    PetscCall(VecGetArrayReadAndMemType(ctx->xloc, &xa, &mtype_x));
+    PetscCall(VecGetArrayWriteAndMemType(y, &ya, &mtype_y));
+
+    PetscInt sy = info.gxm;
+    PetscInt sz = info.gxm * info.gym;
+
+    PetscCallCXX(Kokkos::parallel_for(
+        "StencilMult",
+        Kokkos::MDRangePolicy<
+            Kokkos::Rank<3, Kokkos::Iterate::Right, Kokkos::Iterate::Right>>(
+            {info.zs, info.ys, info.xs},
+            {info.zs + info.zm, info.ys + info.ym, info.xs + info.xm}),
+        KOKKOS_LAMBDA(PetscCount k, PetscCount j, PetscCount i) {
+            PetscInt p = (k - info.zs) * info.ym * info.xm +
+                         (j - info.ys) * info.xm + (i - info.xs);
+            PetscInt q =
+                (k - info.gzs) * sz + (j - info.gys) * sy + (i - info.gxs);
+            if (i == 0 || j == 0 || k == 0 || i == info.mx - 1 ||
+                j == info.my - 1 || k == info.mz - 1) {
+                ya[p] = xa[q]; // on boundary: trivial equation
+            } else {
+                ya[p] = diag * xa[q] - dhxhyhz * (xa[q - 1] + xa[q + 1]) -
+                        hxdhyhz * (xa[q - sy] + xa[q + sy]) -
+                        hxhydhz * (xa[q - sz] + xa[q + sz]);
+            }
+        }));
+    Kokkos::fence();
+
+    PetscCall(VecRestoreArrayReadAndMemType(ctx->xloc, &xa));
+    PetscCall(VecRestoreArrayWriteAndMemType(y, &ya));
+
+    PetscFunctionReturn(0);
+}
+
+/* --------------------------------------------------------------------- */
+/*!
+  Diagonal of the shell operator, needed by the Jacobi smoothers
+  \param   A - shell matrix
+  \param   d - output vector
+  \return  ierr - PetscErrorCode
+  */
+static PetscErrorCode
+stencil_get_diagonal(Mat A, Vec d)
+{
+    StencilCtx* ctx;
+    DMDALocalInfo info;
+    PetscScalar* da;
+    PetscMemType mtype_d;
+
+    PetscFunctionBeginUser;
+    PetscCall(MatShellGetContext(A, &ctx));
+    PetscCall(DMDAGetLocalInfo(ctx->da, &info));
+
+    PetscScalar hx = (ctx->gctx->Lx) / (PetscReal)(info.mx);
+    PetscScalar hy = (ctx->gctx->Ly) / (PetscReal)(info.my);
+    PetscScalar hz = (ctx->gctx->Lz) / (PetscReal)(info.mz);
+
+    PetscScalar diag = 2 * ((hx * hy) / hz + (hx * hz) / hy + (hy * hz) / hx);
+
+    PetscCall(VecGetArrayWriteAndMemType(d, &da, &mtype_d));
+
+    PetscCallCXX(Kokkos::parallel_for(
+        "StencilDiagonal",
+        Kokkos::MDRangePolicy<
+            Kokkos::Rank<3, Kokkos::Iterate::Right, Kokkos::Iterate::Right>>(
+            {info.zs, info.ys, info.xs},
+            {info.zs + info.zm, info.ys + info.ym, info.xs + info.xm}),
+        KOKKOS_LAMBDA(PetscCount k, PetscCount j, PetscCount i) {
+            PetscInt p = (k - info.zs) * info.ym * info.xm +
+                         (j - info.ys) * info.xm + (i - info.xs);
+            if (i == 0 || j == 0 || k == 0 || i == info.mx - 1 ||
+                j == info.my - 1 || k == info.mz - 1) {
+                da[p] = 1.0;
+            } else {
+                da[p] = diag;
+            }
+        }));
+    Kokkos::fence();
+
+    PetscCall(VecRestoreArrayWriteAndMemType(d, &da));
+
+    PetscFunctionReturn(0);
+}
+
+/* --------------------------------------------------------------------- */
+/*!
+  Create the shell stencil operator on a DMDA
+  \param   da - the DMDA of the level
+  \param   ctx - the shell context, must outlive the matrix
+  \param   gctx - global context
+  \param   A - the created shell matrix
+  \return  ierr - PetscErrorCode
+  */
+static PetscErrorCode
+create_stencil_shell(DM da, StencilCtx& ctx, GlobalCtx& gctx, Mat* A)
+{
+    DMDALocalInfo info;
+
+    PetscFunctionBeginUser;
+    PetscCall(DMDAGetLocalInfo(da, &info));
+
+    ctx.da = da;
+    ctx.gctx = &gctx;
+    PetscCall(DMCreateLocalVector(da, &ctx.xloc));
+
+    PetscInt nlocal = info.xm * info.ym * info.zm;
+    PetscInt nglobal = info.mx * info.my * info.mz;
+
+    PetscCall(MatCreateShell(PetscObjectComm((PetscObject)da),
+                             nlocal,
+                             nlocal,
+                             nglobal,
+                             nglobal,
+                             &ctx,
+                             A));
+    PetscCall(
+        MatShellSetOperation(*A, MATOP_MULT, (void (*)(void))stencil_mult));
+    PetscCall(MatShellSetOperation(
+        *A, MATOP_GET_DIAGONAL, (void (*)(void))stencil_get_diagonal));
+    PetscCall(MatShellSetVecType(*A, gctx.vectype));
+
+    PetscFunctionReturn(0);
+}
+
+/* --------------------------------------------------------------------- */
+/*!
+  Initialize the matrix-free operator and the geometric multigrid
+  preconditioner on the DMDA hierarchy. Smoothers are Chebyshev/Jacobi,
+  the coarse problem is solved approximately with GMRES/Jacobi, hence the
+  outer solver is FGMRES. Everything can be overridden from the PETSc
+  options database.
+  \param   sctx - subcomm context
+  \param   gctx - global context
+  \return  ierr - PetscErrorCode
+  */
+PetscErrorCode
+init_subcomm_mg(SubcommCtx& sctx, GlobalCtx& gctx)
+{
+    PetscFunctionBeginUser;
+
+    /* the non-periodic DMDA can only be coarsened while (m-1) is even */
+    PetscInt nlevels = 1;
+    PetscInt mx = gctx.nsize_x, my = gctx.nsize_y, mz = gctx.nsize_z;
+    while (nlevels < gctx.mg_levels && (mx - 1) % 2 == 0 &&
+           (my - 1) % 2 == 0 && (mz - 1) % 2 == 0 && mx > 4 && my > 4 &&
+           mz > 4) {
+        mx = (mx - 1) / 2 + 1;
+        my = (my - 1) / 2 + 1;
+        mz = (mz - 1) / 2 + 1;
+        nlevels++;
+    }
+
+    if (nlevels < 2)
+        throw std::runtime_error(
+            "[sc3d-fd-error] matrix-free solver requires grid sizes of the "
+            "form k*2^n+1.");
+
+    /* matrix-free operations use the DMDA layout of the subcomm vectors */
+    PetscInt vlocal;
+    DMDALocalInfo info;
+    PetscCall(VecGetLocalSize(sctx.phi_subcomm, &vlocal));
+    PetscCall(DMDAGetLocalInfo(sctx.da, &info));
+
+    if (vlocal != info.xm * info.ym * info.zm)
+        throw std::runtime_error(
+            "[sc3d-fd-error] matrix-free solver requires the subcomm vector "
+            "layout to match the DMDA, use comm_group_size = 1.");
+
+    /* coarse DMDAs, coarsest first */
+    std::vector<DM> das(nlevels - 1);
+    PetscCall(DMCoarsenHierarchy(sctx.da, nlevels - 1, das.data()));
+    sctx.da_coarse.assign(das.rbegin(), das.rend());
+
+    for (auto da : sctx.da_coarse) {
+        PetscCall(DMSetVecType(da, gctx.vectype));
+    }
+
+    /* shell operators, contexts must not move after the shells are made */
+    sctx.stencils.resize(nlevels);
+    sctx.A_coarse.resize(nlevels - 1);
+
+    for (PetscInt l = 0; l < nlevels - 1; l++) {
+        PetscCall(create_stencil_shell(
+            sctx.da_coarse[l], sctx.stencils[l], gctx, &sctx.A_coarse[l]));
+    }
+
+    PetscCall(create_stencil_shell(
+        sctx.da, sctx.stencils[nlevels - 1], gctx, &sctx.A));
+
+    /* krylov solver */
+    PetscCall(KSPCreate(sctx.solversubcomm, &sctx.ksp));
+    PetscCall(KSPSetType(sctx.ksp, KSPFGMRES));
+    PetscCall(KSPSetOperators(sctx.ksp, sctx.A, sctx.A));
+
+    /* geometric multigrid */
+    PetscCall(KSPGetPC(sctx.ksp, &(sctx.pc)));
+    PetscCall(PCSetType(sctx.pc, PCMG));
+    PetscCall(PCMGSetLevels(sctx.pc, nlevels, NULL));
+    PetscCall(PCMGSetGalerkin(sctx.pc, PC_MG_GALERKIN_NONE));
+
+    for (PetscInt l = 0; l < nlevels; l++) {
+        DM da = (l == nlevels - 1) ? sctx.da : sctx.da_coarse[l];
+        Mat A = (l == nlevels - 1) ? sctx.A : sctx.A_coarse[l];
+
+        if (l > 0) {
+            Mat P;
+            DM dac = sctx.da_coarse[l - 1];
+            PetscCall(DMCreateInterpolation(dac, da, &P, NULL));
+            PetscCall(PCMGSetInterpolation(sctx.pc, l, P));
+            PetscCall(MatDestroy(&P));
+        }
+
+        KSP ksp_l;
+        PC pc_l;
+        PetscCall(PCMGGetSmoother(sctx.pc, l, &ksp_l));
+        PetscCall(KSPSetOperators(ksp_l, A, A));
+        PetscCall(KSPGetPC(ksp_l, &pc_l));
+        PetscCall(PCSetType(pc_l, PCJACOBI));
+
+        if (l == 0) {
+            PetscCall(KSPSetType(ksp_l, KSPGMRES));
+            PetscCall(KSPSetTolerances(
+                ksp_l, 1e-3, PETSC_DEFAULT, PETSC_DEFAULT, 50));
+        } else {
+            PetscCall(KSPSetType(ksp_l, KSPCHEBYSHEV));
+            PetscCall(KSPChebyshevEstEigSet(
+                ksp_l, PETSC_DECIDE, PETSC_DECIDE, PETSC_DECIDE, PETSC_DECIDE));
+        }
+    }
+
+    PetscCall(KSPSetFromOptions(sctx.ksp));
+
+    if (gctx.debug) {
+        PetscCall(PetscPrintf(gctx.bunch_comm,
+                              "matrix-free solver with %d multigrid levels\n",
+                              static_cast<int>(nlevels)));
+    }
+
+    PetscFunctionReturn(0);
+}
+
 /* --------------------------------------------------------------------- */
 /*!
   Compute the RHS matrix to solve the (scaled) Poisson's Eq, setup the
@@ -326,6 +624,32 @@ compute_mat(LocalCtx& lctx, SubcommCtx& sctx, GlobalCtx& gctx)
     PetscFunctionBeginUser;
     scoped_simple_timer("sc3d_fd_compute_mat");
 
+    /* the shell operators read the domain lengths on every MatMult, only
+       the smoothers (eigenvalue estimates) are rebuilt, and only when the
+       domain has changed beyond the thresholds */
+    if (gctx.matrix_free) {
+        if (sctx.reuse == PETSC_FALSE) {
+            PetscCall(PetscObjectStateIncrease((PetscObject)sctx.A));
+            for (auto A : sctx.A_coarse) {
+                PetscCall(PetscObjectStateIncrease((PetscObject)A));
+            }
+            PetscCall(KSPSetReusePreconditioner(sctx.ksp, PETSC_FALSE));
+            PetscCall(PCSetReusePreconditioner(sctx.pc, PETSC_FALSE));
+            sctx.reuse = PETSC_TRUE; /* will reset reuse at next solve  */
+        } else {
+            PetscCall(KSPSetReusePreconditioner(sctx.ksp, PETSC_TRUE));
+            PetscCall(PCSetReusePreconditioner(sctx.pc, PETSC_TRUE));
+        }
+
+        /* the previous phi is only a good guess once interpolated */
+        PetscCall(KSPSetInitialGuessNonzero(sctx.ksp, PETSC_FALSE));
+
+        PetscCall(KSPSetUp(sctx.ksp));
+        PetscCall(PCSetUp(sctx.pc));
+
+        PetscFunctionReturn(0);
+    }
+
     DMDALocalInfo info; /* For storing DMDA info */
     PetscScalar hx, hy, hz;
     PetscScalar hxhydhz, hxdhyhz, dhxhyhz;
@@ -415,6 +739,101 @@ solve(SubcommCtx& sctx, GlobalCtx& gctx)
     PetscFunctionReturn(0);
 }
 
+/* --------------------------------------------------------------------- */
+/*!
+  Warm start: interpolate the potential of the previous solve (still held
+  in the local seqphi on every rank) from the previous domain onto the
+  current one, and use it as the initial guess of the next solve
+  \param   lctx - local context
+  \param   sctx - subcomm context
+  \param   gctx - global context
+  \param   left_old - left edges of the previous domain
+  \param   h_old - cell sizes of the previous domain
+  \param   left_new - left edges of the current domain
+  \param   h_new - cell sizes of the current domain
+  \return  ierr - PetscErrorCode
+  */
+PetscErrorCode
+warm_start(LocalCtx& lctx,
+           SubcommCtx& sctx,
+           GlobalCtx& gctx,
+           std::array<double, 3> const& left_old,
+           std::array<double, 3> const& h_old,
+           std::array<double, 3> const& left_new,
+           std::array<double, 3> const& h_new)
+{
+    PetscInt start, end;
+    PetscScalar* phi;
+    PetscMemType mtype_phi;
+
+    PetscFunctionBeginUser;
+    scoped_simple_timer timer("sc3d_fd_warm_start");
+
+    PetscCall(VecGetOwnershipRange(sctx.phi_subcomm, &start, &end));
+    PetscCall(VecGetArrayWriteAndMemType(sctx.phi_subcomm, &phi, &mtype_phi));
+
+    auto phi_old = lctx.seqphi_view;
+
+    PetscInt gx = gctx.nsize_x;
+    PetscInt gy = gctx.nsize_y;
+    PetscInt gz = gctx.nsize_z;
+
+    /* grid point i sits at left + (i + 0.5) * h */
+    double ax = h_new[0] / h_old[0];
+    double ay = h_new[1] / h_old[1];
+    double az = h_new[2] / h_old[2];
+
+    double bx = (left_new[0] - left_old[0]) / h_old[0] + 0.5 * ax - 0.5;
+    double by = (left_new[1] - left_old[1]) / h_old[1] + 0.5 * ay - 0.5;
+    double bz = (left_new[2] - left_old[2]) / h_old[2] + 0.5 * az - 0.5;
+
+    PetscCallCXX(Kokkos::parallel_for(
+        "WarmStart",
+        Kokkos::RangePolicy<>(start, end),
+        KOKKOS_LAMBDA(PetscInt n) {
+            PetscInt k = n / (gx * gy);
+            PetscInt j = (n - k * gx * gy) / gx;
+            PetscInt i = n - k * gx * gy - j * gx;
+
+            double sx = ax * i + bx;
+            double sy = ay * j + by;
+            double sz = az * k + bz;
+
+            PetscInt ix = (PetscInt)Kokkos::floor(sx);
+            PetscInt iy = (PetscInt)Kokkos::floor(sy);
+            PetscInt iz = (PetscInt)Kokkos::floor(sz);
+
+            /* zero outside of the previous domain, like the boundary */
+            if (ix < 0 || ix >= gx - 1 || iy < 0 || iy >= gy - 1 || iz < 0 ||
+                iz >= gz - 1) {
+                phi[n - start] = 0.0;
+                return;
+            }
+
+            double ox = sx - ix;
+            double oy = sy - iy;
+            double oz = sz - iz;
+
+            PetscInt b = (iz * gy + iy) * gx + ix;
+
+            phi[n - start] =
+                (1 - oz) * ((1 - oy) * ((1 - ox) * phi_old(b) +
+                                        ox * phi_old(b + 1)) +
+                            oy * ((1 - ox) * phi_old(b + gx) +
+                                  ox * phi_old(b + gx + 1))) +
+                oz * ((1 - oy) * ((1 - ox) * phi_old(b + gx * gy) +
+                                  ox * phi_old(b + gx * gy + 1)) +
+                      oy * ((1 - ox) * phi_old(b + gx * gy + gx) +
+                            ox * phi_old(b + gx * gy + gx + 1)));
+        }));
+    Kokkos::fence();
+
+    PetscCall(VecRestoreArrayWriteAndMemType(sctx.phi_subcomm, &phi));
+    PetscCall(KSPSetInitialGuessNonzero(sctx.ksp, PETSC_TRUE));
+
+    PetscFunctionReturn(0);
+}
+
 /* --------------------------------------------------------------------- */
 /*!
   Initialize global (alias of local) to subcomm scatters
@@ -564,6 +983,17 @@ finalize(LocalCtx& lctx, SubcommCtx& sctx, GlobalCtx& gctx)
     PetscCall(DMDestroy(&sctx.da));
     PetscCall(KSPDestroy(&sctx.ksp));
 
+    /* Destroy the multigrid hierarchy (matrix-free mode) */
+    for (auto& A : sctx.A_coarse) {
+        PetscCall(MatDestroy(&A));
+    }
+    for (auto& st : sctx.stencils) {
+        PetscCall(VecDestroy(&st.xloc));
+    }
+    for (auto& da : sctx.da_coarse) {
+        PetscCall(DMDestroy(&da));
+    }
+
     /* Destroy subcomm vectors */
     PetscCall(VecDestroy(&(lctx.seqphi)));
     PetscCall(VecDestroy(&(lctx.seqrho)));
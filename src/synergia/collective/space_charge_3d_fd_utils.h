@@ -1,6 +1,8 @@
 #ifndef SPACE_CHARGE_3D_FD_UTILS_H_
 #define SPACE_CHARGE_3D_FD_UTILS_H_
 
+#include <array>
+
 #include "space_charge_3d_fd_impl.h"
 #include "synergia/utils/simple_timer.h"
 
@@ -13,10 +15,22 @@ PetscErrorCode init_subcomm_mat(LocalCtx& lctx,
                                 SubcommCtx& sctx,
                                 GlobalCtx& gctx);
 
+PetscErrorCode init_subcomm_mg(SubcommCtx& sctx, GlobalCtx& gctx);
+
+PetscErrorCode init_ksp_logging(SubcommCtx& sctx, GlobalCtx& gctx);
+
 PetscErrorCode compute_mat(LocalCtx& lctx, SubcommCtx& sctx, GlobalCtx& gctx);
 
 PetscErrorCode solve(SubcommCtx& sctx, GlobalCtx& gctx);
 
+PetscErrorCode warm_start(LocalCtx& lctx,
+                          SubcommCtx& sctx,
+                          GlobalCtx& gctx,
+                          std::array<double, 3> const& left_old,
+                          std::array<double, 3> const& h_old,
+                          std::array<double, 3> const& left_new,
+                          std::array<double, 3> const& h_new);
+
 PetscErrorCode init_global_subcomm_scatters(SubcommCtx& sctx, GlobalCtx& gctx);
 PetscErrorCode init_subcomm_local_scatters(LocalCtx& lctx,
                                            SubcommCtx& sctx,
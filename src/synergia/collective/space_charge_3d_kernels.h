@@ -214,98 +214,125 @@ namespace sc3d_kernels {
             }
         };
 
-        struct alg_force_extractor_doubled_domain {
+        /*! Fused gather and kick from the potential in the doubled
+         *  domain. The field at the 8 grid points around the particle
+         *  is differentiated from phi2 on the fly with central
+         *  differences, and zero field at the boundaries of the
+         *  original domain, so the field arrays are never stored and
+         *  the particle is binned only once. */
+        struct alg_gather_kicker_doubled_domain {
+            Particles parts;
+            ConstParticleMasks masks;
+
             karray1d_dev phi2;
-            karray1d_dev enx;
-            karray1d_dev eny;
-            karray1d_dev enz;
 
             int gx, gy, gz;
             int dgx, dgy;
             double ihx, ihy, ihz;
-            double igxgy;
-            double igx;
+            double ihx2, ihy2, ihz2;
+            double lx, ly, lz;
+            double factor, pref, m;
 
-            alg_force_extractor_doubled_domain(karray1d_dev const& phi2,
-                                               karray1d_dev const& enx,
-                                               karray1d_dev const& eny,
-                                               karray1d_dev const& enz,
-                                               std::array<int, 3> const& g,
-                                               std::array<int, 3> const& dg,
-                                               std::array<double, 3> const& h)
-                : phi2(phi2)
-                , enx(enx)
-                , eny(eny)
-                , enz(enz)
+            alg_gather_kicker_doubled_domain(Particles parts,
+                                             ConstParticleMasks masks,
+                                             karray1d_dev const& phi2,
+                                             std::array<int, 3> const& g,
+                                             std::array<int, 3> const& dg,
+                                             std::array<double, 3> const& h,
+                                             std::array<double, 3> const& dh,
+                                             std::array<double, 3> const& l,
+                                             double factor,
+                                             double pref,
+                                             double m)
+                : parts(parts)
+                , masks(masks)
+                , phi2(phi2)
                 , gx(g[0])
                 , gy(g[1])
                 , gz(g[2])
                 , dgx(Distributed_fft3d::get_padded_shape_real(dg[0]))
                 , dgy(dg[1])
-                , ihx(0.5 / h[0])
-                , ihy(0.5 / h[1])
-                , ihz(0.5 / h[2])
-                , igxgy(1.0 / (gx * gy))
-                , igx(1.0 / gx)
+                , ihx(1.0 / h[0])
+                , ihy(1.0 / h[1])
+                , ihz(1.0 / h[2])
+                , ihx2(0.5 / dh[0])
+                , ihy2(0.5 / dh[1])
+                , ihz2(0.5 / dh[2])
+                , lx(l[0])
+                , ly(l[1])
+                , lz(l[2])
+                , factor(factor)
+                , pref(pref)
+                , m(m)
             {}
 
+            // accumulate w * E at the grid point (ix, iy, iz)
             KOKKOS_INLINE_FUNCTION
             void
-            operator()(const int i) const
+            add_field(int ix,
+                      int iy,
+                      int iz,
+                      double w,
+                      double& ex,
+                      double& ey,
+                      double& ez) const
             {
-                int iz = i * igxgy;
-                int iy = (i - iz * gx * gy) * igx;
-                int ix = i - iz * gx * gy - iy * gx;
-
-                int ixl, ixr, iyl, iyr, izl, izr;
-
-                double idx, idy, idz;
-
-                // all boundaries will be skipped (set to 0)
+                // zero field at the boundaries
                 if (ix == 0 || ix == gx - 1 || iy == 0 || iy == gy - 1 ||
                     iz == 0 || iz == gz - 1)
                     return;
 
-                ixl = ix - 1;
-                ixr = ix + 1;
-                iyl = iy - 1;
-                iyr = iy + 1;
-                izl = iz - 1;
-                izr = iz + 1;
-
-                idx = ihx;
-                idy = ihy;
-                idz = ihz;
+                int i = iz * dgx * dgy + iy * dgx + ix;
 
-#if 0
-            // or, calculate the full domain
-            if (ix==0) { ixl = 0; ixr = 1; idx = ihx*2; }
-            else if (ix==gx-1) { ixl = gx-2; ixr = gx-1; idx = ihx; }
-            else { ixl = ix-1; ixr = ix+1; idx = ihx; }
+                ex -= w * (phi2(i + 1) - phi2(i - 1)) * ihx2;
+                ey -= w * (phi2(i + dgx) - phi2(i - dgx)) * ihy2;
+                ez -= w * (phi2(i + dgx * dgy) - phi2(i - dgx * dgy)) * ihz2;
+            }
 
-            if (iy==0) { iyl = 0; iyr = 1; idy = ihy*2; }
-            else if (iy==gy-1) { iyl = gy-2; iyr = gy-1; idy = ihy; }
-            else { iyl = iy-1; iyr = iy+1; idy = ihy; }
+            KOKKOS_INLINE_FUNCTION
+            void
+            operator()(const int i) const
+            {
+                if (!masks(i)) return;
 
-            if (iz==0) { izl = 0; izr = 1; idz = ihz*2; }
-            else if (iz==gz-1) { izl = gz-2; izr = gz-1; idz = ihz; }
-            else { izl = iz-1; izr = iz+1; idz = ihz; }
-#endif
+                int ix, iy, iz;
+                double ox, oy, oz;
 
-                int idx_r = iz * dgx * dgy + iy * dgx + ixr;
-                int idx_l = iz * dgx * dgy + iy * dgx + ixl;
-                enx(i) = -(phi2(idx_r) - phi2(idx_l)) * idx;
+                get_leftmost_indices_offset(parts(i, 0), lx, ihx, ix, ox);
+                get_leftmost_indices_offset(parts(i, 2), ly, ihy, iy, oy);
+                get_leftmost_indices_offset(parts(i, 4), lz, ihz, iz, oz);
 
-                idx_r = iz * dgx * dgy + iyr * dgx + ix;
-                idx_l = iz * dgx * dgy + iyl * dgx + ix;
-                eny(i) = -(phi2(idx_r) - phi2(idx_l)) * idy;
+                if (ix < 0 || ix >= gx - 1 || iy < 0 || iy >= gy - 1 ||
+                    iz < 0 || iz >= gz - 1)
+                    return;
 
-                idx_r = izr * dgx * dgy + iy * dgx + ix;
-                idx_l = izl * dgx * dgy + iy * dgx + ix;
-                enz(i) = -(phi2(idx_r) - phi2(idx_l)) * idz;
+                double aox = 1.0 - ox;
+                double aoy = 1.0 - oy;
+                double aoz = 1.0 - oz;
+
+                double ex = 0.0, ey = 0.0, ez = 0.0;
+
+                add_field(ix, iy, iz, aoz * aoy * aox, ex, ey, ez);
+                add_field(ix + 1, iy, iz, aoz * aoy * ox, ex, ey, ez);
+                add_field(ix, iy + 1, iz, aoz * oy * aox, ex, ey, ez);
+                add_field(ix + 1, iy + 1, iz, aoz * oy * ox, ex, ey, ez);
+                add_field(ix, iy, iz + 1, oz * aoy * aox, ex, ey, ez);
+                add_field(ix + 1, iy, iz + 1, oz * aoy * ox, ex, ey, ez);
+                add_field(ix, iy + 1, iz + 1, oz * oy * aox, ex, ey, ez);
+                add_field(ix + 1, iy + 1, iz + 1, oz * oy * ox, ex, ey, ez);
+
+                double p = pref + parts(i, 5) * pref;
+                double Eoc_i = std::sqrt(p * p + m * m);
+                double Eoc_f = Eoc_i + factor * (-pref) * ez;
+                double dpop = (std::sqrt(Eoc_f * Eoc_f - m * m) -
+                               std::sqrt(Eoc_i * Eoc_i - m * m)) /
+                              pref;
+
+                parts(i, 5) += dpop;
+                parts(i, 3) += factor * ey;
+                parts(i, 1) += factor * ex;
             }
         };
-
     }
 
     /*! Kernels where the data has xyz ordering */
@@ -381,6 +381,8 @@ Space_charge_3d_open_hockney::Space_charge_3d_open_hockney(
     , domain(ops.shape, {1.0, 1.0, 1.0})
     , doubled_domain(ops.doubled_shape, {1.0, 1.0, 1.0})
     , ffts()
+    , trackers()
+    , green_key{-1, -1, -1}
 {
 
     if (ops.domain_fixed) {
@@ -414,7 +416,13 @@ Space_charge_3d_open_hockney::apply_impl(Bunch_simulator& sim,
     // apply to bunches
     for (size_t t = 0; t < 2; ++t) {
         for (size_t b = 0; b < sim[t].get_bunch_array_size(); ++b) {
-            apply_bunch(sim[t][b], ffts[t][b], time_step, logger);
+            std::array<int, 3> key{int(t), int(b), 0};
+            apply_bunch(sim[t][b],
+                        ffts[t][b],
+                        trackers[t][b],
+                        key,
+                        time_step,
+                        logger);
         }
     }
 }
@@ -422,33 +430,144 @@ Space_charge_3d_open_hockney::apply_impl(Bunch_simulator& sim,
 void
 Space_charge_3d_open_hockney::apply_bunch(Bunch& bunch,
                                           Distributed_fft3d& fft,
+                                          Domain_tracker& tracker,
+                                          std::array<int, 3> const& key,
                                           double time_step,
                                           Logger& logger)
 {
     // update domain only when not using fixed
-    if (!use_fixed_domain) update_domain(bunch);
+    if (!use_fixed_domain) update_domain(bunch, tracker);
 
     // charge density
-    get_local_charge_density(bunch); // [C/m^3]
+    get_local_charge_density(bunch, tracker); // [C/m^3]
     get_global_charge_density(bunch);
 
-    // green function
-    if (options.green_fn == green_fn_t::pointlike) {
-        get_green_fn2_pointlike();
-    } else {
-        get_green_fn2_linear();
+    solve_and_kick(bunch, fft, tracker, key, time_step);
+}
+
+bool
+Space_charge_3d_open_hockney::begin_bunch_impl(Bunch_simulator& sim,
+                                               int t,
+                                               int b,
+                                               double time_step,
+                                               Logger& logger)
+{
+    if (bunch_sim_id != sim.id()) {
+        construct_workspaces(sim);
+        bunch_sim_id = sim.id();
+    }
+
+    auto& bunch = sim[t][b];
+    std::array<int, 3> key{t, b, 0};
+
+    // nothing to overlap for a bunch on a single rank
+    if (bunch.get_comm().size() == 1) {
+        logger << "    Space charge 3d open hockney\n";
+        scoped_simple_timer timer("sc3d_total");
+
+        apply_bunch(
+            bunch, ffts[t][b], trackers[t][b], key, time_step, logger);
+        return false;
+    }
+
+    scoped_simple_timer timer("sc3d_begin");
+
+    if (!use_fixed_domain) update_domain(bunch, trackers[t][b]);
+    get_local_charge_density(bunch, trackers[t][b]);
+
+    // rho2 is reused by the next bunch, so the reduction works on its
+    // own host copy
+    auto& rr = reduces[t][b];
+    if (rr.rho.extent(0) != rho2.extent(0))
+        rr.rho = karray1d_hst("rho2_reduce", rho2.extent(0));
+
+    Kokkos::deep_copy(rr.rho, rho2);
+
+    int err = MPI_Iallreduce(MPI_IN_PLACE,
+                             (void*)rr.rho.data(),
+                             rr.rho.extent(0),
+                             MPI_DOUBLE,
+                             MPI_SUM,
+                             bunch.get_comm(),
+                             &rr.request);
+
+    if (err != MPI_SUCCESS) {
+        throw std::runtime_error(
+            "MPI error in Space_charge_3d_open_hockney"
+            "(MPI_Iallreduce in begin_bunch)");
+    }
+
+    rr.pending = true;
+    return true;
+}
+
+bool
+Space_charge_3d_open_hockney::test_bunch_impl(int t, int b)
+{
+    auto& rr = reduces[t][b];
+    if (!rr.pending) return true;
+
+    int flag = 0;
+    MPI_Test(&rr.request, &flag, MPI_STATUS_IGNORE);
+    return flag;
+}
+
+void
+Space_charge_3d_open_hockney::finish_bunch_impl(Bunch_simulator& sim,
+                                                int t,
+                                                int b,
+                                                double time_step,
+                                                Logger& logger)
+{
+    auto& rr = reduces[t][b];
+    if (!rr.pending) return;
+
+    logger << "    Space charge 3d open hockney\n";
+    scoped_simple_timer timer("sc3d_finish");
+
+    simple_timer_start("sc3d_global_rho_reduce");
+    MPI_Wait(&rr.request, MPI_STATUS_IGNORE);
+    simple_timer_stop("sc3d_global_rho_reduce");
+
+    rr.pending = false;
+    Kokkos::deep_copy(rho2, rr.rho);
+
+    // the domain of this bunch, other bunches may have been begun since
+    if (!use_fixed_domain) set_domain(trackers[t][b]);
+
+    std::array<int, 3> key{t, b, 0};
+    solve_and_kick(sim[t][b], ffts[t][b], trackers[t][b], key, time_step);
+}
+
+void
+Space_charge_3d_open_hockney::solve_and_kick(Bunch& bunch,
+                                             Distributed_fft3d& fft,
+                                             Domain_tracker const& tracker,
+                                             std::array<int, 3> const& key,
+                                             double time_step)
+{
+    // green function, reused as long as the same bunch is being
+    // processed and its domain has not changed
+    std::array<int, 3> gkey{key[0], key[1], tracker.get_revision()};
+    bool new_green = (gkey != green_key);
+
+    if (new_green) {
+        if (options.green_fn == green_fn_t::pointlike) {
+            get_green_fn2_pointlike();
+        } else {
+            get_green_fn2_linear();
+        }
+
+        green_key = gkey;
     }
 
     // potential
-    get_local_phi2(fft);
+    get_local_phi2(fft, new_green);
     get_global_phi2(fft);
 
     auto fn_norm = get_normalization_force(fft);
 
-    // force
-    get_force();
-
-    // kick
+    // field and kick
     apply_kick(bunch, fn_norm, time_step);
 }
 
@@ -470,8 +589,20 @@ Space_charge_3d_open_hockney::construct_workspaces(Bunch_simulator const& sim)
 
             ffts[t][b].construct(s, comm);
         }
+
+        reduces[t] = std::vector<rho_reduce>(num_local_bunches);
+
+        trackers[t].clear();
+        trackers[t].reserve(num_local_bunches);
+
+        for (size_t b = 0; b < num_local_bunches; ++b) {
+            trackers[t].emplace_back(options.domain_centroid_tolerance,
+                                     options.domain_size_tolerance);
+        }
     }
 
+    green_key = {-1, -1, -1};
+
     // local workspaces
     int nx_real = Distributed_fft3d::get_padded_shape_real(s[0]);
     int nx_cplx = Distributed_fft3d::get_padded_shape_cplx(s[0]);
@@ -483,29 +614,24 @@ Space_charge_3d_open_hockney::construct_workspaces(Bunch_simulator const& sim)
 
     h_rho2 = Kokkos::create_mirror_view(rho2);
     h_phi2 = Kokkos::create_mirror_view(phi2);
-
-    // En is in the original domain
-    enx = karray1d_dev("enx", s[0] * s[1] * s[2] / 8);
-    eny = karray1d_dev("eny", s[0] * s[1] * s[2] / 8);
-    enz = karray1d_dev("enz", s[0] * s[1] * s[2] / 8);
 }
 
 void
-Space_charge_3d_open_hockney::update_domain(Bunch const& bunch)
+Space_charge_3d_open_hockney::update_domain(Bunch const& bunch,
+                                            Domain_tracker& tracker)
 {
     scoped_simple_timer timer("sc3d_domain");
 
     // do nothing for fixed domain
     if (options.domain_fixed) return;
 
-    auto spatial_mean_stddev =
-        Core_diagnostics::calculate_spatial_mean_stddev(bunch);
-    auto mean_x = spatial_mean_stddev(0);
-    auto mean_y = spatial_mean_stddev(1);
-    auto mean_z = spatial_mean_stddev(2);
-    auto stddev_x = spatial_mean_stddev(3);
-    auto stddev_y = spatial_mean_stddev(4);
-    auto stddev_z = spatial_mean_stddev(5);
+    auto spatial_mean_stddev = tracker.get_mean_stddev(bunch);
+    auto mean_x = spatial_mean_stddev[0];
+    auto mean_y = spatial_mean_stddev[1];
+    auto mean_z = spatial_mean_stddev[2];
+    auto stddev_x = spatial_mean_stddev[3];
+    auto stddev_y = spatial_mean_stddev[4];
+    auto stddev_z = spatial_mean_stddev[5];
 
     const double tiny = 1.0e-10;
 
@@ -530,6 +656,19 @@ Space_charge_3d_open_hockney::update_domain(Bunch const& bunch)
         size[2] = options.z_period;
     }
 
+    // the tracker keeps the current domain if the beam has not moved or
+    // changed size beyond the tolerances
+    tracker.update(offset, size);
+    set_domain(tracker);
+}
+
+void
+Space_charge_3d_open_hockney::set_domain(Domain_tracker const& tracker)
+{
+    // the domains are shared by all bunches
+    auto const& offset = tracker.get_offset();
+    auto const& size = tracker.get_size();
+
     std::array<double, 3> doubled_size{
         size[0] * 2.0, size[1] * 2.0, size[2] * 2.0};
 
@@ -540,18 +679,27 @@ Space_charge_3d_open_hockney::update_domain(Bunch const& bunch)
 }
 
 void
-Space_charge_3d_open_hockney::get_local_charge_density(Bunch const& bunch)
+Space_charge_3d_open_hockney::get_local_charge_density(
+    Bunch const& bunch,
+    Domain_tracker& tracker)
 {
     scoped_simple_timer timer("sc3d_local_rho");
 
     auto dg = doubled_domain.get_grid_shape();
     dg[0] = Distributed_fft3d::get_padded_shape_real(dg[0]);
 
+    // beam moments for the domain of the next kick
+    auto moments = tracker.deposit_moments();
+
 #ifdef SYNERGIA_ENABLE_CUDA
-    deposit_charge_rectangular_3d_kokkos_scatter_view(rho2, domain, dg, bunch);
+    deposit_charge_rectangular_3d_kokkos_scatter_view(
+        rho2, domain, dg, bunch, moments);
 #else
-    deposit_charge_rectangular_3d_omp_reduce(rho2, domain, dg, bunch);
+    deposit_charge_rectangular_3d_omp_reduce(
+        rho2, domain, dg, bunch, moments);
 #endif
+
+    tracker.start_reduce(bunch);
 }
 
 void
@@ -639,7 +787,8 @@ Space_charge_3d_open_hockney::get_green_fn2_linear()
 }
 
 void
-Space_charge_3d_open_hockney::get_local_phi2(Distributed_fft3d& fft)
+Space_charge_3d_open_hockney::get_local_phi2(Distributed_fft3d& fft,
+                                             bool transform_green)
 {
     scoped_simple_timer timer("sc3d_local_f");
 
@@ -649,8 +798,11 @@ Space_charge_3d_open_hockney::get_local_phi2(Distributed_fft3d& fft)
     fft.transform(rho2, rho2);
     Kokkos::fence();
 
-    fft.transform(g2, g2);
-    Kokkos::fence();
+    // g2 is kept transformed while it is being reused
+    if (transform_green) {
+        fft.transform(g2, g2);
+        Kokkos::fence();
+    }
 
     // zero phi2 when using multiple ranks
     if (fft.get_comm().size() > 1) {
@@ -734,21 +886,6 @@ Space_charge_3d_open_hockney::get_normalization_force(
     return normalization;
 }
 
-void
-Space_charge_3d_open_hockney::get_force()
-{
-    auto g = domain.get_grid_shape();
-    auto h = doubled_domain.get_cell_size();
-    auto dg = doubled_domain.get_grid_shape();
-
-    // phi2 is in (padded_real_dgx, dgy, dgz)
-    // en{x|y|z} is in (gx, gy, gz)
-    sc3d_kernels::zyx::alg_force_extractor_doubled_domain alg(
-        phi2, enx, eny, enz, g, dg, h);
-    Kokkos::parallel_for(g[0] * g[1] * g[2], alg);
-    Kokkos::fence();
-}
-
 void
 Space_charge_3d_open_hockney::apply_kick(Bunch& bunch,
                                          double fn_norm,
@@ -773,11 +910,15 @@ Space_charge_3d_open_hockney::apply_kick(Bunch& bunch,
     auto masks = bunch.get_local_particle_masks();
 
     auto g = domain.get_grid_shape();
+    auto dg = doubled_domain.get_grid_shape();
     auto h = domain.get_cell_size();
+    auto dh = doubled_domain.get_cell_size();
     auto l = domain.get_left();
 
-    sc3d_kernels::zyx::alg_kicker kicker(
-        parts, masks, enx, eny, enz, g, h, l, factor, pref, m);
+    // the field is differentiated from phi2 in the same particle pass,
+    // phi2 is in (padded_real_dgx, dgy, dgz)
+    sc3d_kernels::zyx::alg_gather_kicker_doubled_domain kicker(
+        parts, masks, phi2, g, dg, h, dh, l, factor, pref, m);
 
     Kokkos::parallel_for(bunch.size(), kicker);
     Kokkos::fence();
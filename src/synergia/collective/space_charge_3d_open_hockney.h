@@ -4,6 +4,7 @@
 #include "synergia/simulation/collective_operator.h"
 #include "synergia/simulation/implemented_collective_options.h"
 
+#include "synergia/collective/domain_tracker.h"
 #include "synergia/collective/rectangular_grid.h"
 #include "synergia/collective/rectangular_grid_domain.h"
 
@@ -24,6 +25,11 @@ class Space_charge_3d_open_hockney : public Collective_operator {
     bool use_fixed_domain;
 
     std::array<std::vector<Distributed_fft3d>, 2> ffts;
+    std::array<std::vector<Domain_tracker>, 2> trackers;
+
+    // (train, bunch, domain revision) of the transformed green function
+    // currently held in g2
+    std::array<int, 3> green_key;
 
     karray1d_dev rho2;
     karray1d_dev phi2;
@@ -32,25 +38,63 @@ class Space_charge_3d_open_hockney : public Collective_operator {
     karray1d_hst h_rho2;
     karray1d_hst h_phi2;
 
-    karray1d_dev enx;
-    karray1d_dev eny;
-    karray1d_dev enz;
+    // charge density of a bunch being reduced in the pipelined apply,
+    // from begin_bunch() to finish_bunch()
+    struct rho_reduce {
+        karray1d_hst rho;
+        MPI_Request request = MPI_REQUEST_NULL;
+        bool pending = false;
+    };
+
+    std::array<std::vector<rho_reduce>, 2> reduces;
 
   private:
     void apply_impl(Bunch_simulator& simulator,
                     double time_step,
                     Logger& logger);
 
+    bool
+    pipelined_impl() const override
+    {
+        return true;
+    }
+
+    bool begin_bunch_impl(Bunch_simulator& simulator,
+                          int train,
+                          int bunch,
+                          double time_step,
+                          Logger& logger) override;
+
+    bool test_bunch_impl(int train, int bunch) override;
+
+    void finish_bunch_impl(Bunch_simulator& simulator,
+                           int train,
+                           int bunch,
+                           double time_step,
+                           Logger& logger) override;
+
     void apply_bunch(Bunch& bunch,
                      Distributed_fft3d& fft,
+                     Domain_tracker& tracker,
+                     std::array<int, 3> const& key,
                      double time_step,
                      Logger& logger);
 
+    // green function, potential, force and kick from the global charge
+    // density in rho2
+    void solve_and_kick(Bunch& bunch,
+                        Distributed_fft3d& fft,
+                        Domain_tracker const& tracker,
+                        std::array<int, 3> const& key,
+                        double time_step);
+
     void construct_workspaces(Bunch_simulator const& sim);
 
-    void update_domain(Bunch const& bunch);
+    void update_domain(Bunch const& bunch, Domain_tracker& tracker);
 
-    void get_local_charge_density(Bunch const& bunch);
+    void set_domain(Domain_tracker const& tracker);
+
+    void get_local_charge_density(Bunch const& bunch, Domain_tracker& tracker);
 
     void get_global_charge_density(Bunch const& bunch);
 
@@ -59,12 +103,10 @@ class Space_charge_3d_open_hockney : public Collective_operator {
     void get_green_fn2_pointlike();
     void get_green_fn2_linear();
 
-    void get_local_phi2(Distributed_fft3d& fft);
+    void get_local_phi2(Distributed_fft3d& fft, bool transform_green);
 
     void get_global_phi2(Distributed_fft3d const& fft);
 
-    void get_force();
-
     double get_normalization_force(Distributed_fft3d const& fft);
 
   public:
@@ -3,6 +3,7 @@
 #include "synergia/foundation/physical_constants.h"
 
 #include "synergia/collective/deposit.h"
+#include "synergia/collective/domain_tracker.h"
 
 const double mass = 100.0;
 const double total_energy = 125.0;
@@ -93,3 +94,128 @@ TEST_CASE("OneParticle", "[OneParticle]")
   // one particle is deposited
   CHECK(sums == Approx(1).margin(.01));
 }
+
+TEST_CASE("DepositMoments", "[DepositMoments]")
+{
+  Four_momentum fm(mass, total_energy);
+  Reference_particle ref(pconstants::proton_charge, fm);
+
+  Bunch bunch(ref, 1, 1, Commxx());
+
+  bunch.checkout_particles();
+  auto bunch_parts = bunch.get_host_particles();
+  bunch_parts.access(0, 0) = 1.5;
+  bunch_parts.access(0, 2) = -0.5;
+  bunch_parts.access(0, 4) = 2.0;
+  bunch.checkin_particles();
+
+  Rectangular_grid_domain domain({6, 6, 6}, {6, 6, 6}, {2, 2, 2}, false);
+
+  const std::array<int, 3> dims{6, 6, 6};
+  karray1d_dev rho_dev("rho_dev", 216);
+  karray1d moments("moments", Domain_tracker::num_moments);
+
+  deposit_charge_rectangular_3d_kokkos_scatter_view(
+    rho_dev, domain, dims, bunch, &moments);
+
+  CHECK(moments(0) == Approx(1.0));
+  CHECK(moments(1) == Approx(1.5));
+  CHECK(moments(2) == Approx(-0.5));
+  CHECK(moments(3) == Approx(2.0));
+  CHECK(moments(4) == Approx(2.25));
+  CHECK(moments(5) == Approx(0.25));
+  CHECK(moments(6) == Approx(4.0));
+}
+
+TEST_CASE("DomainTrackerHysteresis", "[DomainTrackerHysteresis]")
+{
+  Domain_tracker tracker(0.1, 0.2);
+  CHECK(tracker.hysteresis());
+
+  // first domain is always adopted
+  CHECK(tracker.update({0, 0, 0}, {1, 1, 1}));
+  CHECK(tracker.get_revision() == 1);
+
+  // small drift and growth within the tolerances
+  CHECK(!tracker.update({0.05, 0, 0}, {1.1, 1, 1}));
+  CHECK(!tracker.domain_changed());
+  CHECK(tracker.get_revision() == 1);
+  CHECK(tracker.get_offset()[0] == 0.0);
+  CHECK(tracker.get_size()[0] == 1.0);
+
+  // centroid moved beyond the tolerance
+  CHECK(tracker.update({0, 0.2, 0}, {1, 1, 1}));
+  CHECK(tracker.get_revision() == 2);
+  CHECK(tracker.get_offset()[1] == 0.2);
+
+  // size changed beyond the tolerance
+  CHECK(tracker.update({0, 0.2, 0}, {1, 1, 1.5}));
+  CHECK(tracker.get_revision() == 3);
+  CHECK(tracker.get_size()[2] == 1.5);
+
+  // no hysteresis follows every change
+  Domain_tracker follower;
+  CHECK(!follower.hysteresis());
+  CHECK(follower.deposit_moments() == nullptr);
+  CHECK(follower.update({0, 0, 0}, {1, 1, 1}));
+  CHECK(follower.update({1e-9, 0, 0}, {1, 1, 1}));
+}
+
+TEST_CASE("DepositFloat", "[DepositFloat]")
+{
+  Four_momentum fm(mass, total_energy);
+  Reference_particle ref(pconstants::proton_charge, fm);
+
+  Bunch bunch(ref, total_num, real_num, Commxx());
+  BunchF fbunch(ref, 1, real_num, Commxx());
+
+  bunch.checkout_particles();
+  auto parts = bunch.get_host_particles();
+
+  // irrational steps, so no particle sits on a cell boundary
+  for (int i = 0; i < total_num; ++i) {
+    parts(i, 0) = 1.5 * std::sin(1.3 * i + 0.1);
+    parts(i, 2) = 1.5 * std::cos(0.7 * i + 0.2);
+    parts(i, 4) = 1.5 * std::sin(0.3 * i + 0.3);
+  }
+
+  bunch.checkin_particles();
+  fbunch.assign(bunch);
+
+  Rectangular_grid_domain domain({8, 8, 8}, {4, 4, 4}, {0, 0, 0}, false);
+
+  auto h = domain.get_cell_size();
+  double weight0 = (real_num / total_num) * bunch.get_particle_charge() *
+                   pconstants::e / (h[0] * h[1] * h[2]);
+
+  const std::array<int, 3> dims{8, 8, 8};
+  const int size = dims[0] * dims[1] * dims[2];
+
+  karray1d_dev rho("rho", size);
+  karray1d_dev frho("frho", size);
+
+  karray1d moments("moments", Domain_tracker::num_moments);
+  karray1d fmoments("fmoments", Domain_tracker::num_moments);
+
+  deposit_charge_rectangular_3d_kokkos_scatter_view(
+    rho, domain, dims, bunch, &moments);
+
+  deposit_charge_rectangular_3d_kokkos_scatter_view(
+    frho, domain, dims, fbunch, &fmoments);
+
+  karray1d_hst hrho = Kokkos::create_mirror_view(rho);
+  karray1d_hst hfrho = Kokkos::create_mirror_view(frho);
+  Kokkos::deep_copy(hrho, rho);
+  Kokkos::deep_copy(hfrho, frho);
+
+  // the float positions are within ~1e-7 of the double ones, which
+  // moves at most that fraction of a particle between the cells
+  for (int idx = 0; idx < size; ++idx) {
+    CHECK(hfrho(idx) / weight0 ==
+          Approx(hrho(idx) / weight0).epsilon(1e-5).margin(1e-5));
+  }
+
+  for (int m = 0; m < Domain_tracker::num_moments; ++m) {
+    CHECK(fmoments(m) == Approx(moments(m)).epsilon(1e-5).margin(1e-6));
+  }
+}
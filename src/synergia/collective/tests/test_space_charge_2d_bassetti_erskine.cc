@@ -0,0 +1,125 @@
+#include "synergia/utils/catch.hpp"
+
+#include "synergia/collective/space_charge_2d_bassetti_erskine.h"
+#include "synergia/foundation/physical_constants.h"
+
+namespace {
+    const double real_num = 1.0e11;
+    const double beam_gamma = 61.0 / 11.0;
+    const double sigma = 1.0e-3;
+    const double sigma_cdt = 0.5;
+    const double step_length = 0.1;
+
+    // probes at 0.25, 0.5, 1, 2 and 4 sigma along a few directions
+    const int num_probes = 15;
+
+    Bunch_simulator
+    create_probes()
+    {
+        auto sim = Bunch_simulator::create_single_bunch_simulator(
+            Reference_particle(pconstants::proton_charge,
+                               Four_momentum(pconstants::mp,
+                                             pconstants::mp * beam_gamma)),
+            num_probes,
+            real_num);
+
+        auto& bunch = sim.get_bunch();
+        auto parts = bunch.get_host_particles();
+
+        const double angles[] = {0.3, 1.1, 2.5};
+        const double radii[] = {0.25, 0.5, 1.0, 2.0, 4.0};
+
+        int i = 0;
+        for (double a : angles) {
+            for (double r : radii) {
+                for (int j = 0; j < 6; ++j)
+                    parts(i, j) = 0.0;
+
+                parts(i, Bunch::x) = r * sigma * cos(a);
+                parts(i, Bunch::y) = r * sigma * sin(a);
+                ++i;
+            }
+        }
+
+        bunch.checkin_particles();
+        return sim;
+    }
+
+    void
+    apply_kick(Bunch_simulator& sim, double sigma_x, double sigma_y)
+    {
+        Logger logger(0, LoggerV::DEBUG);
+
+        Space_charge_2d_bassetti_erskine_options opts;
+        opts.strictly_centered = true;
+        opts.frozen_sigma = true;
+        opts.sigma_x = sigma_x;
+        opts.sigma_y = sigma_y;
+        opts.sigma_cdt = sigma_cdt;
+
+        auto const& ref = sim.get_bunch().get_reference_particle();
+        double time_step = step_length / (ref.get_beta() * pconstants::c);
+
+        Space_charge_2d_bassetti_erskine sc(opts);
+        sc.apply(sim, time_step, logger);
+
+        sim.get_bunch().checkout_particles();
+    }
+}
+
+TEST_CASE("round_gaussian_kick", "[Space_charge_2d_bassetti_erskine]")
+{
+    auto sim = create_probes();
+    apply_kick(sim, sigma, sigma);
+
+    auto& bunch = sim.get_bunch();
+    auto parts = bunch.get_host_particles();
+
+    double beta = bunch.get_reference_particle().get_beta();
+    double N = bunch.get_real_num();
+
+    // uniform line density over L = sqrt(12) sigma_z. The enclosed
+    // charge at radius r is the fraction 1 - exp(-r^2/(2 sigma^2)) of
+    // the line charge, so the rod kick (see the 3d open Hockney test)
+    //
+    //   dp/p = 2 N r_p / (L beta^2 gamma^3) * D / r
+    //
+    // is reduced by that fraction
+    double L = std::sqrt(12.0) * sigma_cdt * beta;
+    double rod = 2.0 * N * pconstants::rp * step_length /
+                 (L * beta * beta * beam_gamma * beam_gamma * beam_gamma);
+
+    for (int i = 0; i < num_probes; ++i) {
+        double x = parts(i, Bunch::x);
+        double y = parts(i, Bunch::y);
+        double r2 = x * x + y * y;
+        double g = rod * (1.0 - exp(-0.5 * r2 / (sigma * sigma))) / r2;
+
+        CHECK(parts(i, Bunch::xp) == Approx(g * x).epsilon(1.0e-10));
+        CHECK(parts(i, Bunch::yp) == Approx(g * y).epsilon(1.0e-10));
+    }
+}
+
+TEST_CASE("elliptic_to_round_limit", "[Space_charge_2d_bassetti_erskine]")
+{
+    auto round = create_probes();
+    apply_kick(round, sigma, sigma);
+
+    auto pr = round.get_bunch().get_host_particles();
+
+    // the elliptic field approaches the round one linearly in the
+    // relative difference of the sizes, for either major axis
+    for (double eps : {1.0e-2, 1.0e-3, -1.0e-3}) {
+        auto ellip = create_probes();
+        apply_kick(ellip, sigma * (1.0 + eps), sigma);
+
+        auto pe = ellip.get_bunch().get_host_particles();
+
+        for (int i = 0; i < num_probes; ++i) {
+            CHECK(pe(i, Bunch::xp) ==
+                  Approx(pr(i, Bunch::xp)).epsilon(2.0 * std::abs(eps)));
+            CHECK(pe(i, Bunch::yp) ==
+                  Approx(pr(i, Bunch::yp)).epsilon(2.0 * std::abs(eps)));
+        }
+    }
+}
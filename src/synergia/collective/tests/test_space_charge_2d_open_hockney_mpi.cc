@@ -0,0 +1,340 @@
+#include "synergia/utils/catch.hpp"
+
+#include "synergia/collective/space_charge_2d_open_hockney.h"
+#include "synergia/foundation/physical_constants.h"
+
+namespace {
+    const double real_num = 1.0e11;
+    const double beam_gamma = 61.0 / 11.0;
+    const double step_length = 0.1;
+
+    // every layer in z has the same transverse pattern of particles
+    const int pattern = 5;
+    const int per_layer = pattern * pattern;
+    const int num_layers = 240;
+    const double bunch_cdt = 1.0;
+
+    // 240 layers split evenly over 1 to 4 ranks
+    const int total_num = per_layer * num_layers;
+
+    Bunch_simulator
+    create_uniform_bunch()
+    {
+        auto sim = Bunch_simulator::create_single_bunch_simulator(
+            Reference_particle(pconstants::proton_charge,
+                               Four_momentum(pconstants::mp,
+                                             pconstants::mp * beam_gamma)),
+            total_num,
+            real_num);
+
+        auto& bunch = sim.get_bunch();
+        auto parts = bunch.get_host_particles();
+
+        int local_layers = bunch.get_local_num() / per_layer;
+        int first_layer = Commxx::world_rank() * local_layers;
+
+        for (int l = 0; l < local_layers; ++l) {
+            double z = bunch_cdt * ((first_layer + l + 0.5) / num_layers - 0.5);
+
+            for (int i = 0; i < pattern; ++i) {
+                for (int j = 0; j < pattern; ++j) {
+                    int p = l * per_layer + i * pattern + j;
+
+                    for (int k = 0; k < 6; ++k)
+                        parts(p, k) = 0.0;
+
+                    parts(p, Bunch::x) = 1.0e-3 * (i - 2 + 0.13 * j);
+                    parts(p, Bunch::y) = 0.7e-3 * (j - 2 + 0.07 * i);
+                    parts(p, Bunch::cdt) = z;
+                }
+            }
+        }
+
+        bunch.checkin_particles();
+        return sim;
+    }
+
+    void
+    apply_kick(Bunch_simulator& sim, bool slice_parallel)
+    {
+        Logger logger(0, LoggerV::DEBUG);
+
+        // gridz is not divisible by 3 or 4 ranks
+        Space_charge_2d_open_hockney_options opts(32, 32, 10);
+        opts.slice_parallel = slice_parallel;
+
+        auto const& ref = sim.get_bunch().get_reference_particle();
+        double time_step = step_length / (ref.get_beta() * pconstants::c);
+
+        Space_charge_2d_open_hockney sc(opts);
+        sc.apply(sim, time_step, logger);
+
+        sim.get_bunch().checkout_particles();
+    }
+}
+
+TEST_CASE("slice_parallel_uniform_beam", "[Space_charge_2d_open_hockney]")
+{
+    REQUIRE(total_num % (per_layer * Commxx::world_size()) == 0);
+
+    auto projected = create_uniform_bunch();
+    apply_kick(projected, false);
+
+    auto sliced = create_uniform_bunch();
+    apply_kick(sliced, true);
+
+    auto pp = projected.get_bunch().get_host_particles();
+    auto ps = sliced.get_bunch().get_host_particles();
+
+    int num = projected.get_bunch().get_local_num();
+
+    double max_kick = 0.0;
+    for (int i = 0; i < num; ++i) {
+        max_kick = std::max(max_kick, std::abs(pp(i, Bunch::xp)));
+        max_kick = std::max(max_kick, std::abs(pp(i, Bunch::yp)));
+    }
+
+    REQUIRE(max_kick > 0.0);
+
+    // every slice has the transverse distribution of the whole bunch,
+    // so the slice fields are the projected field times the line
+    // density, up to round-off
+    double margin = 1.0e-9 * max_kick;
+
+    for (int i = 0; i < num; ++i) {
+        CHECK(ps(i, Bunch::xp) == Approx(pp(i, Bunch::xp)).margin(margin));
+        CHECK(ps(i, Bunch::yp) == Approx(pp(i, Bunch::yp)).margin(margin));
+    }
+}
+
+namespace {
+    // two beams at different z on a periodic grid of 10 slices over the
+    // whole period [-0.5, 0.5). Slice i is centred at -0.45 + 0.1 * i.
+    // Beam a has 10 layers from cdt = -0.25 to 0.2, on the slice centres
+    // and half way between them, so it only touches the slices 2 to 7.
+    // Beam b has 6 layers from 0.35 to 0.6, wrapping around the period
+    // onto the slices 8, 9, 0 and 1
+    const int zdep_gridz = 10;
+    const double zdep_period = 1.0;
+    const double zdep_dz = 0.05;
+
+    const int zdep_per_layer = 12;
+    const int zdep_layers[2] = {10, 6};
+    const double zdep_first_z[2] = {-0.25, 0.35};
+
+    // same charge for every macroparticle of all the bunches
+    const double zdep_real_per_macro = 1.0e9;
+
+    // transverse pattern of the layers, with zero mean. Beam b has the
+    // pattern of beam a mirrored through the origin, so all the bunches
+    // made of a, b or both have the same transverse domain
+    std::array<double, 2>
+    zdep_point(int beam, int k)
+    {
+        double x = 1.0e-3 * std::sin(1.3 * k + 0.1);
+        double y = 0.7e-3 * std::cos(0.7 * k + 0.2);
+
+        double mx = 0.0;
+        double my = 0.0;
+
+        for (int j = 0; j < zdep_per_layer; ++j) {
+            mx += 1.0e-3 * std::sin(1.3 * j + 0.1) / zdep_per_layer;
+            my += 0.7e-3 * std::cos(0.7 * j + 0.2) / zdep_per_layer;
+        }
+
+        double sign = (beam == 0) ? 1.0 : -1.0;
+        return {sign * (x - mx), sign * (y - my)};
+    }
+
+    int
+    zdep_beam_num(int beam)
+    {
+        return zdep_layers[beam] * zdep_per_layer;
+    }
+
+    // a bunch of the given beams. Each rank holds an equal share of
+    // every beam, the particles of beam a first
+    Bunch_simulator
+    create_zdep_bunch(std::vector<int> const& beams)
+    {
+        const int ranks = Commxx::world_size();
+        const int rank = Commxx::world_rank();
+
+        int total = 0;
+        for (int beam : beams)
+            total += zdep_beam_num(beam);
+
+        auto sim = Bunch_simulator::create_single_bunch_simulator(
+            Reference_particle(
+                pconstants::proton_charge,
+                Four_momentum(pconstants::mp, pconstants::mp * beam_gamma)),
+            total,
+            total * zdep_real_per_macro);
+
+        auto& bunch = sim.get_bunch();
+        auto parts = bunch.get_host_particles();
+
+        REQUIRE(bunch.get_local_num() == total / ranks);
+
+        int p = 0;
+
+        for (int beam : beams) {
+            int local = zdep_beam_num(beam) / ranks;
+
+            for (int i = 0; i < local; ++i, ++p) {
+                int g = rank * local + i;
+                int layer = g / zdep_per_layer;
+                auto xy = zdep_point(beam, g % zdep_per_layer);
+
+                for (int k = 0; k < 6; ++k)
+                    parts(p, k) = 0.0;
+
+                parts(p, Bunch::x) = xy[0];
+                parts(p, Bunch::y) = xy[1];
+                parts(p, Bunch::cdt) = zdep_first_z[beam] + layer * zdep_dz;
+            }
+        }
+
+        bunch.checkin_particles();
+        return sim;
+    }
+
+    // kicks (xp, yp) of all the particles of the beam, from all ranks
+    std::vector<double>
+    gather_zdep_kicks(Bunch_simulator& sim,
+                      std::vector<int> const& beams,
+                      int beam)
+    {
+        auto& bunch = sim.get_bunch();
+        bunch.checkout_particles();
+
+        auto parts = bunch.get_host_particles();
+
+        const int ranks = Commxx::world_size();
+
+        int first = 0;
+        for (int b : beams) {
+            if (b == beam) break;
+            first += zdep_beam_num(b) / ranks;
+        }
+
+        int local = zdep_beam_num(beam) / ranks;
+
+        std::vector<double> lkicks(local * 2);
+        for (int i = 0; i < local; ++i) {
+            lkicks[i * 2] = parts(first + i, Bunch::xp);
+            lkicks[i * 2 + 1] = parts(first + i, Bunch::yp);
+        }
+
+        std::vector<double> kicks(local * 2 * ranks);
+
+        MPI_Allgather(lkicks.data(),
+                      local * 2,
+                      MPI_DOUBLE,
+                      kicks.data(),
+                      local * 2,
+                      MPI_DOUBLE,
+                      MPI_COMM_WORLD);
+
+        return kicks;
+    }
+
+    void
+    apply_zdep_kick(Bunch_simulator& sim)
+    {
+        Logger logger(0, LoggerV::DEBUG);
+
+        Space_charge_2d_open_hockney_options opts(32, 32, zdep_gridz);
+        opts.slice_parallel = true;
+        opts.periodic_z = true;
+        opts.z_period = zdep_period;
+        opts.grid_entire_period = true;
+
+        auto const& ref = sim.get_bunch().get_reference_particle();
+        double time_step = step_length / (ref.get_beta() * pconstants::c);
+
+        Space_charge_2d_open_hockney sc(opts);
+        sc.apply(sim, time_step, logger);
+    }
+
+    double
+    max_abs(std::vector<double> const& v)
+    {
+        double m = 0.0;
+        for (double x : v)
+            m = std::max(m, std::abs(x));
+        return m;
+    }
+}
+
+TEST_CASE("slice_parallel_separated_beams", "[Space_charge_2d_open_hockney]")
+{
+    for (int beam : {0, 1})
+        REQUIRE(zdep_beam_num(beam) % Commxx::world_size() == 0);
+
+    auto both = create_zdep_bunch({0, 1});
+    apply_zdep_kick(both);
+
+    for (int beam : {0, 1}) {
+        auto single = create_zdep_bunch({beam});
+        apply_zdep_kick(single);
+
+        auto kb = gather_zdep_kicks(both, {0, 1}, beam);
+        auto ks = gather_zdep_kicks(single, {beam}, beam);
+
+        REQUIRE(kb.size() == ks.size());
+
+        double max_kick = max_abs(ks);
+        REQUIRE(max_kick > 0.0);
+
+        // the two beams have no slice in common, so each sees only its
+        // own fields. The wrapped slices of beam b go through the
+        // periodic deposit and interpolation
+        double margin = 1.0e-9 * max_kick;
+
+        for (size_t i = 0; i < kb.size(); ++i)
+            CHECK(kb[i] == Approx(ks[i]).margin(margin));
+    }
+}
+
+TEST_CASE("slice_parallel_z_interpolation", "[Space_charge_2d_open_hockney]")
+{
+    REQUIRE(zdep_beam_num(0) % Commxx::world_size() == 0);
+
+    auto sim = create_zdep_bunch({0});
+    apply_zdep_kick(sim);
+
+    auto kicks = gather_zdep_kicks(sim, {0}, 0);
+
+    double max_kick = max_abs(kicks);
+    REQUIRE(max_kick > 0.0);
+
+    double margin = 1.0e-9 * max_kick;
+
+    // the even layers of beam a sit on the slice centres, the odd ones
+    // half way between. The kick of a particle half way is the mean of
+    // the kicks of the same transverse point on the two slices around it
+    auto kick = [&](int layer, int k, int c) {
+        return kicks[(layer * zdep_per_layer + k) * 2 + c];
+    };
+
+    for (int layer = 1; layer < zdep_layers[0] - 1; layer += 2) {
+        for (int k = 0; k < zdep_per_layer; ++k) {
+            for (int c = 0; c < 2; ++c) {
+                double mid =
+                    0.5 * (kick(layer - 1, k, c) + kick(layer + 1, k, c));
+                CHECK(kick(layer, k, c) == Approx(mid).margin(margin));
+            }
+        }
+    }
+
+    // the end slices of the beam have less charge than the middle ones,
+    // so the kicks depend on z
+    bool z_dependent = false;
+    for (int k = 0; k < zdep_per_layer; ++k) {
+        double d = std::abs(kick(0, k, 0) - kick(4, k, 0));
+        z_dependent = z_dependent || d > 1.0e-3 * max_kick;
+    }
+
+    CHECK(z_dependent);
+}
@@ -78,3 +78,165 @@ TEST_CASE("PointCharge", "[PointCharge]")
         }
     }
 }
+
+TEST_CASE("PointChargeMatrixFree", "[PointCharge]")
+{
+    auto simlogger = Logger(0, LoggerV::INFO_STEP);
+
+    const double mass = 100.0;
+    const double total_energy = 125.0;
+
+    /* scope to prevent deallocate after finalize errors for Kokkos views! */
+    {
+        Four_momentum fm(mass, total_energy);
+        Reference_particle ref(pconstants::proton_charge, fm);
+
+        auto bsim =
+            Bunch_simulator::create_single_bunch_simulator(ref, 1, 1, Commxx());
+
+        Bunch& bunch = bsim.get_bunch();
+        {
+            bunch.checkout_particles();
+            auto bunch_parts = bunch.get_host_particles();
+            bunch_parts.access(0, 0) = 0;
+            bunch_parts.access(0, 2) = 0;
+            bunch_parts.access(0, 4) = 0;
+            bunch.checkin_particles();
+        }
+
+        // matrix-free operator with multigrid, warm started
+        auto sc_ops = Space_charge_3d_fd_options(17, 17, 17);
+        sc_ops.comm_group_size = 1;
+        sc_ops.matrix_free = true;
+        sc_ops.warm_start = true;
+
+        std::array<double, 3> offset = {0, 0, 0};
+        std::array<double, 3> size = {4, 4, 4};
+        sc_ops.set_fixed_domain(offset, size);
+
+        auto sc = Space_charge_3d_fd(sc_ops);
+
+        // second apply starts from the first solution
+        sc.apply(bsim, 1e-6, simlogger);
+        sc.apply(bsim, 1e-6, simlogger);
+
+        {
+            bunch.checkout_particles();
+            auto bunch_parts = bunch.get_host_particles();
+
+            CHECK(bunch_parts(0, 1) == Approx(0).margin(.01));
+            CHECK(bunch_parts(0, 3) == Approx(0).margin(.01));
+            CHECK(bunch_parts(0, 5) == Approx(0).margin(.01));
+        }
+    }
+}
+
+namespace {
+    // a bunch of many particles spread over the domain, centered at
+    // (x0, 0, 0) and with the longitudinal size scaled by zscale
+    void
+    fill_bunch(Bunch& bunch, double x0, double zscale)
+    {
+        bunch.checkout_particles();
+        auto parts = bunch.get_host_particles();
+
+        for (int p = 0; p < bunch.get_local_num(); ++p) {
+            parts(p, 0) = x0 + 1.0e-3 * std::sin(1.3 * p + 0.1);
+            parts(p, 1) = 0.0;
+            parts(p, 2) = 1.2e-3 * std::cos(0.7 * p + 0.2);
+            parts(p, 3) = 0.0;
+            parts(p, 4) = zscale * 1.0e-2 * std::sin(0.3 * p + 0.3);
+            parts(p, 5) = 0.0;
+        }
+
+        bunch.checkin_particles();
+    }
+
+    // the kicks of the two bunches agree to a fraction of the largest
+    // kick of the first one
+    void
+    check_same_kicks(Bunch& b1, Bunch& b2, double tolerance)
+    {
+        b1.checkout_particles();
+        b2.checkout_particles();
+
+        auto p1 = b1.get_host_particles();
+        auto p2 = b2.get_host_particles();
+
+        for (int c : {1, 3, 5}) {
+            double kmax = 0.0;
+            for (int p = 0; p < b1.get_local_num(); ++p)
+                kmax = std::max(kmax, std::abs(p1(p, c)));
+
+            CHECK(kmax > 0.0);
+
+            for (int p = 0; p < b1.get_local_num(); ++p)
+                CHECK(p2(p, c) == Approx(p1(p, c)).margin(tolerance * kmax));
+        }
+    }
+}
+
+TEST_CASE("MatrixFreeMatchesAssembled", "[MatrixFree]")
+{
+    auto simlogger = Logger(0, LoggerV::INFO_STEP);
+
+    const double mass = 100.0;
+    const double total_energy = 125.0;
+    const int total_num = 4096;
+    const double real_num = 2.0e12;
+
+    const double tolerance = 1.0e-3;
+
+    /* scope to prevent deallocate after finalize errors for Kokkos views! */
+    {
+        Four_momentum fm(mass, total_energy);
+        Reference_particle ref(pconstants::proton_charge, fm);
+
+        auto bsim_a = Bunch_simulator::create_single_bunch_simulator(
+            ref, total_num, real_num, Commxx());
+        auto bsim_m = Bunch_simulator::create_single_bunch_simulator(
+            ref, total_num, real_num, Commxx());
+
+        Bunch& bunch_a = bsim_a.get_bunch();
+        Bunch& bunch_m = bsim_m.get_bunch();
+
+        // the domains follow the bunch
+        auto ops_a = Space_charge_3d_fd_options(17, 17, 17);
+        ops_a.comm_group_size = 1;
+
+        auto ops_m = ops_a;
+        ops_m.matrix_free = true;
+        ops_m.warm_start = true;
+
+        auto sc_a = Space_charge_3d_fd(ops_a);
+        auto sc_m = Space_charge_3d_fd(ops_m);
+
+        // cold start of the matrix-free solver
+        fill_bunch(bunch_a, 0.0, 1.0);
+        fill_bunch(bunch_m, 0.0, 1.0);
+
+        sc_a.apply(bsim_a, 1e-6, simlogger);
+        sc_m.apply(bsim_m, 1e-6, simlogger);
+
+        check_same_kicks(bunch_a, bunch_m, tolerance);
+
+        // the bunch moves and grows, so the previous potential is
+        // interpolated onto a new domain for the warm start
+        fill_bunch(bunch_a, 5.0e-4, 1.5);
+        fill_bunch(bunch_m, 5.0e-4, 1.5);
+
+        sc_a.apply(bsim_a, 1e-6, simlogger);
+        sc_m.apply(bsim_m, 1e-6, simlogger);
+
+        check_same_kicks(bunch_a, bunch_m, tolerance);
+
+        // and shrinks back
+        fill_bunch(bunch_a, -5.0e-4, 0.8);
+        fill_bunch(bunch_m, -5.0e-4, 0.8);
+
+        sc_a.apply(bsim_a, 1e-6, simlogger);
+        sc_m.apply(bsim_m, 1e-6, simlogger);
+
+        check_same_kicks(bunch_a, bunch_m, tolerance);
+    }
+}
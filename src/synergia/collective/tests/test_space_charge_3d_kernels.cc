@@ -0,0 +1,175 @@
+#include "synergia/utils/catch.hpp"
+
+#include "synergia/collective/space_charge_3d_kernels.h"
+#include "synergia/foundation/physical_constants.h"
+
+constexpr int num_parts = 200;
+
+namespace {
+    // the field extraction into the enx/eny/enz grids that was run
+    // before the kick, kept here as the reference for the fused kick
+    struct reference_force_extractor {
+        karray1d_dev phi2;
+        karray1d_dev enx;
+        karray1d_dev eny;
+        karray1d_dev enz;
+
+        int gx, gy, gz;
+        int dgx, dgy;
+        double ihx, ihy, ihz;
+
+        KOKKOS_INLINE_FUNCTION
+        void
+        operator()(const int i) const
+        {
+            int iz = i / (gx * gy);
+            int iy = (i - iz * gx * gy) / gx;
+            int ix = i - iz * gx * gy - iy * gx;
+
+            // all boundaries will be skipped (set to 0)
+            if (ix == 0 || ix == gx - 1 || iy == 0 || iy == gy - 1 ||
+                iz == 0 || iz == gz - 1)
+                return;
+
+            int idx_r = iz * dgx * dgy + iy * dgx + ix + 1;
+            int idx_l = iz * dgx * dgy + iy * dgx + ix - 1;
+            enx(i) = -(phi2(idx_r) - phi2(idx_l)) * ihx;
+
+            idx_r = iz * dgx * dgy + (iy + 1) * dgx + ix;
+            idx_l = iz * dgx * dgy + (iy - 1) * dgx + ix;
+            eny(i) = -(phi2(idx_r) - phi2(idx_l)) * ihy;
+
+            idx_r = (iz + 1) * dgx * dgy + iy * dgx + ix;
+            idx_l = (iz - 1) * dgx * dgy + iy * dgx + ix;
+            enz(i) = -(phi2(idx_r) - phi2(idx_l)) * ihz;
+        }
+    };
+
+    void
+    fill_particles(Bunch& bunch)
+    {
+        bunch.checkout_particles();
+        auto parts = bunch.get_host_particles();
+
+        // spread over the domain [-1, 1)^3 including its boundary cells,
+        // and a few particles outside of it
+        for (int i = 0; i < num_parts; ++i) {
+            parts(i, 0) = -1.1 + 2.2 * ((i * 37) % num_parts) / num_parts;
+            parts(i, 1) = 0.0;
+            parts(i, 2) = -1.05 + 2.1 * ((i * 53) % num_parts) / num_parts;
+            parts(i, 3) = 0.0;
+            parts(i, 4) = -0.99 + 1.98 * ((i * 71) % num_parts) / num_parts;
+            parts(i, 5) = 1.0e-3 * (i % 7);
+        }
+
+        bunch.checkin_particles();
+    }
+}
+
+TEST_CASE("alg_gather_kicker_doubled_domain", "[sc3d_kernels]")
+{
+    const std::array<int, 3> g{8, 10, 12};
+    const std::array<int, 3> dg{2 * g[0], 2 * g[1], 2 * g[2]};
+    const std::array<double, 3> l{-1.0, -1.0, -1.0};
+    const std::array<double, 3> h{2.0 / g[0], 2.0 / g[1], 2.0 / g[2]};
+
+    const double factor = 1.0e-3;
+    const double pref = 1.2;
+    const double m = 0.9;
+
+    int dgx = Distributed_fft3d::get_padded_shape_real(dg[0]);
+
+    // any potential will do
+    karray1d_dev phi2("phi2", dgx * dg[1] * dg[2]);
+    auto h_phi2 = Kokkos::create_mirror_view(phi2);
+
+    int nphi = phi2.extent(0);
+    for (int i = 0; i < nphi; ++i)
+        h_phi2(i) = std::sin(0.1 * i) + 0.3 * std::cos(0.37 * i);
+
+    Kokkos::deep_copy(phi2, h_phi2);
+
+    Four_momentum fm(pconstants::mp, 1.5 * pconstants::mp);
+    Reference_particle ref(pconstants::proton_charge, fm);
+
+    Bunch fused(ref, num_parts, 1e11, Commxx());
+    Bunch reference(ref, num_parts, 1e11, Commxx());
+
+    fill_particles(fused);
+    fill_particles(reference);
+
+    // fused gather and kick
+    sc3d_kernels::zyx::alg_gather_kicker_doubled_domain gather_kicker(
+        fused.get_local_particles(),
+        fused.get_local_particle_masks(),
+        phi2,
+        g,
+        dg,
+        h,
+        h,
+        l,
+        factor,
+        pref,
+        m);
+
+    Kokkos::parallel_for(fused.size(), gather_kicker);
+    Kokkos::fence();
+
+    // field grids, then the kick
+    int ng = g[0] * g[1] * g[2];
+
+    karray1d_dev enx("enx", ng);
+    karray1d_dev eny("eny", ng);
+    karray1d_dev enz("enz", ng);
+
+    reference_force_extractor extractor{phi2,
+                                        enx,
+                                        eny,
+                                        enz,
+                                        g[0],
+                                        g[1],
+                                        g[2],
+                                        dgx,
+                                        dg[1],
+                                        0.5 / h[0],
+                                        0.5 / h[1],
+                                        0.5 / h[2]};
+
+    Kokkos::parallel_for(ng, extractor);
+    Kokkos::fence();
+
+    sc3d_kernels::zyx::alg_kicker kicker(reference.get_local_particles(),
+                                         reference.get_local_particle_masks(),
+                                         enx,
+                                         eny,
+                                         enz,
+                                         g,
+                                         h,
+                                         l,
+                                         factor,
+                                         pref,
+                                         m);
+
+    Kokkos::parallel_for(reference.size(), kicker);
+    Kokkos::fence();
+
+    fused.checkout_particles();
+    reference.checkout_particles();
+
+    auto pf = fused.get_host_particles();
+    auto pr = reference.get_host_particles();
+
+    int kicked = 0;
+
+    for (int i = 0; i < num_parts; ++i) {
+        for (int j = 0; j < 7; ++j) {
+            CHECK(pf(i, j) ==
+                  Approx(pr(i, j)).epsilon(1.0e-13).margin(1.0e-16));
+        }
+
+        if (pr(i, 1) != 0.0) ++kicked;
+    }
+
+    // most of the particles are inside the domain
+    CHECK(kicked > num_parts / 2);
+}
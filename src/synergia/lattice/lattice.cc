@@ -172,13 +172,13 @@ Lattice::set_all_string_attribute(std::string const& name,
     updated.element = true;
 }
 
-std::list<Lattice_element> const&
+Lattice_elements const&
 Lattice::get_elements() const
 {
     return elements;
 }
 
-std::list<Lattice_element>&
+Lattice_elements&
 Lattice::get_elements()
 {
     return elements;
@@ -352,14 +352,26 @@ Lattice::set_lattice_tree(Lattice_tree const& lattice_tree)
     tree = lattice_tree;
 }
 
+void
+Lattice::revise_dependent_elements()
+{
+    // the variable can be referenced through other variables or element
+    // attributes, so every element with an expression is revised
+    for (auto& e : elements) {
+        if (e.has_expression_attributes()) e.revise();
+    }
+}
+
 void
 Lattice::set_variable(std::string const& name, double val)
 {
     tree.set_variable(name, val);
+    revise_dependent_elements();
 }
 
 void
 Lattice::set_variable(std::string const& name, std::string const& val)
 {
     tree.set_variable(name, val);
+    revise_dependent_elements();
 }
@@ -1,7 +1,7 @@
 #ifndef LATTICE_H_
 #define LATTICE_H_
 
-#include <list>
+#include <deque>
 #include <string>
 #include <optional>
 #include <stdexcept>
@@ -12,8 +12,14 @@
 
 #include "synergia/utils/logger.h"
 
+#include <cereal/types/deque.hpp>
 #include <cereal/types/list.hpp>
 
+/// Elements of a lattice. Indexable, and unlike a vector the references
+/// to the elements (e.g., held by the Lattice_element_slice) stay valid
+/// when more elements are appended
+using Lattice_elements = std::deque<Lattice_element>;
+
 /// The Lattice class contains an abstract representation of an ordered
 /// set of objects of type Lattice_element.
 /// Each element of the Lattice is unique.
@@ -36,7 +42,7 @@ private:
   std::string name;
 
   std::optional<Reference_particle> reference_particle;
-  std::list<Lattice_element> elements;
+  Lattice_elements elements;
 
   update_flags_t updated;
 
@@ -49,7 +55,9 @@ public:
   /// Defaults to interpreting elements as Mad8 elements
   Lattice();
 
-  /// Copy, move, and assignment of Lattices contain copies of elements
+  /// Copy, move, and assignment of Lattices contain copies of elements.
+  /// The copied elements share their definitions with the originals
+  /// until modified
   Lattice(Lattice const& lattice);
   Lattice(Lattice&& lattice) noexcept;
   Lattice& operator=(Lattice const& lattice);
@@ -167,9 +175,9 @@ public:
                                 bool increment_revision = true);
 
   /// Get the list of elements in the Lattice
-  std::list<Lattice_element> const& get_elements() const;
+  Lattice_elements const& get_elements() const;
 
-  std::list<Lattice_element>& get_elements();
+  Lattice_elements& get_elements();
 
   /// Clear the h/v tunes and chromaticity markers for all lattice elements
   void reset_all_markers();
@@ -239,6 +247,11 @@ public:
                                   std::string const& line);
 
 private:
+  // increment the revisions of the elements which may depend on the
+  // lattice variables
+  void revise_dependent_elements();
+
+  friend class Lattice_element;
   friend class cereal::access;
 
 
@@ -47,17 +47,29 @@ namespace {
   }
 }
 
+namespace {
+  // definition of an element without attributes
+  template <class DEF>
+  std::shared_ptr<DEF>
+  make_definition(std::string const& stype,
+                  std::string const& name,
+                  element_format format)
+  {
+    auto def = std::make_shared<DEF>();
+
+    def->name = name;
+    def->format = format;
+    def->stype = stype;
+    def->type = find_type(stype);
+    def->length_attribute_name = "l";
+    def->bend_angle_attribute_name = "angle";
+
+    return def;
+  }
+}
+
 Lattice_element::Lattice_element()
-  : name("")
-  , format(element_format::madx)
-  , stype("generic")
-  , type(find_type(stype))
-  , ancestors()
-  , string_attributes()
-  , lazy_double_attributes()
-  , lazy_vector_attributes()
-  , length_attribute_name("l")
-  , bend_angle_attribute_name("angle")
+  : def(make_definition<definition_t>("generic", "", element_format::madx))
   , revision(0)
   , lattice_ptr(nullptr)
   , markers{}
@@ -66,56 +78,41 @@ Lattice_element::Lattice_element()
 Lattice_element::Lattice_element(std::string const& type,
                                  std::string const& name,
                                  element_format format)
-  : name(name)
-  , format(format)
-  , stype(type)
-  , type(find_type(stype))
-  , ancestors()
-  , string_attributes()
-  , lazy_double_attributes()
-  , lazy_vector_attributes()
-  , length_attribute_name("l")
-  , bend_angle_attribute_name("angle")
+  : def(make_definition<definition_t>(type, name, format))
   , revision(0)
   , lattice_ptr(nullptr)
   , markers{}
 {}
 
 Lattice_element::Lattice_element(Lsexpr const& lsexpr)
-  : name("")
-  , format(element_format::madx)
-  , stype("generic")
-  , type(find_type(stype))
-  , ancestors()
-  , string_attributes()
-  , lazy_double_attributes()
-  , lazy_vector_attributes()
-  , length_attribute_name("l")
-  , bend_angle_attribute_name("angle")
+  : def(make_definition<definition_t>("generic", "", element_format::madx))
   , revision(0)
   , lattice_ptr(nullptr)
   , markers{}
 {
   using namespace synergia;
 
+  auto& d = *def;
+
   for (auto const& lse : lsexpr) {
     if (lse.is_labeled()) {
       if (lse.get_label() == "type") {
-        stype = lse.get_string();
-        type = find_type(stype);
+        d.stype = lse.get_string();
+        d.type = find_type(d.stype);
       } else if (lse.get_label() == "name") {
-        name = lse.get_string();
-      } else if (lse.get_label() == "ancestors") {
+        d.name = lse.get_string();
+      } else if (lse.get_label() == "d.ancestors") {
         auto ancestors_vector = lse.get_string_vector();
         std::copy(ancestors_vector.begin(),
                   ancestors_vector.end(),
-                  std::back_inserter(ancestors));
+                  std::back_inserter(d.ancestors));
       } else if (lse.get_label() == "double_attributes") {
         for (auto const& attr : lse)
-          lazy_double_attributes[attr.get_label()] = mx_expr(attr.get_double());
-      } else if (lse.get_label() == "string_attributes") {
+          d.lazy_double_attributes[attr.get_label()] =
+            mx_expr(attr.get_double());
+      } else if (lse.get_label() == "d.string_attributes") {
         for (auto const& attr : lse)
-          string_attributes[attr.get_label()] = attr.get_string();
+          d.string_attributes[attr.get_label()] = attr.get_string();
       } else if (lse.get_label() == "vector_attributes") {
         for (auto const& attr : lse) {
           std::vector<double> vd = attr.get_double_vector();
@@ -123,13 +120,14 @@ Lattice_element::Lattice_element(Lsexpr const& lsexpr)
           std::vector<mx_expr> ve;
           for (double d : vd) ve.push_back(mx_expr(d));
 
-          lazy_vector_attributes[attr.get_label()] = ve;
+          d.lazy_vector_attributes[attr.get_label()] = ve;
         }
       }
     } else {
       if (!lse.is_atomic()) {
         for (auto const& attr : lse)
-          lazy_double_attributes[attr.get_label()] = mx_expr(attr.get_double());
+          d.lazy_double_attributes[attr.get_label()] =
+            mx_expr(attr.get_double());
       }
     }
   }
@@ -220,37 +218,37 @@ Lattice_element::get_all_type_names()
 std::string const&
 Lattice_element::get_type_name() const
 {
-  return stype;
+  return def->stype;
 }
 
 element_type
 Lattice_element::get_type() const
 {
-  return type;
+  return def->type;
 }
 
 std::string const&
 Lattice_element::get_name() const
 {
-  return name;
+  return def->name;
 }
 
 element_format
 Lattice_element::get_format() const
 {
-  return format;
+  return def->format;
 }
 
 void
 Lattice_element::add_ancestor(std::string const& ancestor)
 {
-  ancestors.push_back(ancestor);
+  mdef().ancestors.push_back(ancestor);
 }
 
 std::list<std::string> const&
 Lattice_element::get_ancestors() const
 {
-  return ancestors;
+  return def->ancestors;
 }
 
 void
@@ -270,17 +268,21 @@ Lattice_element::duplicate_attribute(std::string const& name,
     if (attrs.find(name) != attrs.end()) attrs[new_name] = attrs[name];
   };
 
-  duplicator(lazy_double_attributes, name, new_name, overwrite);
-  duplicator(lazy_vector_attributes, name, new_name, overwrite);
-  duplicator(string_attributes, name, new_name, overwrite);
+  auto& d = mdef();
+
+  duplicator(d.lazy_double_attributes, name, new_name, overwrite);
+  duplicator(d.lazy_vector_attributes, name, new_name, overwrite);
+  duplicator(d.string_attributes, name, new_name, overwrite);
 }
 
 void
 Lattice_element::delete_attribute(std::string const& name)
 {
-  lazy_double_attributes.erase(name);
-  lazy_vector_attributes.erase(name);
-  string_attributes.erase(name);
+  auto& d = mdef();
+
+  d.lazy_double_attributes.erase(name);
+  d.lazy_vector_attributes.erase(name);
+  d.string_attributes.erase(name);
 }
 
 void
@@ -294,9 +296,11 @@ Lattice_element::rename_attribute(std::string const& name,
 void
 Lattice_element::copy_attributes_from(Lattice_element const& o)
 {
-  lazy_double_attributes = o.lazy_double_attributes;
-  lazy_vector_attributes = o.lazy_vector_attributes;
-  string_attributes = o.string_attributes;
+  auto& d = mdef();
+
+  d.lazy_double_attributes = o.def->lazy_double_attributes;
+  d.lazy_vector_attributes = o.def->lazy_vector_attributes;
+  d.string_attributes = o.def->string_attributes;
 }
 
 void
@@ -304,8 +308,8 @@ Lattice_element::set_double_attribute(std::string const& name,
                                       double value,
                                       bool increment_revision)
 {
-  lazy_double_attributes[name] = mx_expr(value);
-  if (increment_revision) ++revision;
+  mdef().lazy_double_attributes[name] = mx_expr(value);
+  if (increment_revision) revise();
 }
 
 void
@@ -313,8 +317,8 @@ Lattice_element::set_double_attribute(std::string const& name,
                                       mx_expr const& value,
                                       bool increment_revision)
 {
-  lazy_double_attributes[name] = value;
-  if (increment_revision) ++revision;
+  mdef().lazy_double_attributes[name] = value;
+  if (increment_revision) revise();
 }
 
 void
@@ -332,8 +336,8 @@ Lattice_element::set_double_attribute(std::string const& name,
                              "a valid expression");
   }
 
-  lazy_double_attributes[name] = expr;
-  if (increment_revision) ++revision;
+  mdef().lazy_double_attributes[name] = expr;
+  if (increment_revision) revise();
 }
 
 void
@@ -350,26 +354,26 @@ Lattice_element::set_default_double_attribute(std::string const& name,
                                               bool increment_revision)
 {
   if (!has_double_attribute(name)) {
-    lazy_double_attributes[name] = mx_expr(value);
-    if (increment_revision) ++revision;
+    mdef().lazy_double_attributes[name] = mx_expr(value);
+    if (increment_revision) revise();
   }
 }
 
 bool
 Lattice_element::has_double_attribute(std::string const& name) const
 {
-  return lazy_double_attributes.count(name) > 0;
+  return def->lazy_double_attributes.count(name) > 0;
 }
 
 double
 Lattice_element::get_double_attribute(std::string const& name) const
 {
-  auto lr = lazy_double_attributes.find(name);
+  auto lr = def->lazy_double_attributes.find(name);
 
   // no such attribute
-  if (lr == lazy_double_attributes.end()) {
+  if (lr == def->lazy_double_attributes.end()) {
     throw std::runtime_error("Lattice_element::get_double_attribute: element " +
-                             this->name + " of type " + stype +
+                             def->name + " of type " + def->stype +
                              " has no double attribute '" + name + "'");
   }
 
@@ -392,10 +396,10 @@ Lattice_element::get_double_attribute(std::string const& name) const
 double
 Lattice_element::get_double_attribute(std::string const& name, double val) const
 {
-  auto lr = lazy_double_attributes.find(name);
+  auto lr = def->lazy_double_attributes.find(name);
 
   // no such attribute, returns the def value
-  if (lr == lazy_double_attributes.end()) return val;
+  if (lr == def->lazy_double_attributes.end()) return val;
 
   // default the references to 0.0 when evaluating the lazy value.
   if (lattice_ptr && lattice_ptr->is_dynamic_lattice()) {
@@ -411,7 +415,8 @@ Lattice_element::get_double_attribute_names() const
 {
   std::vector<std::string> names;
 
-  for (auto const& attr : lazy_double_attributes) names.push_back(attr.first);
+  for (auto const& attr : def->lazy_double_attributes)
+    names.push_back(attr.first);
 
   return names;
 }
@@ -430,7 +435,7 @@ Lattice_element::get_double_attributes() const
 
   std::map<std::string, double> attrs;
 
-  for (auto const& attr : lazy_double_attributes) {
+  for (auto const& attr : def->lazy_double_attributes) {
     if (lattice_ptr && lattice_ptr->is_dynamic_lattice()) {
       auto const& mx = lattice_ptr->get_lattice_tree().mx;
       attrs[attr.first] = mx_eval(attr.second, mx, 0.0);
@@ -447,8 +452,8 @@ Lattice_element::set_string_attribute(std::string const& name,
                                       std::string const& value,
                                       bool increment_revision)
 {
-  string_attributes[name] = value;
-  if (increment_revision) ++revision;
+  mdef().string_attributes[name] = value;
+  if (increment_revision) revise();
 }
 
 void
@@ -457,25 +462,25 @@ Lattice_element::set_default_string_attribute(std::string const& name,
                                               bool increment_revision)
 {
   if (!has_string_attribute(name)) {
-    string_attributes[name] = value;
-    if (increment_revision) ++revision;
+    mdef().string_attributes[name] = value;
+    if (increment_revision) revise();
   }
 }
 
 bool
 Lattice_element::has_string_attribute(std::string const& name) const
 {
-  bool retval = (string_attributes.count(name) > 0);
+  bool retval = (def->string_attributes.count(name) > 0);
   return retval;
 }
 
 std::string const&
 Lattice_element::get_string_attribute(std::string const& name) const
 {
-  auto r = string_attributes.find(name);
-  if (r == string_attributes.end()) {
+  auto r = def->string_attributes.find(name);
+  if (r == def->string_attributes.end()) {
     throw std::runtime_error("Lattice_element::get_string_attribute: element " +
-                             this->name + " of type " + stype +
+                             def->name + " of type " + def->stype +
                              " has no string attribute '" + name + "'");
   } else {
     return r->second;
@@ -486,8 +491,8 @@ std::string const&
 Lattice_element::get_string_attribute(std::string const& name,
                                       std::string const& val) const
 {
-  auto r = string_attributes.find(name);
-  if (r == string_attributes.end())
+  auto r = def->string_attributes.find(name);
+  if (r == def->string_attributes.end())
     return val;
   else
     return r->second;
@@ -501,26 +506,26 @@ Lattice_element::set_vector_attribute(std::string const& name,
   std::vector<mx_expr> ve;
   for (double d : value) ve.emplace_back(d);
 
-  lazy_vector_attributes[name] = ve;
-  if (increment_revision) ++revision;
+  mdef().lazy_vector_attributes[name] = ve;
+  if (increment_revision) revise();
 }
 
 bool
 Lattice_element::has_vector_attribute(std::string const& name) const
 {
-  bool retval = (lazy_vector_attributes.count(name) > 0);
+  bool retval = (def->lazy_vector_attributes.count(name) > 0);
   return retval;
 }
 
 std::vector<double>
 Lattice_element::get_vector_attribute(std::string const& name) const
 {
-  auto r = lazy_vector_attributes.find(name);
+  auto r = def->lazy_vector_attributes.find(name);
 
   // no such attribute
-  if (r == lazy_vector_attributes.end()) {
+  if (r == def->lazy_vector_attributes.end()) {
     throw std::runtime_error("Lattice_element::get_vector_attribute: element " +
-                             this->name + " of type " + stype +
+                             def->name + " of type " + def->stype +
                              " has no vector attribute '" + name + "'");
   }
 
@@ -542,10 +547,10 @@ std::vector<double>
 Lattice_element::get_vector_attribute(std::string const& name,
                                       std::vector<double> const& val) const
 {
-  auto r = lazy_vector_attributes.find(name);
+  auto r = def->lazy_vector_attributes.find(name);
 
   // no such attribute, returns the default val
-  if (r == lazy_vector_attributes.end()) return val;
+  if (r == def->lazy_vector_attributes.end()) return val;
 
   // the double array to be returned
   std::vector<double> vd;
@@ -564,26 +569,26 @@ Lattice_element::get_vector_attribute(std::string const& name,
 void
 Lattice_element::set_length_attribute_name(std::string const& attribute_name)
 {
-  length_attribute_name = attribute_name;
+  mdef().length_attribute_name = attribute_name;
 }
 
 void
 Lattice_element::set_bend_angle_attribute_name(
   std::string const& attribute_name)
 {
-  bend_angle_attribute_name = attribute_name;
+  mdef().bend_angle_attribute_name = attribute_name;
 }
 
 double
 Lattice_element::get_length() const
 {
-  return get_double_attribute(length_attribute_name, 0.0);
+  return get_double_attribute(def->length_attribute_name, 0.0);
 }
 
 double
 Lattice_element::get_bend_angle() const
 {
-  return get_double_attribute(bend_angle_attribute_name, 0.0);
+  return get_double_attribute(def->bend_angle_attribute_name, 0.0);
 }
 
 long int
@@ -592,6 +597,38 @@ Lattice_element::get_revision() const
   return revision;
 }
 
+bool
+Lattice_element::has_expression_attributes() const
+{
+  for (auto const& attr : def->lazy_double_attributes) {
+    if (!mx_expr_is_number(attr.second)) return true;
+  }
+
+  for (auto const& attr : def->lazy_vector_attributes) {
+    for (auto const& expr : attr.second) {
+      if (!mx_expr_is_number(expr)) return true;
+    }
+  }
+
+  return false;
+}
+
+void
+Lattice_element::revise()
+{
+  ++revision;
+
+  // let the parent lattice know one of its elements has changed
+  if (lattice_ptr) lattice_ptr->updated.element = true;
+}
+
+Lattice_element::definition_t&
+Lattice_element::mdef()
+{
+  if (def.use_count() > 1) def = std::make_shared<definition_t>(*def);
+  return *def;
+}
+
 bool
 Lattice_element::has_lattice() const
 {
@@ -642,7 +679,7 @@ Lattice_element::set_marker(marker_type t)
         throw std::runtime_error(
           "Lattice_element::set_marker(): "
           "v_tunes_corrector has been set for the element " +
-          name + ", unable to set the h_tunes_corrector.");
+          def->name + ", unable to set the h_tunes_corrector.");
 
       validate_tunes_corrector(*this);
 
@@ -654,7 +691,7 @@ Lattice_element::set_marker(marker_type t)
         throw std::runtime_error(
           "Lattice_element::set_marker(): "
           "h_tunes_corrector has been set for the element " +
-          name + ", unable to set the v_tunes_corrector.");
+          def->name + ", unable to set the v_tunes_corrector.");
 
       validate_tunes_corrector(*this);
 
@@ -666,7 +703,7 @@ Lattice_element::set_marker(marker_type t)
         throw std::runtime_error(
           "Lattice_element::set_marker(): "
           "v_chrom_corrector has been set for the element " +
-          name + ", unable to set the h_chrom_corrector.");
+          def->name + ", unable to set the h_chrom_corrector.");
 
       validate_chrom_corrector(*this);
 
@@ -678,7 +715,7 @@ Lattice_element::set_marker(marker_type t)
         throw std::runtime_error(
           "Lattice_element::set_marker(): "
           "h_chrom_corrector has been set for the element " +
-          name + ", unable to set the v_chrom_corrector.");
+          def->name + ", unable to set the v_chrom_corrector.");
 
       validate_chrom_corrector(*this);
 
@@ -697,13 +734,13 @@ Lattice_element::as_string() const
   std::stringstream sstream;
   sstream.precision(15);
 
-  for (auto const& ancestor : ancestors) sstream << ancestor << ":";
+  for (auto const& ancestor : def->ancestors) sstream << ancestor << ":";
 
-  sstream << " " << stype << " ";
-  sstream << name << ": ";
+  sstream << " " << def->stype << " ";
+  sstream << def->name << ": ";
   bool first_attr = true;
 
-  for (auto const& attr : lazy_double_attributes) {
+  for (auto const& attr : def->lazy_double_attributes) {
     if (first_attr)
       first_attr = false;
     else
@@ -712,7 +749,7 @@ Lattice_element::as_string() const
     sstream << attr.first << "=" << mx_expr_str(attr.second);
   }
 
-  for (auto const& attr : string_attributes) {
+  for (auto const& attr : def->string_attributes) {
     if (first_attr)
       first_attr = false;
     else
@@ -721,7 +758,7 @@ Lattice_element::as_string() const
     sstream << attr.first << "=" << attr.second;
   }
 
-  for (auto const& attr : lazy_vector_attributes) {
+  for (auto const& attr : def->lazy_vector_attributes) {
     if (first_attr)
       first_attr = false;
     else
@@ -748,15 +785,15 @@ std::string
 Lattice_element::as_madx() const
 {
   std::stringstream ss;
-  ss << name << ": " << stype;
+  ss << def->name << ": " << def->stype;
 
-  for (auto const& attr : lazy_double_attributes)
+  for (auto const& attr : def->lazy_double_attributes)
     ss << ", " << attr.first << "=" << mx_expr_str(attr.second);
 
-  for (auto const& attr : string_attributes)
+  for (auto const& attr : def->string_attributes)
     ss << ", " << attr.first << "=" << attr.second;
 
-  for (auto const& attr : lazy_vector_attributes) {
+  for (auto const& attr : def->lazy_vector_attributes) {
     ss << ", " << attr.first << "={";
 
     for (int i = 0; i < attr.second.size(); ++i) {
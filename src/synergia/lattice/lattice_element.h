@@ -4,6 +4,7 @@
 #include <array>
 #include <list>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -110,24 +111,33 @@ class Lattice;
 class Lattice_element {
 
 private:
-  std::string name;
-  element_format format;
-
-  std::string stype;
-  element_type type;
-
-  std::list<std::string> ancestors;
-
-  // std::map<std::string, double> double_attributes;
-  std::map<std::string, std::string> string_attributes;
-  // std::map<std::string, std::vector<double>> vector_attributes;
-
-  // lazy attributes
-  std::map<std::string, synergia::mx_expr> lazy_double_attributes;
-  std::map<std::string, std::vector<synergia::mx_expr>> lazy_vector_attributes;
+  // name, type and attributes of the element. The copies of an element
+  // (e.g., the many instances of a MAD-X definition in a lattice, or the
+  // elements of a copied lattice) share a single definition, which is
+  // duplicated only when one of the copies gets modified (copy on write)
+  struct definition_t {
+    std::string name;
+    element_format format;
+
+    std::string stype;
+    element_type type;
+
+    std::list<std::string> ancestors;
+
+    // std::map<std::string, double> double_attributes;
+    std::map<std::string, std::string> string_attributes;
+    // std::map<std::string, std::vector<double>> vector_attributes;
+
+    // lazy attributes
+    std::map<std::string, synergia::mx_expr> lazy_double_attributes;
+    std::map<std::string, std::vector<synergia::mx_expr>>
+      lazy_vector_attributes;
+
+    std::string length_attribute_name;
+    std::string bend_angle_attribute_name;
+  };
 
-  std::string length_attribute_name;
-  std::string bend_angle_attribute_name;
+  std::shared_ptr<definition_t> def;
 
   long int revision;
 
@@ -399,29 +409,66 @@ public:
   std::map<std::string, std::string> const&
   get_string_attributes() const
   {
-    return string_attributes;
+    return def->string_attributes;
+  }
+
+  /// Whether the two elements share the same definition, i.e., neither
+  /// has been modified since one was copied from the other
+  bool
+  shares_definition(Lattice_element const& o) const
+  {
+    return def == o.def;
   }
 
+  /// Whether any of the double or vector attributes is an expression,
+  /// i.e., it may depend on the lattice variables
+  bool has_expression_attributes() const;
+
 private:
+  // increment the revision and flag the parent lattice as updated
+  void revise();
+
+  // the definition to be modified, duplicated first if shared
+  definition_t& mdef();
+
   friend class Lattice;
   friend class cereal::access;
 
+  template <class Archive, class DEF>
+  static void
+  serialize_definition(Archive& ar, DEF& d)
+  {
+    ar(cereal::make_nvp("name", d.name));
+    ar(cereal::make_nvp("format", d.format));
+    ar(cereal::make_nvp("stype", d.stype));
+    ar(cereal::make_nvp("type", d.type));
+    ar(cereal::make_nvp("ancestors", d.ancestors));
+
+    ar(cereal::make_nvp("string_attributes", d.string_attributes));
+    ar(cereal::make_nvp("lazy_double_attributes", d.lazy_double_attributes));
+    ar(cereal::make_nvp("lazy_vector_attributes", d.lazy_vector_attributes));
+
+    ar(cereal::make_nvp("length_attribute_name", d.length_attribute_name));
+    ar(cereal::make_nvp("bend_angle_attribute_name",
+                        d.bend_angle_attribute_name));
+  }
+
+  template <class Archive>
+  void
+  save(Archive& ar) const
+  {
+    serialize_definition(ar, *def);
+
+    ar(CEREAL_NVP(revision));
+    ar(CEREAL_NVP(markers));
+  }
+
   template <class Archive>
   void
-  serialize(Archive& ar)
+  load(Archive& ar)
   {
-    ar(CEREAL_NVP(name));
-    ar(CEREAL_NVP(format));
-    ar(CEREAL_NVP(stype));
-    ar(CEREAL_NVP(type));
-    ar(CEREAL_NVP(ancestors));
-
-    ar(CEREAL_NVP(string_attributes));
-    ar(CEREAL_NVP(lazy_double_attributes));
-    ar(CEREAL_NVP(lazy_vector_attributes));
-
-    ar(CEREAL_NVP(length_attribute_name));
-    ar(CEREAL_NVP(bend_angle_attribute_name));
+    serialize_definition(ar, mdef());
+
     ar(CEREAL_NVP(revision));
     ar(CEREAL_NVP(markers));
   }
@@ -15,6 +15,7 @@ Lattice_element_slice::Lattice_element_slice(Lattice_element const& element)
   , left(0.0)
   , right(element.get_length())
   , ref_ct(0.0)
+  , lf()
 {}
 
 Lattice_element_slice::Lattice_element_slice(Lattice_element const& element,
@@ -27,6 +28,7 @@ Lattice_element_slice::Lattice_element_slice(Lattice_element const& element,
   , left(l)
   , right(r)
   , ref_ct(0.0)
+  , lf()
 {
   if (left < 0.0) {
     throw std::range_error("Lattice_element_slice: left must be >= 0.0");
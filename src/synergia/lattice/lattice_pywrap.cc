@@ -10,14 +10,15 @@
 #include "synergia/lattice/lattice.h"
 #include "synergia/lattice/madx_reader.h"
 #include "synergia/lattice/dynamic_lattice.h"
+#include "synergia/lattice/ramp_table.h"
 
 namespace py = pybind11;
 using namespace py::literals;
 
-// convert the std::list<Lattice_element> to a python tuple object
+// convert the Lattice_elements to a python tuple object
 template <> 
-struct pybind11::detail::type_caster<std::list<Lattice_element>> 
-    : pybind11::detail::py_tuple_caster<std::list<Lattice_element>, Lattice_element> { };
+struct pybind11::detail::type_caster<Lattice_elements> 
+    : pybind11::detail::py_tuple_caster<Lattice_elements, Lattice_element> { };
 
 
 // lattice python module
@@ -53,6 +54,22 @@ PYBIND11_MODULE(lattice, m)
         .value("v_chrom_corrector", marker_type::v_chrom_corrector)
         ;
 
+    py::enum_<ramp_index_t>(m, "ramp_index_t", py::arithmetic())
+        .value("turn", ramp_index_t::turn)
+        .value("time", ramp_index_t::time)
+        ;
+
+    py::class_<Ramp_table>(m, "Ramp_table")
+        .def( py::init<ramp_index_t, std::vector<double> const&, 
+                       std::vector<double> const&>(),
+                "Construct a piecewise linear ramp table.",
+                "index"_a, "at"_a, "values"_a )
+        .def( "get_index_type", &Ramp_table::get_index_type )
+        .def( "value", &Ramp_table::value, 
+                "Value at the given turn and absolute time.",
+                "turn"_a, "time"_a )
+        ;
+
     py::class_<latt_func_t::lf_val_t>(m, "lf_val_t")
         .def_readwrite("hor", &latt_func_t::lf_val_t::hor)
         .def_readwrite("ver", &latt_func_t::lf_val_t::ver)
@@ -106,6 +123,9 @@ PYBIND11_MODULE(lattice, m)
                 &Lattice_element::add_ancestor,
                 "ancestor"_a )
 
+        .def( "get_revision",
+                &Lattice_element::get_revision )
+
         .def( "copy_attributes_from",
                 &Lattice_element::copy_attributes_from,
                 "element"_a )
@@ -226,6 +246,9 @@ PYBIND11_MODULE(lattice, m)
                 &Lattice_element::add_ancestor,
                 "ancestor"_a )
 
+        .def( "get_revision",
+                &Lattice_element::get_revision )
+
         .def_static( "get_all_type_names",
                 &Lattice_element::get_all_type_names )
 
@@ -363,7 +386,7 @@ PYBIND11_MODULE(lattice, m)
                 "energy"_a )
 
         .def( "get_elements",
-                (std::list<Lattice_element>& (Lattice::*)())
+                (Lattice_elements& (Lattice::*)())
                 &Lattice::get_elements,
                 //py::overload_cast<>(&Lattice::get_elements),
                 py::return_value_policy::reference_internal,
@@ -407,7 +430,7 @@ PYBIND11_MODULE(lattice, m)
                 "Get the total angle in radians subtended by all elements in the lattice" )
 
         .def( "get_elements_const",
-                (std::list<Lattice_element> const& (Lattice::*)() const)&Lattice::get_elements,
+                (Lattice_elements const& (Lattice::*)() const)&Lattice::get_elements,
                 //py::overload_cast<>(&Lattice::get_elements, py::const_),
                 py::return_value_policy::reference_internal,
                 "Get the list of all lattice elements" )
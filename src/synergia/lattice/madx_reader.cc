@@ -14,6 +14,54 @@ using namespace synergia;
 
 namespace {
 
+  // element from the resolved command
+  Lattice_element
+  make_element(Lattice& lattice,
+               MadX_command const& cmd,
+               std::string const& name,
+               bool dynamic)
+  {
+    Lattice_element element(cmd.name(), name);
+    element.set_lattice(lattice);
+
+    for (auto const& attr : cmd.attribute_names()) {
+      MadX_value_type vt = cmd.attribute_type(attr);
+
+      switch (vt) {
+        case NONE:
+
+        case STRING:
+          element.set_string_attribute(attr,
+                                       cmd.attribute_as_string(attr, ""));
+          break;
+
+        case NUMBER:
+          if (dynamic)
+            element.set_double_attribute(attr, cmd.attribute_as_expr(attr));
+          else
+            element.set_double_attribute(attr,
+                                         cmd.attribute_as_number(attr, 0.0));
+          break;
+
+        case ARRAY:
+          element.set_vector_attribute(attr,
+                                       cmd.attribute_as_number_seq(attr, 0.0));
+          break;
+
+        default:
+          throw std::runtime_error("unable to process attribute " + attr +
+                                   " of element " + name);
+      }
+    }
+
+    return element;
+  }
+
+  // elements already in the lattice by name. The other instances of an
+  // element are appended as copies of the first one, so they all share
+  // a single definition
+  using instances_t = std::map<std::string, Lattice_element const*>;
+
   void
   insert_line(Lattice& lattice,
               MadX const& mx,
@@ -21,49 +69,20 @@ namespace {
               bool dynamic = false)
   {
     MadX_line const& line = mx.line(line_name);
+    instances_t instances;
 
     for (int i = 0; i < line.element_count(); ++i) {
-      MadX_command cmd = line.element(i, true);
       std::string name = line.element_name(i);
-      std::string type = cmd.name();
-
-      Lattice_element element(type, name);
-      std::vector<std::string> attr_names(cmd.attribute_names());
-
-      for (std::vector<std::string>::const_iterator it = attr_names.begin();
-           it != attr_names.end();
-           ++it)
-        for (auto const& name : attr_names) {
-          MadX_value_type vt = cmd.attribute_type(name);
-
-          switch (vt) {
-            case NONE:
-
-            case STRING:
-              element.set_string_attribute(name,
-                                           cmd.attribute_as_string(name, ""));
-              break;
-
-            case NUMBER:
-              if (dynamic)
-                element.set_double_attribute(name, cmd.attribute_as_expr(name));
-              else
-                element.set_double_attribute(
-                  name, cmd.attribute_as_number(name, 0.0));
-              break;
-
-            case ARRAY:
-              element.set_vector_attribute(
-                name, cmd.attribute_as_number_seq(name, 0.0));
-              break;
-
-            default:
-              throw std::runtime_error("unable to process attribute " + name +
-                                       " of element " + name);
-          }
-        }
 
-      lattice.append(element);
+      auto inst = instances.find(name);
+      if (inst != instances.end()) {
+        lattice.append(*inst->second);
+        continue;
+      }
+
+      MadX_command cmd = line.element(i, true);
+      lattice.append(make_element(lattice, cmd, name, dynamic));
+      instances[name] = &lattice.get_elements().back();
     }
   }
 
@@ -74,6 +93,7 @@ namespace {
                   bool dynamic = false)
   {
     MadX_sequence const& sequence = mx.sequence(line_name);
+    instances_t instances;
 
     double r = 0.5;
     double total_length = sequence.length();
@@ -104,43 +124,15 @@ namespace {
         continue;
       }
 
-      MadX_command cmd = sequence.element(i);
-      std::string type(cmd.name());
-      std::string name(cmd.label());
-
-      Lattice_element element(type, name);
-      element.set_lattice(lattice);
+      auto inst = instances.find(label);
+      bool first = (inst == instances.end());
 
-      std::vector<string_t> attribute_names(cmd.attribute_names());
+      auto element = [&]() {
+        if (!first) return *inst->second;
 
-      for (std::vector<string_t>::iterator it = attribute_names.begin();
-           it != attribute_names.end();
-           ++it) {
-
-        MadX_value_type vt = cmd.attribute_type(*it);
-
-        switch (vt) {
-          case NONE:
-          case STRING:
-            element.set_string_attribute(*it, cmd.attribute_as_string(*it, ""));
-            break;
-          case NUMBER:
-            if (dynamic)
-              element.set_double_attribute(*it, cmd.attribute_as_expr(*it));
-            else
-              element.set_double_attribute(*it,
-                                           cmd.attribute_as_number(*it, 0.0));
-
-            break;
-          case ARRAY:
-            element.set_vector_attribute(*it,
-                                         cmd.attribute_as_number_seq(*it, 0.0));
-            break;
-          default:
-            throw std::runtime_error("unable to process attribute " + *it +
-                                     " of element " + name);
-        }
-      }
+        MadX_command cmd = sequence.element(i);
+        return make_element(lattice, cmd, cmd.label(), dynamic);
+      }();
 
       double drift_length =
         at + from - current_pos - element.get_length() * (1.0 - r);
@@ -159,6 +151,8 @@ namespace {
         ++drift_count;
       }
       lattice.append(element);
+      if (first) instances[label] = &lattice.get_elements().back();
+
       current_pos = at + from + element.get_length() * r;
     }
 
@@ -0,0 +1,137 @@
+#ifndef RAMP_TABLE_H_
+#define RAMP_TABLE_H_
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "synergia/lattice/lattice.h"
+#include "synergia/utils/cereal.h"
+
+#include <cereal/types/vector.hpp>
+
+enum class ramp_index_t {
+    turn, // indexed by the turn number (starting at 0)
+    time, // indexed by the bunch absolute time in seconds
+};
+
+/// Ramp_table is a piecewise linear table of values indexed by either
+/// the turn number or the absolute time. Values outside of the table
+/// are clamped to the first and last entries.
+class Ramp_table {
+  private:
+    ramp_index_t index;
+    std::vector<double> at;
+    std::vector<double> values;
+
+  public:
+    Ramp_table() : index(ramp_index_t::turn), at(), values() {}
+
+    Ramp_table(ramp_index_t index,
+               std::vector<double> const& at,
+               std::vector<double> const& values)
+        : index(index), at(at), values(values)
+    {
+        if (at.empty() || at.size() != values.size())
+            throw std::runtime_error(
+                "Ramp_table: index and value tables must be non-empty "
+                "and of the same size");
+
+        if (!std::is_sorted(at.begin(), at.end()))
+            throw std::runtime_error(
+                "Ramp_table: index table must be in ascending order");
+    }
+
+    ramp_index_t
+    get_index_type() const
+    {
+        return index;
+    }
+
+    /// value of the table at the given turn and bunch absolute time,
+    /// only the one matching the index type is used
+    double
+    value(int turn, double time) const
+    {
+        return interpolate((index == ramp_index_t::turn) ? turn : time);
+    }
+
+  private:
+    double
+    interpolate(double t) const
+    {
+        if (t <= at.front()) return values.front();
+        if (t >= at.back()) return values.back();
+
+        auto it = std::upper_bound(at.begin(), at.end(), t);
+        size_t i = it - at.begin();
+
+        double f = (t - at[i - 1]) / (at[i] - at[i - 1]);
+        return values[i - 1] + f * (values[i] - values[i - 1]);
+    }
+
+    friend class cereal::access;
+
+    template <class Archive>
+    void
+    serialize(Archive& ar)
+    {
+        ar(CEREAL_NVP(index));
+        ar(CEREAL_NVP(at));
+        ar(CEREAL_NVP(values));
+    }
+};
+
+/// Lattice_ramp drives a double attribute of the lattice elements
+/// with the given name (or, if no element has that name, all the
+/// elements of that type) from a Ramp_table.
+struct Lattice_ramp {
+    std::string element;
+    std::string attribute;
+    Ramp_table table;
+
+    /// set the attribute of the matching elements. The revision of an
+    /// element is only incremented when its value has actually changed.
+    /// Returns the number of elements updated
+    int
+    apply(Lattice& lattice, int turn, double time) const
+    {
+        double val = table.value(turn, time);
+
+        bool by_name = false;
+        for (auto const& e : lattice.get_elements()) {
+            if (e.get_name() == element) {
+                by_name = true;
+                break;
+            }
+        }
+
+        int num = 0;
+        for (auto& e : lattice.get_elements()) {
+            if (by_name ? (e.get_name() != element)
+                        : (e.get_type_name() != element))
+                continue;
+
+            if (e.has_double_attribute(attribute) &&
+                e.get_double_attribute(attribute) == val)
+                continue;
+
+            e.set_double_attribute(attribute, val);
+            ++num;
+        }
+
+        return num;
+    }
+
+    template <class Archive>
+    void
+    serialize(Archive& ar)
+    {
+        ar(CEREAL_NVP(element));
+        ar(CEREAL_NVP(attribute));
+        ar(CEREAL_NVP(table));
+    }
+};
+
+#endif /* RAMP_TABLE_H_ */
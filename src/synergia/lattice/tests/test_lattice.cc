@@ -397,3 +397,43 @@ TEST_CASE("test_serialize2")
 
     CHECK(loaded.get_reference_particle().equal(reference_particle, tolerance));
 }
+
+TEST_CASE("shared_definitions")
+{
+    std::string str = R"(
+        f: quadrupole, l=0.2, k1=0.1;
+        o: drift, l=3.0;
+        d: quadrupole, l=0.2, k1=-0.1;
+        fodo: line=(f, o, d, o, f, o, d, o);
+    )";
+
+    MadX_reader reader;
+    reader.parse(str);
+
+    auto lattice = reader.get_lattice("fodo");
+    auto& elms = lattice.get_elements();
+
+    REQUIRE(elms.size() == 8);
+
+    // the instances of an element share the definition
+    CHECK(elms[0].shares_definition(elms[4]));
+    CHECK(elms[1].shares_definition(elms[3]));
+    CHECK(elms[1].shares_definition(elms[7]));
+    CHECK(!elms[0].shares_definition(elms[2]));
+
+    // so do the elements of a copied lattice
+    Lattice copied_lattice(lattice);
+    CHECK(elms[0].shares_definition(copied_lattice.get_elements()[0]));
+
+    // copy on write
+    elms[4].set_double_attribute("k1", 0.2);
+
+    CHECK(!elms[0].shares_definition(elms[4]));
+    CHECK(elms[0].get_double_attribute("k1") ==
+          Approx(0.1).margin(tolerance));
+    CHECK(elms[4].get_double_attribute("k1") ==
+          Approx(0.2).margin(tolerance));
+    CHECK(copied_lattice.get_elements()[4].get_double_attribute("k1") ==
+          Approx(0.1).margin(tolerance));
+    CHECK(elms[4].get_name() == "f");
+}
@@ -0,0 +1,78 @@
+#include "synergia/utils/catch.hpp"
+
+#include "synergia/lattice/ramp_table.h"
+
+const double tolerance = 1.0e-12;
+
+TEST_CASE("ramp_table_interpolate")
+{
+    Ramp_table table(ramp_index_t::turn, {0, 10, 20}, {1.0, 2.0, 0.0});
+
+    CHECK(table.value(-5, 0.0) == Approx(1.0).epsilon(tolerance));
+    CHECK(table.value(0, 0.0) == Approx(1.0).epsilon(tolerance));
+    CHECK(table.value(5, 0.0) == Approx(1.5).epsilon(tolerance));
+    CHECK(table.value(10, 0.0) == Approx(2.0).epsilon(tolerance));
+    CHECK(table.value(15, 0.0) == Approx(1.0).epsilon(tolerance));
+    CHECK(table.value(25, 0.0) == Approx(0.0).margin(tolerance));
+
+    CHECK(table.value(5, 1.0e-3) == Approx(1.5).epsilon(tolerance));
+}
+
+TEST_CASE("ramp_table_time")
+{
+    Ramp_table table(ramp_index_t::time, {0.0, 1.0e-3}, {0.0, 100.0});
+
+    CHECK(table.value(100, 0.5e-3) == Approx(50.0).epsilon(tolerance));
+}
+
+TEST_CASE("ramp_table_invalid")
+{
+    CHECK_THROWS(Ramp_table(ramp_index_t::turn, {}, {}));
+    CHECK_THROWS(Ramp_table(ramp_index_t::turn, {0, 1}, {1.0}));
+    CHECK_THROWS(Ramp_table(ramp_index_t::turn, {1, 0}, {1.0, 2.0}));
+}
+
+TEST_CASE("lattice_ramp_apply")
+{
+    Lattice lattice("foo");
+
+    Lattice_element rf1("rfcavity", "rf1");
+    Lattice_element rf2("rfcavity", "rf2");
+    Lattice_element q("quadrupole", "q");
+
+    rf1.set_double_attribute("volt", 0.0);
+    rf2.set_double_attribute("volt", 0.0);
+    q.set_double_attribute("k1", 0.1);
+
+    lattice.append(rf1);
+    lattice.append(rf2);
+    lattice.append(q);
+
+    // by type
+    Lattice_ramp volt{
+        "rfcavity",
+        "volt",
+        Ramp_table(ramp_index_t::turn, {0, 100}, {0.0, 0.2})};
+
+    // by name
+    Lattice_ramp k1{
+        "q", "k1", Ramp_table(ramp_index_t::turn, {0, 100}, {0.1, 0.2})};
+
+    CHECK(volt.apply(lattice, 50, 0.0) == 2);
+    CHECK(k1.apply(lattice, 50, 0.0) == 1);
+
+    // unchanged values do not touch the elements
+    long int rev = lattice.get_elements().back().get_revision();
+    CHECK(k1.apply(lattice, 50, 0.0) == 0);
+    CHECK(lattice.get_elements().back().get_revision() == rev);
+
+    for (auto const& e : lattice.get_elements()) {
+        if (e.get_type_name() == "rfcavity") {
+            CHECK(e.get_double_attribute("volt") ==
+                  Approx(0.1).epsilon(tolerance));
+        } else {
+            CHECK(e.get_double_attribute("k1") ==
+                  Approx(0.15).epsilon(tolerance));
+        }
+    }
+}
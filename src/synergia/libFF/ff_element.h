@@ -67,6 +67,62 @@ namespace FF_element
     template<class BUNCH>
     void apply(Lattice_element const& element, BUNCH & b)
     { apply(Lattice_element_slice(element), b); }
+
+    // the elements which access the bunch only through the particles,
+    // the reference particles and the mass, and can therefore propagate
+    // a tiled_bunch_t
+    inline bool supports_tiles(Lattice_element_slice const& slice)
+    {
+        switch(slice.get_lattice_element().get_type())
+        {
+        case element_type::drift:
+        case element_type::sbend:
+        case element_type::quadrupole:
+        case element_type::monitor:
+        case element_type::hmonitor:
+        case element_type::vmonitor:
+        case element_type::marker:
+        case element_type::instrument:
+        case element_type::rcollimator:
+        case element_type::dipedge:
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    // same as apply() for the elements of supports_tiles(). Only those
+    // branches are instantiated, so BUNCH can be a tiled_bunch_t
+    template<class BUNCH>
+    void apply_tiled(Lattice_element_slice const& slice, BUNCH & b)
+    {
+        auto const& elm = slice.get_lattice_element();
+        auto t = elm.get_type();
+
+        switch(t)
+        {
+        case element_type::drift:      FF_drift::apply(slice, b); break; 
+        case element_type::sbend:      FF_sbend::apply(slice, b); break;
+        case element_type::quadrupole: FF_quadrupole::apply(slice, b); break;
+
+        case element_type::monitor:    FF_drift::apply(slice, b); break;
+        case element_type::hmonitor:   FF_drift::apply(slice, b); break;
+        case element_type::vmonitor:   FF_drift::apply(slice, b); break;
+        case element_type::marker:     FF_drift::apply(slice, b); break;
+        case element_type::instrument: FF_drift::apply(slice, b); break;
+        case element_type::rcollimator:FF_drift::apply(slice, b); break;
+
+        case element_type::dipedge:    FF_dipedge::apply(slice, b); break;
+
+        default: 
+            throw std::runtime_error(
+                    "FF_element::apply_tiled() unsupported element type = " + 
+                        elm.get_type_name() +
+                    ", element name = " + 
+                        elm.get_name() );
+        }
+    }
 };
 
 
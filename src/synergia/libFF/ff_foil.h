@@ -1,6 +1,7 @@
 #ifndef FF_FOIL_H
 #define FF_FOIL_H
 
+#include "synergia/bunch/probe_bunch.h"
 #include "synergia/libFF/ff_algorithm.h"
 #include "synergia/utils/simple_timer.h"
 #include <Kokkos_MathematicalConstants.hpp>
@@ -979,9 +980,9 @@ namespace foil_impl {
 
         Foil_aperture() {}
 
-        KOKKOS_INLINE_FUNCTION
-        bool
-        discard(ConstParticles const& parts,
+        template <class CP>
+        KOKKOS_INLINE_FUNCTION bool
+        discard(CP const& parts,
                 ConstParticleMasks const& masks,
                 int p) const
         {
@@ -996,8 +997,10 @@ namespace FF_foil {
     inline void
     apply(Lattice_element_slice const& slice, BunchT& bunch)
     {
-        // Do notthing for trigons
-        if constexpr (is_trigon<typename BunchT::part_t>::value) {
+        // Do notthing for trigons, or the probes of the optics
+        // calculations
+        if constexpr (is_trigon<typename BunchT::part_t>::value ||
+                      is_probe_bunch<BunchT>::value) {
             return;
         } else {
             using namespace foil_impl;
@@ -0,0 +1,106 @@
+#include "synergia/utils/catch.hpp"
+
+#include "synergia/bunch/bunch.h"
+#include "synergia/foundation/physical_constants.h"
+#include "synergia/lattice/lattice_element_slice.h"
+#include "synergia/libFF/ff_drift.h"
+#include "synergia/libFF/ff_quadrupole.h"
+
+constexpr int num_parts = 37;
+
+namespace {
+    // a double bunch and its float copy
+    void
+    init_bunches(Bunch& bunch, BunchF& fbunch)
+    {
+        bunch.checkout_particles();
+
+        auto parts = bunch.get_host_particles();
+        auto masks = bunch.get_host_particle_masks();
+
+        for (int i = 0; i < num_parts; ++i) {
+            for (int j = 0; j < 6; ++j)
+                parts(i, j) = 1.0e-3 * (i % 7 - 3) * (j + 1);
+        }
+
+        masks(3) = 0;
+
+        bunch.checkin_particles();
+        bunch.get_bunch_particles().update_valid_num();
+
+        fbunch.assign(bunch);
+    }
+
+    void
+    check_close_particles(Bunch& bunch, BunchF& fbunch)
+    {
+        bunch.checkout_particles();
+        fbunch.checkout_particles();
+
+        auto p = bunch.get_host_particles();
+        auto fp = fbunch.get_host_particles();
+
+        REQUIRE(fbunch.get_local_num() == bunch.get_local_num());
+
+        for (int i = 0; i < num_parts; ++i) {
+            for (int j = 0; j < 6; ++j)
+                CHECK(fp(i, j) == Approx(p(i, j)).epsilon(1e-6).margin(1e-9));
+        }
+
+        auto const& r = bunch.get_reference_particle();
+        auto const& fr = fbunch.get_reference_particle();
+
+        CHECK(fr.get_s() == r.get_s());
+        CHECK(fr.get_bunch_abs_time() == r.get_bunch_abs_time());
+    }
+}
+
+TEST_CASE("FF_drift on a float bunch", "[BunchF]")
+{
+    Four_momentum fm(pconstants::mp, 8.0 + pconstants::mp);
+    Reference_particle ref(pconstants::proton_charge, fm);
+
+    Bunch bunch(ref, num_parts, 1e10, Commxx());
+    BunchF fbunch(ref, 1, 1e10, Commxx());
+
+    init_bunches(bunch, fbunch);
+
+    Lattice_element d("drift", "d");
+    d.set_double_attribute("l", 2.5);
+    Lattice_element_slice slice(d);
+
+    FF_drift::apply(slice, bunch);
+    FF_drift::apply(slice, fbunch);
+
+    check_close_particles(bunch, fbunch);
+}
+
+TEST_CASE("FF_quadrupole on a float bunch", "[BunchF]")
+{
+    Four_momentum fm(pconstants::mp, 8.0 + pconstants::mp);
+    Reference_particle ref(pconstants::proton_charge, fm);
+
+    Bunch bunch(ref, num_parts, 1e10, Commxx());
+    BunchF fbunch(ref, 1, 1e10, Commxx());
+
+    init_bunches(bunch, fbunch);
+
+    Lattice_element q("quadrupole", "q");
+    q.set_double_attribute("l", 0.5);
+    q.set_double_attribute("k1", 0.3);
+    Lattice_element_slice slice(q);
+
+    // thick quadrupole kicks and drifts, then a thin one
+    FF_quadrupole::apply(slice, bunch);
+    FF_quadrupole::apply(slice, fbunch);
+
+    Lattice_element tq("quadrupole", "tq");
+    tq.set_double_attribute("l", 0.0);
+    tq.set_double_attribute("k1", 0.2);
+    Lattice_element_slice tslice(tq);
+
+    FF_quadrupole::apply(tslice, bunch);
+    FF_quadrupole::apply(tslice, fbunch);
+
+    check_close_particles(bunch, fbunch);
+}
@@ -0,0 +1,227 @@
+#include "synergia/utils/catch.hpp"
+
+#include "synergia/bunch/bunch.h"
+#include "synergia/bunch/particle_tiles.h"
+#include "synergia/foundation/physical_constants.h"
+#include "synergia/lattice/lattice.h"
+#include "synergia/libFF/ff_drift.h"
+#include "synergia/libFF/ff_element.h"
+#include "synergia/simulation/independent_operation.h"
+#include "synergia/simulation/operation_extractor.h"
+
+constexpr int num_parts = 37;
+
+namespace {
+    void
+    init_bunch(Bunch& bunch)
+    {
+        bunch.checkout_particles();
+
+        auto parts = bunch.get_host_particles();
+        auto masks = bunch.get_host_particle_masks();
+
+        for (int i = 0; i < num_parts; ++i) {
+            for (int j = 0; j < 6; ++j)
+                parts(i, j) = 1.0e-3 * (i % 7 - 3) * (j + 1);
+        }
+
+        masks(3) = 0;
+        masks(20) = 0;
+
+        bunch.checkin_particles();
+        bunch.get_bunch_particles().update_valid_num();
+    }
+
+    // the multipole splits the lattice into two runs of tiled elements
+    Lattice
+    create_lattice()
+    {
+        Lattice lattice("tiles");
+
+        Lattice_element d("drift", "d");
+        Lattice_element q("quadrupole", "q");
+        Lattice_element b("sbend", "b");
+        Lattice_element m("marker", "m");
+        Lattice_element mp("multipole", "mp");
+
+        d.set_double_attribute("l", 1.0);
+        q.set_double_attribute("l", 0.5);
+        q.set_double_attribute("k1", 0.3);
+        b.set_double_attribute("l", 2.0);
+        b.set_double_attribute("angle", 0.1);
+        mp.set_vector_attribute("knl", {0.0, 0.02});
+
+        for (auto const& e : {d, q, d, b, m, mp, d, q})
+            lattice.append(e);
+
+        return lattice;
+    }
+
+    void
+    check_same_particles(Bunch& b1, Bunch& b2)
+    {
+        b1.checkout_particles();
+        b2.checkout_particles();
+
+        auto p1 = b1.get_host_particles();
+        auto p2 = b2.get_host_particles();
+
+        for (int i = 0; i < num_parts; ++i) {
+            for (int j = 0; j < 7; ++j)
+                CHECK(p1(i, j) == p2(i, j));
+        }
+
+        auto const& r1 = b1.get_reference_particle();
+        auto const& r2 = b2.get_reference_particle();
+
+        CHECK(r1.get_s() == r2.get_s());
+        CHECK(r1.get_bunch_abs_time() == r2.get_bunch_abs_time());
+    }
+}
+
+TEST_CASE("particle_tiles_t layout", "[particle_tiles]")
+{
+    Four_momentum fm(pconstants::mp, 8.0 + pconstants::mp);
+    Reference_particle ref(pconstants::proton_charge, fm);
+
+    Bunch bunch(ref, num_parts, 1e10, Commxx());
+    init_bunch(bunch);
+
+    using tiles_t = particle_tiles_t<>;
+    constexpr int w = tiles_t::tile_width;
+
+    tiles_t tiles(num_parts);
+    tiles.pack(bunch.get_bunch_particles());
+
+    CHECK(tiles.size() == num_parts);
+    CHECK(tiles.num_tiles() == (num_parts + w - 1) / w);
+
+    // the columns of a tile are contiguous
+    auto const& t = tiles.parts.tiles;
+    CHECK(t.stride(1) == w);
+    CHECK(t.stride(0) == 7 * w);
+
+    auto words = Kokkos::create_mirror_view(tiles.masks.words);
+    Kokkos::deep_copy(words, tiles.masks.words);
+
+    CHECK(((words(3 / w) >> (3 % w)) & 1u) == 0);
+    CHECK(((words(20 / w) >> (20 % w)) & 1u) == 0);
+    CHECK(((words(4 / w) >> (4 % w)) & 1u) == 1);
+}
+
+TEST_CASE("particle_tiles_t drift kernel", "[particle_tiles]")
+{
+    using namespace drift_impl;
+
+    Four_momentum fm(pconstants::mp, 8.0 + pconstants::mp);
+    Reference_particle ref(pconstants::proton_charge, fm);
+
+    Bunch b1(ref, num_parts, 1e10, Commxx());
+    Bunch b2(ref, num_parts, 1e10, Commxx());
+
+    init_bunch(b1);
+    init_bunch(b2);
+
+    using tiles_t = particle_tiles_t<>;
+    tiles_t tiles(num_parts);
+    tiles.pack(b2.get_bunch_particles());
+
+    double ref_p = ref.get_momentum();
+    double mass = ref.get_mass();
+
+    // the same kernel on the column and on the tiled layout
+    auto& bp = b1.get_bunch_particles();
+
+    PropDriftSimd<Bunch::bp_t> d1{bp.parts, bp.masks, 1.0, ref_p, mass, 0.0};
+    Kokkos::parallel_for(bp.size_in_gsv(), d1);
+
+    PropDriftSimd<tiles_t> d2{
+        tiles.parts, tiles.masks, 1.0, ref_p, mass, 0.0};
+    Kokkos::parallel_for(tiles.size_in_gsv(), d2);
+
+    tiles.unpack(b2.get_bunch_particles());
+
+    b1.checkout_particles();
+    b2.checkout_particles();
+
+    auto p1 = b1.get_host_particles();
+    auto p2 = b2.get_host_particles();
+
+    for (int i = 0; i < num_parts; ++i) {
+        for (int j = 0; j < 6; ++j)
+            CHECK(p1(i, j) == p2(i, j));
+    }
+}
+
+TEST_CASE("LibFF_operation on tiles", "[particle_tiles]")
+{
+    Four_momentum fm(pconstants::mp, 8.0 + pconstants::mp);
+    Reference_particle ref(pconstants::proton_charge, fm);
+
+    Bunch b1(ref, num_parts, 1e10, Commxx());
+    Bunch b2(ref, num_parts, 1e10, Commxx());
+
+    init_bunch(b1);
+    init_bunch(b2);
+
+    auto lattice = create_lattice();
+
+    std::vector<Lattice_element_slice> slices;
+    for (auto const& e : lattice.get_elements()) {
+        Lattice_element_slice slice(e);
+        if (FF_element::supports_tiles(slice)) slices.push_back(slice);
+    }
+
+    REQUIRE(slices.size() == 7);
+
+    Logger logger(0, LoggerV::DEBUG);
+
+    LibFF_operation columns(slices);
+    LibFF_operation tiled(slices, std::make_shared<tiled_bunch_t<>>());
+
+    // twice, the second time on the tiles of the first
+    for (int turn = 0; turn < 2; ++turn) {
+        columns.apply(b1, logger);
+        tiled.apply(b2, logger);
+    }
+
+    check_same_particles(b1, b2);
+}
+
+TEST_CASE("libff_tiled extractor", "[particle_tiles]")
+{
+    Four_momentum fm(pconstants::mp, 8.0 + pconstants::mp);
+    Reference_particle ref(pconstants::proton_charge, fm);
+
+    Bunch b1(ref, num_parts, 1e10, Commxx());
+    Bunch b2(ref, num_parts, 1e10, Commxx());
+
+    init_bunch(b1);
+    init_bunch(b2);
+
+    auto lattice = create_lattice();
+
+    std::vector<Lattice_element_slice> slices;
+    for (auto const& e : lattice.get_elements())
+        slices.emplace_back(e);
+
+    std::vector<std::unique_ptr<Independent_operation>> ops1;
+    std::vector<std::unique_ptr<Independent_operation>> ops2;
+
+    extract_independent_operations("libff", lattice, slices, ops1);
+    extract_independent_operations("libff_tiled", lattice, slices, ops2);
+
+    // d q d b m | mp | d q
+    CHECK(ops1.size() == 1);
+    CHECK(ops2.size() == 3);
+
+    Logger logger(0, LoggerV::DEBUG);
+
+    for (auto const& op : ops1)
+        op->apply(b1, logger);
+
+    for (auto const& op : ops2)
+        op->apply(b2, logger);
+
+    check_same_particles(b1, b2);
+}
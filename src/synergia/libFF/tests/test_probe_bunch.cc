@@ -0,0 +1,71 @@
+#include "synergia/utils/catch.hpp"
+
+#include "synergia/bunch/probe_bunch.h"
+#include "synergia/lattice/madx_reader.h"
+#include "synergia/libFF/ff_element.h"
+
+namespace {
+    // propagate the same particles through the sequence as a bunch and
+    // as probes, the results should be identical
+    void
+    compare_probes(std::string const& seq)
+    {
+        const int num = 4;
+
+        auto lattice = MadX_reader().get_lattice(seq, "fodo.madx");
+        auto const& ref = lattice.get_reference_particle();
+
+        Bunch bunch(ref, num, 1e9, Commxx());
+        probe_bunch_t<double> probes(ref, num);
+
+        auto bp = bunch.get_host_particles();
+        auto pp = probes.get_local_particles();
+
+        for (int i = 0; i < num; ++i) {
+            for (int j = 0; j < 6; ++j) {
+                bp(i, j) = 1.0e-3 * (i + 1) * (j % 3 - 1);
+                pp(i, j) = bp(i, j);
+            }
+        }
+
+        bunch.checkin_particles();
+
+        for (auto const& ele : lattice.get_elements()) {
+            FF_element::apply(ele, bunch);
+            FF_element::apply(ele, probes);
+        }
+
+        bunch.checkout_particles();
+
+        for (int i = 0; i < num; ++i) {
+            for (int j = 0; j < 6; ++j)
+                CHECK(pp(i, j) == Approx(bp(i, j)).margin(1e-14));
+        }
+
+        auto const& r1 = bunch.get_design_reference_particle();
+        auto const& r2 = probes.get_design_reference_particle();
+
+        CHECK(r2.get_state()[Bunch::cdt] ==
+              Approx(r1.get_state()[Bunch::cdt]).margin(1e-14));
+    }
+}
+
+TEST_CASE("probe_bunch_t drift", "[probe_bunch]")
+{
+    compare_probes("seq_drift");
+}
+
+TEST_CASE("probe_bunch_t sbend", "[probe_bunch]")
+{
+    compare_probes("seq_sbend");
+}
+
+TEST_CASE("probe_bunch_t quadrupole", "[probe_bunch]")
+{
+    compare_probes("seq_quadrupole");
+}
+
+TEST_CASE("probe_bunch_t sextupole", "[probe_bunch]")
+{
+    compare_probes("seq_sextupole");
+}
@@ -16,7 +16,8 @@ class Aperture_operation : public Independent_operation {
     {
         scoped_simple_timer timer(std::string("aperture_") + ap.type);
 
-        int ndiscarded = bunch.apply_aperture(ap);
+        int ndiscarded = bunch.apply_aperture(
+            ap, ParticleGroup::regular, slice.get_lattice_element().get_name());
         double charge =
             ndiscarded * bunch.get_real_num() / bunch.get_total_num();
         slice.get_lattice_element().deposit_charge(
@@ -42,9 +43,9 @@ struct Dummy_aperture {
 
     Dummy_aperture(Lattice_element const&) {}
 
-    KOKKOS_INLINE_FUNCTION
-    bool
-    discard(ConstParticles const&, ConstParticleMasks const&, int p) const
+    template <class CP>
+    KOKKOS_INLINE_FUNCTION bool
+    discard(CP const&, ConstParticleMasks const&, int p) const
     {
         return false;
     }
@@ -56,9 +57,9 @@ struct Finite_aperture {
 
     Finite_aperture(Lattice_element const&) {}
 
-    KOKKOS_INLINE_FUNCTION
-    bool
-    discard(ConstParticles const& parts, ConstParticleMasks const&, int p) const
+    template <class CP>
+    KOKKOS_INLINE_FUNCTION bool
+    discard(CP const& parts, ConstParticleMasks const&, int p) const
     {
 #if 1
         if (!std::isfinite(parts(p, 0)) || !std::isfinite(parts(p, 1)) ||
@@ -102,9 +103,9 @@ struct Circular_aperture {
         r2 = r * r;
     }
 
-    KOKKOS_INLINE_FUNCTION
-    bool
-    discard(ConstParticles const& parts, ConstParticleMasks const&, int p) const
+    template <class CP>
+    KOKKOS_INLINE_FUNCTION bool
+    discard(CP const& parts, ConstParticleMasks const&, int p) const
     {
         double xrel = parts(p, 0) - xoff;
         double yrel = parts(p, 2) - yoff;
@@ -138,9 +139,9 @@ struct Elliptical_aperture {
         v2 = vr * vr;
     }
 
-    KOKKOS_INLINE_FUNCTION
-    bool
-    discard(ConstParticles const& parts, ConstParticleMasks const&, int p) const
+    template <class CP>
+    KOKKOS_INLINE_FUNCTION bool
+    discard(CP const& parts, ConstParticleMasks const&, int p) const
     {
         double xrel = parts(p, 0) - xoff;
         double yrel = parts(p, 2) - yoff;
@@ -167,9 +168,9 @@ struct Rectangular_aperture {
         , yoff(ele.get_double_attribute("voffset", 0.0))
     {}
 
-    KOKKOS_INLINE_FUNCTION
-    bool
-    discard(ConstParticles const& parts, ConstParticleMasks const&, int p) const
+    template <class CP>
+    KOKKOS_INLINE_FUNCTION bool
+    discard(CP const& parts, ConstParticleMasks const&, int p) const
     {
         using Kokkos::fabs;
 
@@ -227,9 +228,9 @@ struct Polygon_aperture {
         }
     }
 
-    KOKKOS_INLINE_FUNCTION
-    bool
-    discard(ConstParticles const& parts, ConstParticleMasks const&, int p) const
+    template <class CP>
+    KOKKOS_INLINE_FUNCTION bool
+    discard(CP const& parts, ConstParticleMasks const&, int p) const
     {
         using Kokkos::atan2;
 
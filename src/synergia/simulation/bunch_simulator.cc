@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <numeric>
 #include <random>
 #include <sstream>
@@ -45,72 +46,89 @@ namespace impl {
 
     void
     divide_bunches(int size,
-                   size_t num_bunches_pri,
-                   size_t num_bunches_sec,
+                   std::vector<double> const& weights_pri,
+                   std::vector<double> const& weights_sec,
                    std::vector<int>& p_ranks,
                    std::vector<int>& s_ranks)
     {
         assert(size > 0);
 
-        const size_t num_bunches = num_bunches_pri + num_bunches_sec;
+        const size_t num_bunches_pri = weights_pri.size();
+        const size_t num_bunches_sec = weights_sec.size();
+
+        size_t num_ranks_pri = 0;
+        size_t num_ranks_sec = 0;
         size_t st_start_rank = 0;
 
-        if (num_bunches == 0) {
+        if (num_bunches_pri + num_bunches_sec == 0) {
             // no bunch at all
-            p_ranks.resize(0);
-            s_ranks.resize(0);
-            st_start_rank = 0;
         } else if (size == 1) {
             // all bunches on a single rank
-            p_ranks.resize(num_bunches_pri ? 1 : 0);
-            s_ranks.resize(num_bunches_sec ? 1 : 0);
-            st_start_rank = 0;
-        } else if (size < num_bunches) {
-            // multiple ranks, each rank stores 1 train at max
-            if (num_bunches % size != 0) {
-                throw std::runtime_error(
-                    "Bunch_simulator::create_bunch_train_simulator() "
-                    "the number of bunches must be divisible by the number of "
-                    "ranks");
-            }
+            num_ranks_pri = num_bunches_pri ? 1 : 0;
+            num_ranks_sec = num_bunches_sec ? 1 : 0;
+        } else if (num_bunches_sec == 0) {
+            num_ranks_pri = size;
+        } else if (num_bunches_pri == 0) {
+            num_ranks_sec = size;
+        } else {
+            // multiple ranks, each rank stores 1 train at max. the ranks
+            // are shared by the total weights of the trains
+            double w_pri = std::accumulate(
+                weights_pri.begin(), weights_pri.end(), 0.0);
+            double w_sec = std::accumulate(
+                weights_sec.begin(), weights_sec.end(), 0.0);
+
+            Bunch_rank_map map(size, {w_pri, w_sec});
+
+            num_ranks_pri = map.get_rank_count(0);
+            num_ranks_sec = map.get_rank_count(1);
+            st_start_rank = num_ranks_pri;
+        }
 
-            int const bunch_per_rank = num_bunches / size;
+        p_ranks.resize(num_ranks_pri);
+        s_ranks.resize(num_ranks_sec);
 
-            if (num_bunches_pri % bunch_per_rank != 0 ||
-                num_bunches_sec % bunch_per_rank != 0) {
-                throw std::runtime_error(
-                    "Bunch_simulator::create_bunch_train_simulator() "
-                    "the number of bunches in primary or secondary train must "
-                    "be "
-                    "divisible by the number of bunches per rank");
-            }
+        std::iota(p_ranks.begin(), p_ranks.end(), 0);
+        std::iota(s_ranks.begin(), s_ranks.end(), st_start_rank);
 
-            p_ranks.resize(num_bunches_pri / bunch_per_rank);
-            s_ranks.resize(num_bunches_sec / bunch_per_rank);
-            st_start_rank = p_ranks.size();
-        } else {
-            // now size >= num_bunches, one bunch (or a fraciton of a bunch) per
-            // rank
-            if (size % num_bunches != 0) {
+        return;
+    }
+
+    void
+    divide_bunches(int size,
+                   size_t num_bunches_pri,
+                   size_t num_bunches_sec,
+                   std::vector<int>& p_ranks,
+                   std::vector<int>& s_ranks)
+    {
+        divide_bunches(size,
+                       std::vector<double>(num_bunches_pri, 1.0),
+                       std::vector<double>(num_bunches_sec, 1.0),
+                       p_ranks,
+                       s_ranks);
+    }
+
+    // bunch weights default to the numbers of macroparticles
+    std::vector<double>
+    bunch_weights(std::vector<size_t> const& num_particles,
+                  std::vector<double> const& weights)
+    {
+        if (!weights.empty()) {
+            if (weights.size() != num_particles.size()) {
                 throw std::runtime_error(
-                    "Bunch_simulator::create_bunch_train_simulator() "
-                    "the number of ranks must be divisible by the number of "
-                    "bunches");
+                    "Bunch_simulator: the number of bunch weights must be "
+                    "the same as the number of bunches");
             }
 
-            int const rank_per_bunch = size / num_bunches;
-
-            p_ranks.resize(rank_per_bunch * num_bunches_pri);
-            s_ranks.resize(rank_per_bunch * num_bunches_sec);
-            st_start_rank = p_ranks.size();
+            return weights;
         }
 
-        std::iota(p_ranks.begin(), p_ranks.end(), 0);
-        std::iota(s_ranks.begin(), s_ranks.end(), st_start_rank);
+        std::vector<double> w;
+        for (auto n : num_particles)
+            w.push_back(std::max(1.0, double(n)));
 
-        return;
+        return w;
     }
-
 }
 
 Bunch_simulator
@@ -192,6 +210,53 @@ Bunch_simulator::create_two_trains_simulator(Reference_particle const& ref_pri,
                      comm);
 }
 
+Bunch_simulator
+Bunch_simulator::create_bunch_train_simulator(
+    Reference_particle const& ref,
+    std::vector<size_t> const& num_particles,
+    std::vector<double> const& num_real_particles,
+    double spacing,
+    Commxx const& comm,
+    size_t num_spectators,
+    std::vector<double> const& weights)
+{
+    return construct(ref,
+                     ref,
+                     {num_particles, {}},
+                     {num_real_particles, {}},
+                     {weights, {}},
+                     num_spectators,
+                     spacing,
+                     1.0, // spacing
+                     comm);
+}
+
+Bunch_simulator
+Bunch_simulator::create_two_trains_simulator(
+    Reference_particle const& ref_pri,
+    Reference_particle const& ref_sec,
+    std::vector<size_t> const& num_particles_pri,
+    std::vector<size_t> const& num_particles_sec,
+    std::vector<double> const& num_real_particles_pri,
+    std::vector<double> const& num_real_particles_sec,
+    double spacing_pri,
+    double spacing_sec,
+    Commxx const& comm,
+    size_t num_spectators,
+    std::vector<double> const& weights_pri,
+    std::vector<double> const& weights_sec)
+{
+    return construct(ref_pri,
+                     ref_sec,
+                     {num_particles_pri, num_particles_sec},
+                     {num_real_particles_pri, num_real_particles_sec},
+                     {weights_pri, weights_sec},
+                     num_spectators,
+                     spacing_pri,
+                     spacing_sec,
+                     comm);
+}
+
 Bunch_simulator
 Bunch_simulator::construct(Reference_particle const& ref_pri,
                            Reference_particle const& ref_sec,
@@ -203,34 +268,70 @@ Bunch_simulator::construct(Reference_particle const& ref_pri,
                            double spacing_pri,
                            double spacing_sec,
                            Commxx const& comm)
+{
+    return construct(ref_pri,
+                     ref_sec,
+                     {std::vector<size_t>(num_bunches_pri, num_part),
+                      std::vector<size_t>(num_bunches_sec, num_part)},
+                     {std::vector<double>(num_bunches_pri, num_real_part),
+                      std::vector<double>(num_bunches_sec, num_real_part)},
+                     {},
+                     num_spec,
+                     spacing_pri,
+                     spacing_sec,
+                     comm);
+}
+
+Bunch_simulator
+Bunch_simulator::construct(
+    Reference_particle const& ref_pri,
+    Reference_particle const& ref_sec,
+    std::array<std::vector<size_t>, 2> const& num_parts,
+    std::array<std::vector<double>, 2> const& num_real_parts,
+    std::array<std::vector<double>, 2> const& weights,
+    size_t num_spec,
+    double spacing_pri,
+    double spacing_sec,
+    Commxx const& comm)
 {
     auto comm_ptr = std::make_shared<Commxx>(comm);
 
+    auto w_pri = impl::bunch_weights(num_parts[0], weights[0]);
+    auto w_sec = impl::bunch_weights(num_parts[1], weights[1]);
+
     std::vector<int> p_ranks;
     std::vector<int> s_ranks;
 
-    impl::divide_bunches(
-        comm.size(), num_bunches_pri, num_bunches_sec, p_ranks, s_ranks);
+    impl::divide_bunches(comm.size(), w_pri, w_sec, p_ranks, s_ranks);
 
     auto comm_pri = comm_ptr->group(p_ranks);
     auto comm_sec = comm_ptr->group(s_ranks);
 
+    // the rank maps are known on all ranks of the simulator, including
+    // the ones not in the train
+    auto map_pri = p_ranks.empty() ? Bunch_rank_map()
+                                   : Bunch_rank_map(p_ranks.size(), w_pri);
+    auto map_sec = s_ranks.empty() ? Bunch_rank_map()
+                                   : Bunch_rank_map(s_ranks.size(), w_sec);
+
     return Bunch_simulator(Bunch_train(ref_pri,
-                                       num_bunches_pri,
-                                       num_part,
-                                       num_real_part,
+                                       num_parts[0],
+                                       num_real_parts[0],
                                        spacing_pri,
                                        comm_pri,
                                        num_spec,
-                                       0),
+                                       0,
+                                       map_pri,
+                                       p_ranks.empty() ? 0 : p_ranks[0]),
                            Bunch_train(ref_sec,
-                                       num_bunches_sec,
-                                       num_part,
-                                       num_real_part,
+                                       num_parts[1],
+                                       num_real_parts[1],
                                        spacing_sec,
                                        comm_sec,
                                        num_spec,
-                                       1),
+                                       1,
+                                       map_sec,
+                                       s_ranks.empty() ? 0 : s_ranks[0]),
                            comm_ptr);
 
     // A more general approach to the above logic could be like:
@@ -369,42 +470,244 @@ Bunch_simulator::get_bunch(size_t train, size_t bunch) const
 std::vector<int>
 Bunch_simulator::get_bunch_ranks(size_t train, size_t bunch) const
 {
-    int rank_per_bunch =
-        std::ceil(1.0 * comm->size() /
-                  (trains[0].get_num_bunches() + trains[1].get_num_bunches()));
+    if (train > 1) throw std::runtime_error("invalid train index");
+    return trains[train].get_bunch_ranks(bunch);
+}
+
+void
+Bunch_simulator::remap_bunches(size_t train, Bunch_rank_map const& map)
+{
+    if (train > 1) throw std::runtime_error("invalid train index");
+
+    auto& bt = trains[train];
+    if (map == bt.get_rank_map()) return;
+
+    // the diagnostics triggers store the array indices of the bunches,
+    // which change with the remap. the bunches with diagnostics always
+    // stay on the same ranks
+    auto to_bunch_idx = [&](auto& dts) {
+        for (auto& dt : dts) {
+            if (dt.train != (int)train) continue;
+            dt.bunch = bt.get_train_idx_of_bunch(dt.bunch);
+        }
+    };
+
+    auto to_array_idx = [&](auto& dts) {
+        for (auto& dt : dts) {
+            if (dt.train != (int)train) continue;
+            dt.bunch = bt.get_array_idx_of_bunch(dt.bunch);
+        }
+    };
+
+    to_bunch_idx(diags_step_period);
+    to_bunch_idx(diags_turn_listed);
+    to_bunch_idx(diags_element);
+
+    bt.remap(map);
+
+    to_array_idx(diags_step_period);
+    to_array_idx(diags_turn_listed);
+    to_array_idx(diags_element);
+
+    // a new id for the collective operators to rebuild their per-bunch
+    // states
+    uuid = impl::generate_uuid_v4();
+}
+
+void
+Bunch_simulator::share_bunch_ranks(size_t train)
+{
+    if (train > 1) throw std::runtime_error("invalid train index");
 
-    std::vector<int> ranks(rank_per_bunch);
-    std::iota(ranks.begin(), ranks.end(), bunch * rank_per_bunch);
+    auto const& map = trains[train].get_rank_map();
+    if (map.get_num_bunches() == 0) return;
 
-    return ranks;
+    remap_bunches(
+        train,
+        Bunch_rank_map::shared(map.get_num_ranks(), map.get_num_bunches()));
+}
+
+bool
+Bunch_simulator::rebalance_bunches(
+    double tolerance,
+    std::array<std::vector<double>, 2> const& costs)
+{
+    bool remapped = false;
+
+    for (int t = 0; t < 2; ++t) {
+        auto& bt = trains[t];
+        auto const& old_map = bt.get_rank_map();
+
+        int nb = bt.get_num_bunches();
+        if (nb == 0 || old_map.get_num_bunches() != nb) continue;
+
+        // shared bunches are balanced by construction
+        if (old_map.is_shared()) continue;
+
+        if (!costs[t].empty() && (int)costs[t].size() != nb) {
+            throw std::runtime_error("Bunch_simulator::rebalance_bunches() "
+                                     "inconsistent number of bunch costs");
+        }
+
+        auto weights = bt.get_bunch_total_nums(*comm);
+
+        for (int b = 0; b < nb; ++b) {
+            if (!costs[t].empty()) weights[b] *= costs[t][b];
+            weights[b] = std::max(1.0, weights[b]);
+        }
+
+        Bunch_rank_map map(old_map.get_num_ranks(), weights);
+
+        if (map == old_map) continue;
+
+        if (map.get_imbalance(weights) >
+            (1.0 - tolerance) * old_map.get_imbalance(weights))
+            continue;
+
+        // bunches with diagnostics cannot be moved
+        int ok = bt.can_remap(map);
+        MPI_Allreduce(MPI_IN_PLACE, &ok, 1, MPI_INT, MPI_MIN, *comm);
+        if (!ok) continue;
+
+        remap_bunches(t, map);
+        remapped = true;
+    }
+
+    return remapped;
+}
+
+void
+Bunch_simulator::build_diag_tables()
+{
+    static long revision = 0;
+
+    diag_tables = diag_tables_t();
+    diag_tables.revision = ++revision;
+
+    for (int i = 0; i < (int)diags_step_period.size(); ++i) {
+        if (diags_step_period[i].trigger.step_period > 0)
+            diag_tables.step_period.push_back(i);
+    }
+
+    for (int i = 0; i < (int)diags_turn_listed.size(); ++i) {
+        for (int turn : diags_turn_listed[i].trigger.numbers) {
+            // a turn listed more than once triggers only once
+            auto& dts = diag_tables.turn_listed[turn];
+            if (dts.empty() || dts.back() != i) dts.push_back(i);
+        }
+    }
+
+    for (int i = 0; i < (int)diags_element.size(); ++i)
+        diag_tables.element[diags_element[i].trigger.name].push_back(i);
+
+    diag_tables.valid = true;
 }
 
 void
 Bunch_simulator::diag_action_step_and_turn(int turn_num, int step_num)
 {
-    for (auto const& dt : diags_step_period) {
-        if (dt.trigger(turn_num, step_num)) {
-            trains[dt.train][dt.bunch].diag_update_and_write(dt.diag_id);
+    if (!diag_tables.valid) build_diag_tables();
+
+    // in the middle of a turn only the diagnostics with a step
+    // period can be triggered
+    if (step_num != FINAL_STEP) {
+        for (int i : diag_tables.step_period) {
+            auto const& dt = diags_step_period[i];
+            if (dt.trigger(turn_num, step_num)) {
+                trains[dt.train][dt.bunch].diag_update_and_write(dt.diag_id);
+            }
         }
+
+        return;
     }
 
-    for (auto const& dt : diags_turn_listed) {
+    for (auto const& dt : diags_step_period) {
         if (dt.trigger(turn_num, step_num)) {
             trains[dt.train][dt.bunch].diag_update_and_write(dt.diag_id);
         }
     }
+
+    auto listed = diag_tables.turn_listed.find(turn_num);
+    if (listed == diag_tables.turn_listed.end()) return;
+
+    for (int i : listed->second) {
+        auto const& dt = diags_turn_listed[i];
+        trains[dt.train][dt.bunch].diag_update_and_write(dt.diag_id);
+    }
+}
+
+void
+Bunch_simulator::flush_diag_loss(bool force)
+{
+    for (auto& train : trains)
+        for (auto& bunch : train.get_bunches())
+            bunch.flush_diag_loss(force);
+}
+
+void
+Bunch_simulator::flush_diags(bool force)
+{
+    for (auto& train : trains)
+        for (auto& bunch : train.get_bunches())
+            bunch.flush_diags(force);
 }
 
 void
 Bunch_simulator::diag_action_element(Lattice_element const& element)
 {
-    for (auto const& dt : diags_element) {
+    diag_action_element(element, -1, -1);
+}
+
+void
+Bunch_simulator::diag_action_element(Lattice_element const& element,
+                                     int train,
+                                     int bunch)
+{
+    if (!diag_tables.valid) build_diag_tables();
+    if (diag_tables.element.empty()) return;
+
+    auto dts = diag_tables.element.find(element.get_name());
+    if (dts == diag_tables.element.end()) return;
+
+    diag_action_element(dts->second, element, train, bunch);
+}
+
+void
+Bunch_simulator::diag_action_element(std::vector<int> const& diags,
+                                     Lattice_element const& element,
+                                     int train,
+                                     int bunch)
+{
+    // train = -1 for the diagnostics of all bunches
+    for (int i : diags) {
+        auto const& dt = diags_element[i];
+
+        if (train >= 0 && (dt.train != train || dt.bunch != bunch)) continue;
+
         if (dt.trigger(current_turn(), element)) {
             trains[dt.train][dt.bunch].diag_update_and_write(dt.diag_id);
         }
     }
 }
 
+std::vector<int>
+Bunch_simulator::get_element_diags(Lattice_element const& element)
+{
+    if (!diag_tables.valid) build_diag_tables();
+
+    auto dts = diag_tables.element.find(element.get_name());
+    if (dts == diag_tables.element.end()) return {};
+
+    return dts->second;
+}
+
+long
+Bunch_simulator::get_diag_revision()
+{
+    if (!diag_tables.valid) build_diag_tables();
+    return diag_tables.revision;
+}
+
 void
 Bunch_simulator::diag_action_operator(Operator const& opr)
 {}
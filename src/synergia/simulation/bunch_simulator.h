@@ -8,6 +8,8 @@
 #include <cereal/types/utility.hpp> // std::pair
 #include <cereal/types/vector.hpp>
 
+#include <unordered_map>
+
 class Operator;
 class Independent_operation;
 
@@ -116,6 +118,27 @@ class Bunch_simulator {
     using dt_turn_listed = diag_tuple_t<trigger_turn_listed>;
     using dt_element = diag_tuple_t<trigger_element>;
 
+    // the triggers compiled into lookup tables of indices into the
+    // diags_* arrays, so the dispatch at every step and every slice
+    // does not scan all the registered diagnostics. Rebuilt on the
+    // first dispatch after a diagnostics is registered
+    struct diag_tables_t {
+        bool valid = false;
+
+        // diags_step_period with a step period, the only ones which
+        // can be triggered in the middle of a turn
+        std::vector<int> step_period;
+
+        // turn number -> diags_turn_listed
+        std::unordered_map<int, std::vector<int>> turn_listed;
+
+        // element name -> diags_element
+        std::unordered_map<std::string, std::vector<int>> element;
+
+        // unique over all simulators, changes on every rebuild
+        long revision = 0;
+    };
+
     // void action(Bunch_simulator&, Lattice&, int turn, int step, void* data)
     using action_step_t =
         std::function<void(Bunch_simulator&, Lattice&, int, int)>;
@@ -144,8 +167,21 @@ class Bunch_simulator {
                                      double spacing_sec,
                                      Commxx const& comm);
 
+    static Bunch_simulator construct(
+        Reference_particle const& ref_pri,
+        Reference_particle const& ref_sec,
+        std::array<std::vector<size_t>, 2> const& num_parts,
+        std::array<std::vector<double>, 2> const& num_real_parts,
+        std::array<std::vector<double>, 2> const& weights,
+        size_t num_spec,
+        double spacing_pri,
+        double spacing_sec,
+        Commxx const& comm);
+
     int get_bunch_array_idx(int train, int bunch) const;
 
+    void build_diag_tables();
+
   public:
     Bunch_simulator(Bunch_simulator const&) = delete;
     Bunch_simulator(Bunch_simulator&&) = default;
@@ -181,6 +217,34 @@ class Bunch_simulator {
         Commxx const& comm = Commxx(),
         size_t num_spectators = 0);
 
+    // bunches with individual numbers of macro and real particles. The
+    // bunches are assigned to the ranks by the weights (e.g., the costs of
+    // the collective operators of each bunch), or by their numbers of
+    // macroparticles when the weights are empty. Any number of bunches
+    // and ranks can be used, see Bunch_rank_map
+    static Bunch_simulator create_bunch_train_simulator(
+        Reference_particle const& ref,
+        std::vector<size_t> const& num_particles,
+        std::vector<double> const& num_real_particles,
+        double spacing,
+        Commxx const& comm = Commxx(),
+        size_t num_spectators = 0,
+        std::vector<double> const& weights = {});
+
+    static Bunch_simulator create_two_trains_simulator(
+        Reference_particle const& ref_pri,
+        Reference_particle const& ref_sec,
+        std::vector<size_t> const& num_particles_pri,
+        std::vector<size_t> const& num_particles_sec,
+        std::vector<double> const& num_real_particles_pri,
+        std::vector<double> const& num_real_particles_sec,
+        double spacing_pri,
+        double spacing_sec,
+        Commxx const& comm = Commxx(),
+        size_t num_spectators = 0,
+        std::vector<double> const& weights_pri = {},
+        std::vector<double> const& weights_sec = {});
+
     // bunch simulator id
     std::string const&
     id() const
@@ -214,6 +278,8 @@ class Bunch_simulator {
                           trigger_step_period{turn_period, step_period}};
 
         diags_step_period.push_back(dt);
+        diag_tables.valid = false;
+
         return handler.first;
     }
 
@@ -254,6 +320,8 @@ class Bunch_simulator {
             train, bunch_idx, handler.second, trigger_turn_listed{numbers}};
 
         diags_turn_listed.push_back(dt);
+        diag_tables.valid = false;
+
         return handler.first;
     }
 
@@ -283,26 +351,44 @@ class Bunch_simulator {
                       trigger_element{ele.get_name(), turn_period}};
 
         diags_element.push_back(dt);
+        diag_tables.valid = false;
+
         return handler.first;
     }
 
     // diag loss
+    // non-zero flush_turns or flush_size enables the buffered loss
+    // recording, see Diagnostics_loss
     void
     reg_diag_loss_aperture(std::string const& filename,
                            int bunch = 0,
-                           int train = 0)
+                           int train = 0,
+                           int flush_turns = 0,
+                           int flush_size = 0)
     {
-        get_bunch(train, bunch).set_diag_loss_aperture(filename);
+        get_bunch(train, bunch)
+            .set_diag_loss_aperture(filename, flush_turns, flush_size);
     }
 
     void
     reg_diag_loss_zcut(std::string const& filename,
                        int bunch = 0,
-                       int train = 0)
+                       int train = 0,
+                       int flush_turns = 0,
+                       int flush_size = 0)
     {
-        get_bunch(train, bunch).set_diag_loss_zcut(filename);
+        get_bunch(train, bunch)
+            .set_diag_loss_zcut(filename, flush_turns, flush_size);
     }
 
+    // flush the buffered loss diagnostics of all local bunches. called at
+    // the end of each turn, and with force = true to drain the buffers
+    // before checkpointing and at the end of the propagation
+    void flush_diag_loss(bool force = false);
+
+    // same as above, for all the buffered diagnostics of the bunches
+    void flush_diags(bool force = false);
+
 #if 0
     // diag per operator
     void reg_diag_at_operator(
@@ -335,9 +421,22 @@ class Bunch_simulator {
     // diag actions
     void diag_action_step_and_turn(int turn_num, int step_num);
     void diag_action_element(Lattice_element const& element);
+    void diag_action_element(Lattice_element const& element,
+                             int train,
+                             int bunch);
     void diag_action_operator(Operator const& opr);
     void diag_action_operation(Independent_operation const& opn);
 
+    // the element diagnostics looked up once by the caller with
+    // get_element_diags(), and valid while get_diag_revision() is
+    // unchanged. train = -1 for the diagnostics of all bunches
+    void diag_action_element(std::vector<int> const& diags,
+                             Lattice_element const& element,
+                             int train,
+                             int bunch);
+    std::vector<int> get_element_diags(Lattice_element const& element);
+    long get_diag_revision();
+
     // propagate actions
     void prop_action_first(Lattice& lattice);
     void prop_action_step_end(Lattice& lattice, int turn, int step);
@@ -386,6 +485,27 @@ class Bunch_simulator {
     // which ranks are a given bunch on
     std::vector<int> get_bunch_ranks(size_t train, size_t bunch) const;
 
+    // reassign the bunches of the train to its ranks, see
+    // Bunch_train::remap(). Collective over the simulator communicator
+    void remap_bunches(size_t train, Bunch_rank_map const& map);
+
+    // put all bunches of the train on all of its ranks (see
+    // Bunch_rank_map::shared()), so that Step::apply() can overlap the
+    // communications of one bunch with the computations of the others.
+    // Must be called before adding diagnostics to the bunches
+    void share_bunch_ranks(size_t train);
+
+    // remap the bunches of both trains by their current numbers of
+    // macroparticles, times the per-bunch costs if given (e.g., of the
+    // collective operators applied to them). A train is only remapped
+    // if its imbalance (see Bunch_rank_map::get_imbalance()) improves by
+    // more than the relative tolerance, and none of the moved bunches
+    // has diagnostics. Returns true if any train has been remapped.
+    // Collective over the simulator communicator
+    bool rebalance_bunches(
+        double tolerance = 0.1,
+        std::array<std::vector<double>, 2> const& costs = {});
+
     // turns
     void
     inc_turn()
@@ -470,6 +590,9 @@ class Bunch_simulator {
     std::vector<dt_turn_listed> diags_turn_listed;
     std::vector<dt_element> diags_element;
 
+    // not persistent, rebuilt from the above
+    diag_tables_t diag_tables;
+
     // it would survive the checkpoint load
     std::shared_ptr<Propagate_actions> prop_actions;
 
@@ -496,6 +619,7 @@ class Bunch_simulator {
         ar(CEREAL_NVP(diags_step_period));
         ar(CEREAL_NVP(diags_turn_listed));
         ar(CEREAL_NVP(diags_element));
+        diag_tables.valid = false;
 
         ar(CEREAL_NVP(prop_actions));
 
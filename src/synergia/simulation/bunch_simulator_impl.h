@@ -12,6 +12,14 @@ namespace impl {
                         std::vector<int>& p_ranks,
                         std::vector<int>& s_ranks);
 
+    // the ranks are shared between the two trains in proportion to the
+    // total weights of their bunches (see Bunch_rank_map)
+    void divide_bunches(int size,
+                        std::vector<double> const& weights_pri,
+                        std::vector<double> const& weights_sec,
+                        std::vector<int>& p_ranks,
+                        std::vector<int>& s_ranks);
+
 }
 
 #endif
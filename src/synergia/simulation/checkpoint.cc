@@ -2,6 +2,7 @@
 
 #include "synergia/simulation/bunch_simulator.h"
 #include "synergia/simulation/propagator.h"
+#include "synergia/utils/io_thread.h"
 
 namespace syn {
     void checkpoint_save_as_json(std::string const& prop_str,
@@ -17,6 +18,10 @@ namespace syn {
 void
 syn::checkpoint_save(Propagator const& prop, Bunch_simulator const& sim)
 {
+    // the file counters of the diagnostics are saved, and must not be
+    // changed by the pending writes
+    Io_thread::get().drain();
+
     std::string prop_str = prop.dump();
     std::string sim_str = sim.dump();
 
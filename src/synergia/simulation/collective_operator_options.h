@@ -18,7 +18,8 @@ using CO_options = std::variant<Dummy_CO_options,
                                 Space_charge_2d_open_hockney_options,
                                 Space_charge_2d_kv_options,
                                 Space_charge_rectangular_options,
-                                Impedance_options>;
+                                Impedance_options,
+                                Space_charge_2d_bassetti_erskine_options>;
 
 #else
 using CO_options = std::variant<Dummy_CO_options,
@@ -26,7 +27,8 @@ using CO_options = std::variant<Dummy_CO_options,
                                 Space_charge_2d_open_hockney_options,
                                 Space_charge_2d_kv_options,
                                 Space_charge_rectangular_options,
-                                Impedance_options>;
+                                Impedance_options,
+                                Space_charge_2d_bassetti_erskine_options>;
 #endif
 
 struct create_collective_operator {
@@ -67,6 +69,13 @@ struct create_collective_operator {
       static_cast<const Space_charge_2d_kv_options&>(ops));
   }
 
+  std::shared_ptr<Operator>
+  operator()(const Space_charge_2d_bassetti_erskine_options& ops)
+  {
+    return std::make_shared<Space_charge_2d_bassetti_erskine>(
+      static_cast<const Space_charge_2d_bassetti_erskine_options&>(ops));
+  }
+
   std::shared_ptr<Operator>
   operator()(const Space_charge_rectangular_options& ops)
   {
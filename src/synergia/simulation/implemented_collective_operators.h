@@ -2,6 +2,7 @@
 #define IMPLEMENTED_COLLECTIVE_OPERATORS_H
 
 #include "synergia/collective/impedance.h"
+#include "synergia/collective/space_charge_2d_bassetti_erskine.h"
 #include "synergia/collective/space_charge_2d_kv.h"
 #include "synergia/collective/space_charge_2d_open_hockney.h"
 
@@ -28,6 +28,15 @@ struct Space_charge_3d_fd_options {
     double kick_scale;
     int comm_group_size;
 
+    // start each solve from the previous potential, interpolated
+    // onto the current domain
+    bool warm_start;
+
+    // matrix-free 7-point stencil operator with geometric multigrid on the
+    // DMDA hierarchy. Requires grid sizes of the form k*2^n+1
+    bool matrix_free;
+    int mg_levels;
+
     Space_charge_3d_fd_options(int gridx = 32,
                                int gridy = 32,
                                int gridz = 64,
@@ -42,6 +51,9 @@ struct Space_charge_3d_fd_options {
         , n_sigma(8.0)
         , kick_scale(1.0)
         , comm_group_size(1)
+        , warm_start(false)
+        , matrix_free(false)
+        , mg_levels(3)
     {}
 
     void
@@ -60,6 +72,9 @@ struct Space_charge_3d_fd_options {
         ar(shape);
         ar(n_sigma);
         ar(comm_group_size);
+        ar(warm_start);
+        ar(matrix_free);
+        ar(mg_levels);
     }
 };
 #endif
@@ -79,6 +94,11 @@ struct Space_charge_3d_open_hockney_options {
     bool domain_fixed;
     int comm_group_size;
 
+    // domain hysteresis (see Domain_tracker), 0 to follow the beam on
+    // every kick
+    double domain_centroid_tolerance;
+    double domain_size_tolerance;
+
     Space_charge_3d_open_hockney_options(int gridx = 32,
                                          int gridy = 32,
                                          int gridz = 64)
@@ -92,6 +112,8 @@ struct Space_charge_3d_open_hockney_options {
         , kick_scale(1.0)
         , domain_fixed(false)
         , comm_group_size(4)
+        , domain_centroid_tolerance(0.0)
+        , domain_size_tolerance(0.0)
     {}
 
     void
@@ -122,6 +144,8 @@ struct Space_charge_3d_open_hockney_options {
         ar(grid_entire_period);
         ar(n_sigma);
         ar(comm_group_size);
+        ar(domain_centroid_tolerance);
+        ar(domain_size_tolerance);
     };
 };
 
@@ -135,6 +159,17 @@ struct Space_charge_2d_open_hockney_options {
     double n_sigma;
     int comm_group_size;
 
+    // domain hysteresis (see Domain_tracker), 0 to follow the beam on
+    // every kick
+    double domain_centroid_tolerance;
+    double domain_size_tolerance;
+
+    // solve each of the gridz slices of the bunch with its own
+    // transverse charge (2.5d), the slices are distributed over the
+    // ranks of the bunch. Honours periodic_z, z_period and
+    // grid_entire_period
+    bool slice_parallel;
+
     Space_charge_2d_open_hockney_options(int gridx = 32,
                                          int gridy = 32,
                                          int gridz = 32)
@@ -145,6 +180,9 @@ struct Space_charge_2d_open_hockney_options {
         , grid_entire_period(false)
         , n_sigma(8.0)
         , comm_group_size(4)
+        , domain_centroid_tolerance(0.0)
+        , domain_size_tolerance(0.0)
+        , slice_parallel(false)
     {}
 
     template <class Archive>
@@ -158,6 +196,9 @@ struct Space_charge_2d_open_hockney_options {
         ar(grid_entire_period);
         ar(n_sigma);
         ar(comm_group_size);
+        ar(domain_centroid_tolerance);
+        ar(domain_size_tolerance);
+        ar(slice_parallel);
     }
 };
 
@@ -181,6 +222,36 @@ struct Space_charge_2d_kv_options {
     }
 };
 
+// transverse Gaussian field (Bassetti-Erskine) space charge kick
+struct Space_charge_2d_bassetti_erskine_options {
+    using LD = LongitudinalDistribution;
+
+    // line charge density assumed to be gaussian or uniform over the
+    // bunch length
+    LD longitudinal_distribution = LD::uniform;
+
+    bool strictly_centered = false;
+
+    // use fixed rms sizes instead of the moments of the bunch at every
+    // kick. Sizes left at 0 are taken from each bunch at its first kick
+    bool frozen_sigma = false;
+    double sigma_x = 0.0;
+    double sigma_y = 0.0;
+    double sigma_cdt = 0.0;
+
+    template <class Archive>
+    void
+    serialize(Archive& ar)
+    {
+        ar(longitudinal_distribution);
+        ar(strictly_centered);
+        ar(frozen_sigma);
+        ar(sigma_x);
+        ar(sigma_y);
+        ar(sigma_cdt);
+    }
+};
+
 struct Space_charge_rectangular_options {
 
     std::array<int, 3> shape;
@@ -5,5 +5,11 @@
 void
 LibFF_operation::apply_impl(Bunch& bunch, Logger& logger) const
 {
-  for (auto const& slice : slices) FF_element::apply(slice, bunch);
+  if (tiles) {
+    tiles->pack(bunch);
+    for (auto const& slice : slices) FF_element::apply_tiled(slice, *tiles);
+    tiles->unpack();
+  } else {
+    for (auto const& slice : slices) FF_element::apply(slice, bunch);
+  }
 }
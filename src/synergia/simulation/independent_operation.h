@@ -2,9 +2,12 @@
 #define INDEPENDENT_OPERATION_H_
 
 #include "synergia/bunch/bunch.h"
+#include "synergia/bunch/particle_tiles.h"
 #include "synergia/lattice/lattice_element_slice.h"
 #include "synergia/utils/logger.h"
 
+#include <memory>
+
 class Independent_operation {
 private:
   std::string type;
@@ -43,6 +46,12 @@ class LibFF_operation : public Independent_operation {
 private:
   std::vector<Lattice_element_slice> slices;
 
+  // when set, the particles are propagated packed in these tiles, see
+  // particle_tiles.h. All the slices must be of
+  // FF_element::supports_tiles(). The tiles are only scratch space, so
+  // the tiled operations of an operator share them
+  std::shared_ptr<tiled_bunch_t<>> tiles;
+
 private:
   void
   print_impl(Logger& logger) const override
@@ -50,8 +59,9 @@ private:
   void apply_impl(Bunch& bunch, Logger& logger) const override;
 
 public:
-  LibFF_operation(std::vector<Lattice_element_slice> const& slices)
-    : Independent_operation("LibFF"), slices(slices)
+  LibFF_operation(std::vector<Lattice_element_slice> const& slices,
+                  std::shared_ptr<tiled_bunch_t<>> const& tiles = nullptr)
+    : Independent_operation("LibFF"), slices(slices), tiles(tiles)
   {}
 };
 
@@ -6,26 +6,59 @@
 #include "synergia/simulation/independent_operator.h"
 #include "synergia/simulation/operation_extractor.h"
 
+#include "synergia/utils/floating_point.h"
+
+namespace {
+  // same as the tolerance used in slicing the elements
+  const double slice_tolerance = 1.0e-9;
+}
+
 Independent_operator::Independent_operator(std::string const& name, double time)
-  : Operator(name, "independent", time), slices(), operations()
+  : Operator(name, "independent", time)
+  , slices()
+  , operations()
+  , revisions()
+  , slice_diags()
+  , diag_revision(-1)
 {}
 
 bool
-Independent_operator::need_update(Reference_particle const& ref, Logger& logger)
+Independent_operator::operations_outdated() const
 {
+  if (revisions.size() != slices.size()) return true;
+
+  for (size_t i = 0; i < slices.size(); ++i) {
+    if (slices[i].get_lattice_element().get_revision() != revisions[i])
+      return true;
+  }
+
   return false;
 }
 
-void
-Independent_operator::update_operations(
-  Reference_particle const& reference_particle)
-{}
+bool
+Independent_operator::slices_outdated() const
+{
+  for (auto const& slice : slices) {
+    double length = slice.get_lattice_element().get_length();
+
+    if (slice.get_right() > length + slice_tolerance) return true;
+
+    if (slice.has_right_edge() &&
+        !floating_point_equal(slice.get_right(), length, slice_tolerance))
+      return true;
+  }
+
+  return false;
+}
 
 void
 Independent_operator::create_operations_impl(Lattice const& lattice)
 {
   operations.clear();
-  // operations_revisions.clear();
+  revisions.clear();
+
+  slice_diags.clear();
+  diag_revision = -1;
 
   std::string aperture_type("");
   bool need_left_aperture, need_right_aperture;
@@ -70,7 +103,7 @@ Independent_operator::create_operations_impl(Lattice const& lattice)
       group.clear();
     }
 
-    // operations_revisions.push_back(element.get_revision());
+    revisions.push_back(element.get_revision());
   }
 
   if (!group.empty()) {
@@ -118,12 +151,10 @@ Independent_operator::apply_impl(Bunch_simulator& simulator,
         simulator.diag_action_operation(*opn);
       }
 
-      // per element diagnostics
+      // per element diagnostics of this bunch
       // the former "forced diagnostics"
-      for (auto const& slice : slices) {
-        if (slice.has_right_edge())
-          simulator.diag_action_element(slice.get_lattice_element());
-      }
+      diag_action_slices(
+        simulator, bunch.get_train_index(), bunch.get_array_index());
 
       // update per-bunch per-independent-operator
       bunch.update_total_num();
@@ -131,6 +162,58 @@ Independent_operator::apply_impl(Bunch_simulator& simulator,
   }
 }
 
+bool
+Independent_operator::begin_bunch_impl(Bunch_simulator& simulator,
+                                       int train,
+                                       int bunch_idx,
+                                       double time_step,
+                                       Logger& logger)
+{
+  using LV = LoggerV;
+
+  auto& bunch = simulator[train][bunch_idx];
+
+  for (auto const& opn : operations) {
+    logger(LV::INFO_OPN) << "    Independent_operator: operation type = "
+                         << opn->get_type() << "\n";
+
+    opn->apply(bunch, logger);
+
+    simulator.diag_action_operation(*opn);
+  }
+
+  // per element diagnostics, of this bunch only
+  diag_action_slices(simulator, train, bunch_idx);
+
+  bunch.update_total_num();
+
+  return false;
+}
+
+void
+Independent_operator::diag_action_slices(Bunch_simulator& simulator,
+                                         int train,
+                                         int bunch)
+{
+  if (diag_revision != simulator.get_diag_revision()) {
+    slice_diags.assign(slices.size(), {});
+
+    for (size_t i = 0; i < slices.size(); ++i) {
+      if (slices[i].has_right_edge())
+        slice_diags[i] =
+          simulator.get_element_diags(slices[i].get_lattice_element());
+    }
+
+    diag_revision = simulator.get_diag_revision();
+  }
+
+  for (size_t i = 0; i < slices.size(); ++i) {
+    if (!slice_diags[i].empty())
+      simulator.diag_action_element(
+        slice_diags[i], slices[i].get_lattice_element(), train, bunch);
+  }
+}
+
 void
 Independent_operator::print_impl(Logger& logger) const
 {
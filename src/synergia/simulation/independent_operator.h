@@ -10,18 +10,40 @@ private:
                   double time_step,
                   Logger& logger) override;
 
+  // independent operations are local to the bunch, so the pipelined
+  // application completes in begin_bunch()
+  bool
+  pipelined_impl() const override
+  {
+    return true;
+  }
+
+  bool begin_bunch_impl(Bunch_simulator& simulator,
+                        int train,
+                        int bunch,
+                        double time_step,
+                        Logger& logger) override;
+
   void create_operations_impl(Lattice const& lattice) override;
 
   void print_impl(Logger& logger) const override;
 
-  bool need_update(Reference_particle const& ref, Logger& logger);
-
-  void update_operations(Reference_particle const& ref);
+  // element diagnostics at the right edge of each slice
+  void diag_action_slices(Bunch_simulator& simulator, int train, int bunch);
 
 private:
   std::vector<Lattice_element_slice> slices;
   std::vector<std::unique_ptr<Independent_operation>> operations;
 
+  // element revisions of the slices when the operations were created
+  std::vector<long int> revisions;
+
+  // per slice indices of the element diagnostics of the simulator, see
+  // Bunch_simulator::get_element_diags(). Resolved again when the
+  // operations are created or the diagnostics tables have changed
+  std::vector<std::vector<int>> slice_diags;
+  long diag_revision;
+
 public:
   Independent_operator(std::string const& name, double time);
 
@@ -39,6 +61,13 @@ public:
     return slices;
   }
 
+  // an element has been revised since the operations were created
+  bool operations_outdated() const;
+
+  // a slice no longer fits in its element, i.e., the element length
+  // has changed and the steps need to be rebuilt
+  bool slices_outdated() const;
+
   friend class Propagator;
 };
 
@@ -2,7 +2,6 @@
 #include "synergia/foundation/physical_constants.h"
 #include "synergia/utils/multi_array_conversions.h"
 
-#include "independent_stepper_elements.h"
 #include "propagator.h"
 
 #include "lattice_simulator.h"
@@ -119,25 +118,21 @@ namespace Lattice_simulator {
         double psi_x = 0.0;
         double psi_y = 0.0;
 
-        // trigon bunch
-        Commxx comm;
-        bunch_t<trigon_t> bunch(ref, comm.size(), comm);
+        // trigon probe
+        probe_bunch_t<trigon_t> bunch(ref);
 
         // design reference particle from the closed orbit
         auto ref_l = ref;
         ref_l.set_state(probe);
         bunch.set_design_reference_particle(ref_l);
 
-        auto tparts = bunch.get_host_particles();
+        auto tparts = bunch.get_local_particles();
 
         // init value set to id map, ref points set to state
         // equivalent to jparticle.setState( particle.State() );
         for (int i = 0; i < 6; ++i)
             tparts(0, i).set(probe[i], i);
 
-        // check in
-        bunch.checkin_particles();
-
         // propagate trigon
         for (auto& elm : elms) {
             // At one time, dipoles with non-standard faces were discriminated
@@ -233,10 +228,10 @@ namespace Lattice_simulator {
         auto probe1 = calculate_closed_orbit(lattice, 0.0);
         auto probe2 = calculate_closed_orbit(lattice, dpp);
 
-        // propagate through elements
-        Commxx comm;
-        bunch_t<double> b1(ref, comm.size(), 1e9, comm);
-        bunch_t<double> b2(ref, comm.size(), 1e9, comm);
+        // propagate through elements, the two probes have their own
+        // design reference particles
+        probe_bunch_t<double> b1(ref);
+        probe_bunch_t<double> b2(ref);
 
         // design reference particle from the closed orbit
         auto ref1 = ref;
@@ -248,8 +243,8 @@ namespace Lattice_simulator {
         b2.set_design_reference_particle(ref2);
 
         // local particle data
-        auto part1 = b1.get_host_particles();
-        auto part2 = b2.get_host_particles();
+        auto part1 = b1.get_local_particles();
+        auto part2 = b2.get_local_particles();
 
         // init value
         for (int i = 0; i < 6; ++i) {
@@ -257,10 +252,6 @@ namespace Lattice_simulator {
             part2(0, i) = probe2[i];
         }
 
-        // check in
-        b1.checkin_particles();
-        b2.checkin_particles();
-
         // arcLength
         double lng = 0.0;
 
@@ -271,9 +262,6 @@ namespace Lattice_simulator {
             FF_element::apply(elm, b1);
             FF_element::apply(elm, b2);
 
-            b1.checkout_particles();
-            b2.checkout_particles();
-
             std::array<double, 6> d;
 
             for (int i = 0; i < 6; ++i)
@@ -343,33 +331,21 @@ namespace Lattice_simulator {
                 ele.set_double_attribute("volt", 0.0);
         }
 
-        // setup the propagator
-        Propagator propagator(temp_lattice, Independent_stepper_elements(1));
-
-        // bunch simulator
-        auto sim = Bunch_simulator::create_single_bunch_simulator(
-            ref, Commxx::world_size(), 1e09);
+        // only the design reference particle, which is the lattice
+        // reference particle as in a propagation, is needed
+        probe_bunch_t<double> pb(ref);
 
-        //
-        sim.get_bunch().get_design_reference_particle().set_state(
-            ref.get_state());
-
-        // propagate actions
+        // propagate element by element (the steps of a propagation with
+        // Independent_stepper_elements(1)) to get the accumulated cdt
         double accum_cdt = 0.0;
-        sim.reg_prop_action_step_end(
-            [&accum_cdt](Bunch_simulator& sim, Lattice&, int, int, void*) {
-                accum_cdt += sim.get_bunch()
-                                 .get_design_reference_particle()
-                                 .get_state()[4];
-            },
-            nullptr);
-
-        // propagate to get the accumulated cdt
-        Logger simlog(0, LoggerV::ERROR);
-        propagator.propagate(sim, simlog, 1);
+
+        for (auto const& ele : temp_lattice.get_elements()) {
+            FF_element::apply(ele, pb);
+            accum_cdt += pb.get_design_reference_particle().get_state()[4];
+        }
 
         // return the state
-        auto state = sim.get_bunch().get_reference_particle().get_state();
+        auto state = pb.get_reference_particle().get_state();
         state[Bunch::cdt] = accum_cdt;
 
         // go back and set the frequency of the cavities based on the
@@ -425,13 +401,9 @@ namespace Lattice_simulator {
             Closed_orbit_params* copp =
                 static_cast<Closed_orbit_params*>(params);
 
-            auto comm = Commxx();
-            Bunch bunch(copp->lattice.get_reference_particle(),
-                        comm.size(),
-                        1.0e10,
-                        comm);
+            probe_bunch_t<double> bunch(copp->lattice.get_reference_particle());
 
-            auto lp = bunch.get_host_particles();
+            auto lp = bunch.get_local_particles();
 
             // set phase space coordinates in bunch
             double orbit_start[4];
@@ -442,17 +414,12 @@ namespace Lattice_simulator {
 
             lp(0, 4) = 0.0;
             lp(0, 5) = copp->dpp;
-            // checkin
-            bunch.checkin_particles();
 
             // propagate
             for (auto const& ele : copp->lattice.get_elements()) {
                 FF_element::apply(ele, bunch);
             }
 
-            // checkout
-            bunch.checkout_particles();
-
             gsl_vector_set(co_results, 0, lp(0, 0) - orbit_start[0]);
             gsl_vector_set(co_results, 1, lp(0, 1) - orbit_start[1]);
             gsl_vector_set(co_results, 2, lp(0, 2) - orbit_start[2]);
@@ -569,11 +536,8 @@ namespace Lattice_simulator {
         // closed orbit
         auto probe = Lattice_simulator::calculate_closed_orbit(lattice, dpp);
 
-        // comm world
-        Commxx comm;
-
-        bunch_t<trigon_t> tb(ref, comm.size(), comm);
-        bunch_t<double> pb(ref, comm.size(), 1e9, comm);
+        probe_bunch_t<trigon_t> tb(ref);
+        probe_bunch_t<double> pb(ref);
 
         // design reference particle from the closed orbit
         auto ref_l = ref;
@@ -581,8 +545,8 @@ namespace Lattice_simulator {
         tb.set_design_reference_particle(ref_l);
         pb.set_design_reference_particle(ref_l);
 
-        auto tparts = tb.get_host_particles();
-        auto pparts = pb.get_host_particles();
+        auto tparts = tb.get_local_particles();
+        auto pparts = pb.get_local_particles();
 
         // init value
         for (int i = 0; i < 6; ++i) {
@@ -590,10 +554,6 @@ namespace Lattice_simulator {
             pparts(0, i) = probe[i];
         }
 
-        // check in
-        tb.checkin_particles();
-        pb.checkin_particles();
-
         // init c_delta_t
         double c_delta_t = 0.0;
 
@@ -615,10 +575,6 @@ namespace Lattice_simulator {
                 pb.get_design_reference_particle().get_state()[Bunch::cdt];
         }
 
-        // checkout particles
-        tb.checkout_particles();
-        pb.checkout_particles();
-
         // cdt from actual particle
         c_delta_t += pparts(0, 4);
 
@@ -932,7 +888,7 @@ namespace Lattice_simulator {
             double lastval = get_AT_corrector_strength(*(elms[0]));
             const double tolerance = 1.0e-12;
 
-            for (int i = 0; i < elms.size(); ++i) {
+            for (size_t i = 0; i < elms.size(); ++i) {
                 double val = get_AT_corrector_strength(*(elms[i]));
                 if (std::abs(val - lastval) > tolerance) relative = true;
 
@@ -943,88 +899,128 @@ namespace Lattice_simulator {
             param = relative ? 1.0 : original_strengths[0];
         }
 
-        struct Adjust_tunes_params {
-            Lattice& lattice;
-
-            double h_nu_target;
-            double v_nu_target;
-
-            std::vector<Lattice_element*> h_elements;
-            std::vector<Lattice_element*> v_elements;
-
-            std::vector<double> h_original_strengths;
-            std::vector<double> v_original_strengths;
-
-            double h_param;
-            double v_param;
-
-            bool h_relative;
-            bool v_relative;
-
-            Adjust_tunes_params(
-                Lattice& lattice,
-                double horizontal_tune,
-                double vertical_tune,
-                std::vector<Lattice_element*> const& h_correctors,
-                std::vector<Lattice_element*> const& v_correctors)
-                : lattice(lattice)
-                , h_nu_target(horizontal_tune)
-                , v_nu_target(vertical_tune)
-                , h_elements(h_correctors)
-                , v_elements(v_correctors)
-                , h_original_strengths(h_correctors.size())
-                , v_original_strengths(v_correctors.size())
-                , h_param(1.0)
-                , v_param(1.0)
-                , h_relative(false)
-                , v_relative(false)
+        // correctors driven together by a single knob, either the common
+        // strength, or a factor on the original strengths when they differ
+        struct Tunes_knob {
+            std::vector<Lattice_element*> elements;
+            std::vector<double> original_strengths;
+
+            double param;
+            bool relative;
+
+            explicit Tunes_knob(std::vector<Lattice_element*> const& elms)
+                : elements(elms)
+                , original_strengths(elms.size())
+                , param(1.0)
+                , relative(false)
             {
                 get_strengths_param(
-                    h_elements, h_original_strengths, h_param, h_relative);
+                    elements, original_strengths, param, relative);
+            }
 
-                get_strengths_param(
-                    v_elements, v_original_strengths, v_param, v_relative);
+            void
+            set(double p) const
+            {
+                for (size_t i = 0; i < elements.size(); ++i) {
+                    double str = relative ? p * original_strengths[i] : p;
+                    set_AT_corrector_strength(*elements[i], str);
+                }
             }
         };
 
-        int
-        adjust_tunes_function(const gsl_vector* x, void* params, gsl_vector* f)
+        // correctors driven together by a single knob, the change of the
+        // integrated k2 applied to every sextupole of the family
+        struct Chrom_knob {
+            std::vector<Lattice_element*> elements;
+            std::vector<double> original_k2;
+
+            explicit Chrom_knob(std::vector<Lattice_element*> const& elms)
+                : elements(elms), original_k2(elms.size())
+            {
+                for (size_t i = 0; i < elements.size(); ++i)
+                    original_k2[i] =
+                        elements[i]->get_double_attribute("k2", 0.0);
+            }
+
+            void
+            set(double dk2l) const
+            {
+                for (size_t i = 0; i < elements.size(); ++i) {
+                    double len = elements[i]->get_length();
+                    double dk2 = (len > 0.0) ? dk2l / len : dk2l;
+                    double str = original_k2[i] + dk2;
+                    elements[i]->set_double_attribute("k2", str);
+                }
+            }
+        };
+
+        using knobs_t = Eigen::Vector2d;
+        using knobs_jac_t = Eigen::Matrix2d;
+
+        // Newton iterations on f(x) = 0 for the two knobs x. The Jacobian
+        // is calculated from forward differences with steps dx, then kept
+        // up to date with Broyden's rank one updates, so a Newton step
+        // costs a single evaluation of f. It is recalculated when a step
+        // does not reduce the residual. Returns false when not converged
+        // within max_steps Newton steps. x is the last point tried.
+        // The derivatives are not taken from the maps, since the element
+        // strengths enter the libFF kernels as plain doubles
+        template <class F>
+        bool
+        newton_match(F&& f,
+                     knobs_t& x,
+                     knobs_t const& dx,
+                     double tolerance,
+                     int max_steps,
+                     const char* caller)
         {
-            Adjust_tunes_params* atparams =
-                static_cast<Adjust_tunes_params*>(params);
+            auto jacobian = [&](knobs_t const& x0, knobs_t const& f0) {
+                knobs_jac_t jac;
 
-            double h_param = gsl_vector_get(x, 0);
+                for (int j = 0; j < 2; ++j) {
+                    knobs_t xj = x0;
+                    xj[j] += dx[j];
+                    jac.col(j) = (f(xj) - f0) / dx[j];
+                }
 
-            for (int i = 0; i < atparams->h_elements.size(); ++i) {
-                double str = atparams->h_relative ?
-                                 h_param * atparams->h_original_strengths[i] :
-                                 h_param;
+                return jac;
+            };
 
-                auto pe = atparams->h_elements[i];
-                set_AT_corrector_strength(*pe, str);
-            }
+            knobs_t fx = f(x);
+            if (fx.cwiseAbs().maxCoeff() < tolerance) return true;
 
-            double v_param = gsl_vector_get(x, 1);
+            knobs_jac_t jac = jacobian(x, fx);
 
-            for (int i = 0; i < atparams->v_elements.size(); ++i) {
-                double str = atparams->v_relative ?
-                                 v_param * atparams->v_original_strengths[i] :
-                                 v_param;
+            for (int step = 0; step < max_steps; ++step) {
+                auto lu = jac.fullPivLu();
 
-                auto pe = atparams->v_elements[i];
-                set_AT_corrector_strength(*pe, str);
-            }
+                if (!lu.isInvertible()) {
+                    throw std::runtime_error(
+                        std::string("Lattice_simulator::") + caller +
+                        ": the two corrector families are not independent");
+                }
 
-            auto nus = Lattice_simulator::calculate_tune_and_cdt(
-                atparams->lattice, 0.0);
+                knobs_t s = -lu.solve(fx);
+                knobs_t xn = x + s;
+                knobs_t fn = f(xn);
 
-            double nu_h = nus[0];
-            double nu_v = nus[1];
+                if (fn.cwiseAbs().maxCoeff() < tolerance) {
+                    x = xn;
+                    return true;
+                }
 
-            gsl_vector_set(f, 0, nu_h - atparams->h_nu_target);
-            gsl_vector_set(f, 1, nu_v - atparams->v_nu_target);
+                if (fn.norm() < fx.norm()) {
+                    jac += (fn - fx - jac * s) * s.transpose() /
+                           s.squaredNorm();
+                } else {
+                    jac = jacobian(xn, fn);
+                }
 
-            return GSL_SUCCESS;
+                x = xn;
+                fx = fn;
+            }
+
+            return false;
         }
     }
 
@@ -1052,42 +1048,32 @@ namespace Lattice_simulator {
             throw std::runtime_error("No v_tunes_correctors defined");
         }
 
-        Adjust_tunes_params atparams(lattice,
-                                     horizontal_tune,
-                                     vertical_tune,
-                                     h_correctors,
-                                     v_correctors);
+        Tunes_knob h_knob(h_correctors);
+        Tunes_knob v_knob(v_correctors);
 
-        const size_t n = 2;
-        gsl_multiroot_function f = {
-            &adjust_tunes_function, n, (void*)&atparams};
+        // tunes from the host probes, one closed orbit and one trigon
+        // pass per evaluation
+        auto residual = [&](knobs_t const& x) {
+            h_knob.set(x[0]);
+            v_knob.set(x[1]);
 
-        gsl_vector* x = gsl_vector_alloc(n);
-        gsl_vector_set(x, 0, atparams.h_param);
-        gsl_vector_set(x, 1, atparams.v_param);
-
-        const gsl_multiroot_fsolver_type* T = gsl_multiroot_fsolver_hybrids;
-        gsl_multiroot_fsolver* s = gsl_multiroot_fsolver_alloc(T, n);
-        gsl_multiroot_fsolver_set(s, &f, x);
-
-        int status;
-        size_t iter = 0;
-        const int max_iter = 100;
-
-        do {
-            iter++;
+            auto nus = Lattice_simulator::calculate_tune_and_cdt(lattice, 0.0);
+            return knobs_t(nus[0] - horizontal_tune, nus[1] - vertical_tune);
+        };
 
-            status = gsl_multiroot_fsolver_iterate(s);
-            if (status) break;
+        knobs_t x(h_knob.param, v_knob.param);
+        knobs_t dx(1e-6 * std::max(std::abs(x[0]), 1.0),
+                   1e-6 * std::max(std::abs(x[1]), 1.0));
 
-            status = gsl_multiroot_test_residual(s->f, tolerance);
+        const int max_steps = 100;
 
-        } while (status == GSL_CONTINUE && iter < max_iter);
+        bool ok =
+            newton_match(residual, x, dx, tolerance, max_steps, "adjust_tunes");
 
-        gsl_multiroot_fsolver_free(s);
-        gsl_vector_free(x);
+        h_knob.set(x[0]);
+        v_knob.set(x[1]);
 
-        if (iter >= max_iter)
+        if (!ok)
             throw std::runtime_error("Lattice_elements::adjust_tunes: "
                                      "solver failed to converge");
     }
@@ -1107,6 +1093,7 @@ namespace Lattice_simulator {
     {
         CourantSnyderLatticeFunctions_impl(prop.get_lattice(),
                                            prop.get_lattice_element_slices());
+        prop.slices_updated();
     }
 
     void
@@ -1120,88 +1107,13 @@ namespace Lattice_simulator {
     {
         calc_dispersions_impl(prop.get_lattice(),
                               prop.get_lattice_element_slices());
+        prop.slices_updated();
     }
 
     // --------------------------------------------
     // adjust chromaticities
     // --------------------------------------------
 
-    namespace {
-        struct ChromAdjuster {
-            using MatrixD = Eigen::
-                Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
-
-            const int N;
-            Lattice& lattice;
-            std::vector<Lattice_element*> correctors;
-            MatrixD f_;
-
-            ChromAdjuster(Lattice& lattice,
-                          std::vector<Lattice_element*> const& h_correctors,
-                          std::vector<Lattice_element*> const& v_correctors)
-                : N(h_correctors.size() + v_correctors.size())
-                , lattice(lattice)
-                , correctors(N)
-                , f_(N, 2)
-            {
-                auto h_size = h_correctors.size();
-                auto v_size = v_correctors.size();
-
-                for (size_t i = 0; i < h_size; ++i) {
-                    correctors[i] = h_correctors[i];
-                    f_(i, 0) = 1.0;
-                    f_(i, 1) = 0.0;
-                }
-
-                for (size_t i = 0; i < v_size; ++i) {
-                    correctors[i + h_size] = v_correctors[i];
-                    f_(i + h_size, 0) = 0.0;
-                    f_(i + h_size, 1) = 1.0;
-                }
-            }
-
-            void
-            change_chrom_by(double dh, double dv)
-            {
-                namespace LS = Lattice_simulator;
-
-                LS::CourantSnyderLatticeFunctions(lattice);
-                LS::calc_dispersions(lattice);
-
-                MatrixD beta(2, N);
-
-                // delta_xi = beta * _f * c
-                // w = _f * c
-                // delta chef_str = 2 * pi * brho * w_k / dsp_k
-                // (chef_str = k * brho / 2)
-
-                for (int j = 0; j < N; ++j) {
-                    double dsp = correctors[j]->lf.dispersion.hor;
-                    beta(0, j) = correctors[j]->lf.beta.hor * dsp;
-                    beta(1, j) = -correctors[j]->lf.beta.ver * dsp;
-                }
-
-                // Adjust chromaticity
-                MatrixD d_xi(2, 1);
-                d_xi(0, 0) = dh;
-                d_xi(1, 0) = dv;
-
-                MatrixD c_ = 4.0 * Kokkos::numbers::pi_v<double> *
-                             ((beta * f_).inverse() * d_xi);
-                MatrixD w = f_ * c_;
-
-                for (int j = 0; j < N; ++j) {
-                    double len = correctors[j]->get_length();
-                    double str = correctors[j]->get_double_attribute("k2");
-
-                    str += (len > 0.0) ? w(j, 0) / len : w(j, 0);
-                    correctors[j]->set_double_attribute("k2", str);
-                }
-            }
-        };
-
-    }
-
     void
     adjust_chromaticities(Lattice& lattice,
                           double horizontal_chromaticity,
@@ -1221,40 +1133,49 @@ namespace Lattice_simulator {
                 v_correctors.push_back(&e);
         }
 
-        // Adjuster
-        ChromAdjuster ca(lattice, h_correctors, v_correctors);
-        ;
-
-        // current chromaticities
-        auto chroms = get_chromaticities(lattice);
+        // a lattice that is already matched needs no correctors
+        if (h_correctors.empty() || v_correctors.empty()) {
+            auto chroms = get_chromaticities(lattice);
 
-        double chr_h = chroms.horizontal_chromaticity;
-        double chr_v = chroms.vertical_chromaticity;
+            double dh =
+                horizontal_chromaticity - chroms.horizontal_chromaticity;
+            double dv = vertical_chromaticity - chroms.vertical_chromaticity;
 
-        // delta = target - current
-        double dh = horizontal_chromaticity - chr_h;
-        double dv = vertical_chromaticity - chr_v;
+            if (std::abs(dh) < tolerance && std::abs(dv) < tolerance) return;
+        }
 
-        int count = 0;
+        if (!h_correctors.size()) {
+            throw std::runtime_error("No h_chrom_correctors defined");
+        }
+        if (!v_correctors.size()) {
+            throw std::runtime_error("No v_chrom_correctors defined");
+        }
 
-        // loop
-        while (((std::abs(dh) > tolerance) || (std::abs(dv) > tolerance)) &&
-               (count < max_steps)) {
+        Chrom_knob h_knob(h_correctors);
+        Chrom_knob v_knob(v_correctors);
 
-            ca.change_chrom_by(dh, dv);
+        auto residual = [&](knobs_t const& x) {
+            h_knob.set(x[0]);
+            v_knob.set(x[1]);
 
             auto chroms = get_chromaticities(lattice);
+            return knobs_t(
+                chroms.horizontal_chromaticity - horizontal_chromaticity,
+                chroms.vertical_chromaticity - vertical_chromaticity);
+        };
 
-            chr_h = chroms.horizontal_chromaticity;
-            chr_v = chroms.vertical_chromaticity;
+        // the chromaticities are linear in the sextupole strengths, the
+        // difference steps need not be small (integrated k2 in m^-2)
+        knobs_t x(0.0, 0.0);
+        knobs_t dx(1e-2, 1e-2);
 
-            dh = horizontal_chromaticity - chr_h;
-            dv = vertical_chromaticity - chr_v;
+        bool ok = newton_match(
+            residual, x, dx, tolerance, max_steps, "adjust_chromaticities");
 
-            count++;
-        }
+        h_knob.set(x[0]);
+        v_knob.set(x[1]);
 
-        if (count == max_steps)
+        if (!ok)
             throw std::runtime_error(
                 "Lattice_simulator::adjust_chromaticities: "
                 "Convergence not achieved. Increase the maximum number of "
@@ -3,6 +3,7 @@
 #define SYNERGIA_SIMULATION_LATTICE_SIMULATOR_H
 
 #include "synergia/bunch/bunch.h"
+#include "synergia/bunch/probe_bunch.h"
 #include "synergia/lattice/lattice.h"
 #include "synergia/libFF/ff_element.h"
 #include "synergia/simulation/propagator.h"
@@ -23,6 +24,9 @@ struct chromaticities_t {
   double slip_factor_prime;
 };
 
+// The optics calculations below propagate a few probe particles
+// (probe_bunch_t) on the host, see probe_bunch.h.
+
 namespace Lattice_simulator {
   // just to get a sense of things, the Booster acceleration script
   // fails to find a closed orbit after about 100 turns if the
@@ -80,25 +84,19 @@ namespace Lattice_simulator {
     // closed orbit
     auto probe = Lattice_simulator::calculate_closed_orbit(lattice, dpp);
 
-    // comm world
-    Commxx comm;
-
-    // trigon bunch to get the one-turn-map
-    bunch_t<trigon_t> tb(ref, comm.size(), comm);
+    // trigon probe to get the one-turn-map
+    probe_bunch_t<trigon_t> tb(ref);
 
     // design reference particle from the closed orbit
     auto ref_l = ref;
     ref_l.set_state(probe);
     tb.set_design_reference_particle(ref_l);
 
-    auto tparts = tb.get_host_particles();
+    auto tparts = tb.get_local_particles();
 
     // init value
     for (int i = 0; i < 6; ++i) tparts(0, i).set(probe[i], i);
 
-    // check in
-    tb.checkin_particles();
-
     // propagate trigon
     for (auto& ele : lattice.get_elements()) {
       if (ele.get_type() == element_type::rfcavity) {
@@ -111,9 +109,6 @@ namespace Lattice_simulator {
       }
     }
 
-    // checkout particles
-    tb.checkout_particles();
-
     // one-turn-map
     TMapping<trigon_t> map;
     for (int i = 0; i < trigon_t::dim; ++i) map[i] = tparts(0, i);
@@ -168,7 +163,14 @@ namespace Lattice_simulator {
   template <class ELMS>
   void calc_dispersions_impl(Lattice& lattice, ELMS& elms);
 
-  // adjust tunes and chromaticities
+  // adjust tunes and chromaticities. Each family of correctors (elements
+  // marked as h/v_tunes_corrector or h/v_chrom_corrector) is one knob,
+  // and the two knobs are matched with Newton steps on a finite
+  // difference Jacobian kept up to date with Broyden updates.
+  //
+  // Throw std::runtime_error when either family is empty (for the
+  // chromaticities, unless they are already within tolerance), or the
+  // match has not converged.
   void adjust_tunes(Lattice& lattice,
                     double horizontal_tune,
                     double vertical_tune,
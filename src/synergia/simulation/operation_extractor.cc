@@ -4,6 +4,8 @@
 #include "synergia/simulation/aperture_operation.h"
 #include "synergia/simulation/independent_operation.h"
 
+#include "synergia/libFF/ff_element.h"
+
 namespace {
   void
   chef_map_operation_extract(
@@ -28,6 +30,42 @@ namespace {
     operations.push_back(std::make_unique<LibFF_operation>(slices));
   }
 
+  // the runs of slices the libFF elements can propagate on particle
+  // tiles become tiled operations, which pack the bunch once per run.
+  // The other slices are propagated on the bunch as with "libff". All
+  // the tiled operations share one set of tiles
+  void
+  libff_tiled_operation_extract(
+    Lattice const& lattice,
+    std::vector<Lattice_element_slice> const& slices,
+    std::vector<std::unique_ptr<Independent_operation>>& operations)
+  {
+    std::vector<Lattice_element_slice> run;
+    bool run_tiled = false;
+
+    std::shared_ptr<tiled_bunch_t<>> tiles;
+
+    auto push_run = [&]() {
+      if (run_tiled && !tiles) tiles = std::make_shared<tiled_bunch_t<>>();
+      operations.push_back(
+        std::make_unique<LibFF_operation>(run, run_tiled ? tiles : nullptr));
+    };
+
+    for (auto const& slice : slices) {
+      bool tiled = FF_element::supports_tiles(slice);
+
+      if (!run.empty() && tiled != run_tiled) {
+        push_run();
+        run.clear();
+      }
+
+      run.push_back(slice);
+      run_tiled = tiled;
+    }
+
+    if (!run.empty()) push_run();
+  }
+
 } // namespace
 
 void
@@ -50,6 +88,8 @@ extract_independent_operations(
 #endif
   else if (extractor_type == "libff" || extractor_type == "default") {
     libff_operation_extract(lattice, slices, operations);
+  } else if (extractor_type == "libff_tiled") {
+    libff_tiled_operation_extract(lattice, slices, operations);
   } else {
     throw std::runtime_error("unknown extractor_type: " + extractor_type);
   }
@@ -1,6 +1,7 @@
 #ifndef OPERATOR_H_
 #define OPERATOR_H_
 
+#include <stdexcept>
 #include <string>
 
 #include "synergia/lattice/lattice_element_slice.h"
@@ -29,6 +30,37 @@ private:
 
   virtual void print_impl(Logger& logger) const = 0;
 
+  // split-phase application to a single bunch, see is_pipelined()
+  virtual bool
+  pipelined_impl() const
+  {
+    return false;
+  }
+
+  virtual bool
+  begin_bunch_impl(Bunch_simulator& simulator,
+                   int train,
+                   int bunch,
+                   double time_step,
+                   Logger& logger)
+  {
+    throw std::runtime_error("Operator::begin_bunch() not implemented");
+  }
+
+  virtual bool
+  test_bunch_impl(int train, int bunch)
+  {
+    return true;
+  }
+
+  virtual void
+  finish_bunch_impl(Bunch_simulator& simulator,
+                    int train,
+                    int bunch,
+                    double time_step,
+                    Logger& logger)
+  {}
+
 public:
   Operator(std::string const& name, std::string const& type, double time)
     : name(name), type(type), time_fraction(time)
@@ -64,6 +96,47 @@ public:
     apply_impl(simulator, time_step * time_fraction, logger);
   }
 
+  /// Whether the operator can be applied to one local bunch at a time.
+  /// begin_bunch() does the local work and posts the nonblocking
+  /// communications, and returns true if finish_bunch() has to be called
+  /// to wait for them and complete the operator on the bunch. In between,
+  /// other bunches can be begun or finished, as long as all ranks of the
+  /// bunch communicators do so in the same order. test_bunch() only
+  /// progresses the communications and tells if they have completed.
+  bool
+  is_pipelined() const
+  {
+    return pipelined_impl();
+  }
+
+  bool
+  begin_bunch(Bunch_simulator& simulator,
+              int train,
+              int bunch,
+              double time_step,
+              Logger& logger)
+  {
+    return begin_bunch_impl(
+      simulator, train, bunch, time_step * time_fraction, logger);
+  }
+
+  bool
+  test_bunch(int train, int bunch)
+  {
+    return test_bunch_impl(train, bunch);
+  }
+
+  void
+  finish_bunch(Bunch_simulator& simulator,
+               int train,
+               int bunch,
+               double time_step,
+               Logger& logger)
+  {
+    finish_bunch_impl(
+      simulator, train, bunch, time_step * time_fraction, logger);
+  }
+
   void
   print(Logger& logger) const
   {
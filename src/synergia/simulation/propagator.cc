@@ -2,7 +2,13 @@
 #include "synergia/simulation/bunch_simulator.h"
 #include "synergia/simulation/checkpoint.h"
 
+#include "synergia/bunch/probe_bunch.h"
+#include "synergia/libFF/ff_element.h"
+
 #include "synergia/utils/digits.h"
+#include "synergia/utils/io_thread.h"
+
+#include <algorithm>
 
 void
 Propagator::do_before_start(Bunch_simulator& simulator, Logger& logger)
@@ -67,12 +73,140 @@ Propagator::do_before_start(Bunch_simulator& simulator, Logger& logger)
             lattice.get_reference_particle());
     }
 
+    update_lattice(logger, true);
+}
+
+void
+Propagator::update_lattice(Logger& logger, bool turn_boundary)
+{
     auto updates = lattice.update();
-    // if (updates.structure) steps = stepper.apply(lattice);
+
+    if (updates.structure) rebuild_pending = true;
+    if (updates.ref) ++slices_revision;
+
+    if (updates.element) {
+        int num = 0;
+
+        for (auto& step : steps) {
+            for (auto& opr : step.operators) {
+                auto o = dynamic_cast<Independent_operator*>(opr.get());
+                if (!o) continue;
+
+                if (!rebuild_pending && o->slices_outdated())
+                    rebuild_pending = true;
+
+                if (o->operations_outdated()) {
+                    o->create_operations(lattice);
+                    ++num;
+                }
+            }
+        }
+
+        if (num) {
+            ++slices_revision;
+
+            logger(LoggerV::DINFO) << "Propagator: operations of " << num
+                                   << " operator(s) recreated\n";
+        }
+    }
+
+    if (rebuild_pending && turn_boundary) {
+        steps = stepper_ptr->apply(lattice);
+        rebuild_pending = false;
+        ++slices_revision;
+
+        logger(LoggerV::INFO_TURN) << "Propagator: steps rebuilt after "
+                                   << "changes to the lattice\n";
+    }
+}
+
+Slice_reference_table const&
+Propagator::get_slice_reference_table()
+{
+    if (slice_reference_table_outdated()) build_slice_reference_table();
+    return slice_table;
+}
+
+bool
+Propagator::slice_reference_table_outdated()
+{
+    if (slice_table.revision != slices_revision) return true;
+
+    // the elements or the reference particle may have been changed
+    // since the last lattice update
+    double energy = lattice.get_reference_particle().get_total_energy();
+    if (slice_table.ref_energy != energy) return true;
+
+    auto const& revs = slice_table.element_revisions;
+    size_t i = 0;
+
+    for (auto const& slice : slices) {
+        if (i == revs.size()) return true;
+
+        auto rev = slice.get_lattice_element().get_revision();
+        if (revs[i++] != rev) return true;
+    }
+
+    return i != revs.size();
 }
 
 void
-Propagator::do_start_repetition(Bunch_simulator& simulator)
+Propagator::build_slice_reference_table()
+{
+    using srt = Slice_reference_table;
+
+    int num = std::distance(slices.begin(), slices.end());
+
+    Slice_reference_table table;
+    table.revision = slices_revision;
+    table.ref_energy = lattice.get_reference_particle().get_total_energy();
+    table.num_slices = num;
+    table.data =
+        karray2d_row_dev("slice_reference_table", num, srt::num_columns);
+    table.hdata = Kokkos::create_mirror_view(table.data);
+
+    // the lattice reference particle through all the slices, the
+    // design reference particle is advanced by the elements the same
+    // way as in the propagation of a bunch
+    probe_bunch_t<double> probe(lattice.get_reference_particle());
+
+    auto& ref = probe.get_reference_particle();
+    auto& ref_l = probe.get_design_reference_particle();
+    double s0 = ref.get_s_n();
+
+    auto h = table.hdata;
+    int i = 0;
+
+    for (auto& slice : slices) {
+        FF_element::apply(slice, probe);
+
+        table.element_revisions.push_back(
+            slice.get_lattice_element().get_revision());
+
+        h(i, srt::length) = slice.get_length();
+        h(i, srt::s_n) = ref.get_s_n() - s0;
+        h(i, srt::ref_cdt) = ref_l.get_state()[Bunch::cdt];
+        h(i, srt::momentum) = ref.get_momentum();
+        h(i, srt::ref_beta) = ref.get_beta();
+
+        h(i, srt::beta_x) = slice.lf.beta.hor;
+        h(i, srt::beta_y) = slice.lf.beta.ver;
+        h(i, srt::alpha_x) = slice.lf.alpha.hor;
+        h(i, srt::alpha_y) = slice.lf.alpha.ver;
+        h(i, srt::psi_x) = slice.lf.psi.hor;
+        h(i, srt::psi_y) = slice.lf.psi.ver;
+        h(i, srt::disp_x) = slice.lf.dispersion.hor;
+        h(i, srt::disp_y) = slice.lf.dispersion.ver;
+
+        ++i;
+    }
+
+    Kokkos::deep_copy(table.data, table.hdata);
+    slice_table = table;
+}
+
+void
+Propagator::do_start_repetition(Bunch_simulator& simulator, Logger& logger)
 {
 #if 0
     if (state.bunch_simulator_ptr) {
@@ -92,6 +226,42 @@ Propagator::do_start_repetition(Bunch_simulator& simulator)
 
     for (auto& bunch : simulator[1].get_bunches())
         bunch.get_reference_particle().start_repetition();
+
+    apply_ramps(simulator);
+    update_lattice(logger, true);
+}
+
+void
+Propagator::apply_ramps(Bunch_simulator& simulator)
+{
+    if (ramps.empty()) return;
+
+    // the lattice is shared by all the bunches, so the time indexed ramps
+    // follow a single reference bunch (bunch 0 of the first non-empty
+    // train), whose time is broadcast from its first rank to make all
+    // the ranks apply the same values
+    bool by_time = std::any_of(ramps.begin(), ramps.end(), [](auto const& r) {
+        return r.table.get_index_type() == ramp_index_t::time;
+    });
+
+    double time = 0.0;
+
+    for (size_t t = 0; by_time && t < 2; ++t) {
+        if (!simulator[t].get_num_bunches()) continue;
+
+        if (simulator.has_local_bunch(t, 0)) {
+            auto const& bunch = simulator.get_bunch(t, 0);
+            time = bunch.get_reference_particle().get_bunch_abs_time();
+        }
+
+        int root = simulator.get_bunch_ranks(t, 0).front();
+        MPI_Bcast(&time, 1, MPI_DOUBLE, root, simulator.get_comm());
+        break;
+    }
+
+    int turn = simulator.current_turn();
+    for (auto const& ramp : ramps)
+        ramp.apply(lattice, turn, time);
 }
 
 void
@@ -103,10 +273,9 @@ Propagator::do_step(Bunch_simulator& simulator,
 {
     double t_step0 = MPI_Wtime();
 
-    // make sure the lattice is up-to-date
-    // e.g., update the chef_lattice after any of the
+    // make sure the operations are up-to-date after any of the
     // lattice elements has been updated
-    lattice.update();
+    update_lattice(logger, false);
 
     // propagate through the step
     step.apply(simulator, logger);
@@ -278,14 +447,14 @@ Propagator::do_turn_end(Bunch_simulator& simulator,
     // diagnostic actions
     Kokkos::Profiling::pushRegion("diagnostic-actions");
     simulator.diag_action_step_and_turn(turn_count, Propagator::FINAL_STEP);
+    simulator.flush_diags();
     Kokkos::Profiling::popRegion();
 
     // propagate actions
     simulator.prop_action_turn_end(lattice, turn_count);
 
     // update lattice in case it has been chaged in the propagate action
-    auto updates = lattice.update();
-    // if (updates.structure()) steps = stepper.apply(lattice);
+    update_lattice(logger, true);
 
     // increment the turn number
     simulator.inc_turn();
@@ -447,7 +616,7 @@ Propagator::propagate(Bunch_simulator& sim, Logger& logger, int max_turns)
         for (; turn < last_turn; ++turn) {
             double t_turn0 = MPI_Wtime();
 
-            do_start_repetition(sim);
+            do_start_repetition(sim, logger);
 
             int step_count = 0;
             for (auto& step : steps) {
@@ -504,6 +673,13 @@ Propagator::propagate(Bunch_simulator& sim, Logger& logger, int max_turns)
             if ((turns_since_checkpoint == checkpoint_period) ||
                 ((turn == (sim.max_turns() - 1)) && final_checkpoint)) {
                 // t = simple_timer_current();
+                sim.flush_diags(true);
+
+                if (rebalance_at_checkpoint && sim.rebalance_bunches()) {
+                    logger(LoggerV::INFO_TURN)
+                        << "Propagator: bunches remapped to the ranks\n";
+                }
+
                 syn::checkpoint_save(*this, sim);
                 // t = simple_timer_show(t, "propagate-checkpoint_period");
                 turns_since_checkpoint = 0;
@@ -555,6 +731,12 @@ Propagator::propagate(Bunch_simulator& sim, Logger& logger, int max_turns)
             logger(LoggerV::WARNING) << "Propagator: no particles left\n";
         }
 
+        // drain the buffered diagnostics
+        sim.flush_diags(true);
+
+        // and the writes still queued to the I/O thread
+        Io_thread::get().drain();
+
         double t_prop1 = MPI_Wtime();
 
         logger(LoggerV::INFO_TURN)
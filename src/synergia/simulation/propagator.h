@@ -2,8 +2,10 @@
 #define PROPAGATOR_H_
 
 #include "synergia/lattice/lattice.h"
+#include "synergia/lattice/ramp_table.h"
 
 #include "synergia/simulation/independent_stepper_elements.h"
+#include "synergia/simulation/slice_reference_table.h"
 #include "synergia/simulation/step.h"
 #include "synergia/simulation/stepper.h"
 
@@ -189,10 +191,36 @@ class Propagator {
     int checkpoint_period;
     bool final_checkpoint;
 
+    // rebalance the bunches over the ranks before checkpoint saves
+    bool rebalance_at_checkpoint;
+
+    // attribute ramps applied at the start of every turn
+    std::vector<Lattice_ramp> ramps;
+
+    // the lattice structure or an element length has changed, the steps
+    // are rebuilt at the next turn boundary
+    bool rebuild_pending;
+
+    // incremented whenever the slices or their operations change
+    int slices_revision;
+
+    // not persistent, recomputed on demand
+    Slice_reference_table slice_table;
+
   private:
     void do_before_start(Bunch_simulator& simulator, Logger& logger);
 
-    void do_start_repetition(Bunch_simulator& simulator);
+    void do_start_repetition(Bunch_simulator& simulator, Logger& logger);
+
+    // bring the steps up to date with the lattice. Only the operations
+    // of the revised elements are recreated, unless the lattice
+    // structure or the element lengths have changed, in which case all
+    // the steps are rebuilt (only at a turn boundary)
+    void update_lattice(Logger& logger, bool turn_boundary);
+
+    // collective over the simulator communicator when any of the ramps
+    // is indexed by time
+    void apply_ramps(Bunch_simulator& simulator);
 
     void do_turn_end(Bunch_simulator& simulator,
                      int turn_count,
@@ -207,6 +235,9 @@ class Propagator {
     bool check_out_of_particles(Bunch_simulator const& simulator,
                                 Logger& logger);
 
+    bool slice_reference_table_outdated();
+    void build_slice_reference_table();
+
   public:
     // given lattice and stepper
     Propagator(Lattice const& lattice,
@@ -217,6 +248,11 @@ class Propagator {
         , stepper_ptr(stepper.clone())
         , checkpoint_period(-1)
         , final_checkpoint(false)
+        , rebalance_at_checkpoint(false)
+        , ramps()
+        , rebuild_pending(false)
+        , slices_revision(0)
+        , slice_table()
     {
         this->lattice.update();
         steps = stepper_ptr->apply(this->lattice);
@@ -241,6 +277,29 @@ class Propagator {
         return checkpoint_period;
     }
 
+    // ramp the double attribute of the named elements (or of all the
+    // elements of that type) from the table. Ramps are evaluated at the
+    // start of each turn, so no turn end action or retune is needed
+    void
+    add_ramp(std::string const& element,
+             std::string const& attribute,
+             Ramp_table const& table)
+    {
+        ramps.push_back(Lattice_ramp{element, attribute, table});
+    }
+
+    void
+    clear_ramps()
+    {
+        ramps.clear();
+    }
+
+    std::vector<Lattice_ramp> const&
+    get_ramps() const
+    {
+        return ramps;
+    }
+
     // whether to perform checkpoint save at the end of simulation
     void
     set_final_checkpoint(bool val)
@@ -254,6 +313,22 @@ class Propagator {
         return final_checkpoint;
     }
 
+    // remap the bunches to balance the macroparticles over the ranks
+    // before every checkpoint save (see
+    // Bunch_simulator::rebalance_bunches()), so that a resumed
+    // simulation starts from the balanced layout
+    void
+    set_rebalance_at_checkpoint(bool val)
+    {
+        rebalance_at_checkpoint = val;
+    }
+
+    bool
+    get_rebalance_at_checkpoint() const
+    {
+        return rebalance_at_checkpoint;
+    }
+
     // slices
     Lattice_element_slices&
     get_lattice_element_slices()
@@ -261,8 +336,21 @@ class Propagator {
         return slices;
     }
 
+    // design reference quantities of the slices in device memory,
+    // recomputed if the slices, their elements or the lattice reference
+    // energy have changed since the last call
+    Slice_reference_table const& get_slice_reference_table();
+
+    // to be called after the lattice functions of the slices have
+    // been recalculated
+    void
+    slices_updated()
+    {
+        ++slices_revision;
+    }
+
     // elements
-    std::list<Lattice_element> const&
+    Lattice_elements const&
     get_lattice_elements()
     {
         return lattice.get_elements();
@@ -318,7 +406,15 @@ class Propagator {
 
   private:
     // default ctor for serialization only
-    Propagator() : lattice(), steps(), slices(*this), stepper_ptr() {}
+    Propagator()
+        : lattice()
+        , steps()
+        , slices(*this)
+        , stepper_ptr()
+        , rebuild_pending(false)
+        , slices_revision(0)
+        , slice_table()
+    {}
 
     friend class cereal::access;
 
@@ -330,6 +426,8 @@ class Propagator {
         ar(CEREAL_NVP(stepper_ptr));
         ar(CEREAL_NVP(checkpoint_period));
         ar(CEREAL_NVP(final_checkpoint));
+        ar(CEREAL_NVP(rebalance_at_checkpoint));
+        ar(CEREAL_NVP(ramps));
     }
 
     template <class AR>
@@ -340,6 +438,8 @@ class Propagator {
         ar(CEREAL_NVP(stepper_ptr));
         ar(CEREAL_NVP(checkpoint_period));
         ar(CEREAL_NVP(final_checkpoint));
+        ar(CEREAL_NVP(rebalance_at_checkpoint));
+        ar(CEREAL_NVP(ramps));
 
         lattice.update();
         steps = stepper_ptr->apply(lattice);
@@ -69,6 +69,40 @@ PYBIND11_MODULE(simulation, m)
 
     .def("get_final_checkpoint", &Propagator::get_final_checkpoint)
 
+    .def("set_rebalance_at_checkpoint",
+         &Propagator::set_rebalance_at_checkpoint,
+         "Remap the bunches over the ranks before every checkpoint save.",
+         "val"_a)
+
+    .def("get_rebalance_at_checkpoint",
+         &Propagator::get_rebalance_at_checkpoint)
+
+    .def("add_ramp",
+         &Propagator::add_ramp,
+         "Ramp a double attribute of the named elements (or of all elements "
+         "of that type) from a Ramp_table, evaluated at each turn start.",
+         "element"_a,
+         "attribute"_a,
+         "table"_a)
+
+    .def("clear_ramps", &Propagator::clear_ramps)
+
+    .def(
+      "get_slice_reference_table",
+      [](Propagator& prop) {
+        auto const& h = prop.get_slice_reference_table().hdata;
+
+        auto arr = py::array_t<double>({h.extent(0), h.extent(1)});
+        for (int i = 0; i < h.extent(0); ++i)
+          for (int j = 0; j < h.extent(1); ++j)
+            arr.mutable_at(i, j) = h(i, j);
+
+        return arr;
+      },
+      "Design reference quantities of the slices, one row per slice with "
+      "the columns (length, s_n, ref_cdt, momentum, ref_beta, beta_x, "
+      "beta_y, alpha_x, alpha_y, psi_x, psi_y, disp_x, disp_y).")
+
     ;
 
   // chormaticities_t
@@ -340,7 +374,14 @@ PYBIND11_MODULE(simulation, m)
                 "num_spectators"_a = 0)
 
     .def_static("create_bunch_train_simulator",
-                &Bunch_simulator::create_bunch_train_simulator,
+                (Bunch_simulator(*)(Reference_particle const&,
+                                    size_t,
+                                    double,
+                                    size_t,
+                                    double,
+                                    Commxx const&,
+                                    size_t)) &
+                  Bunch_simulator::create_bunch_train_simulator,
                 py::return_value_policy::move,
                 "Create a Bunch_simulator with a single bunch train.",
                 "reference_particle"_a,
@@ -351,6 +392,28 @@ PYBIND11_MODULE(simulation, m)
                 "commxx"_a = Commxx(),
                 "num_spectators"_a = 0)
 
+    .def_static(
+      "create_bunch_train_simulator",
+      (Bunch_simulator(*)(Reference_particle const&,
+                          std::vector<size_t> const&,
+                          std::vector<double> const&,
+                          double,
+                          Commxx const&,
+                          size_t,
+                          std::vector<double> const&)) &
+        Bunch_simulator::create_bunch_train_simulator,
+      py::return_value_policy::move,
+      "Create a Bunch_simulator with a single bunch train of bunches with "
+      "individual numbers of particles, mapped to the ranks by the weights "
+      "(or the numbers of macroparticles).",
+      "reference_particle"_a,
+      "num_particles"_a,
+      "num_real_particles"_a,
+      "spacing"_a,
+      "commxx"_a = Commxx(),
+      "num_spectators"_a = 0,
+      "weights"_a = std::vector<double>())
+
 #if 0
 		.def( "set_turns",
 			&Bunch_simulator::set_turns,
@@ -374,6 +437,24 @@ PYBIND11_MODULE(simulation, m)
          "train"_a,
          "bunch"_a)
 
+    .def("get_bunch_ranks",
+         &Bunch_simulator::get_bunch_ranks,
+         "Get the ranks of the bunch in the simulator communicator.",
+         "train"_a,
+         "bunch"_a)
+
+    .def("share_bunch_ranks",
+         &Bunch_simulator::share_bunch_ranks,
+         "Put all bunches of the train on all of its ranks.",
+         "train"_a = 0)
+
+    .def("rebalance_bunches",
+         &Bunch_simulator::rebalance_bunches,
+         "Remap the bunches over the ranks by their numbers of particles "
+         "(times the optional per-bunch costs of each train).",
+         "tolerance"_a = 0.1,
+         "costs"_a = std::array<std::vector<double>, 2>())
+
     .def(
       "reg_prop_action_step_end",
       (void(Bunch_simulator::*)(action_step_t)) &
@@ -444,14 +525,28 @@ PYBIND11_MODULE(simulation, m)
          "Register an aperture loss diagnostics to the bunch.",
          "filename"_a,
          "bunch_idx"_a = 0,
-         "train_idx"_a = 0)
+         "train_idx"_a = 0,
+         "flush_turns"_a = 0,
+         "flush_size"_a = 0)
 
     .def("reg_diag_loss_zcut",
          &Bunch_simulator::reg_diag_loss_zcut,
          "Register a zcut loss diagnostics to the bunch.",
          "filename"_a,
          "bunch_idx"_a = 0,
-         "train_idx"_a = 0)
+         "train_idx"_a = 0,
+         "flush_turns"_a = 0,
+         "flush_size"_a = 0)
+
+    .def("flush_diag_loss",
+         &Bunch_simulator::flush_diag_loss,
+         "Write out the buffered loss diagnostics.",
+         "force"_a = false)
+
+    .def("flush_diags",
+         &Bunch_simulator::flush_diags,
+         "Write out all the buffered diagnostics.",
+         "force"_a = false)
 
     .def("current_turn",
          &Bunch_simulator::current_turn,
@@ -0,0 +1,55 @@
+#ifndef SLICE_REFERENCE_TABLE_H_
+#define SLICE_REFERENCE_TABLE_H_
+
+#include <vector>
+
+#include "synergia/utils/kokkos_views.h"
+
+/// Slice_reference_table holds the design reference quantities of all the
+/// lattice element slices of a Propagator, one row per slice in the order
+/// of propagation. The table is computed once per revision of the slices,
+/// of their elements and of the lattice reference energy, by propagating
+/// the lattice reference particle through the slices on the host, and
+/// kept in a device array, so the kernels working on many slices at once
+/// can read the reference quantities of any slice without a round trip
+/// to the host. The kernels capture the data view and index it as
+/// data(slice, Slice_reference_table::ref_cdt).
+///
+/// The lattice function columns are copied from the slices, they are only
+/// meaningful after Lattice_simulator::CourantSnyderLatticeFunctions() and
+/// Lattice_simulator::calc_dispersions() have been called on the
+/// propagator.
+struct Slice_reference_table {
+    enum column {
+        length,   // length of the slice
+        s_n,      // trajectory length at the end of the slice
+        ref_cdt,  // c*dt of the design reference particle in the slice
+        momentum, // reference momentum at the end of the slice
+        ref_beta, // reference velocity at the end of the slice
+        beta_x,
+        beta_y,
+        alpha_x,
+        alpha_y,
+        psi_x,
+        psi_y,
+        disp_x,
+        disp_y,
+        num_columns
+    };
+
+    // revision of the propagator slices the table was computed from
+    int revision = -1;
+
+    // revisions of the elements of the slices, and the energy of the
+    // lattice reference particle, the table was computed from. They
+    // catch the changes not followed by a lattice update yet
+    std::vector<long int> element_revisions;
+    double ref_energy = 0.0;
+    int num_slices = 0;
+
+    // [num_slices x num_columns], and the host copy
+    karray2d_row_dev data;
+    karray2d_row_hst hdata;
+};
+
+#endif /* SLICE_REFERENCE_TABLE_H_ */
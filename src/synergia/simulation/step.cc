@@ -35,6 +35,149 @@ Step::create_operations(Lattice const& lattice)
   for (auto& op : operators) { op->create_operations(lattice); }
 }
 
+bool
+Step::pipelined(Bunch_simulator const& simulator) const
+{
+  // needs several local bunches, and at least one of them communicating
+  int num_bunches = 0;
+  bool comm = false;
+
+  for (auto const& train : simulator.get_trains()) {
+    for (auto const& bunch : train.get_bunches()) {
+      ++num_bunches;
+      comm = comm || bunch.get_comm().size() > 1;
+    }
+  }
+
+  if (num_bunches < 2 || !comm) return false;
+
+  for (auto const& op : operators) {
+    if (op->is_pipelined() && op->get_type() == "collective") return true;
+  }
+
+  return false;
+}
+
+void
+Step::apply_operator(Operator& op,
+                     Bunch_simulator& simulator,
+                     double time,
+                     Logger& logger) const
+{
+  double t0 = MPI_Wtime();
+
+  logger(LoggerV::INFO_OPR) << "\n  Operator start:\n";
+
+  // operator apply
+  op.apply(simulator, time, logger);
+
+  double t1 = MPI_Wtime();
+
+  logger(LoggerV::INFO_OPR)
+    << "  Operator finish: operator: name = " << op.get_name()
+    << ", type = " << op.get_type() << ", time = " << std::fixed
+    << std::setprecision(3) << t1 - t0 << "s"
+    << "\n";
+
+  // per operator diagnostics action
+  simulator.diag_action_operator(op);
+
+  // longitudinal conditions
+  for (auto& train : simulator.get_trains())
+    for (auto& bunch : train.get_bunches())
+      apply_longitudinal_boundary(bunch);
+}
+
+void
+Step::apply_pipeline(size_t first,
+                     size_t last,
+                     Bunch_simulator& simulator,
+                     double time,
+                     Logger& logger) const
+{
+  // a local bunch going through the operators [first, last)
+  struct cursor {
+    int train;
+    int bunch;
+    size_t op;     // current operator
+    bool pending;  // op has been begun and not finished yet
+    bool complete; // communications of op have completed
+  };
+
+  std::vector<cursor> cursors;
+
+  for (int t = 0; t < 2; ++t) {
+    for (int b = 0; b < simulator[t].get_bunch_array_size(); ++b)
+      cursors.push_back({t, b, first, false, false});
+  }
+
+  double t0 = MPI_Wtime();
+
+  logger(LoggerV::INFO_OPR) << "\n  Pipelined operators start:\n";
+
+  int num_comms = 0;
+  int num_hidden = 0;
+  size_t remaining = cursors.size();
+
+  // the bunches are visited in a fixed order, and each visit finishes
+  // the pending operator and carries the bunch up to its next
+  // communication. The order of the collectives does not depend on
+  // when they complete, so it is the same on all ranks
+  while (remaining) {
+    for (auto& c : cursors) {
+      if (c.op == last) continue;
+
+      auto& bunch = simulator[c.train][c.bunch];
+
+      if (c.pending) {
+        if (c.complete) ++num_hidden;
+
+        operators[c.op]->finish_bunch(
+          simulator, c.train, c.bunch, time, logger);
+        apply_longitudinal_boundary(bunch);
+
+        c.pending = false;
+        ++c.op;
+      }
+
+      while (c.op < last) {
+        c.pending = operators[c.op]->begin_bunch(
+          simulator, c.train, c.bunch, time, logger);
+
+        if (c.pending) {
+          c.complete = false;
+          ++num_comms;
+          break;
+        }
+
+        apply_longitudinal_boundary(bunch);
+        ++c.op;
+      }
+
+      if (c.op == last) --remaining;
+
+      // progress the communications of the other bunches
+      for (auto& o : cursors) {
+        if (o.pending && !o.complete)
+          o.complete = operators[o.op]->test_bunch(o.train, o.bunch);
+      }
+    }
+  }
+
+  double t1 = MPI_Wtime();
+
+  logger(LoggerV::INFO_OPR)
+    << "  Pipelined operators finish: operators = " << last - first
+    << ", bunches = " << cursors.size() << ", communications = " << num_comms
+    << " (" << num_hidden << " completed before waiting)"
+    << ", time = " << std::fixed << std::setprecision(3) << t1 - t0 << "s"
+    << "\n";
+
+  // per operator diagnostics action
+  for (size_t i = first; i < last; ++i)
+    simulator.diag_action_operator(*operators[i]);
+}
+
 void
 Step::apply(Bunch_simulator& simulator, Logger& logger) const
 {
@@ -47,28 +190,29 @@ Step::apply(Bunch_simulator& simulator, Logger& logger) const
   double ref_beta = simulator[0][0].get_reference_particle().get_beta();
   double time = length / (ref_beta * pconstants::c);
 
-  for (auto const& op : operators) {
-    double t0 = MPI_Wtime();
-
-    logger(LoggerV::INFO_OPR) << "\n  Operator start:\n";
+  if (!pipelined(simulator)) {
+    for (auto const& op : operators)
+      apply_operator(*op, simulator, time, logger);
 
-    // operator apply
-    op->apply(simulator, time, logger);
+    return;
+  }
 
-    double t1 = MPI_Wtime();
+  // runs of pipelined operators, separated by the ones which have to be
+  // applied to all bunches at once
+  size_t i = 0;
 
-    logger(LoggerV::INFO_OPR)
-      << "  Operator finish: operator: name = " << op->get_name()
-      << ", type = " << op->get_type() << ", time = " << std::fixed
-      << std::setprecision(3) << t1 - t0 << "s"
-      << "\n";
+  while (i < operators.size()) {
+    if (!operators[i]->is_pipelined()) {
+      apply_operator(*operators[i], simulator, time, logger);
+      ++i;
+      continue;
+    }
 
-    // per operator diagnostics action
-    simulator.diag_action_operator(*op);
+    size_t j = i;
+    while (j < operators.size() && operators[j]->is_pipelined())
+      ++j;
 
-    // longitudinal conditions
-    for (auto& train : simulator.get_trains())
-      for (auto& bunch : train.get_bunches())
-        apply_longitudinal_boundary(bunch);
+    apply_pipeline(i, j, simulator, time, logger);
+    i = j;
   }
 }
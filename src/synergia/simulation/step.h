@@ -17,6 +17,21 @@ private:
   double length;
   std::vector<double> step_betas;
 
+  // whether the operators are applied one bunch at a time, overlapping
+  // the communications of a bunch with the work on the others
+  bool pipelined(Bunch_simulator const& simulator) const;
+
+  void apply_operator(Operator& op,
+                      Bunch_simulator& simulator,
+                      double time,
+                      Logger& logger) const;
+
+  void apply_pipeline(size_t first,
+                      size_t last,
+                      Bunch_simulator& simulator,
+                      double time,
+                      Logger& logger) const;
+
 public:
   explicit Step(double length);
 
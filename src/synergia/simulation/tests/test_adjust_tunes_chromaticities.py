@@ -0,0 +1,122 @@
+#!/usr/bin/env python
+import synergia
+import pytest
+
+ET = synergia.lattice.element_type
+MT = synergia.lattice.marker_type
+LS = synergia.simulation.Lattice_simulator
+
+# eight FODO cells with bends, and a sextupole next to every quadrupole
+ring_madx = """
+beam, particle=proton, pc=3.0;
+
+qf: quadrupole, l=0.5, k1=0.1;
+qd: quadrupole, l=0.5, k1=-0.1;
+sf: sextupole, l=0.2, k2=0.0;
+sd: sextupole, l=0.2, k2=0.0;
+b: sbend, l=4.0, angle=2*pi/16;
+o: drift, l=0.5;
+
+cell: line=(qf, o, sf, o, b, o, qd, o, sd, o, b, o);
+ring: line=(cell, cell, cell, cell, cell, cell, cell, cell);
+"""
+
+def get_lattice():
+    reader = synergia.lattice.MadX_reader()
+    reader.parse(ring_madx)
+    return reader.get_lattice('ring')
+
+def mark_correctors(lattice, tunes=True, chroms=True):
+    for elem in lattice.get_elements():
+        name = elem.get_name()
+        if tunes and name == 'qf':
+            elem.set_marker(MT.h_tunes_corrector)
+        if tunes and name == 'qd':
+            elem.set_marker(MT.v_tunes_corrector)
+        if chroms and name == 'sf':
+            elem.set_marker(MT.h_chrom_corrector)
+        if chroms and name == 'sd':
+            elem.set_marker(MT.v_chrom_corrector)
+
+def test_adjust_tunes():
+    lattice = get_lattice()
+    mark_correctors(lattice)
+
+    nus = LS.calculate_tune_and_cdt(lattice)
+    h_tune = nus[0] + 0.01
+    v_tune = nus[1] - 0.005
+
+    tolerance = 1.0e-6
+    LS.adjust_tunes(lattice, h_tune, v_tune, tolerance)
+
+    nus = LS.calculate_tune_and_cdt(lattice)
+    assert nus[0] == pytest.approx(h_tune, abs=tolerance)
+    assert nus[1] == pytest.approx(v_tune, abs=tolerance)
+
+    # every corrector of a family has the same strength
+    k1 = {}
+    for elem in lattice.get_elements():
+        if elem.get_type() == ET.quadrupole:
+            k1.setdefault(elem.get_name(), set()).add(
+                elem.get_double_attribute('k1'))
+    assert len(k1['qf']) == 1
+    assert len(k1['qd']) == 1
+    assert k1['qf'].pop() != pytest.approx(0.1)
+
+def test_adjust_chromaticities():
+    lattice = get_lattice()
+    mark_correctors(lattice)
+
+    h_chrom = 0.5
+    v_chrom = -0.2
+
+    tolerance = 1.0e-4
+    LS.adjust_chromaticities(lattice, h_chrom, v_chrom, tolerance)
+
+    chroms = LS.get_chromaticities(lattice)
+    assert chroms.horizontal_chromaticity == pytest.approx(h_chrom,
+                                                           abs=tolerance)
+    assert chroms.vertical_chromaticity == pytest.approx(v_chrom,
+                                                         abs=tolerance)
+
+def test_adjust_chromaticities_keeps_tunes():
+    lattice = get_lattice()
+    mark_correctors(lattice)
+
+    nus0 = LS.calculate_tune_and_cdt(lattice)
+    LS.adjust_chromaticities(lattice, 0.0, 0.0)
+    nus = LS.calculate_tune_and_cdt(lattice)
+
+    # no dispersion offset, the sextupoles do not move the tunes
+    assert nus[0] == pytest.approx(nus0[0], abs=1.0e-8)
+    assert nus[1] == pytest.approx(nus0[1], abs=1.0e-8)
+
+def test_missing_tunes_correctors():
+    lattice = get_lattice()
+    mark_correctors(lattice, tunes=False)
+
+    with pytest.raises(RuntimeError, match='No h_tunes_correctors'):
+        LS.adjust_tunes(lattice, 0.3, 0.3)
+
+def test_missing_chrom_correctors():
+    lattice = get_lattice()
+    mark_correctors(lattice, chroms=False)
+
+    with pytest.raises(RuntimeError, match='No h_chrom_correctors'):
+        LS.adjust_chromaticities(lattice, 0.0, 0.0)
+
+    for elem in lattice.get_elements():
+        if elem.get_name() == 'sf':
+            elem.set_marker(MT.h_chrom_corrector)
+
+    with pytest.raises(RuntimeError, match='No v_chrom_correctors'):
+        LS.adjust_chromaticities(lattice, 0.0, 0.0)
+
+def test_missing_chrom_correctors_already_matched():
+    lattice = get_lattice()
+
+    # nothing to correct, as before the Newton matching
+    chroms = LS.get_chromaticities(lattice)
+    LS.adjust_chromaticities(lattice,
+                             chroms.horizontal_chromaticity,
+                             chroms.vertical_chromaticity)
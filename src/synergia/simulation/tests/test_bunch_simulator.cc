@@ -1,8 +1,125 @@
 #include "synergia/utils/catch.hpp"
 
+#include "synergia/foundation/physical_constants.h"
 #include "synergia/simulation/bunch_simulator.h"
 #include "synergia/simulation/bunch_simulator_impl.h"
 
+#include <algorithm>
+#include <set>
+
+namespace {
+    // labels of the updated diagnostics, in the order of the updates
+    std::vector<std::string> fired;
+
+    class Diagnostics_recorder : public Diagnostics {
+      public:
+        Diagnostics_recorder(std::string const& label = "")
+            : Diagnostics("diag_recorder",
+                          "diag_recorder_" + label + ".h5",
+                          true)
+            , label(label)
+        {}
+
+      private:
+        std::string label;
+
+        void
+        do_update(Bunch const&) override
+        {
+            fired.push_back(label);
+        }
+
+        void
+        do_reduce(Commxx const&, int) override
+        {}
+        void
+        do_first_write(io_device&) override
+        {}
+        void
+        do_write(io_device&, const size_t) override
+        {}
+
+        // buffered and never due, so nothing is written
+        bool
+        do_buffered() const override
+        {
+            return true;
+        }
+
+        bool
+        do_flush_due(Bunch const&, bool) override
+        {
+            return false;
+        }
+    };
+
+    struct step_reg {
+        std::string label;
+        int turn_period, step_period;
+    };
+
+    struct listed_reg {
+        std::string label;
+        std::vector<int> numbers;
+    };
+
+    struct element_reg {
+        std::string label;
+        std::string name;
+        int turn_period;
+    };
+
+    // the scan over all the registered diagnostics, as done before the
+    // dispatch tables
+    std::vector<std::string>
+    scan_step_and_turn(std::vector<step_reg> const& steps,
+                       std::vector<listed_reg> const& listed,
+                       int turn,
+                       int step)
+    {
+        using BS = Bunch_simulator;
+        std::vector<std::string> labels;
+
+        for (auto const& r : steps) {
+            bool t = false;
+
+            if (turn == BS::PRE_TURN && step == BS::FINAL_STEP)
+                t = true;
+            else if (r.step_period < 0)
+                t = (turn % r.turn_period == 0) && (step == BS::FINAL_STEP);
+            else
+                t = (turn % r.turn_period == 0) && (step % r.step_period == 0);
+
+            if (t) labels.push_back(r.label);
+        }
+
+        for (auto const& r : listed) {
+            auto const& n = r.numbers;
+
+            if (step == BS::FINAL_STEP &&
+                std::find(n.begin(), n.end(), turn) != n.end())
+                labels.push_back(r.label);
+        }
+
+        return labels;
+    }
+
+    std::vector<std::string>
+    scan_element(std::vector<element_reg> const& elements,
+                 int turn,
+                 Lattice_element const& ele)
+    {
+        std::vector<std::string> labels;
+
+        for (auto const& r : elements) {
+            if (turn % r.turn_period == 0 && ele.get_name() == r.name)
+                labels.push_back(r.label);
+        }
+
+        return labels;
+    }
+}
+
 TEST_CASE("divide bunches train(1, 0)", "[Bunch_simulator]")
 {
     size_t nb_pt = 1;
@@ -58,7 +175,10 @@ TEST_CASE("divide bunches train(3, 0)", "[Bunch_simulator]")
 
     {
         mpi_size = 2;
-        CHECK_THROWS(impl::divide_bunches(mpi_size, nb_pt, nb_st, p_ranks, s_ranks));
+        REQUIRE_NOTHROW(impl::divide_bunches(mpi_size, nb_pt, nb_st, p_ranks, s_ranks));
+
+        CHECK( p_ranks == std::vector<int>{0, 1} );
+        CHECK( s_ranks == std::vector<int>{} );
     }
 
     {
@@ -71,12 +191,18 @@ TEST_CASE("divide bunches train(3, 0)", "[Bunch_simulator]")
 
     {
         mpi_size = 4;
-        CHECK_THROWS(impl::divide_bunches(mpi_size, nb_pt, nb_st, p_ranks, s_ranks));
+        REQUIRE_NOTHROW(impl::divide_bunches(mpi_size, nb_pt, nb_st, p_ranks, s_ranks));
+
+        CHECK( p_ranks == std::vector<int>{0, 1, 2, 3} );
+        CHECK( s_ranks == std::vector<int>{} );
     }
 
     {
         mpi_size = 5;
-        CHECK_THROWS(impl::divide_bunches(mpi_size, nb_pt, nb_st, p_ranks, s_ranks));
+        REQUIRE_NOTHROW(impl::divide_bunches(mpi_size, nb_pt, nb_st, p_ranks, s_ranks));
+
+        CHECK( p_ranks == std::vector<int>{0, 1, 2, 3, 4} );
+        CHECK( s_ranks == std::vector<int>{} );
     }
 
     {
@@ -108,7 +234,10 @@ TEST_CASE("divide bunches train(4, 2)", "[Bunch_simulator]")
 
     {
         mpi_size = 2;
-        CHECK_THROWS(impl::divide_bunches(mpi_size, nb_pt, nb_st, p_ranks, s_ranks));
+        REQUIRE_NOTHROW(impl::divide_bunches(mpi_size, nb_pt, nb_st, p_ranks, s_ranks));
+
+        CHECK( p_ranks == std::vector<int>{0} );
+        CHECK( s_ranks == std::vector<int>{1} );
     }
 
     {
@@ -121,7 +250,10 @@ TEST_CASE("divide bunches train(4, 2)", "[Bunch_simulator]")
 
     {
         mpi_size = 4;
-        CHECK_THROWS(impl::divide_bunches(mpi_size, nb_pt, nb_st, p_ranks, s_ranks));
+        REQUIRE_NOTHROW(impl::divide_bunches(mpi_size, nb_pt, nb_st, p_ranks, s_ranks));
+
+        CHECK( p_ranks == std::vector<int>{0, 1, 2} );
+        CHECK( s_ranks == std::vector<int>{3} );
     }
 
     {
@@ -140,3 +272,133 @@ TEST_CASE("divide bunches train(4, 2)", "[Bunch_simulator]")
         CHECK( s_ranks == std::vector<int>{8, 9, 10, 11} );
     }
 }
+
+TEST_CASE("divide bunches weighted", "[Bunch_simulator]")
+{
+    std::vector<int> p_ranks;
+    std::vector<int> s_ranks;
+
+    // the secondary train is three times as heavy
+    REQUIRE_NOTHROW(impl::divide_bunches(
+        8, {1.0, 1.0}, {3.0, 3.0}, p_ranks, s_ranks));
+
+    CHECK( p_ranks == std::vector<int>{0, 1} );
+    CHECK( s_ranks == std::vector<int>{2, 3, 4, 5, 6, 7} );
+}
+
+TEST_CASE("diagnostics dispatch tables", "[Bunch_simulator]")
+{
+    using BS = Bunch_simulator;
+
+    Four_momentum fm(pconstants::mp, 1.5 * pconstants::mp);
+    Reference_particle ref(pconstants::proton_charge, fm);
+
+    auto sim = BS::create_single_bunch_simulator(ref, 16, 1e10);
+
+    Lattice_element q("quadrupole", "q");
+    Lattice_element o("drift", "o");
+    Lattice_element d("quadrupole", "d");
+
+    // the element dispatched at every step
+    std::vector<Lattice_element const*> line{&q, &o, &d, &o};
+
+    std::vector<step_reg> steps;
+    std::vector<listed_reg> listed;
+    std::vector<element_reg> elements;
+
+    auto reg_period = [&](std::string const& label, int tp, int sp) {
+        sim.reg_diag_period(Diagnostics_recorder(label), tp, sp, 0, 0);
+        steps.push_back({label, tp, sp});
+    };
+
+    auto reg_listed = [&](std::string const& label, std::vector<int> n) {
+        sim.reg_diag_turn_listed(Diagnostics_recorder(label), n);
+        listed.push_back({label, n});
+    };
+
+    auto reg_element = [&](std::string const& label,
+                           Lattice_element const& ele,
+                           int tp) {
+        sim.reg_diag_at_element(Diagnostics_recorder(label), ele, tp);
+        elements.push_back({label, ele.get_name(), tp});
+    };
+
+    reg_period("turn_2", 2, -1);
+    reg_period("step_3", 1, 3);
+    reg_period("turn_3_step_2", 3, 2);
+    reg_listed("listed_1_3", {1, 3, 3});
+    reg_listed("listed_0", {0});
+    reg_element("q", q, 1);
+    reg_element("d_2", d, 2);
+    reg_element("q_3", q, 3);
+
+    const int num_steps = 7;
+    std::set<std::string> seen;
+
+    auto check_step = [&](int turn, int step) {
+        fired.clear();
+        sim.diag_action_step_and_turn(turn, step);
+        CHECK(fired == scan_step_and_turn(steps, listed, turn, step));
+        seen.insert(fired.begin(), fired.end());
+    };
+
+    auto check_element = [&](Lattice_element const& ele) {
+        auto expected = scan_element(elements, sim.current_turn(), ele);
+
+        fired.clear();
+        sim.diag_action_element(ele);
+        CHECK(fired == expected);
+        seen.insert(fired.begin(), fired.end());
+
+        // the diagnostics of the given bunch only
+        fired.clear();
+        sim.diag_action_element(ele, 0, 0);
+        CHECK(fired == expected);
+
+        fired.clear();
+        sim.diag_action_element(ele, 0, 1);
+        CHECK(fired.empty());
+
+        // looked up once, as the independent operators do per slice
+        fired.clear();
+        sim.diag_action_element(sim.get_element_diags(ele), ele, 0, 0);
+        CHECK(fired == expected);
+    };
+
+    auto check_turn = [&](int turn) {
+        REQUIRE(sim.current_turn() == turn);
+
+        for (int step = 0; step < num_steps; ++step) {
+            check_step(turn, step);
+            check_element(*line[step % line.size()]);
+        }
+
+        check_step(turn, BS::FINAL_STEP);
+        sim.inc_turn();
+    };
+
+    check_step(BS::PRE_TURN, BS::FINAL_STEP);
+
+    for (int turn = 0; turn < 3; ++turn)
+        check_turn(turn);
+
+    // registered after the tables have been built
+    long revision = sim.get_diag_revision();
+
+    reg_period("step_1", 1, 1);
+    reg_listed("listed_4_5", {4, 5});
+    reg_element("o", o, 1);
+
+    CHECK(sim.get_diag_revision() != revision);
+
+    for (int turn = 3; turn < 6; ++turn)
+        check_turn(turn);
+
+    // every trigger has fired at some point
+    for (auto const& r : steps)
+        CHECK(seen.count(r.label));
+    for (auto const& r : listed)
+        CHECK(seen.count(r.label));
+    for (auto const& r : elements)
+        CHECK(seen.count(r.label));
+}
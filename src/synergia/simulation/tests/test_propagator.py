@@ -74,3 +74,183 @@ def test_set_get_final_checkpoint(prop_fixture):
     prop_fixture['propagator'].set_final_checkpoint(not init_fcp)
     assert prop_fixture['propagator'].get_final_checkpoint() is not init_fcp
     return True
+
+def test_rebuild_on_length_change(prop_fixture):
+    propagator = prop_fixture['propagator']
+    lattice = propagator.get_lattice()
+    refpart = lattice.get_reference_particle()
+
+    sim = synergia.simulation.Bunch_simulator.create_single_bunch_simulator(
+        refpart, 16, 1.0e10)
+    simlog = synergia.utils.parallel_utils.Logger(
+        0, synergia.utils.parallel_utils.LoggerV.WARNING, False)
+
+    # retuning a quadrupole only recreates its operations
+    lattice.get_elements()[0].set_double_attribute('k1', 0.08)
+    propagator.propagate(sim, simlog, 1)
+
+    slices = list(propagator.get_lattice_element_slices())
+    assert slices[1].get_right() == 8.0
+
+    # a length change rebuilds the steps at the next turn
+    lattice.get_elements()[1].set_double_attribute('l', 7.0)
+    propagator.propagate(sim, simlog, 1)
+
+    slices = list(propagator.get_lattice_element_slices())
+    assert slices[1].get_right() == 7.0
+    return True
+
+def test_slice_reference_table(prop_fixture):
+    propagator = prop_fixture['propagator']
+    lattice = propagator.get_lattice()
+    beta = lattice.get_reference_particle().get_beta()
+
+    table = propagator.get_slice_reference_table()
+    assert table.shape[0] == len(list(propagator.get_lattice_element_slices()))
+    assert table[:, 0].sum() == pytest.approx(20.0)
+    assert table[-1, 1] == pytest.approx(20.0)
+
+    # on axis the reference cdt of a drift is l/beta
+    assert table[1, 2] == pytest.approx(8.0/beta)
+
+    # recomputed after the lattice has changed
+    lattice.get_elements()[1].set_double_attribute('l', 7.0)
+    refpart = lattice.get_reference_particle()
+    sim = synergia.simulation.Bunch_simulator.create_single_bunch_simulator(
+        refpart, 16, 1.0e10)
+    simlog = synergia.utils.parallel_utils.Logger(
+        0, synergia.utils.parallel_utils.LoggerV.WARNING, False)
+    propagator.propagate(sim, simlog, 1)
+
+    table = propagator.get_slice_reference_table()
+    assert table[1, 2] == pytest.approx(7.0/beta)
+    return True
+
+def test_slice_reference_table_element_change():
+    channel_madx = """
+beam, particle=proton,pc=3.0;
+
+o: drift, l=1.0;
+rfc: rfcavity, l=0.0, volt=0.1, lag=0.25;
+
+channel: line=(o, rfc, o);
+"""
+    reader = synergia.lattice.MadX_reader()
+    reader.parse(channel_madx)
+    lattice = reader.get_lattice('channel')
+    lattice.set_all_string_attribute('extractor_type', 'libff')
+
+    stepper = synergia.simulation.Independent_stepper_elements(1)
+    propagator = synergia.simulation.Propagator(lattice, stepper)
+    lattice = propagator.get_lattice()
+
+    table = propagator.get_slice_reference_table()
+    p0 = lattice.get_reference_particle().get_momentum()
+    p1 = table[-1, 3]
+    assert p1 > p0
+
+    # no lattice update in between, the table follows the element revision
+    lattice.get_elements()[1].set_double_attribute('volt', 0.2)
+    table = propagator.get_slice_reference_table()
+    assert table[-1, 3] - p0 > 1.5 * (p1 - p0)
+
+    # and the reference energy
+    beta0 = table[0, 4]
+    refpart = lattice.get_reference_particle()
+    refpart.set_total_energy(refpart.get_total_energy() + 1.0)
+    table = propagator.get_slice_reference_table()
+    assert table[0, 4] > beta0
+    return True
+
+dynamic_fodo_madx = """
+beam, particle=proton,pc=3.0;
+
+kq = {};
+
+o: drift, l=8.0;
+f: quadrupole, l=2.0, k1=kq;
+d: quadrupole, l=2.0, k1=-kq;
+
+fodo: sequence, l=20.0, refer=entry;
+fodo_1: f, at=0.0;
+fodo_2: o, at=2.0;
+fodo_3: d, at=10.0;
+fodo_4: o, at=12.0;
+endsequence;
+"""
+
+def get_dynamic_fodo(kq):
+    reader = synergia.lattice.MadX_reader()
+    reader.parse(dynamic_fodo_madx.format(kq))
+    lattice = reader.get_dynamic_lattice('fodo')
+    lattice.set_all_string_attribute('extractor_type', 'libff')
+    return lattice
+
+def get_particles(sim):
+    bunch = sim.get_bunch()
+    bunch.checkout_particles()
+    return numpy.array(bunch.get_particles_numpy()[:, 0:6])
+
+def test_set_variable_propagated_map():
+    kq0 = 0.071428571428571425
+    kq1 = 0.06
+
+    simlog = synergia.utils.parallel_utils.Logger(
+        0, synergia.utils.parallel_utils.LoggerV.WARNING, False)
+
+    def create_simulator(lattice):
+        sim = synergia.simulation.Bunch_simulator.create_single_bunch_simulator(
+            lattice.get_reference_particle(), 4, 1.0e10)
+        bunch = sim.get_bunch()
+        bunch.checkout_particles()
+        lp = bunch.get_particles_numpy()
+        lp[:, 0:6] = 0.0
+        for i in range(4):
+            lp[i, 0] = 1.0e-3 * (i + 1)
+            lp[i, 2] = -0.5e-3 * (i + 1)
+            lp[i, 1] = 1.0e-5 * i
+        bunch.checkin_particles()
+        return sim
+
+    def create_propagator(lattice):
+        stepper = synergia.simulation.Independent_stepper_elements(1)
+        return synergia.simulation.Propagator(lattice, stepper)
+
+    # one turn with kq0, then the variable is changed on the lattice of
+    # the propagator and a second turn is done
+    propagator = create_propagator(get_dynamic_fodo(kq0))
+    lattice = propagator.get_lattice()
+
+    sim = create_simulator(lattice)
+    propagator.propagate(sim, simlog, 1)
+
+    revisions = [e.get_revision() for e in lattice.get_elements()]
+    lattice.set_variable('kq', kq1)
+
+    # only the quadrupoles depend on the variable
+    quadrupole = synergia.lattice.element_type.quadrupole
+    for e, rev in zip(lattice.get_elements(), revisions):
+        if e.get_type() == quadrupole:
+            assert e.get_revision() > rev
+        else:
+            assert e.get_revision() == rev
+
+    propagator.propagate(sim, simlog, 1)
+
+    # the same two turns with a new lattice for the second one
+    ref_sim = create_simulator(lattice)
+    create_propagator(get_dynamic_fodo(kq0)).propagate(ref_sim, simlog, 1)
+    create_propagator(get_dynamic_fodo(kq1)).propagate(ref_sim, simlog, 1)
+
+    # and without the change
+    old_sim = create_simulator(lattice)
+    old_propagator = create_propagator(get_dynamic_fodo(kq0))
+    old_propagator.propagate(old_sim, simlog, 1)
+    old_propagator.propagate(old_sim, simlog, 1)
+
+    parts = get_particles(sim)
+    ref_parts = get_particles(ref_sim)
+    old_parts = get_particles(old_sim)
+
+    assert parts == pytest.approx(ref_parts, abs=1.0e-14)
+    assert numpy.abs(parts[:, 0] - old_parts[:, 0]).max() > 1.0e-6
@@ -0,0 +1,68 @@
+#include "synergia/utils/catch.hpp"
+
+#include "synergia/simulation/bunch_simulator.h"
+#include "synergia/simulation/propagator.h"
+
+const int charge = 1;
+const double mass = 100.0;
+const double total_energy = 125.0;
+
+const Reference_particle ref(charge, mass, total_energy);
+
+const int total_num = 64;
+const double real_num = 2.0e12;
+const int num_bunches = 4;
+
+const double tolerance = 1.0e-12;
+
+TEST_CASE("time ramps follow bunch 0 on all ranks", "[Propagator]")
+{
+    Lattice lattice("ramps");
+    lattice.set_reference_particle(ref);
+
+    Lattice_element q("quadrupole", "q");
+    q.set_double_attribute("l", 0.5);
+    q.set_double_attribute("k1", 0.0);
+
+    Lattice_element d("drift", "d");
+    d.set_double_attribute("l", 1.0);
+
+    lattice.append(q);
+    lattice.append(d);
+
+    Propagator propagator(lattice, Independent_stepper_elements(1));
+
+    // k1 = 1000 * t
+    propagator.add_ramp(
+        "q", "k1", Ramp_table(ramp_index_t::time, {0.0, 1.0e-2}, {0.0, 10.0}));
+
+    auto sim = Bunch_simulator::create_bunch_train_simulator(
+        ref, total_num, real_num, num_bunches, 1.0, Commxx());
+
+    // a different time on every bunch, so a rank without bunch 0 would
+    // see a different value if it used its own bunches
+    for (auto& bunch : sim[0].get_bunches()) {
+        double t = 1.0e-3 * (bunch.get_bunch_index() + 1);
+        bunch.get_reference_particle().set_bunch_abs_time(t);
+    }
+
+    Logger logger(0, LoggerV::ERROR);
+
+    // the ramps are applied at the start of the turn, before the bunches
+    // have moved
+    propagator.propagate(sim, logger, 1);
+
+    double k1 = -1.0;
+    for (auto const& e : propagator.get_lattice().get_elements())
+        if (e.get_name() == "q") k1 = e.get_double_attribute("k1");
+
+    CHECK(k1 == Approx(1.0).epsilon(tolerance));
+
+    double kmin = 0.0;
+    double kmax = 0.0;
+
+    MPI_Allreduce(&k1, &kmin, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+    MPI_Allreduce(&k1, &kmax, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+    CHECK(kmin == kmax);
+}
@@ -0,0 +1,112 @@
+#include "synergia/utils/catch.hpp"
+
+#include "synergia/collective/space_charge_3d_open_hockney.h"
+#include "synergia/foundation/physical_constants.h"
+#include "synergia/simulation/bunch_simulator.h"
+#include "synergia/simulation/step.h"
+
+const int charge = pconstants::proton_charge;
+const double mass = pconstants::mp;
+const double total_energy = 1.5;
+
+const Reference_particle ref(charge, mass, total_energy);
+
+const int total_num = 4096;
+const double real_num = 1.0e12;
+const int num_bunches = 3;
+
+const double step_length = 0.5;
+
+const double tolerance = 1.0e-12;
+
+namespace {
+    Bunch_simulator
+    create_shared_simulator()
+    {
+        auto sim = Bunch_simulator::create_bunch_train_simulator(
+            ref, total_num, real_num, num_bunches, 1.0, Commxx());
+
+        // every bunch on every rank, so that Step::apply() pipelines
+        sim.share_bunch_ranks(0);
+
+        int rank = Commxx().rank();
+
+        // a different size for each bunch, so that the charge densities
+        // of the bunches can not be mixed up in the pipeline
+        for (auto& bunch : sim[0].get_bunches()) {
+            auto parts = bunch.get_host_particles();
+            double scale = 1.0e-3 * (1 + bunch.get_bunch_index());
+
+            for (int p = 0; p < bunch.get_local_num(); ++p) {
+                double s = p + 0.37 * rank;
+
+                parts(p, Bunch::x) = scale * std::sin(1.1 * s);
+                parts(p, Bunch::xp) = 0.0;
+                parts(p, Bunch::y) = 0.7 * scale * std::cos(1.7 * s);
+                parts(p, Bunch::yp) = 0.0;
+                parts(p, Bunch::cdt) = 10.0 * scale * std::sin(0.3 * s);
+                parts(p, Bunch::dpop) = 0.0;
+            }
+
+            bunch.checkin_particles();
+        }
+
+        return sim;
+    }
+
+    Space_charge_3d_open_hockney_options
+    sc_options()
+    {
+        Space_charge_3d_open_hockney_options ops(16, 16, 32);
+        ops.green_fn = green_fn_t::linear;
+        return ops;
+    }
+}
+
+TEST_CASE("pipelined step matches the serial step", "[Step]")
+{
+    Logger logger(0, LoggerV::ERROR);
+
+    auto sim_serial = create_shared_simulator();
+    auto sim_pipelined = create_shared_simulator();
+
+    REQUIRE(sim_pipelined[0].get_num_local_bunches() == num_bunches);
+
+    // serial reference, the operator applied to all bunches at once
+    Space_charge_3d_open_hockney sc_serial(sc_options());
+
+    double time = step_length / (ref.get_beta() * pconstants::c);
+    sc_serial.apply(sim_serial, time, logger);
+
+    // Step::apply() goes through apply_pipeline() with more than one
+    // rank, since all the local bunches share their communicator
+    Step step(step_length);
+    step.append(std::make_shared<Space_charge_3d_open_hockney>(sc_options()));
+    step.apply(sim_pipelined, logger);
+
+    for (int b = 0; b < num_bunches; ++b) {
+        auto& bs = sim_serial[0][b];
+        auto& bp = sim_pipelined[0][b];
+
+        bs.checkout_particles();
+        bp.checkout_particles();
+
+        auto ps = bs.get_host_particles();
+        auto pp = bp.get_host_particles();
+
+        REQUIRE(bs.get_local_num() == bp.get_local_num());
+
+        bool kicked = false;
+
+        for (int p = 0; p < bs.get_local_num(); ++p) {
+            for (int i = 0; i < 6; ++i) {
+                CHECK(pp(p, i) ==
+                      Approx(ps(p, i)).epsilon(tolerance).margin(1.0e-18));
+            }
+
+            kicked = kicked || ps(p, Bunch::xp) != 0.0;
+        }
+
+        CHECK(kicked);
+    }
+}
@@ -0,0 +1,148 @@
+#ifndef ARRAY_EXPORT_H_
+#define ARRAY_EXPORT_H_
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <Kokkos_Core.hpp>
+
+#include "synergia/utils/dlpack.h"
+
+// Array_export describes a (strided) Kokkos array without copying it, so
+// it can be handed to other array libraries through the DLPack or the
+// (cuda) array interface protocols. A reference to the underlying
+// allocation is kept for as long as the export (or any DLPack tensor made
+// from it) is alive.
+struct Array_export {
+    void* data;
+    DLDataType dtype;
+    DLDevice device;
+
+    // strides are in number of elements
+    std::vector<int64_t> shape;
+    std::vector<int64_t> strides;
+
+    // keeps the Kokkos allocation alive
+    std::shared_ptr<void> owner;
+
+    Array_export()
+        : data(nullptr), dtype(), device{kDLCPU, 0}, shape(), strides(), owner()
+    {}
+
+    template <class View>
+    static Array_export from_view(View const& v);
+
+    // restrict a 2d array to the rows [0, rows) and columns [first, last).
+    // no copy is made
+    Array_export
+    subset(int64_t rows, int first, int last) const
+    {
+        if (shape.size() != 2)
+            throw std::runtime_error("Array_export::subset: 2d array only");
+
+        if (rows < 0 || rows > shape[0] || first < 0 || last > shape[1] ||
+            first >= last)
+            throw std::runtime_error("Array_export::subset: invalid range");
+
+        Array_export e(*this);
+        e.data = (char*)data + first * strides[1] * (dtype.bits / 8);
+        e.shape = {rows, last - first};
+        return e;
+    }
+
+    bool
+    on_host() const
+    {
+        return device.device_type == kDLCPU ||
+               device.device_type == kDLCUDAHost;
+    }
+
+    // allocates a DLManagedTensor owning a copy of this export. The
+    // consumer is responsible for calling the deleter
+    DLManagedTensor*
+    to_dlpack() const
+    {
+        struct ctx_t {
+            Array_export ae;
+            DLManagedTensor tensor;
+        };
+
+        auto ctx = new ctx_t{*this, DLManagedTensor()};
+
+        ctx->tensor.dl_tensor.data = ctx->ae.data;
+        ctx->tensor.dl_tensor.device = ctx->ae.device;
+        ctx->tensor.dl_tensor.ndim = ctx->ae.shape.size();
+        ctx->tensor.dl_tensor.dtype = ctx->ae.dtype;
+        ctx->tensor.dl_tensor.shape = ctx->ae.shape.data();
+        ctx->tensor.dl_tensor.strides = ctx->ae.strides.data();
+        ctx->tensor.dl_tensor.byte_offset = 0;
+
+        ctx->tensor.manager_ctx = ctx;
+        ctx->tensor.deleter = [](DLManagedTensor* self) {
+            delete (ctx_t*)self->manager_ctx;
+        };
+
+        return &ctx->tensor;
+    }
+};
+
+namespace array_export_impl {
+    template <class T>
+    DLDataType
+    dtype()
+    {
+        static_assert(std::is_arithmetic<T>::value,
+                      "Array_export: only arithmetic types can be exported");
+
+        uint8_t code = std::is_floating_point<T>::value ? kDLFloat
+                       : std::is_signed<T>::value       ? kDLInt
+                                                        : kDLUInt;
+
+        return DLDataType{code, uint8_t(sizeof(T) * 8), 1};
+    }
+
+    template <class MemSpace>
+    DLDevice
+    device()
+    {
+        if constexpr (Kokkos::SpaceAccessibility<Kokkos::HostSpace,
+                                                 MemSpace>::accessible) {
+            return DLDevice{kDLCPU, 0};
+        } else {
+#if defined KOKKOS_ENABLE_CUDA
+            return DLDevice{kDLCUDA, Kokkos::Cuda().cuda_device()};
+#elif defined KOKKOS_ENABLE_HIP
+            return DLDevice{kDLROCM, Kokkos::HIP().hip_device()};
+#else
+            throw std::runtime_error("Array_export: unsupported memory space");
+#endif
+        }
+    }
+}
+
+template <class View>
+inline Array_export
+Array_export::from_view(View const& v)
+{
+    using value_t = typename View::non_const_value_type;
+    using memspace_t = typename View::memory_space;
+
+    Array_export e;
+
+    e.data = (void*)v.data();
+    e.dtype = array_export_impl::dtype<value_t>();
+    e.device = array_export_impl::device<memspace_t>();
+
+    for (size_t i = 0; i < View::rank; ++i) {
+        e.shape.push_back(v.extent(i));
+        e.strides.push_back(v.stride(i));
+    }
+
+    // the copy of the view holds a reference to the allocation
+    e.owner = std::shared_ptr<void>(nullptr, [v](void*) {});
+
+    return e;
+}
+
+#endif /* ARRAY_EXPORT_H_ */
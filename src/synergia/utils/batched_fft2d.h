@@ -0,0 +1,47 @@
+#ifndef BATCHED_FFT2D_H_
+#define BATCHED_FFT2D_H_
+
+#include <array>
+
+#include "synergia/utils/kokkos_views.h"
+
+// A batch of local (single rank) 2d complex-to-complex transforms over
+// consecutive arrays of shape[0] x shape[1] interleaved complex values,
+// executed as a single batched plan
+class Batched_fft2d_base {
+
+protected:
+  std::array<int, 2> shape;
+  int batch;
+
+public:
+  Batched_fft2d_base() : shape(), batch(0) {}
+
+  virtual ~Batched_fft2d_base() {}
+
+  std::array<int, 2> const&
+  get_shape() const
+  {
+    return shape;
+  }
+
+  int
+  get_batch() const
+  {
+    return batch;
+  }
+
+  double
+  get_roundtrip_normalization() const
+  {
+    return 1.0 / (shape[0] * shape[1]);
+  }
+};
+
+#ifdef SYNERGIA_ENABLE_CUDA
+#include "synergia/utils/batched_fft2d_cuda.h"
+#else
+#include "synergia/utils/batched_fft2d_fftw.h"
+#endif
+
+#endif
@@ -0,0 +1,63 @@
+#include "batched_fft2d.h"
+#include <stdexcept>
+
+Batched_fft2d::Batched_fft2d() : Batched_fft2d_base(), plan(), planned(false)
+{}
+
+void
+Batched_fft2d::construct(std::array<int, 2> const& new_shape, int new_batch)
+{
+  if (planned) cufftDestroy(plan);
+  planned = false;
+
+  shape = new_shape;
+  batch = new_batch;
+
+  if (batch <= 0) return;
+
+  int n[] = {shape[0], shape[1]};
+  int dist = shape[0] * shape[1];
+
+  if (cufftPlanMany(&plan,
+                    2,
+                    n,
+                    nullptr,
+                    1,
+                    dist,
+                    nullptr,
+                    1,
+                    dist,
+                    CUFFT_Z2Z,
+                    batch) != CUFFT_SUCCESS) {
+    throw std::runtime_error("Batched_fft2d: failed to create the plan");
+  }
+
+  planned = true;
+}
+
+void
+Batched_fft2d::transform(karray1d_dev& in, karray1d_dev& out)
+{
+  if (!planned) return;
+
+  cufftExecZ2Z(plan,
+               (cufftDoubleComplex*)in.data(),
+               (cufftDoubleComplex*)out.data(),
+               CUFFT_FORWARD);
+}
+
+void
+Batched_fft2d::inv_transform(karray1d_dev& in, karray1d_dev& out)
+{
+  if (!planned) return;
+
+  cufftExecZ2Z(plan,
+               (cufftDoubleComplex*)in.data(),
+               (cufftDoubleComplex*)out.data(),
+               CUFFT_INVERSE);
+}
+
+Batched_fft2d::~Batched_fft2d()
+{
+  if (planned) cufftDestroy(plan);
+}
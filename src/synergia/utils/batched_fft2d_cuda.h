@@ -0,0 +1,26 @@
+#ifndef BATCHED_FFT2D_CUDA_H_
+#define BATCHED_FFT2D_CUDA_H_
+
+#include <cufft.h>
+
+class Batched_fft2d : public Batched_fft2d_base {
+
+private:
+  cufftHandle plan;
+  bool planned;
+
+public:
+  Batched_fft2d();
+  virtual ~Batched_fft2d();
+
+  Batched_fft2d(Batched_fft2d const&) = delete;
+  Batched_fft2d& operator=(Batched_fft2d const&) = delete;
+
+  void construct(std::array<int, 2> const& shape, int batch);
+
+  void transform(karray1d_dev& in, karray1d_dev& out);
+
+  void inv_transform(karray1d_dev& in, karray1d_dev& out);
+};
+
+#endif /* BATCHED_FFT2D_CUDA_H_ */
@@ -0,0 +1,107 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "batched_fft2d.h"
+
+Batched_fft2d::Batched_fft2d()
+  : Batched_fft2d_base()
+  , plan(nullptr)
+  , inv_plan(nullptr)
+  , data(nullptr)
+  , workspace(nullptr)
+{}
+
+void
+Batched_fft2d::construct(std::array<int, 2> const& new_shape, int new_batch)
+{
+  if (data || workspace) {
+    fftw_destroy_plan(plan);
+    fftw_destroy_plan(inv_plan);
+    fftw_free(data);
+    fftw_free(workspace);
+  }
+
+  plan = nullptr;
+  inv_plan = nullptr;
+  data = nullptr;
+  workspace = nullptr;
+
+  shape = new_shape;
+  batch = new_batch;
+
+  if (batch <= 0) return;
+
+  int n[] = {shape[0], shape[1]};
+  int dist = shape[0] * shape[1];
+
+  data = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * dist * batch);
+  workspace = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * dist * batch);
+
+  plan = fftw_plan_many_dft(2,
+                            n,
+                            batch,
+                            data,
+                            nullptr,
+                            1,
+                            dist,
+                            workspace,
+                            nullptr,
+                            1,
+                            dist,
+                            FFTW_FORWARD,
+                            FFTW_ESTIMATE);
+
+  inv_plan = fftw_plan_many_dft(2,
+                                n,
+                                batch,
+                                workspace,
+                                nullptr,
+                                1,
+                                dist,
+                                data,
+                                nullptr,
+                                1,
+                                dist,
+                                FFTW_BACKWARD,
+                                FFTW_ESTIMATE);
+}
+
+void
+Batched_fft2d::transform(karray1d_dev& in, karray1d_dev& out)
+{
+  if (!batch) return;
+
+  if (!data || !workspace)
+    throw std::runtime_error("Batched_fft2d::transform() uninitialized");
+
+  size_t bytes = sizeof(double) * 2 * shape[0] * shape[1] * batch;
+
+  memcpy((void*)data, (void*)in.data(), bytes);
+  fftw_execute(plan);
+  memcpy((void*)out.data(), (void*)workspace, bytes);
+}
+
+void
+Batched_fft2d::inv_transform(karray1d_dev& in, karray1d_dev& out)
+{
+  if (!batch) return;
+
+  if (!data || !workspace)
+    throw std::runtime_error("Batched_fft2d::inv_transform() uninitialized");
+
+  size_t bytes = sizeof(double) * 2 * shape[0] * shape[1] * batch;
+
+  memcpy((void*)workspace, (void*)in.data(), bytes);
+  fftw_execute(inv_plan);
+  memcpy((void*)out.data(), (void*)data, bytes);
+}
+
+Batched_fft2d::~Batched_fft2d()
+{
+  if (data || workspace) {
+    fftw_destroy_plan(plan);
+    fftw_destroy_plan(inv_plan);
+    fftw_free(data);
+    fftw_free(workspace);
+  }
+}
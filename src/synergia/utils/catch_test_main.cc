@@ -20,7 +20,8 @@ main(int argc, char* argv[])
         Kokkos::InitializationSettings{}; /* use default constructor */
     Kokkos::initialize(initargs);
 #else
-    MPI_Init(&argc, &argv);
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
     Kokkos::initialize(argc, argv);
 #endif
 
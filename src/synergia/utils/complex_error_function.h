@@ -1,6 +1,7 @@
 #ifndef COMPLEX_ERROR_FUNCTION_H_
 #define COMPLEX_ERROR_FUNCTION_H_
 
+#include <Kokkos_Macros.hpp>
 #include <Kokkos_MathematicalConstants.hpp>
 #include <cmath>
 #include <complex>
@@ -158,4 +159,76 @@ wofz(std::complex<double> z)
     return std::complex<double>(u, v);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Branch-free Faddeeva function w(z) for z = x + iy in the closed upper half
+// plane (y >= 0), from the N = 32 rational approximation of J.A.C. Weideman,
+// "Computation of the complex error function", SIAM J. Numer. Anal. 31
+// (1994) 1497:
+//
+//   w(z) = 2 p(Z) / (L - iz)^2 + 1/sqrt(pi) / (L - iz),
+//   Z = (L + iz) / (L - iz),  L = 2^(-1/4) N^(1/2)
+//
+// where p is a polynomial of degree N-1. Every argument takes the same
+// number of operations, so T can be double or GSVector, and the function
+// can be called from the Kokkos kernels. The relative difference to wofz()
+// is below 1e-12. Use w(-conj(z)) = conj(w(z)) and w(-z) = 2 exp(-z^2) -
+// w(z) for the lower half plane.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+template <class T>
+KOKKOS_INLINE_FUNCTION void
+wofz_upper(T const& x, T const& y, T& wr, T& wi)
+{
+    const double L = 4.756828460010884;
+    const double isqrtpi = 0.56418958354775628695;
+
+    // polynomial coefficients, highest order first
+    constexpr double a[32] = {
+        -1.30255212179359728e-12, 3.74129199842698767e-12,
+        8.02722471826555761e-12, -2.15443635154244362e-11,
+        -5.54422271981103165e-11, 1.16579232378732911e-10,
+        4.15375171758380901e-10, -5.23100791849362423e-10,
+        -3.20801434028350485e-09, 8.12481110168405962e-10,
+        2.37975537747958654e-08, 2.29304423643439392e-08,
+        -1.48130789232037152e-07, -4.18407639687923272e-07,
+        4.25583313798383323e-07, 4.40153173207613602e-06,
+        6.82103194306338256e-06, -2.14096192055202028e-05,
+        -1.30754492549511880e-04, -2.45329802699423283e-04,
+        3.92591360698801850e-04, 4.51954110534580344e-03,
+        1.90061557848448803e-02, 5.73044035298368032e-02,
+        1.40607162268936381e-01, 2.95444510715085540e-01,
+        5.46013972063932873e-01, 9.01925489364799438e-01,
+        1.34554416923454379e+00, 1.82566962963248147e+00,
+        2.26353729990026631e+00, 2.57225340812456871e+00};
+
+    // 1 / (L - iz) = ((L + y) + ix) / ((L + y)^2 + x^2)
+    T lpy = y + T(L);
+    T id = T(1.0) / (lpy * lpy + x * x);
+    T qr = lpy * id;
+    T qi = x * id;
+
+    // Z = (L^2 - x^2 - y^2 + 2iLx) / ((L + y)^2 + x^2)
+    T zr = (T(L * L) - x * x - y * y) * id;
+    T zi = T(2.0 * L) * x * id;
+
+    // p(Z) with Horner's scheme
+    T pr(a[0]);
+    T pi(0.0);
+
+    for (int k = 1; k < 32; ++k) {
+        T t = pr * zr - pi * zi + T(a[k]);
+        pi = pr * zi + pi * zr;
+        pr = t;
+    }
+
+    // w = q * (2 p q + 1/sqrt(pi))
+    T sr = T(2.0) * (pr * qr - pi * qi) + T(isqrtpi);
+    T si = T(2.0) * (pr * qi + pi * qr);
+
+    wr = qr * sr - qi * si;
+    wi = qr * si + qi * sr;
+}
+
 #endif /* COMPLEX_ERROR_FUNCTION_H_ */
@@ -0,0 +1,54 @@
+#ifndef DLPACK_H_
+#define DLPACK_H_
+
+// Minimal subset of the DLPack ABI (v0.8, https://github.com/dmlc/dlpack)
+// needed to export arrays to the Python array libraries. The definitions
+// must stay binary compatible with the upstream dlpack.h.
+
+#include <cstdint>
+
+extern "C" {
+
+typedef enum {
+    kDLCPU = 1,
+    kDLCUDA = 2,
+    kDLCUDAHost = 3,
+    kDLROCM = 10,
+    kDLCUDAManaged = 13,
+} DLDeviceType;
+
+typedef struct {
+    DLDeviceType device_type;
+    int32_t device_id;
+} DLDevice;
+
+typedef enum {
+    kDLInt = 0U,
+    kDLUInt = 1U,
+    kDLFloat = 2U,
+} DLDataTypeCode;
+
+typedef struct {
+    uint8_t code;
+    uint8_t bits;
+    uint16_t lanes;
+} DLDataType;
+
+typedef struct {
+    void* data;
+    DLDevice device;
+    int32_t ndim;
+    DLDataType dtype;
+    int64_t* shape;
+    int64_t* strides; // in number of elements, not bytes
+    uint64_t byte_offset;
+} DLTensor;
+
+typedef struct DLManagedTensor {
+    DLTensor dl_tensor;
+    void* manager_ctx;
+    void (*deleter)(struct DLManagedTensor* self);
+} DLManagedTensor;
+}
+
+#endif /* DLPACK_H_ */
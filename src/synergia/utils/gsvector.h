@@ -37,6 +37,21 @@ namespace detail {
     {
       *p = v;
     }
+
+    KOKKOS_INLINE_FUNCTION
+    static T
+    absolute(const T& v)
+    {
+      return v < 0.0 ? -v : v;
+    }
+
+    // a with its sign flipped where b is negative
+    KOKKOS_INLINE_FUNCTION
+    static T
+    flip_sign(const T& a, const T& b)
+    {
+      return b < 0.0 ? -a : a;
+    }
   };
 } // namespace detail
 
@@ -107,6 +122,24 @@ struct GSVec : public VecExpr<GSVec<T>, T> {
     *p = data;
   }
 
+  // reduced precision particles (bunch_t<float>) are widened to double
+  // on load and narrowed on store
+  template <typename U = T>
+  KOKKOS_INLINE_FUNCTION
+  GSVec(const float* p,
+        typename std::enable_if<std::is_same<U, double>::value>::type* = 0)
+    : data(*p)
+  {}
+
+  template <typename U = T>
+  KOKKOS_INLINE_FUNCTION void
+  store(
+    float* p,
+    typename std::enable_if<std::is_same<U, double>::value>::type* = 0) const
+  {
+    *p = data;
+  }
+
   KOKKOS_INLINE_FUNCTION
   T&
   cal()
@@ -498,6 +531,20 @@ namespace detail {
     {
       v.store_a(p);
     }
+
+    KOKKOS_INLINE_FUNCTION
+    static T
+    absolute(const T& v)
+    {
+      return abs(v);
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static T
+    flip_sign(const T& a, const T& b)
+    {
+      return sign_combine(a, b);
+    }
   };
 
   template <class T>
@@ -526,6 +573,20 @@ namespace detail {
     {
       v.store_a(p);
     }
+
+    KOKKOS_INLINE_FUNCTION
+    static T
+    absolute(const T& v)
+    {
+      return abs(v);
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static T
+    flip_sign(const T& a, const T& b)
+    {
+      return sign_combine(a, b);
+    }
   };
 
   template <class T>
@@ -554,6 +615,20 @@ namespace detail {
     {
       v.store_a(p);
     }
+
+    KOKKOS_INLINE_FUNCTION
+    static T
+    absolute(const T& v)
+    {
+      return abs(v);
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    static T
+    flip_sign(const T& a, const T& b)
+    {
+      return sign_combine(a, b);
+    }
   };
 } // namespace detail
 
@@ -575,6 +650,40 @@ struct VecAdd<
   }
 };
 
+// element-wise |v|, and a with its sign flipped where b is negative.
+// Available for the evaluated vectors only (not the expressions)
+KOKKOS_INLINE_FUNCTION
+double
+gsv_abs(double v)
+{
+  return detail::VectorHelper<double>::absolute(v);
+}
+
+KOKKOS_INLINE_FUNCTION
+double
+gsv_flip_sign(double a, double b)
+{
+  return detail::VectorHelper<double>::flip_sign(a, b);
+}
+
+template <class T>
+KOKKOS_INLINE_FUNCTION GSVec<T>
+gsv_abs(GSVec<T> const& v)
+{
+  GSVec<T> r(0.0);
+  r.data = detail::VectorHelper<T>::absolute(v.data);
+  return r;
+}
+
+template <class T>
+KOKKOS_INLINE_FUNCTION GSVec<T>
+gsv_flip_sign(GSVec<T> const& a, GSVec<T> const& b)
+{
+  GSVec<T> r(0.0);
+  r.data = detail::VectorHelper<T>::flip_sign(a.data, b.data);
+  return r;
+}
+
 // stream operator
 template <class T>
 inline std::ostream&
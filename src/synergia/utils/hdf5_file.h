@@ -174,6 +174,33 @@ class Hdf5_file {
         w->second.append(data, collective);
     }
 
+    // append data[0], data[1], ... in a single write. chunk_slabs and
+    // deflate are the chunking and compression of the dataset, used only
+    // when the dataset is created by this call
+    template <typename T>
+    void
+    append_slabs(std::string const& name,
+                 T const& data,
+                 bool collective = false,
+                 size_t chunk_slabs = 0,
+                 int deflate = 0)
+    {
+        auto w = seq_writers.find(name);
+        if (w == seq_writers.end()) {
+            w = seq_writers
+                    .emplace(name,
+                             Hdf5_seq_writer(h5file,
+                                             name,
+                                             *comm,
+                                             root_rank,
+                                             chunk_slabs,
+                                             deflate))
+                    .first;
+        }
+
+        w->second.append_slabs(data, collective);
+    }
+
     // read the dataset to all ranks
     template <typename T>
     T
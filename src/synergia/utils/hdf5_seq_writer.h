@@ -1,6 +1,7 @@
 #ifndef SYNERGIA_UTILS_HDF5_SEQ_WRITER_H
 #define SYNERGIA_UTILS_HDF5_SEQ_WRITER_H
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -23,13 +24,20 @@ class Hdf5_seq_writer {
     std::vector<hsize_t> offset;
     Hdf5_handler dataset;
 
+    // dataset creation: number of slabs in a chunk (0 for the default),
+    // and the deflate level (0 for no compression)
+    size_t chunk_slabs;
+    int deflate;
+
     bool setup;
 
   public:
     Hdf5_seq_writer(Hdf5_handler const& file,
                     std::string const& name,
                     Commxx const& comm,
-                    int root_rank)
+                    int root_rank,
+                    size_t chunk_slabs = 0,
+                    int deflate = 0)
         : file(file)
         , name(name)
         , comm(comm)
@@ -39,6 +47,8 @@ class Hdf5_seq_writer {
         , fdims()
         , offset()
         , dataset()
+        , chunk_slabs(chunk_slabs)
+        , deflate(deflate)
         , setup(false)
     {}
 
@@ -51,8 +61,39 @@ class Hdf5_seq_writer {
         // promote the dimension for collective write of a scalar
         if (collective && di.dims.size() == 0) di.dims = {1};
 
+        // a single slab
+        di.dims.insert(di.dims.begin(), 1);
+
+        append_impl(di, collective);
+    }
+
+    // append multiple slabs in one write. The first dimension of data is
+    // the number of slabs, so it is the same as calling append() on each
+    // data[i], except for the collective calls which are made only once
+    template <typename T>
+    void
+    append_slabs(T const& data, bool collective)
+    {
+        auto di = syn::extract_data_info(data);
+
+        if (di.dims.size() == 0)
+            throw std::runtime_error(
+                "Hdf5_seq_writer: append_slabs() on a scalar");
+
+        // promote the dimension for collective write of scalars
+        if (collective && di.dims.size() == 1) di.dims.push_back(1);
+
+        append_impl(di, collective);
+    }
+
+    // di.dims is (num_slabs, dims of a slab)
+    void
+    append_impl(syn::data_info_t& di, bool collective)
+    {
+        std::vector<hsize_t> slab_dims(di.dims.begin() + 1, di.dims.end());
+
         // collect data dims
-        auto all_dims0 = syn::collect_dims(di.dims, collective, comm, root);
+        auto all_dims0 = syn::collect_dims(slab_dims, collective, comm, root);
 
         // offsets for each rank (offsets of dim0 in the combined array)
         std::vector<hsize_t> offsets(mpi_size, 0);
@@ -62,12 +103,6 @@ class Hdf5_seq_writer {
         // dim0 of the combined array
         hsize_t dim0 = offsets[mpi_size - 1] + all_dims0[mpi_size - 1];
 
-        // promote the data dim and set the first dim to 1
-        di.dims.resize(di.dims.size() + 1);
-        for (int i = di.dims.size() - 1; i > 0; --i)
-            di.dims[i] = di.dims[i - 1];
-        di.dims[0] = 1;
-
         // setup dataset
         if (!setup) {
             bool has = Hdf5_reader::has_dataset(file, name, comm, root);
@@ -141,6 +176,15 @@ class Hdf5_seq_writer {
         chunk_fdims[0] =
             (data_size < good_chunk_size) ? good_chunk_size / data_size : 1;
 
+        // chunk of the requested number of slabs, but no more than
+        // max_chunk_size bytes
+        const size_t max_chunk_size = 1 << 22;
+
+        if (chunk_slabs) {
+            size_t max_slabs = std::max<size_t>(max_chunk_size / data_size, 1);
+            chunk_fdims[0] = std::min(chunk_slabs, max_slabs);
+        }
+
         // are we resuming from an existing file or start new
         if (has_dataset) {
             // try to open the dataset
@@ -177,6 +221,18 @@ class Hdf5_seq_writer {
             herr_t res = H5Pset_chunk(cparms, d_rank, &chunk_fdims[0]);
             if (res < 0) throw Hdf5_exception();
 
+            if (deflate > 0) {
+                if (!H5Zfilter_avail(H5Z_FILTER_DEFLATE))
+                    throw std::runtime_error(
+                        "Hdf5_seq_writer: deflate filter not available");
+
+                res = H5Pset_shuffle(cparms);
+                if (res < 0) throw Hdf5_exception();
+
+                res = H5Pset_deflate(cparms, std::min(deflate, 9));
+                if (res < 0) throw Hdf5_exception();
+            }
+
             Hdf5_handler fspace =
                 H5Screate_simple(d_rank, &fdims[0], &max_fdims[0]);
             dataset = H5Dcreate(file,
@@ -205,8 +261,8 @@ class Hdf5_seq_writer {
         Hdf5_handler mspace =
             H5Screate_simple(dimsm.size(), dimsm.data(), NULL);
 
-        // increment and extend the dataset to the new size (last_dim+1)
-        ++fdims[0];
+        // extend the dataset by the number of slabs
+        fdims[0] += di.dims[0];
         herr_t res = H5Dset_extent(dataset, fdims.data());
         if (res < 0) throw Hdf5_exception();
 
@@ -229,14 +285,14 @@ class Hdf5_seq_writer {
         if (res < 0) throw Hdf5_exception();
 
         // increment the offset
-        ++offset[0];
+        offset[0] += di.dims[0];
 #else
 
         if (mpi_rank == root) {
             if (!file.valid()) throw std::runtime_error("invalid file handler");
 
-            // increment and extend the dataset to the new size (last_dim+1)
-            ++fdims[0];
+            // extend the dataset by the number of slabs
+            fdims[0] += di.dims[0];
             herr_t res = H5Dset_extent(dataset, fdims.data());
             if (res < 0) throw Hdf5_exception();
 
@@ -309,7 +365,7 @@ class Hdf5_seq_writer {
             }
 
             // increment the offset
-            ++offset[0];
+            offset[0] += di.dims[0];
         } else {
             // local dims(counts)
             auto dimsm = di.dims;
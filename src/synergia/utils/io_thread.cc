@@ -0,0 +1,181 @@
+#include "synergia/utils/io_thread.h"
+
+#include <stdexcept>
+
+#include <mpi.h>
+
+#include "synergia/utils/simple_timer.h"
+
+Io_thread::Io_thread()
+    : thread()
+    , mtx()
+    , cv_job()
+    , cv_done()
+    , jobs()
+    , capacity(2)
+    , active(false)
+    , busy(false)
+    , stopping(false)
+    , error()
+{}
+
+Io_thread::~Io_thread()
+{
+    // should have been stopped before MPI_Finalize, the writes left
+    // at this point are lost
+    if (active) {
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            jobs.clear();
+            stopping = true;
+        }
+
+        cv_job.notify_all();
+        thread.join();
+    }
+}
+
+Io_thread&
+Io_thread::get()
+{
+    static Io_thread io;
+    return io;
+}
+
+void
+Io_thread::start(size_t cap)
+{
+    if (active) return;
+
+    int provided = MPI_THREAD_SINGLE;
+    MPI_Query_thread(&provided);
+
+    if (provided < MPI_THREAD_MULTIPLE) {
+        throw std::runtime_error(
+            "Io_thread::start(): the background I/O thread requires "
+            "MPI to be initialized with MPI_THREAD_MULTIPLE");
+    }
+
+    capacity = cap ? cap : 1;
+    stopping = false;
+    error = nullptr;
+
+    thread = std::thread(&Io_thread::loop, this);
+    active = true;
+}
+
+void
+Io_thread::stop()
+{
+    if (!active) return;
+
+    wait();
+
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        stopping = true;
+    }
+
+    cv_job.notify_all();
+    thread.join();
+
+    active = false;
+
+    if (error) {
+        auto e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+void
+Io_thread::loop()
+{
+    // the simple timers synchronize over MPI_COMM_WORLD
+    simple_timer_counter::background = true;
+
+    while (true) {
+        job_t job;
+
+        {
+            std::unique_lock<std::mutex> lk(mtx);
+            cv_job.wait(lk, [this] { return stopping || !jobs.empty(); });
+
+            if (jobs.empty()) return;
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            busy = true;
+        }
+
+        // a free slot in the queue
+        cv_done.notify_all();
+
+        try {
+            job();
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lk(mtx);
+            if (!error) error = std::current_exception();
+        }
+
+        // release whatever the job holds before reporting it done
+        job = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            busy = false;
+        }
+
+        cv_done.notify_all();
+    }
+}
+
+void
+Io_thread::submit(job_t job)
+{
+    if (!active) {
+        job();
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lk(mtx);
+
+        // backpressure
+        cv_done.wait(lk, [this] { return jobs.size() < capacity; });
+        jobs.push_back(std::move(job));
+    }
+
+    cv_job.notify_one();
+}
+
+void
+Io_thread::run(job_t const& job)
+{
+    drain();
+    job();
+}
+
+void
+Io_thread::drain()
+{
+    wait();
+
+    std::lock_guard<std::mutex> lk(mtx);
+
+    if (error) {
+        auto e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+void
+Io_thread::wait() noexcept
+{
+    if (!active) return;
+
+    std::unique_lock<std::mutex> lk(mtx);
+    cv_done.wait(lk, [this] { return jobs.empty() && !busy; });
+}
@@ -0,0 +1,90 @@
+#ifndef IO_THREAD_H_
+#define IO_THREAD_H_
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/*
+ * Process wide background thread for the file writes.
+ *
+ * The jobs are run in the order they were submitted. Since every rank
+ * submits its jobs in the same order, the collective HDF5/openPMD calls
+ * made by the jobs are also matched across the ranks. The jobs must not
+ * use a communicator the main thread is using at the same time, i.e.,
+ * the writers get a private duplicate of the bunch communicator.
+ *
+ * Running the thread needs MPI_THREAD_MULTIPLE. HDF5 is in general not
+ * built thread safe, so all the other HDF5 calls must be made through
+ * run() or after a drain(). The diagnostics and the Bunch particle file
+ * reads and writes do so; any other code opening an HDF5 or openPMD
+ * file (e.g., an Hdf5_file handed to Bunch::write_file()) is
+ * responsible for it.
+ */
+class Io_thread {
+  public:
+    using job_t = std::function<void()>;
+
+  private:
+    std::thread thread;
+
+    std::mutex mtx;
+    std::condition_variable cv_job;
+    std::condition_variable cv_done;
+
+    std::deque<job_t> jobs;
+    size_t capacity;
+
+    bool active;
+    bool busy;
+    bool stopping;
+
+    // first exception thrown by a job, rethrown by the next drain()
+    std::exception_ptr error;
+
+    Io_thread();
+
+    void loop();
+
+  public:
+    ~Io_thread();
+
+    Io_thread(Io_thread const&) = delete;
+    Io_thread& operator=(Io_thread const&) = delete;
+
+    static Io_thread& get();
+
+    // start the thread. capacity is the number of pending jobs after
+    // which submit() blocks (2 for double buffering)
+    void start(size_t capacity = 2);
+
+    // drain the queue and join the thread
+    void stop();
+
+    bool
+    running() const
+    {
+        return active;
+    }
+
+    // queue a job, blocks while the queue is full. The job runs on the
+    // calling thread when the I/O thread is not running
+    void submit(job_t job);
+
+    // wait for the queued jobs, then run the job on the calling thread.
+    // For the writes which are not deferred, no other HDF5 call is in
+    // flight while it runs
+    void run(job_t const& job);
+
+    // wait for all the queued jobs, and rethrow the first error from
+    // any of them
+    void drain();
+
+    // same as drain() without rethrowing
+    void wait() noexcept;
+};
+
+#endif
@@ -6,6 +6,14 @@
 
 #include "commxx.h"
 
+/// Decompose length elements into contiguous ranges over the processors.
+/// The counts differ by at most one, with the larger counts on the last
+/// processors.
+void decompose_1d_raw(int processors,
+                      int length,
+                      std::vector<int>& offsets,
+                      std::vector<int>& counts);
+
 /// See decompose_1d_raw. The number of processors is extracted from the
 /// Commxx object.
 void decompose_1d(Commxx const& comm,
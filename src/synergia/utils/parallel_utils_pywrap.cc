@@ -2,6 +2,7 @@
 #include <pybind11/pybind11.h>
 
 #include "synergia/utils/commxx.h"
+#include "synergia/utils/io_thread.h"
 #include "synergia/utils/logger.h"
 #include "synergia/utils/parallel_utils.h"
 #include "synergia/utils/simple_timer.h"
@@ -57,4 +58,15 @@ PYBIND11_MODULE(parallel_utils, m)
                                   [](py::object) { return Commxx::Null; });
 
   m.def("simple_timer_print", &simple_timer_print, "logger"_a);
+
+  // background thread for the diagnostics writes. Must be started
+  // before the diagnostics are registered, and stopped before finalize
+  m.def(
+    "start_io_thread",
+    [](size_t capacity) { Io_thread::get().start(capacity); },
+    "capacity"_a = 2);
+
+  m.def("stop_io_thread", []() { Io_thread::get().stop(); });
+
+  m.def("drain_io_thread", []() { Io_thread::get().drain(); });
 }
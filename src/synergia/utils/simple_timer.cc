@@ -5,6 +5,8 @@ std::map<std::string, simple_timer_counter::timing>
   simple_timer_counter::timings =
     std::map<std::string, simple_timer_counter::timing>();
 
+thread_local bool simple_timer_counter::background = false;
+
 void
 simple_timer_print(Logger& logger)
 {
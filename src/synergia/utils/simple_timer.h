@@ -14,6 +14,10 @@ struct simple_timer_counter {
   };
   static std::map<std::string, timing> timings;
 
+  // set on the background I/O thread, the timers synchronize over
+  // MPI_COMM_WORLD and are only run on the main thread
+  static thread_local bool background;
+
   static void
   start(std::string const& label, double t0)
   {
@@ -33,6 +37,7 @@ inline void
 simple_timer_start(std::string const& label)
 {
 #ifdef SIMPLE_TIMER
+  if (simple_timer_counter::background) return;
   MPI_Barrier(MPI_COMM_WORLD);
   simple_timer_counter::start(label, MPI_Wtime());
 #endif
@@ -42,6 +47,7 @@ inline void
 simple_timer_stop(std::string const& label)
 {
 #ifdef SIMPLE_TIMER
+  if (simple_timer_counter::background) return;
   MPI_Barrier(MPI_COMM_WORLD);
   simple_timer_counter::stop(label, MPI_Wtime());
 #endif
@@ -0,0 +1,53 @@
+#include "synergia/utils/catch.hpp"
+
+#include "synergia/utils/array_export.h"
+#include "synergia/utils/kokkos_views.h"
+
+TEST_CASE("Array_export from_view", "[Array_export]")
+{
+    karray2d arr("arr", 10, 7);
+    auto ae = Array_export::from_view(arr);
+
+    CHECK(ae.data == arr.data());
+    CHECK(ae.shape == std::vector<int64_t>{10, 7});
+    CHECK(ae.strides == std::vector<int64_t>{1, 10});
+
+    CHECK(ae.dtype.code == kDLFloat);
+    CHECK(ae.dtype.bits == 64);
+    CHECK(ae.dtype.lanes == 1);
+    CHECK(ae.on_host());
+}
+
+TEST_CASE("Array_export subset", "[Array_export]")
+{
+    karray2d arr("arr", 10, 7);
+    auto ae = Array_export::from_view(arr).subset(8, 2, 5);
+
+    CHECK(ae.data == &arr(0, 2));
+    CHECK(ae.shape == std::vector<int64_t>{8, 3});
+    CHECK(ae.strides == std::vector<int64_t>{1, 10});
+
+    CHECK_THROWS(Array_export::from_view(arr).subset(11, 0, 7));
+    CHECK_THROWS(Array_export::from_view(arr).subset(10, 3, 3));
+}
+
+TEST_CASE("Array_export keeps the view alive", "[Array_export]")
+{
+    DLManagedTensor* t = nullptr;
+
+    {
+        Kokkos::View<uint8_t*, Kokkos::HostSpace> masks("masks", 16);
+        masks(3) = 1;
+
+        t = Array_export::from_view(masks).to_dlpack();
+        CHECK(masks.use_count() == 2);
+    }
+
+    CHECK(t->dl_tensor.ndim == 1);
+    CHECK(t->dl_tensor.shape[0] == 16);
+    CHECK(t->dl_tensor.dtype.code == kDLUInt);
+    CHECK(t->dl_tensor.dtype.bits == 8);
+    CHECK(((uint8_t*)t->dl_tensor.data)[3] == 1);
+
+    t->deleter(t);
+}
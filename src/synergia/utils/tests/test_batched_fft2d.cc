@@ -0,0 +1,117 @@
+#include "synergia/utils/catch.hpp"
+
+#include "synergia/utils/batched_fft2d.h"
+#include "synergia/utils/distributed_fft2d.h"
+
+const int shape0 = 16;
+const int shape1 = 8;
+const int batch = 3;
+
+const int size2d = shape0 * shape1 * 2;
+const double tolerance = 1.0e-12;
+
+namespace {
+    double
+    value(int b, int j, int k, int c)
+    {
+        return (c ? 1.2 : 1.1) * k + 10 * j + 100.0 * b * (c + 1);
+    }
+}
+
+TEST_CASE("construct")
+{
+    Batched_fft2d fft;
+    fft.construct({shape0, shape1}, batch);
+
+    auto s = fft.get_shape();
+    CHECK(s[0] == shape0);
+    CHECK(s[1] == shape1);
+    CHECK(fft.get_batch() == batch);
+    CHECK(fft.get_roundtrip_normalization() == 1.0 / (shape0 * shape1));
+
+    // an empty batch is allowed
+    REQUIRE_NOTHROW(fft.construct({shape0, shape1}, 0));
+}
+
+TEST_CASE("transform_roundtrip")
+{
+    Batched_fft2d fft;
+    fft.construct({shape0, shape1}, batch);
+
+    karray1d_dev d_src("src", size2d * batch);
+    karray1d_dev d_dst("dest", size2d * batch);
+
+    karray1d_hst src = Kokkos::create_mirror_view(d_src);
+
+    for (int b = 0; b < batch; ++b)
+        for (int j = 0; j < shape0; ++j)
+            for (int k = 0; k < shape1; ++k)
+                for (int c = 0; c < 2; ++c)
+                    src(b * size2d + j * shape1 * 2 + k * 2 + c) =
+                        value(b, j, k, c);
+
+    Kokkos::deep_copy(d_src, src);
+
+    fft.transform(d_src, d_dst);
+    fft.inv_transform(d_dst, d_src);
+
+    Kokkos::deep_copy(src, d_src);
+
+    auto norm = fft.get_roundtrip_normalization();
+
+    for (int b = 0; b < batch; ++b)
+        for (int j = 0; j < shape0; ++j)
+            for (int k = 0; k < shape1; ++k)
+                for (int c = 0; c < 2; ++c)
+                    CHECK(src(b * size2d + j * shape1 * 2 + k * 2 + c) *
+                              norm ==
+                          Approx(value(b, j, k, c)).margin(tolerance));
+}
+
+TEST_CASE("transform_vs_distributed")
+{
+    Batched_fft2d fft;
+    fft.construct({shape0, shape1}, batch);
+
+    // every rank does the full 2d transform of each slice
+    auto comm_world = std::make_shared<Commxx>(Commxx::World);
+    auto comm = comm_world->divide(1);
+
+    Distributed_fft2d dfft;
+    dfft.construct({shape0, shape1}, comm);
+
+    karray1d_dev d_src("src", size2d * batch);
+    karray1d_dev d_dst("dest", size2d * batch);
+
+    karray1d_hst src = Kokkos::create_mirror_view(d_src);
+    karray1d_hst dst = Kokkos::create_mirror_view(d_dst);
+
+    for (int b = 0; b < batch; ++b)
+        for (int j = 0; j < shape0; ++j)
+            for (int k = 0; k < shape1; ++k)
+                for (int c = 0; c < 2; ++c)
+                    src(b * size2d + j * shape1 * 2 + k * 2 + c) =
+                        value(b, j, k, c);
+
+    Kokkos::deep_copy(d_src, src);
+
+    fft.transform(d_src, d_dst);
+    Kokkos::deep_copy(dst, d_dst);
+
+    karray1d_dev d_slice("slice", size2d);
+    karray1d_dev d_ref("ref", size2d);
+    karray1d_hst slice = Kokkos::create_mirror_view(d_slice);
+    karray1d_hst ref = Kokkos::create_mirror_view(d_ref);
+
+    for (int b = 0; b < batch; ++b) {
+        for (int i = 0; i < size2d; ++i)
+            slice(i) = src(b * size2d + i);
+
+        Kokkos::deep_copy(d_slice, slice);
+        dfft.transform(d_slice, d_ref);
+        Kokkos::deep_copy(ref, d_ref);
+
+        for (int i = 0; i < size2d; ++i)
+            CHECK(dst(b * size2d + i) == Approx(ref(i)).margin(1.0e-8));
+    }
+}
@@ -0,0 +1,46 @@
+#include "synergia/utils/catch.hpp"
+
+#include "synergia/utils/complex_error_function.h"
+#include "synergia/utils/gsvector.h"
+
+TEST_CASE("wofz_upper matches wofz", "[wofz]")
+{
+    for (double x = -12.0; x <= 12.0; x += 0.37) {
+        for (double y = 0.0; y <= 12.0; y += 0.29) {
+            auto w = wofz(std::complex<double>(x, y));
+
+            double wr, wi;
+            wofz_upper(x, y, wr, wi);
+
+            CHECK(std::abs(std::complex<double>(wr, wi) - w) <
+                  1e-12 * std::abs(w));
+        }
+    }
+}
+
+TEST_CASE("wofz_upper on GSVector", "[wofz]")
+{
+    alignas(64) double xs[GSVector::size()];
+    alignas(64) double ys[GSVector::size()];
+    alignas(64) double wrs[GSVector::size()];
+    alignas(64) double wis[GSVector::size()];
+
+    for (int i = 0; i < GSVector::size(); ++i) {
+        xs[i] = -1.5 + 0.9 * i;
+        ys[i] = 0.1 + 0.7 * i;
+    }
+
+    GSVector x(xs), y(ys), wr(0.0), wi(0.0);
+    wofz_upper(x, y, wr, wi);
+
+    wr.store(wrs);
+    wi.store(wis);
+
+    for (int i = 0; i < GSVector::size(); ++i) {
+        double sr, si;
+        wofz_upper(xs[i], ys[i], sr, si);
+
+        CHECK(wrs[i] == Approx(sr).epsilon(1e-14));
+        CHECK(wis[i] == Approx(si).epsilon(1e-14));
+    }
+}
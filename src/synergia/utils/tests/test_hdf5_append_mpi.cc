@@ -259,3 +259,63 @@ TEST_CASE("hdf5_append_resume", "[Hdf5_file_append]")
 }
 
 
+
+TEST_CASE("hdf5_append_slabs", "[Hdf5_file_append]")
+{
+    int mpi_rank = Commxx::world_rank();
+    int mpi_size = Commxx::world_size();
+
+    std::stringstream ss;
+    ss << "hdf5_append_slabs_" << mpi_size << ".h5";
+    std::string fname = ss.str();
+
+    {
+        Hdf5_file file(fname, Hdf5_file::Flag::truncate, Commxx());
+
+        // v1: [1, 2, 3, 4, 5], two slabs then a single one then two
+        karray1d_row v1("v", 2);
+        v1(0) = 1.0;
+        v1(1) = 2.0;
+        file.append_slabs("v1", v1, false, 4, 1);
+        file.append("v1", 3.0, false);
+        v1(0) = 4.0;
+        v1(1) = 5.0;
+        file.append_slabs("v1", v1, false);
+
+        // v2_mem : [[[r, 0], [r, 1]], [[r, 10], [r, 11]]]
+        // v2_file: [ [[0, 0], [0, 1], [1, 0], [1, 1], ... ],
+        //            [[0, 10], [0, 11], [1, 10], [1, 11], ... ] ]
+        karray3d_row v2("v", 2, 2, 2);
+        for (int t = 0; t < 2; ++t) {
+            for (int p = 0; p < 2; ++p) {
+                v2(t, p, 0) = mpi_rank;
+                v2(t, p, 1) = t * 10 + p;
+            }
+        }
+        file.append_slabs("v2", v2, true, 2, 4);
+    }
+
+    {
+        Hdf5_file file(fname, Hdf5_file::Flag::read_only, Commxx());
+
+        // v1
+        auto v1 = file.read<karray1d_row>("v1");
+        REQUIRE(v1.extent(0) == 5);
+        for (int i = 0; i < 5; ++i)
+            CHECK(v1(i) == i + 1.0);
+
+        // v2
+        auto v2 = file.read<karray3d_row>("v2");
+        REQUIRE(v2.extent(0) == 2);
+        REQUIRE(v2.extent(1) == mpi_size * 2);
+        REQUIRE(v2.extent(2) == 2);
+        for (int i = 0; i < mpi_size; ++i) {
+            for (int t = 0; t < 2; ++t) {
+                for (int p = 0; p < 2; ++p) {
+                    CHECK(v2(t, i * 2 + p, 0) == i);
+                    CHECK(v2(t, i * 2 + p, 1) == t * 10 + p);
+                }
+            }
+        }
+    }
+}
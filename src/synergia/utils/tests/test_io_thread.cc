@@ -0,0 +1,70 @@
+#include "synergia/utils/catch.hpp"
+
+#include <mpi.h>
+#include <stdexcept>
+#include <vector>
+
+#include "synergia/utils/io_thread.h"
+
+TEST_CASE("Io_thread inline", "[Io_thread]")
+{
+    auto& io = Io_thread::get();
+    REQUIRE(!io.running());
+
+    // runs on the calling thread without the I/O thread
+    int n = 0;
+    io.submit([&]() { ++n; });
+    CHECK(n == 1);
+
+    io.run([&]() { ++n; });
+    CHECK(n == 2);
+
+    CHECK_NOTHROW(io.drain());
+}
+
+TEST_CASE("Io_thread background", "[Io_thread]")
+{
+    int provided;
+    MPI_Query_thread(&provided);
+
+    auto& io = Io_thread::get();
+
+    if (provided < MPI_THREAD_MULTIPLE) {
+        CHECK_THROWS_AS(io.start(), std::runtime_error);
+        return;
+    }
+
+    io.start(2);
+    REQUIRE(io.running());
+
+    SECTION("order and drain")
+    {
+        std::vector<int> done;
+
+        // more jobs than the capacity, submit blocks in between
+        for (int i = 0; i < 16; ++i)
+            io.submit([&done, i]() { done.push_back(i); });
+
+        io.drain();
+
+        REQUIRE(done.size() == 16);
+        for (int i = 0; i < 16; ++i)
+            CHECK(done[i] == i);
+
+        // run() waits for the queued jobs first
+        io.submit([&done]() { done.push_back(16); });
+        io.run([&done]() { CHECK(done.size() == 17); });
+    }
+
+    SECTION("errors")
+    {
+        io.submit([]() { throw std::runtime_error("write failed"); });
+        CHECK_THROWS_AS(io.drain(), std::runtime_error);
+
+        // reported once
+        CHECK_NOTHROW(io.drain());
+    }
+
+    io.stop();
+    CHECK(!io.running());
+}
@@ -6,6 +6,8 @@
 #include <mpi.h>
 #include <vector>
 
+#include "synergia/utils/io_thread.h"
+
 #if defined BUILD_FD_SPACE_CHARGE_SOLVER
 #include <petsc.h>
 #include <string>
@@ -31,7 +33,11 @@ namespace synergia {
             // PetscCallAbort(PETSC_COMM_WORLD, PetscLogGpuTimeBegin());
             // PetscCallAbort(PETSC_COMM_WORLD, PetscLogDefaultBegin());
 #else
-        if (MPI_Init(&argc, &argv) != MPI_SUCCESS) {
+        // MPI_THREAD_MULTIPLE for the background diagnostics I/O thread,
+        // which only starts if it is provided
+        int provided;
+        if (MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided) !=
+            MPI_SUCCESS) {
             std::runtime_error("Could not initialize MPI!");
         }
 #endif
@@ -54,6 +60,9 @@ namespace synergia {
     static void
     finalize()
     {
+        // pending diagnostics writes
+        Io_thread::get().stop();
+
         Kokkos::finalize();
 #if defined BUILD_FD_SPACE_CHARGE_SOLVER
         // PetscCallAbort(PETSC_COMM_WORLD, PetscLogGpuTimeEnd());
@@ -2,6 +2,8 @@
 #include <Kokkos_Core.hpp>
 #include <pybind11/pybind11.h>
 
+#include "synergia/utils/io_thread.h"
+
 #if defined BUILD_FD_SPACE_CHARGE_SOLVER
 #include <petsc.h>
 #include <string>
@@ -31,6 +33,7 @@ PYBIND11_MODULE(utils, m)
   });
 
   m.def("finalize", []() {
+    Io_thread::get().stop();
     Kokkos::finalize();
 #if defined BUILD_FD_SPACE_CHARGE_SOLVER
     PetscErrorCode ierr;